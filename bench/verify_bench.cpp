@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstdlib>
+#include <curlee/lexer/lexer.h>
+#include <curlee/parser/parser.h>
+#include <curlee/types/type_check.h>
+#include <curlee/verification/checker.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+// Benchmark for verification of chained conditionals.
+//
+// Usage: curlee_verify_bench [--max-ifs N] [--repeat N]
+//
+// Verifies functions with n chained if/else statements, doubling n up to --max-ifs. Every link
+// has an early return and a nested if/else, so 2^n paths reach the final `return`. Prints the
+// obligations discharged and the average verification time per size; both grow linearly,
+// because paths are merged at every join rather than enumerated.
+
+namespace
+{
+
+void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+// fn chain(x: Int, y: Int) -> Int [ ensures result > 0; ] {
+//   if (x < k) { return k; } else { if (y < k) { let a: Int = k; } else { let b: Int = 0; } }
+//   ... for k = 1..n
+//   return x;
+// }
+std::string chain_source(int n)
+{
+    std::string out = "fn chain(x: Int, y: Int) -> Int [ ensures result > 0; ] {\n";
+    for (int k = 1; k <= n; ++k)
+    {
+        const std::string v = std::to_string(k);
+        out += "  if (x < " + v + ") { return " + v + "; } else {\n";
+        out += "    if (y < " + v + ") { let a: Int = " + v + "; } else { let b: Int = 0; }\n";
+        out += "  }\n";
+    }
+    out += "  return x;\n}\n";
+    return out;
+}
+
+void bench(int n, int repeat)
+{
+    const std::string source = chain_source(n);
+    const auto lexed = curlee::lexer::lex(source);
+    if (!std::holds_alternative<std::vector<curlee::lexer::Token>>(lexed))
+    {
+        fail("lexing failed");
+    }
+    auto parsed = curlee::parser::parse(std::get<std::vector<curlee::lexer::Token>>(lexed));
+    if (!std::holds_alternative<curlee::parser::Program>(parsed))
+    {
+        fail("parsing failed");
+    }
+    const auto& program = std::get<curlee::parser::Program>(parsed);
+    const auto typed = curlee::types::type_check(program);
+    if (!std::holds_alternative<curlee::types::TypeInfo>(typed))
+    {
+        fail("type checking failed");
+    }
+    const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+    curlee::verification::VerificationStats stats;
+    curlee::verification::VerifyOptions options;
+    options.stats = &stats;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i)
+    {
+        if (!std::holds_alternative<curlee::verification::Verified>(
+                curlee::verification::verify(program, type_info, options)))
+        {
+            fail("verification failed for " + std::to_string(n) + " ifs");
+        }
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+    std::cout << "ifs=" << n << " paths=2^" << n
+              << " obligations=" << (stats.presolved + stats.solver)
+              << " ms=" << (elapsed / repeat) << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int max_ifs = 64;
+    int repeat = 3;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--max-ifs" && i + 1 < argc)
+        {
+            max_ifs = std::atoi(argv[++i]);
+        }
+        else if (arg == "--repeat" && i + 1 < argc)
+        {
+            repeat = std::atoi(argv[++i]);
+        }
+        else
+        {
+            fail("usage: curlee_verify_bench [--max-ifs N] [--repeat N]");
+        }
+    }
+    if (max_ifs <= 0 || repeat <= 0)
+    {
+        fail("--max-ifs and --repeat must be positive");
+    }
+
+    for (int n = 1; n <= max_ifs; n *= 2)
+    {
+        bench(n, repeat);
+    }
+    return 0;
+}
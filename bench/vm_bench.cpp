@@ -0,0 +1,275 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <curlee/vm/bytecode.h>
+#include <curlee/vm/vm.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Micro-benchmarks for the VM interpreter loop.
+//
+// Usage: curlee_vm_bench [--iters N] [--repeat N]
+//
+// Prints one line per workload and runner (see Runner) with the number of executed instructions and
+// the average nanoseconds per instruction, so runs can be compared across commits.
+
+namespace
+{
+
+using curlee::vm::Chunk;
+using curlee::vm::OpCode;
+using curlee::vm::Value;
+
+void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+std::size_t patch_target(Chunk& chunk)
+{
+    const auto pos = chunk.code.size();
+    chunk.emit_u16(0);
+    return pos;
+}
+
+void patch_u16(Chunk& chunk, std::size_t pos, std::size_t value)
+{
+    chunk.code[pos] = static_cast<std::uint8_t>(value & 0xFF);
+    chunk.code[pos + 1] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
+}
+
+// let i = 0; let acc = 0;
+// while (i < n) { acc = acc + i * 3 - 1; i = i + 1; }
+// return acc;
+//
+// Executes 17 instructions per iteration plus 10 for setup and exit.
+Chunk int_loop_chunk(std::int64_t n)
+{
+    Chunk chunk;
+    chunk.emit_constant(Value::int_v(0));
+    chunk.emit_local(OpCode::StoreLocal, 0);
+    chunk.emit_constant(Value::int_v(0));
+    chunk.emit_local(OpCode::StoreLocal, 1);
+
+    const auto loop_start = chunk.code.size();
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit_constant(Value::int_v(n));
+    chunk.emit(OpCode::Less);
+    chunk.emit(OpCode::JumpIfFalse);
+    const auto exit_patch = patch_target(chunk);
+
+    chunk.emit_local(OpCode::LoadLocal, 1);
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit_constant(Value::int_v(3));
+    chunk.emit(OpCode::Mul);
+    chunk.emit(OpCode::Add);
+    chunk.emit_constant(Value::int_v(1));
+    chunk.emit(OpCode::Sub);
+    chunk.emit_local(OpCode::StoreLocal, 1);
+
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit_constant(Value::int_v(1));
+    chunk.emit(OpCode::Add);
+    chunk.emit_local(OpCode::StoreLocal, 0);
+
+    chunk.emit(OpCode::Jump);
+    chunk.emit_u16(static_cast<std::uint16_t>(loop_start));
+    patch_u16(chunk, exit_patch, chunk.code.size());
+
+    chunk.emit_local(OpCode::LoadLocal, 1);
+    chunk.emit(OpCode::Return);
+    return chunk;
+}
+
+// Same loop shape, but every iteration also moves a String value through a local.
+//
+// Executes 11 instructions per iteration plus 10 for setup and exit.
+Chunk string_loop_chunk(std::int64_t n)
+{
+    Chunk chunk;
+    chunk.emit_constant(Value::int_v(0));
+    chunk.emit_local(OpCode::StoreLocal, 0);
+    chunk.emit_constant(Value::string_v("the quick brown fox jumps over the lazy dog"));
+    chunk.emit_local(OpCode::StoreLocal, 1);
+
+    const auto loop_start = chunk.code.size();
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit_constant(Value::int_v(n));
+    chunk.emit(OpCode::Less);
+    chunk.emit(OpCode::JumpIfFalse);
+    const auto exit_patch = patch_target(chunk);
+
+    chunk.emit_local(OpCode::LoadLocal, 1);
+    chunk.emit_local(OpCode::StoreLocal, 2);
+
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit_constant(Value::int_v(1));
+    chunk.emit(OpCode::Add);
+    chunk.emit_local(OpCode::StoreLocal, 0);
+
+    chunk.emit(OpCode::Jump);
+    chunk.emit_u16(static_cast<std::uint16_t>(loop_start));
+    patch_u16(chunk, exit_patch, chunk.code.size());
+
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit(OpCode::Return);
+    return chunk;
+}
+
+// fib(n) = n < 2 ? n : fib(n - 1) + fib(n - 2), with `n` in a frame-relative parameter slot.
+//
+// A leaf call executes 6 instructions and an inner call 14 plus its two sub-calls; the entry
+// code adds 3 (see fib_instructions).
+Chunk fib_chunk(std::int64_t n)
+{
+    Chunk chunk;
+    chunk.emit_constant(Value::int_v(n));
+    chunk.emit(OpCode::Call);
+    const auto call_patch = patch_target(chunk);
+    chunk.emit(OpCode::Return);
+
+    const auto entry = chunk.code.size();
+    patch_u16(chunk, call_patch, entry);
+    chunk.functions.push_back(
+        curlee::vm::FunctionInfo{.entry = entry, .arity = 1, .locals = 1, .max_stack = 2});
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit_constant(Value::int_v(2));
+    chunk.emit(OpCode::Less);
+    chunk.emit(OpCode::JumpIfFalse);
+    const auto recurse_patch = patch_target(chunk);
+    chunk.emit_local(OpCode::LoadLocal, 0);
+    chunk.emit(OpCode::Ret);
+
+    patch_u16(chunk, recurse_patch, chunk.code.size());
+    for (const std::int64_t k : {1, 2})
+    {
+        chunk.emit_local(OpCode::LoadLocal, 0);
+        chunk.emit_constant(Value::int_v(k));
+        chunk.emit(OpCode::Sub);
+        chunk.emit(OpCode::Call);
+        chunk.emit_u16(static_cast<std::uint16_t>(entry));
+    }
+    chunk.emit(OpCode::Add);
+    chunk.emit(OpCode::Ret);
+    return chunk;
+}
+
+std::size_t fib_call_instructions(std::int64_t n)
+{
+    if (n < 2)
+    {
+        return 6;
+    }
+    return 14 + fib_call_instructions(n - 1) + fib_call_instructions(n - 2);
+}
+
+// Confirms the analytic instruction count for a workload against the VM's fuel accounting.
+std::size_t checked_instructions(const Chunk& chunk, std::size_t expected)
+{
+    curlee::vm::VM vm;
+    if (!vm.run(chunk, expected).ok || vm.run(chunk, expected - 1).ok)
+    {
+        fail("instruction count mismatch for benchmark chunk");
+    }
+    return expected;
+}
+
+// Switch and Threaded run a plain Chunk (decoding and verifying it on every run); Prepared runs
+// a PreparedChunk that was decoded and verified once up front.
+enum class Runner
+{
+    Switch,
+    Threaded,
+    Prepared,
+};
+
+void bench(std::string_view name, const Chunk& chunk, std::size_t instructions, int repeat,
+           Runner runner)
+{
+    curlee::vm::VM vm;
+    if (runner == Runner::Switch)
+    {
+        vm.set_dispatch_mode(curlee::vm::DispatchMode::Switch);
+    }
+    const curlee::vm::PreparedChunk prepared(chunk);
+    if (runner == Runner::Prepared && !prepared.verified())
+    {
+        fail(std::string(name) + ": " + prepared.verify_error()->message);
+    }
+    double best_ns = 0.0;
+    for (int r = 0; r < repeat; ++r)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto res = runner == Runner::Prepared ? vm.run(prepared) : vm.run(chunk);
+        const auto end = std::chrono::steady_clock::now();
+        if (!res.ok)
+        {
+            fail(std::string(name) + ": " + res.error);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (r == 0 || ns < best_ns)
+        {
+            best_ns = ns;
+        }
+    }
+
+    const double per_insn = instructions == 0 ? 0.0 : best_ns / static_cast<double>(instructions);
+    const double mips = per_insn == 0.0 ? 0.0 : 1000.0 / per_insn;
+    const char* runner_name = runner == Runner::Switch     ? "switch"
+                              : runner == Runner::Threaded ? "threaded"
+                                                           : "prepared";
+    std::cout << name << " [" << runner_name << "]: instructions=" << instructions
+              << " best_ns=" << best_ns << " ns_per_insn=" << per_insn
+              << " minsn_per_sec=" << mips << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::int64_t iters = 1'000'000;
+    int repeat = 5;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--iters" && i + 1 < argc)
+        {
+            iters = std::strtoll(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--repeat" && i + 1 < argc)
+        {
+            repeat = std::atoi(argv[++i]);
+        }
+        else
+        {
+            fail("usage: curlee_vm_bench [--iters N] [--repeat N]");
+        }
+    }
+    if (iters <= 0 || repeat <= 0)
+    {
+        fail("--iters and --repeat must be positive");
+    }
+
+    std::cout << "sizeof(vm::Value)=" << sizeof(Value) << "\n";
+
+    const auto n = static_cast<std::size_t>(iters);
+    const auto int_loop = int_loop_chunk(iters);
+    const auto int_insns = checked_instructions(int_loop, (17 * n) + 10);
+    const auto string_loop = string_loop_chunk(iters);
+    const auto string_insns = checked_instructions(string_loop, (11 * n) + 10);
+
+    constexpr std::int64_t kFibN = 25;
+    const auto fib = fib_chunk(kFibN);
+    const auto fib_insns = checked_instructions(fib, fib_call_instructions(kFibN) + 3);
+
+    for (const auto runner : {Runner::Switch, Runner::Threaded, Runner::Prepared})
+    {
+        bench("int_loop", int_loop, int_insns, repeat, runner);
+        bench("string_loop", string_loop, string_insns, repeat, runner);
+        bench("fib_calls", fib, fib_insns, repeat, runner);
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file compile_cache.h
+ * @brief Content-addressed on-disk cache of verified, compiled programs.
+ */
+
+namespace curlee::cli
+{
+
+/**
+ * @brief A file the cached result was derived from.
+ *
+ * `hash` is the SHA-256 of the file's contents, or empty for an import candidate that did not
+ * exist (creating it later could change which module an import resolves to).
+ */
+struct CacheDependency
+{
+    std::string path;
+    std::string hash;
+};
+
+/** @brief The result of a successful check, stored under a CompileCache key. */
+struct CacheEntry
+{
+    /** Every imported module (transitively) and every missing import candidate. */
+    std::vector<CacheDependency> dependencies;
+    /** encode_chunk() of the emitted program; absent if emission failed after verification. */
+    std::optional<std::vector<std::uint8_t>> chunk;
+};
+
+/**
+ * @brief Content-addressed cache of verification verdicts and emitted chunks.
+ *
+ * Keys hash the entry file's path and contents, the compiler version and the options that
+ * affect checking. Import contents are not known before parsing, so an entry records its
+ * dependencies and a lookup only hits while every one of them still has the recorded contents.
+ * Only successful checks are stored; failures always re-run to produce their diagnostics.
+ *
+ * Entries are written to a temporary file and renamed into place, so concurrent invocations
+ * sharing a directory only ever read complete entries. Hits refresh an entry's modification
+ * time, and stores evict the least recently used files once the directory (subdirectories
+ * included) exceeds its size bound. Every filesystem error degrades to a cache miss.
+ */
+class CompileCache
+{
+  public:
+    static constexpr std::uintmax_t kDefaultMaxBytes = 64U * 1024U * 1024U;
+
+    CompileCache(std::filesystem::path dir, std::uintmax_t max_bytes);
+
+    /**
+     * @brief The cache configured by the environment, if enabled.
+     *
+     * `CURLEE_CACHE_DIR` enables caching in that directory; `CURLEE_CACHE_MAX_BYTES` overrides
+     * the size bound.
+     */
+    [[nodiscard]] static std::optional<CompileCache> from_environment();
+
+    /** @brief The key for checking `contents` (loaded from `path`) under `options`. */
+    [[nodiscard]] static std::string key(std::string_view path, std::string_view contents,
+                                         std::string_view options);
+
+    /** @brief The entry stored under `key`, if present and its dependencies are unchanged. */
+    [[nodiscard]] std::optional<CacheEntry> lookup(const std::string& key) const;
+
+    /** @brief Store `entry` under `key`, then evict down to the size bound. */
+    void store(const std::string& key, const CacheEntry& entry) const;
+
+    /**
+     * @brief Remove the least recently used files under dir() until they fit the size bound.
+     *
+     * Covers the obligation cache and verification session kept in its subdirectories as well
+     * as compile entries, so callers that only stored those (a failed check) evict explicitly.
+     */
+    void evict() const;
+
+    [[nodiscard]] const std::filesystem::path& dir() const { return dir_; }
+
+  private:
+
+    std::filesystem::path dir_;
+    std::uintmax_t max_bytes_;
+};
+
+} // namespace curlee::cli
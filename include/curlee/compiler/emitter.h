@@ -2,7 +2,9 @@
 
 #include <curlee/diag/diagnostic.h>
 #include <curlee/parser/ast.h>
+#include <cstddef>
 #include <curlee/vm/bytecode.h>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
@@ -20,4 +22,14 @@ using EmitResult = std::variant<curlee::vm::Chunk, std::vector<curlee::diag::Dia
 /** @brief Emit VM bytecode for the provided Program or return diagnostics. */
 [[nodiscard]] EmitResult emit_bytecode(const curlee::parser::Program& program);
 
+/**
+ * @brief Emit bytecode, lowering the arithmetic expressions whose Expr ids are in
+ * `proven_arithmetic` to unchecked opcodes.
+ *
+ * The ids come from verification::Verified for the same Program; every other `+ - * /` and
+ * unary `-` gets an overflow-checked opcode.
+ */
+[[nodiscard]] EmitResult emit_bytecode(const curlee::parser::Program& program,
+                                       const std::unordered_set<std::size_t>& proven_arithmetic);
+
 } // namespace curlee::compiler
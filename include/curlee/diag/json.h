@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/**
+ * @file json.h
+ * @brief Escaping for the JSON the tools write (LSP messages, reports, runner responses).
+ */
+
+namespace curlee::diag
+{
+
+/**
+ * @brief `input` as the contents of a JSON string literal.
+ *
+ * Quotes, backslashes and every control character are escaped (the usual ones by name, the
+ * rest as `\u00XX`); all other bytes, UTF-8 sequences included, pass through unchanged.
+ */
+[[nodiscard]] inline std::string json_escape(std::string_view input)
+{
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(input.size() + 8);
+    for (const char c : input)
+    {
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\b':
+            out += "\\b";
+            break;
+        case '\f':
+            out += "\\f";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (const auto byte = static_cast<unsigned char>(c); byte < 0x20)
+            {
+                out += "\\u00";
+                out.push_back(kHex[byte >> 4]);
+                out.push_back(kHex[byte & 0xF]);
+            }
+            else
+            {
+                out.push_back(c);
+            }
+            break;
+        }
+    }
+    return out;
+}
+
+} // namespace curlee::diag
@@ -2,6 +2,8 @@
 
 #include <curlee/diag/diagnostic.h>
 #include <curlee/lexer/token.h>
+#include <curlee/source/span.h>
+#include <span>
 #include <string_view>
 #include <variant>
 #include <vector>
@@ -20,4 +22,38 @@ using LexResult = std::variant<std::vector<Token>, curlee::diag::Diagnostic>;
 /** @brief Lex the provided input into tokens. On success includes a terminal Eof token. */
 [[nodiscard]] LexResult lex(std::string_view input);
 
+/**
+ * @brief Which tokens relex() produced anew.
+ *
+ * Tokens before `first` are unchanged. Old tokens [first, old_end) were replaced by new tokens
+ * [first, new_end); every token after that is an old one shifted by the edit.
+ */
+struct TokenEdit
+{
+    std::size_t first = 0;
+    std::size_t old_end = 0;
+    std::size_t new_end = 0;
+};
+
+/** @brief Tokens of an edited text, with where they differ from the tokens before the edit. */
+struct Relexed
+{
+    std::vector<Token> tokens;
+    TokenEdit edit;
+};
+
+/** @brief Result of relexing: tokens on success, diagnostic on failure. */
+using RelexResult = std::variant<Relexed, curlee::diag::Diagnostic>;
+
+/**
+ * @brief Lex `input`, the text `old_tokens` were lexed from with `edit` applied.
+ *
+ * Lexing restarts after the last token that ends before the edit and stops at the first token
+ * past the edit that starts where an old token did, shifted; the tokens after it are copied from
+ * `old_tokens` rather than lexed. The tokens (or diagnostic) are exactly those of lex(input).
+ * `old_tokens` must be a successful lex() result.
+ */
+[[nodiscard]] RelexResult relex(std::span<const Token> old_tokens, std::string_view input,
+                                const curlee::source::TextEdit& edit);
+
 } // namespace curlee::lexer
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <curlee/diag/diagnostic.h>
+#include <curlee/lexer/lexer.h>
 #include <curlee/lexer/token.h>
 #include <curlee/parser/ast.h>
 #include <span>
@@ -21,8 +22,21 @@ using ParseResult = std::variant<Program, std::vector<curlee::diag::Diagnostic>>
 
 /** @brief Parse a sequence of tokens into a Program or diagnostics. */
 [[nodiscard]] ParseResult parse(std::span<const curlee::lexer::Token> tokens);
+
+/**
+ * @brief Update `program`, parsed from `old_tokens`, for the tokens relex() made after an edit.
+ *
+ * Top-level declarations the edit cannot have changed keep their nodes, with spans and names
+ * moved onto the new text. Parsing restarts after the last of them before the edit and stops at
+ * the first one after it that it reaches. The result is exactly what parse(relexed.tokens)
+ * returns, expression ids included.
+ */
+[[nodiscard]] ParseResult reparse(Program program, std::span<const curlee::lexer::Token> old_tokens,
+                                  const curlee::lexer::Relexed& relexed);
 /** @brief Dump a Program to a human-readable string (for debugging/tests). */
 [[nodiscard]] std::string dump(const Program& program);
+/** @brief Dump a single function, signature, contracts and body, on one line. */
+[[nodiscard]] std::string dump(const Function& function);
 
 /**
  * @brief Reassign expression ids so they are unique across the program.
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 
 /**
@@ -18,4 +23,66 @@ namespace curlee::runtime
  */
 using Capabilities = std::unordered_set<std::string>;
 
+/** @brief Capabilities the runtime checks, each interned to one bit of a CapabilityMask. */
+enum class Capability : std::uint8_t
+{
+    IoStdout,
+    PythonFfi,
+    PythonSandbox,
+};
+
+/** @brief Registry of known capability names, indexed by Capability. */
+inline constexpr std::array<std::string_view, 3> kCapabilityNames = {
+    "io:stdout",
+    "python:ffi",
+    "python:sandbox",
+};
+
+/**
+ * @brief A capability set resolved once before execution; gated opcodes test a bit instead of
+ * hashing a name.
+ */
+using CapabilityMask = std::uint32_t;
+
+[[nodiscard]] constexpr CapabilityMask capability_bit(Capability capability)
+{
+    return CapabilityMask{1} << static_cast<unsigned>(capability);
+}
+
+[[nodiscard]] constexpr bool has_capability(CapabilityMask mask, Capability capability)
+{
+    return (mask & capability_bit(capability)) != 0;
+}
+
+/** @brief The registered capability called `name`, if any. */
+[[nodiscard]] constexpr std::optional<Capability> capability_from_name(std::string_view name)
+{
+    for (std::size_t i = 0; i < kCapabilityNames.size(); ++i)
+    {
+        if (kCapabilityNames[i] == name)
+        {
+            return static_cast<Capability>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Resolve a granted set (CLI flags, a bundle manifest) to a mask.
+ *
+ * Names outside the registry gate nothing at run time, so they do not contribute a bit.
+ */
+[[nodiscard]] inline CapabilityMask resolve_capabilities(const Capabilities& capabilities)
+{
+    CapabilityMask mask = 0;
+    for (const auto& name : capabilities)
+    {
+        if (const auto capability = capability_from_name(name); capability.has_value())
+        {
+            mask |= capability_bit(*capability);
+        }
+    }
+    return mask;
+}
+
 } // namespace curlee::runtime
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <curlee/source/line_map.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file rope.h
+ * @brief Editable source text that keeps its line starts up to date across edits.
+ */
+
+namespace curlee::source
+{
+
+/**
+ * @brief Text stored in bounded chunks, each with the offsets of its own newlines.
+ *
+ * replace() rewrites only the chunks an edit touches and the running totals per chunk, so an
+ * edit costs about its own size plus the chunk count, however long the text is. Line and column
+ * queries answer exactly as a LineMap built from str() would.
+ */
+class Rope
+{
+  public:
+    Rope() = default;
+    explicit Rope(std::string_view text);
+
+    /** @brief Total length in bytes. */
+    [[nodiscard]] std::size_t size() const;
+    /** @brief Replace the bytes in [start, end) with `text`; offsets are clamped to size(). */
+    void replace(std::size_t start, std::size_t end, std::string_view text);
+    /** @brief The whole text as one string. */
+    [[nodiscard]] std::string str() const;
+
+    /** @brief As LineMap::offset_to_line_col. */
+    [[nodiscard]] LineCol offset_to_line_col(std::size_t offset) const;
+    /** @brief As LineMap::line_start_offset. */
+    [[nodiscard]] std::size_t line_start_offset(std::size_t line) const;
+    /** @brief As LineMap::line_count. */
+    [[nodiscard]] std::size_t line_count() const;
+    /**
+     * @brief Byte offset of the point `units` UTF-16 code units into 1-based `line`, the way LSP
+     * counts columns. Clamps to the end of the line (before its newline), or to size() past the
+     * last line; a count that splits a surrogate pair stops before that character.
+     */
+    [[nodiscard]] std::size_t utf16_offset(std::size_t line, std::size_t units) const;
+
+  private:
+    struct Chunk
+    {
+        std::string text;
+        /** Offsets of the '\n' bytes within `text`, ascending. */
+        std::vector<std::size_t> newlines;
+    };
+
+    /** Split `text` into chunks and put them in place of chunks [first, last). */
+    void splice(std::size_t first, std::size_t last, std::string_view text);
+    /** The chunk holding byte `offset`, or the last chunk when `offset` is size(). */
+    [[nodiscard]] std::size_t chunk_at(std::size_t offset) const;
+
+    std::vector<Chunk> chunks_;
+    /** Bytes before each chunk, with the total last (so one longer than chunks_). */
+    std::vector<std::size_t> bytes_before_{0};
+    /** Newlines before each chunk, likewise. */
+    std::vector<std::size_t> newlines_before_{0};
+};
+
+} // namespace curlee::source
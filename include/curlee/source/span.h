@@ -24,4 +24,17 @@ struct Span
     [[nodiscard]] constexpr std::size_t length() const { return end - start; }
 };
 
+/**
+ * @brief A replacement of the bytes [start, old_end) of a text by new text ending at new_end.
+ *
+ * Offsets before `start` are the same in both texts; an offset at or after `old_end` in the old
+ * text moves to `offset - old_end + new_end` in the new one.
+ */
+struct TextEdit
+{
+    std::size_t start = 0;   // first byte replaced
+    std::size_t old_end = 0; // end of the replaced bytes in the old text
+    std::size_t new_end = 0; // end of the inserted bytes in the new text
+};
+
 } // namespace curlee::source
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * @file cache_file.h
+ * @brief Key hashing and crash-safe writes shared by the on-disk caches.
+ */
+
+namespace curlee::verification
+{
+
+/** @brief SHA-256 of `bytes` as 64 lowercase hex digits. */
+[[nodiscard]] std::string sha256_hex(std::string_view bytes);
+
+/**
+ * @brief Replace `path` with `bytes`, creating its directory if needed.
+ *
+ * The bytes go to a temporary beside `path` (its name plus `.tmp.<pid>.<n>`, unique per process
+ * and call) that is then renamed into place, so concurrent readers and writers only ever see
+ * complete files. Returns false, leaving no temporary behind, on any filesystem error.
+ */
+bool write_file_atomically(const std::filesystem::path& path, std::string_view bytes);
+
+} // namespace curlee::verification
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file certificate.h
+ * @brief Proof certificates that let a receiver re-verify a program without a full search.
+ */
+
+namespace curlee::verification
+{
+
+/** @brief How the producer discharged one proof obligation. */
+struct ObligationHint
+{
+    enum class Kind
+    {
+        /** The presolver settled it. */
+        Presolved,
+        /** The facts at `core` entail the goal. */
+        Core,
+        /** An arithmetic site the producer could not prove; it keeps its runtime check. */
+        Unproven,
+    };
+
+    Kind kind = Kind::Core;
+    /**
+     * For Core: indices into the facts in scope at the obligation (in the order the verifier
+     * accumulates them) of an unsat core from which no fact can be dropped.
+     */
+    std::vector<std::size_t> core;
+};
+
+/**
+ * @brief Hints for the obligations of each verified function.
+ *
+ * Functions are keyed by sha256_hex() of the fingerprint VerificationSession uses, and hints are
+ * listed in the order the verifier meets the obligations. A receiver never trusts a hint: a
+ * core is re-checked (falling back to a full solve when it does not hold), and an Unproven hint
+ * only keeps a runtime check, so a wrong or stale certificate costs time, not soundness.
+ */
+struct ProofCertificate
+{
+    std::map<std::string, std::vector<ObligationHint>> functions;
+};
+
+/** @brief Single-line text form of `certificate`, for bundle::Manifest::proof. */
+[[nodiscard]] std::string encode_certificate(const ProofCertificate& certificate);
+
+/** @brief Parse encode_certificate() output; nullopt for anything else. */
+[[nodiscard]] std::optional<ProofCertificate> decode_certificate(std::string_view text);
+
+} // namespace curlee::verification
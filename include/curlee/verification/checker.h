@@ -2,7 +2,14 @@
 
 #include <curlee/diag/diagnostic.h>
 #include <curlee/parser/ast.h>
+#include <cstddef>
 #include <curlee/types/type_check.h>
+#include <curlee/verification/certificate.h>
+#include <curlee/verification/obligation_cache.h>
+#include <curlee/verification/profile.h>
+#include <curlee/verification/session.h>
+#include <curlee/verification/solver.h>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
@@ -14,16 +21,99 @@
 namespace curlee::verification
 {
 
-/** @brief Marker type indicating verification succeeded. */
+/** @brief Verification succeeded. */
 struct Verified
 {
+    /**
+     * Ids (Expr::id) of the `+ - * /` and unary `-` expressions proven safe: the int64
+     * result cannot overflow and a divisor cannot be zero. The compiler lowers these to
+     * unchecked opcodes (see compiler::emit_bytecode).
+     *
+     * Proofs assume only what holds at run time: enclosing `if`/`while` conditions, the
+     * left operand of `&&`/`||`, the int64 range of every variable, and a function's
+     * `requires` clauses when every function was verified and none calls it module-qualified
+     * (so every call site was checked).
+     */
+    std::unordered_set<std::size_t> proven_arithmetic;
 };
 
 /** @brief Result of verification: success marker or diagnostics. */
 using VerificationResult = std::variant<Verified, std::vector<curlee::diag::Diagnostic>>;
 
+/** @brief How many proof obligations each decision layer settled. */
+struct VerificationStats
+{
+    /** Discharged by the presolver (constant folding, bounds, syntactic implication). */
+    std::size_t presolved = 0;
+    /** Forwarded to Z3. */
+    std::size_t solver = 0;
+    /** Answered by VerifyOptions::cache without running Z3. */
+    std::size_t cached = 0;
+    /** Functions not verified again because VerifyOptions::session had their result. */
+    std::size_t reused = 0;
+    /** Settled by re-checking the unsat core VerifyOptions::certificate named for them. */
+    std::size_t certified = 0;
+};
+
+/** @brief Options for verify(). */
+struct VerifyOptions
+{
+    /**
+     * Worker threads discharging obligations; 0 uses one per hardware thread. Each function is
+     * verified in its own solver, assuming its callees' contracts, so the result (including
+     * diagnostic order) is the same for every value.
+     */
+    std::size_t jobs = 1;
+    /**
+     * Budgets and strategy for every obligation. An obligation that runs out of budget fails
+     * with its own "solver budget exhausted" diagnostic. Raising `solver.cancel` stops
+     * verification early; the result is then a single "verification cancelled" diagnostic.
+     */
+    SolverOptions solver{};
+    /** Try the presolver before Z3; disabling it sends every obligation to the solver. */
+    bool presolve = true;
+    /** When set, receives per-layer obligation counts (summed over all functions). */
+    VerificationStats* stats = nullptr;
+    /**
+     * When set, obligations the presolver cannot settle are looked up here before going to Z3,
+     * and Z3's sat/unsat answers are stored back.
+     */
+    ObligationCache* cache = nullptr;
+    /**
+     * When set, a function whose body, own contract and callee contracts are unchanged since it
+     * last verified in this session is not verified again, and its proofs are reused.
+     */
+    VerificationSession* session = nullptr;
+    /**
+     * When set, obligations are first re-checked against the facts this certificate names for
+     * them; an obligation whose hint is missing or does not hold is solved as usual.
+     */
+    const ProofCertificate* certificate = nullptr;
+    /**
+     * When set, receives a certificate for every verified function: a minimal unsat core for
+     * each proven obligation. Computing the cores costs extra solver calls, and `session` is
+     * not consulted, since reused functions would have no hints.
+     */
+    ProofCertificate* record_certificate = nullptr;
+    /**
+     * When set, receives the cost and outcome of every obligation, appended in function order
+     * (and, within a function, in the order they are met). Functions `session` reuses have none.
+     */
+    std::vector<ObligationProfile>* profile = nullptr;
+    /**
+     * The program is an imported module, whose functions its importers call module-qualified.
+     * Those calls are not checked against `requires`, so no function here assumes its own.
+     */
+    bool imported_module = false;
+};
+
 /** @brief Verify the program using provided type information; returns diagnostics on failure. */
 [[nodiscard]] VerificationResult verify(const curlee::parser::Program& program,
                                         const curlee::types::TypeInfo& type_info);
 
+/** @brief Verify the program with explicit options (see VerifyOptions). */
+[[nodiscard]] VerificationResult verify(const curlee::parser::Program& program,
+                                        const curlee::types::TypeInfo& type_info,
+                                        const VerifyOptions& options);
+
 } // namespace curlee::verification
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <z3++.h>
+
+/**
+ * @file fact_slicing.h
+ * @brief Cone-of-influence slicing of the facts asserted for a proof obligation.
+ */
+
+namespace curlee::verification
+{
+
+/**
+ * @brief Selects the facts that can influence a goal.
+ *
+ * A fact is relevant when it shares a variable with the goal, or with another relevant fact;
+ * facts without variables are always relevant. Dropped facts only constrain variables the
+ * goal never mentions, so they can change the answer only by being contradictory.
+ *
+ * The variables of each fact are memoized, so re-slicing the facts in scope is linear in the
+ * number of facts rather than in their size.
+ */
+class FactSlicer
+{
+  public:
+    /** @brief The facts connected to any of `seeds`, in their original order. */
+    [[nodiscard]] std::vector<z3::expr> slice(const std::vector<z3::expr>& facts,
+                                              const std::vector<z3::expr>& seeds);
+
+  private:
+    const std::vector<unsigned>& vars_of(const z3::expr& e);
+
+    // Keyed by expression id; the expression is kept alive so its id cannot be reused.
+    std::unordered_map<unsigned, std::pair<z3::expr, std::vector<unsigned>>> vars_;
+};
+
+} // namespace curlee::verification
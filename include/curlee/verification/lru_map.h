@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @file lru_map.h
+ * @brief String-keyed map that forgets its least recently used entries past a capacity.
+ */
+
+namespace curlee::verification
+{
+
+/**
+ * @brief Holds at most `capacity` entries (0 means unbounded); finding or storing an entry
+ * makes it the most recently used, and an insertion past the capacity drops the least recently
+ * used one. Not thread-safe.
+ */
+template <typename Value> class LruMap
+{
+  public:
+    explicit LruMap(std::size_t capacity = 0) : capacity_(capacity) {}
+
+    // The index points into the entries' own keys.
+    LruMap(const LruMap&) = delete;
+    LruMap& operator=(const LruMap&) = delete;
+
+    /** @brief The value stored under `key`, or null. */
+    [[nodiscard]] Value* find(std::string_view key)
+    {
+        const auto it = index_.find(key);
+        if (it == index_.end())
+        {
+            return nullptr;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &it->second->second;
+    }
+
+    /** @brief Store `value` under `key` unless already present; true if it was stored. */
+    bool emplace(std::string key, Value value)
+    {
+        if (find(key) != nullptr)
+        {
+            return false;
+        }
+        insert_front(std::move(key), std::move(value));
+        return true;
+    }
+
+    /** @brief Store `value` under `key`, replacing any earlier value. */
+    void insert_or_assign(std::string key, Value value)
+    {
+        if (Value* existing = find(key); existing != nullptr)
+        {
+            *existing = std::move(value);
+            return;
+        }
+        insert_front(std::move(key), std::move(value));
+    }
+
+    [[nodiscard]] std::size_t size() const { return entries_.size(); }
+
+  private:
+    void insert_front(std::string key, Value value)
+    {
+        entries_.emplace_front(std::move(key), std::move(value));
+        index_.emplace(entries_.front().first, entries_.begin());
+        if (capacity_ != 0 && entries_.size() > capacity_)
+        {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+    }
+
+    using Entries = std::list<std::pair<std::string, Value>>;
+
+    std::size_t capacity_;
+    // Most recently used first.
+    Entries entries_;
+    std::unordered_map<std::string_view, typename Entries::iterator> index_;
+};
+
+} // namespace curlee::verification
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <curlee/verification/lru_map.h>
+#include <curlee/verification/solver.h>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <z3++.h>
+
+/**
+ * @file obligation_cache.h
+ * @brief Cache of solved proof obligations, keyed by their normalized SMT query.
+ */
+
+namespace curlee::verification
+{
+
+/**
+ * @brief A solver query in canonical form.
+ *
+ * Variables are renamed `v0`, `v1`, ... in order of first occurrence (facts first, then the
+ * goal, then the model variables), so queries that differ only in variable names, such as the
+ * same contract checked in a renamed function, share a key.
+ */
+struct ObligationQuery
+{
+    /** The declarations, facts, goal and model variables, as SMT-LIB text. */
+    std::string text;
+    /** sha256_hex() of `text`. */
+    std::string key;
+};
+
+/**
+ * @brief Normalize the query "`facts` entail `goal`", reporting `model_vars` on failure, when
+ * solved under `theory`.
+ */
+[[nodiscard]] ObligationQuery normalize_query(const std::vector<z3::expr>& facts,
+                                              const z3::expr& goal,
+                                              const std::vector<z3::expr>& model_vars,
+                                              IntTheory theory = IntTheory::Integer);
+
+/** @brief The answer to an ObligationQuery. */
+struct ObligationVerdict
+{
+    /** Unsat (the goal holds) or Sat (it fails); inconclusive answers are never cached. */
+    CheckResult result = CheckResult::Unsat;
+    /** For Sat, the value of each model variable, in the order the query lists them. */
+    std::vector<std::string> model_values;
+};
+
+/**
+ * @brief Verdicts of previously solved obligations, in memory and optionally on disk.
+ *
+ * Verdicts do not depend on solver budgets or strategy, so one cache serves every
+ * VerifyOptions; whether IntTheory bounds variables, which does change them, is part of the
+ * query text. On disk each verdict is a file named after the query's key that repeats the
+ * full query text; a lookup only hits when the text matches, so a hash collision is a miss.
+ * Files are written to a temporary and renamed into place, disk hits refresh their modification
+ * time (the recency cli::CompileCache::evict() bounds the directory by), and every filesystem
+ * error degrades to a miss. Safe to share between verify() workers.
+ */
+class ObligationCache
+{
+  public:
+    /** @brief A cache that lives only as long as this object. */
+    ObligationCache() = default;
+
+    /** @brief A cache persisted in `dir`, which is created on the first store. */
+    explicit ObligationCache(std::filesystem::path dir);
+
+    /**
+     * @brief A cache that lives only as long as this object and keeps at most `max_verdicts`,
+     * forgetting the least recently used, for long-running processes.
+     */
+    explicit ObligationCache(std::size_t max_verdicts);
+
+    ObligationCache(const ObligationCache&) = delete;
+    ObligationCache& operator=(const ObligationCache&) = delete;
+
+    [[nodiscard]] std::optional<ObligationVerdict> lookup(const ObligationQuery& query);
+
+    void store(const ObligationQuery& query, const ObligationVerdict& verdict);
+
+  private:
+    std::optional<std::filesystem::path> dir_;
+    std::mutex mutex_;
+    // Keyed by the full query text.
+    LruMap<ObligationVerdict> verdicts_;
+};
+
+} // namespace curlee::verification
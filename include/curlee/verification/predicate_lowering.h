@@ -31,6 +31,11 @@ struct LoweringContext
     std::optional<z3::expr> result_bool;
     std::unordered_map<std::string_view, z3::expr> int_vars;
     std::unordered_map<std::string_view, z3::expr> bool_vars;
+    /**
+     * Accept products of two non-literal operands. Only the bit-vector theories decide them
+     * (see IntTheory), so by default they are rejected as non-linear.
+     */
+    bool nonlinear = false;
 };
 
 /** @brief Result of lowering: either a z3::expr or a diagnostic on error. */
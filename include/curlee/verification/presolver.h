@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <z3++.h>
+
+/**
+ * @file presolver.h
+ * @brief Cheap decision layer that settles trivial obligations without a Z3 round trip.
+ */
+
+namespace curlee::verification
+{
+
+/** @brief Closed integer interval; a missing bound is unbounded. */
+struct Interval
+{
+    std::optional<std::int64_t> lo;
+    std::optional<std::int64_t> hi;
+};
+
+/**
+ * @brief Proves goals from facts by constant folding, interval bounds and syntactic implication.
+ *
+ * Facts are propagated once, in the order they are assumed, into bounds on Int constants and
+ * known truth values for Bool atoms. proves() is sound but incomplete: false means "not
+ * settled here", and the obligation must still go to the solver.
+ */
+class Presolver
+{
+  public:
+    /** @brief Assume `fact` holds. */
+    void assume(const z3::expr& fact);
+
+    /** @brief True when `goal` holds in every model of the assumed facts. */
+    [[nodiscard]] bool proves(const z3::expr& goal) const;
+
+  private:
+    [[nodiscard]] std::optional<bool> eval_bool(const z3::expr& e) const;
+    [[nodiscard]] Interval eval_int(const z3::expr& e) const;
+    void assume_atom(const z3::expr& atom, bool value);
+    void bound(const z3::expr& var, const Interval& range);
+
+    std::unordered_map<unsigned, Interval> bounds_;
+    std::unordered_set<unsigned> known_true_;
+    std::unordered_set<unsigned> known_false_;
+    bool inconsistent_ = false;
+};
+
+} // namespace curlee::verification
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <curlee/source/span.h>
+#include <curlee/verification/solver.h>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file profile.h
+ * @brief Per-obligation verification costs (`curlee check --stats`).
+ */
+
+namespace curlee::verification
+{
+
+/** @brief What an obligation asks to prove. */
+enum class ObligationKind
+{
+    /** A function's `ensures` clause, at one of its returns. */
+    Ensures,
+    /** A callee's `requires` clause, at one call site. */
+    CallRequires,
+    /** A `+ - * /` or unary `-` that cannot overflow (or divide by zero), so it runs unchecked. */
+    Arithmetic,
+};
+
+/** @brief Which layer settled an obligation. */
+enum class Settlement
+{
+    Presolver,
+    /** Re-checked against a certificate's core, or skipped because the certificate had none. */
+    Certificate,
+    Cache,
+    Solver,
+};
+
+/** @brief The cost and outcome of one proof obligation. */
+struct ObligationProfile
+{
+    std::string function;
+    ObligationKind kind = ObligationKind::Ensures;
+    /** The clause, call or arithmetic expression the obligation is about. */
+    curlee::source::Span span;
+    /** Facts asserted for the last query: the relevant slice, or all facts in scope. */
+    std::size_t facts = 0;
+    /** Wall-clock time spent on the obligation, in microseconds. */
+    std::uint64_t micros = 0;
+    Settlement settled_by = Settlement::Solver;
+    /** Unsat means proven; Sat means a counterexample (or a runtime check that stays). */
+    CheckResult verdict = CheckResult::Unknown;
+    /** Summed over every Z3 check the obligation needed; zero unless it reached Z3. */
+    SolverStatistics statistics;
+};
+
+[[nodiscard]] std::string_view obligation_kind_name(ObligationKind kind);
+[[nodiscard]] std::string_view settlement_name(Settlement settlement);
+/** @brief "proven", "refuted", "unknown" or "budget". */
+[[nodiscard]] std::string_view verdict_name(CheckResult verdict);
+
+/**
+ * @brief Render obligations as a text table, slowest first, after a summary line.
+ *
+ * `where` turns an obligation into a location for the report, e.g. `file.curlee:3:5-20`.
+ */
+[[nodiscard]] std::string
+render_verification_profile(const std::vector<ObligationProfile>& profiles,
+                            const std::function<std::string(const ObligationProfile&)>& where);
+
+/**
+ * @brief Render obligations as a JSON object with a `total_micros` count and an `obligations`
+ * array in verification order (stable across runs, unlike the timings).
+ */
+[[nodiscard]] std::string
+verification_profile_json(const std::vector<ObligationProfile>& profiles,
+                          const std::function<std::string(const ObligationProfile&)>& where);
+
+} // namespace curlee::verification
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <curlee/verification/lru_map.h>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @file session.h
+ * @brief Per-function verification results kept across verify() calls.
+ */
+
+namespace curlee::verification
+{
+
+/** @brief What verifying one function proved, independent of where it sits in the program. */
+struct FunctionResult
+{
+    /** Verified::proven_arithmetic of the function, as offsets from its first expression id. */
+    std::vector<std::size_t> proven_arithmetic;
+};
+
+/**
+ * @brief Results of functions that verified, keyed by a fingerprint of what they depend on.
+ *
+ * A fingerprint covers the function's own signature, contracts and body, and the contracts of
+ * every function it calls (see verify()); a function whose fingerprint is unchanged is not
+ * verified again. Only successes are kept, since failures must be re-rendered with current
+ * spans.
+ *
+ * In memory the session holds the latest result per function name, so a long-running process
+ * does not accumulate stale versions, and can be capped at a number of names. When given a directory, results are also written there,
+ * one file per fingerprint (named by sha256_hex(), repeating the fingerprint), so later processes
+ * can reuse them. Disk hits refresh the file's modification time, for the eviction of the
+ * directory holding it, and every filesystem error degrades to a miss. Safe to share between
+ * verify() workers.
+ */
+class VerificationSession
+{
+  public:
+    /** @brief A session that lives only as long as this object. */
+    VerificationSession() = default;
+
+    /** @brief A session persisted in `dir`, which is created on the first store. */
+    explicit VerificationSession(std::filesystem::path dir);
+
+    /**
+     * @brief A session that lives only as long as this object and keeps the results of at
+     * most `max_functions` names, forgetting the least recently used.
+     */
+    explicit VerificationSession(std::size_t max_functions);
+
+    VerificationSession(const VerificationSession&) = delete;
+    VerificationSession& operator=(const VerificationSession&) = delete;
+
+    /** @brief The result stored for `function` under `fingerprint`, if any. */
+    [[nodiscard]] std::optional<FunctionResult> lookup(std::string_view function,
+                                                       const std::string& fingerprint);
+
+    /** @brief Record that `function`, with `fingerprint`, verified with `result`. */
+    void store(std::string_view function, const std::string& fingerprint,
+               const FunctionResult& result);
+
+  private:
+    std::optional<std::filesystem::path> dir_;
+    std::mutex mutex_;
+    // Function name -> (fingerprint, result).
+    LruMap<std::pair<std::string, FunctionResult>> results_;
+};
+
+} // namespace curlee::verification
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <z3++.h>
 
@@ -19,6 +24,70 @@ enum class CheckResult
     Sat,
     Unsat,
     Unknown,
+    /** The check ran out of its time or resource budget before reaching an answer. */
+    BudgetExceeded,
+};
+
+/**
+ * @brief What an Int variable ranges over, and how Z3 solves for it.
+ *
+ * BitVector and Auto give every Int variable the VM's int64 range, so they prove the same
+ * goals; arithmetic on variables still never wraps (the VM traps instead). Both also let the
+ * verifier lower products of two variables.
+ */
+enum class IntTheory
+{
+    /** Unbounded integers. */
+    Integer,
+    /**
+     * 64-bit bit-vectors, with every sum, difference and product widened until it cannot wrap.
+     * Bit-blasting decides products of two variables, though proving them safe can be slow.
+     * Queries the encoding does not cover (such as division) go to the integer solver, bounded
+     * to int64.
+     */
+    BitVector,
+    /**
+     * The integer solver bounded to int64 for linear queries; for a query with a product of two
+     * variables, races it against the bit-vector solver and takes the first answer.
+     */
+    Auto,
+};
+
+/** @brief The `--int-theory` spelling of `theory`: "int", "bv" or "auto". */
+[[nodiscard]] std::string_view int_theory_name(IntTheory theory);
+
+/** @brief Per-check budgets and strategy selection. */
+struct SolverOptions
+{
+    /** Wall-clock limit for each check() in milliseconds; 0 means unlimited. */
+    unsigned timeout_ms = 0;
+    /** Z3 resource limit for each check(), reproducible unlike the timeout; 0 means unlimited. */
+    unsigned rlimit = 0;
+    /**
+     * Race a QF_LIA solver, the default solver and a simplify+smt tactic on separate threads
+     * (each with its own z3::context) and take the first sat/unsat answer. Each strategy gets
+     * the full budget. Models may differ between runs, depending on which strategy wins. The
+     * bit-vector solver, when IntTheory::Auto uses it, joins the race.
+     */
+    bool portfolio = false;
+    /** Range and encoding of Int variables; unlike the budgets, it changes what is provable. */
+    IntTheory theory = IntTheory::Integer;
+    /**
+     * When set, raising it interrupts the running check, and every later check returns Unknown
+     * without starting. Another thread may raise it at any time.
+     */
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+/** @brief How much work Z3 did on one check. */
+struct SolverStatistics
+{
+    /** Conflicts the SMT and SAT cores ran into. */
+    std::uint64_t conflicts = 0;
+    /** Case splits they made. */
+    std::uint64_t decisions = 0;
+    /** Z3's memory in use after the check, in megabytes (shared by the whole process). */
+    double memory_mb = 0;
 };
 
 /** @brief Single entry of a model (variable name and value as string). */
@@ -39,6 +108,7 @@ class Solver
 {
   public:
     Solver();
+    explicit Solver(SolverOptions options);
 
     [[nodiscard]] z3::context& context();
     void add(const z3::expr& constraint);
@@ -47,12 +117,41 @@ class Solver
     [[nodiscard]] CheckResult check();
     [[nodiscard]] std::optional<Model> model_for(const std::vector<z3::expr>& vars) const;
     [[nodiscard]] static std::string format_model(const Model& model);
+    /**
+     * @brief Statistics of the last check(), from the solver that answered it (in a race, the
+     * winner; when no lane answered, the integer lane).
+     */
+    [[nodiscard]] const SolverStatistics& last_statistics() const;
+    /**
+     * @brief Indices of a subset of `facts` that is unsatisfiable together with the assertions
+     * added so far, and from which no fact can be dropped; nullopt unless all of `facts`
+     * together are unsatisfiable. Always runs on this solver's own context, even in portfolio
+     * mode, uses the same theory check() would, and leaves its assertions unchanged.
+     */
+    [[nodiscard]] std::optional<std::vector<std::size_t>>
+    minimal_core(const std::vector<z3::expr>& facts);
 
   private:
+    /** check() `solver` and keep its answer (and model) as the last result. */
+    [[nodiscard]] CheckResult finish(z3::solver& solver, bool bit_vector);
+    /** A fresh QF_BV solver in `ctx`, with this solver's budget. */
+    [[nodiscard]] z3::solver bit_vector_solver(z3::context& ctx) const;
+    /** IntTheory::Auto on a non-linear query: bounded integers against `lowered`. */
+    [[nodiscard]] CheckResult check_race(const z3::expr_vector& assertions,
+                                         const z3::expr_vector& lowered);
+
+    SolverOptions options_;
     z3::context ctx_;
     z3::solver solver_;
+    /** Where check_race() runs the bit-vector lane, created by the first race. */
+    std::unique_ptr<z3::context> race_ctx_;
+    /** Where portfolio checks run their lanes, one per strategy, created by the first one. */
+    std::vector<std::unique_ptr<z3::context>> lane_ctxs_;
     std::optional<CheckResult> last_result_;
     std::optional<z3::model> last_model_;
+    SolverStatistics last_statistics_;
+    /** The last model came from the bit-vector lowering of the assertions. */
+    bool last_bit_vector_ = false;
 };
 
 } // namespace curlee::verification
@@ -3,7 +3,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <curlee/source/span.h>
+#include <curlee/vm/span_table.h>
 #include <curlee/vm/value.h>
+#include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -14,7 +17,15 @@
 namespace curlee::vm
 {
 
-/** @brief Bytecode opcodes executed by the VM. */
+/**
+ * @brief Bytecode opcodes executed by the VM.
+ *
+ * Int arithmetic comes in two flavours. `Add`..`Neg` are checked: they fail the run with
+ * "integer overflow" instead of wrapping, and `Div` also rejects a zero divisor. The
+ * `*Unchecked` variants are Int-only and skip those checks; the compiler emits them only at
+ * sites the verifier proved cannot overflow or divide by zero. Operand kinds are checked by
+ * both unless verify_bytecode proved them.
+ */
 enum class OpCode : std::uint8_t
 {
     Constant,
@@ -40,6 +51,133 @@ enum class OpCode : std::uint8_t
     Ret,
     Print,
     PythonCall,
+    AddUnchecked,
+    SubUnchecked,
+    MulUnchecked,
+    DivUnchecked,
+    NegUnchecked,
+};
+
+/** @brief Number of OpCode enumerators (opcode bytes >= this are not instructions). */
+inline constexpr std::size_t kOpCodeCount = static_cast<std::size_t>(OpCode::NegUnchecked) + 1;
+
+/** @brief True when the opcode is followed by a little-endian u16 operand. */
+[[nodiscard]] constexpr bool has_u16_operand(OpCode op)
+{
+    switch (op)
+    {
+    case OpCode::Constant:
+    case OpCode::LoadLocal:
+    case OpCode::StoreLocal:
+    case OpCode::Jump:
+    case OpCode::JumpIfFalse:
+    case OpCode::Call:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/** @brief Mnemonic of an opcode, as used in reports ("?" for bytes that are not opcodes). */
+[[nodiscard]] constexpr std::string_view opcode_name(OpCode op)
+{
+    switch (op)
+    {
+    case OpCode::Constant:
+        return "Constant";
+    case OpCode::LoadLocal:
+        return "LoadLocal";
+    case OpCode::StoreLocal:
+        return "StoreLocal";
+    case OpCode::Add:
+        return "Add";
+    case OpCode::Sub:
+        return "Sub";
+    case OpCode::Mul:
+        return "Mul";
+    case OpCode::Div:
+        return "Div";
+    case OpCode::Neg:
+        return "Neg";
+    case OpCode::Not:
+        return "Not";
+    case OpCode::Equal:
+        return "Equal";
+    case OpCode::NotEqual:
+        return "NotEqual";
+    case OpCode::Less:
+        return "Less";
+    case OpCode::LessEqual:
+        return "LessEqual";
+    case OpCode::Greater:
+        return "Greater";
+    case OpCode::GreaterEqual:
+        return "GreaterEqual";
+    case OpCode::Pop:
+        return "Pop";
+    case OpCode::Return:
+        return "Return";
+    case OpCode::Jump:
+        return "Jump";
+    case OpCode::JumpIfFalse:
+        return "JumpIfFalse";
+    case OpCode::Call:
+        return "Call";
+    case OpCode::Ret:
+        return "Ret";
+    case OpCode::Print:
+        return "Print";
+    case OpCode::PythonCall:
+        return "PythonCall";
+    case OpCode::AddUnchecked:
+        return "AddUnchecked";
+    case OpCode::SubUnchecked:
+        return "SubUnchecked";
+    case OpCode::MulUnchecked:
+        return "MulUnchecked";
+    case OpCode::DivUnchecked:
+        return "DivUnchecked";
+    case OpCode::NegUnchecked:
+        return "NegUnchecked";
+    }
+    return "?";
+}
+
+/** @brief The checked opcode with the same semantics as `op` (`op` itself if already checked). */
+[[nodiscard]] constexpr OpCode checked_variant(OpCode op)
+{
+    switch (op)
+    {
+    case OpCode::AddUnchecked:
+        return OpCode::Add;
+    case OpCode::SubUnchecked:
+        return OpCode::Sub;
+    case OpCode::MulUnchecked:
+        return OpCode::Mul;
+    case OpCode::DivUnchecked:
+        return OpCode::Div;
+    case OpCode::NegUnchecked:
+        return OpCode::Neg;
+    default:
+        return op;
+    }
+}
+
+/**
+ * @brief Call-frame descriptor for a function whose code starts at `entry`.
+ *
+ * `Call` to `entry` pops `arity` arguments into slots 0..arity-1 of a fresh frame of `locals`
+ * slots (the rest start as Unit); LoadLocal/StoreLocal inside the function address that frame.
+ * `max_stack` is the deepest operand stack the function itself builds, used to pre-size the
+ * stack on entry. `name` is debug information for reports and is not serialized.
+ */
+struct FunctionInfo
+{
+    std::size_t entry = 0;
+    std::size_t arity = 0;
+    std::size_t locals = 0;
+    std::size_t max_stack = 0;
+    std::string name{};
 };
 
 /** @brief A compiled chunk of bytecode, constants and span map. */
@@ -47,8 +185,31 @@ struct Chunk
 {
     std::vector<std::uint8_t> code;
     std::vector<Value> constants;
-    std::vector<curlee::source::Span> spans;
+    /** Source span of each instruction, keyed by the offset of its opcode. */
+    SpanTable spans;
+    /** Local slots of the entry frame (the code starting at ip=0). */
     std::size_t max_locals = 0;
+    /**
+     * Function descriptors, one per call target. A `Call` to an address without a descriptor
+     * shares the caller's frame (the layout of hand-assembled and pre-v3 chunks).
+     */
+    std::vector<FunctionInfo> functions;
+
+    /**
+     * @brief Descriptor of the function starting at `entry`, if any. Scans `functions`; the VM
+     * resolves calls through function_index() instead.
+     */
+    [[nodiscard]] const FunctionInfo* function_at(std::size_t entry) const
+    {
+        for (const auto& fn : functions)
+        {
+            if (fn.entry == entry)
+            {
+                return &fn;
+            }
+        }
+        return nullptr;
+    }
 
     std::size_t add_constant(Value value)
     {
@@ -59,33 +220,49 @@ struct Chunk
     void emit(OpCode op, curlee::source::Span span = {})
     {
         code.push_back(static_cast<std::uint8_t>(op));
-        spans.push_back(span);
+        spans.add(code.size() - 1, span);
     }
 
-    void emit_u16(std::uint16_t value, curlee::source::Span span = {})
+    /** @brief Append an operand; it shares the span of the instruction it belongs to. */
+    void emit_u16(std::uint16_t value)
     {
         code.push_back(static_cast<std::uint8_t>(value & 0xFF));
         code.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
-        spans.push_back(span);
-        spans.push_back(span);
+        spans.extend(code.size());
     }
 
     void emit_constant(Value value, curlee::source::Span span = {})
     {
         const auto idx = add_constant(value);
         emit(OpCode::Constant, span);
-        emit_u16(static_cast<std::uint16_t>(idx), span);
+        emit_u16(static_cast<std::uint16_t>(idx));
     }
 
     void emit_local(OpCode op, std::uint16_t slot, curlee::source::Span span = {})
     {
         emit(op, span);
-        emit_u16(slot, span);
+        emit_u16(slot);
         if (op == OpCode::StoreLocal && static_cast<std::size_t>(slot) + 1 > max_locals)
         {
             max_locals = static_cast<std::size_t>(slot) + 1;
         }
     }
+
+    /**
+     * @brief Rewrite every unchecked arithmetic opcode to its checked variant.
+     *
+     * For bytecode whose proofs cannot be trusted (e.g. loaded from a bundle): the opcodes are
+     * the same size, so offsets, spans and jump targets are unchanged.
+     */
+    void demote_unchecked_arithmetic()
+    {
+        for (std::size_t ip = 0; ip < code.size();)
+        {
+            const auto op = static_cast<OpCode>(code[ip]);
+            code[ip] = static_cast<std::uint8_t>(checked_variant(op));
+            ip += has_u16_operand(op) ? 3 : 1;
+        }
+    }
 };
 
 } // namespace curlee::vm
@@ -34,7 +34,7 @@ struct ChunkDecodeError
  *     - u8 kind (0=int,1=bool,2=string,3=unit)
  *     - payload depending on kind
  *
- * Version 2 (current):
+ * Version 2:
  * - u64 max_locals
  * - u64 code_len, then code bytes
  * - u64 spans_len, then spans: (u64 start, u64 end) repeated
@@ -42,6 +42,16 @@ struct ChunkDecodeError
  *     - u8 kind (0=int,1=bool,2=string,3=unit)
  *     - payload depending on kind
  *     - string payload is: u64 len, then bytes
+ *
+ * Version 3: version 2 followed by
+ * - u64 functions_len, then functions: (u64 entry, u64 arity, u64 locals, u64 max_stack)
+ *
+ * Version 4 (current): version 3 with the per-byte spans replaced by a SpanTable
+ * - u64 spans_len (code bytes covered), u64 table_len, then the table's varint records
+ *
+ * Version 1 and 2 chunks decode with no function descriptors (every call shares its caller's
+ * frame, which is how those chunks were laid out). Per-byte spans of versions 1-3 are
+ * re-encoded into a SpanTable on decode.
  */
 [[nodiscard]] std::vector<std::uint8_t> encode_chunk(const Chunk& chunk);
 
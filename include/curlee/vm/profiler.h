@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <curlee/source/span.h>
+#include <curlee/vm/bytecode.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @file profiler.h
+ * @brief Opt-in VM profiler: per-opcode, per-function and per-source-span costs of a run.
+ */
+
+namespace curlee::vm
+{
+
+/** @brief Profiler timestamp: TSC cycles on x86, steady-clock nanoseconds elsewhere. */
+[[nodiscard]] inline std::uint64_t profile_clock()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/** @brief Executions of one opcode and the cycles spent from its dispatch to the next one. */
+struct OpcodeProfile
+{
+    std::uint64_t count = 0;
+    std::uint64_t cycles = 0;
+};
+
+/**
+ * @brief Time spent in one function (call target).
+ *
+ * Inclusive time covers callees and counts each outermost activation once, so recursion does
+ * not double-count; exclusive time is the function's own instructions.
+ */
+struct FunctionProfile
+{
+    std::size_t entry = 0;
+    std::string name;
+    std::uint64_t calls = 0;
+    std::uint64_t inclusive_cycles = 0;
+    std::uint64_t exclusive_cycles = 0;
+};
+
+/** @brief Instructions executed for one source span (via Chunk::spans) and their cycles. */
+struct SpanProfile
+{
+    curlee::source::Span span;
+    std::uint64_t count = 0;
+    std::uint64_t cycles = 0;
+};
+
+/**
+ * @brief Collects the profile of VM runs; attach it with VM::set_profiler.
+ *
+ * The VM calls the hooks below only from its profiling loop, which is a separate instantiation
+ * of the switch interpreter: runs without a profiler execute exactly the same code as before.
+ * Each instruction is charged the time from its dispatch to the next dispatch (or the end of
+ * the run). Results describe the most recent run.
+ */
+class Profiler
+{
+  public:
+    /** @brief Reset and start profiling a run of `chunk` (which must outlive the results). */
+    void begin(const Chunk& chunk);
+
+    /** @brief An instruction at byte `offset` is about to execute. */
+    void instruction(std::size_t offset, OpCode op)
+    {
+        const std::uint64_t now = profile_clock();
+        close_instruction(now);
+        current_offset_ = offset;
+        current_op_ = op;
+        current_start_ = now;
+        has_current_ = true;
+    }
+
+    /** @brief A call to `target` entered a new activation. */
+    void call(std::size_t target);
+    /** @brief The innermost activation returned to its caller. */
+    void ret();
+    /** @brief The run finished (normally or with an error); closes every open activation. */
+    void end();
+
+    [[nodiscard]] const std::array<OpcodeProfile, kOpCodeCount>& opcodes() const
+    {
+        return opcodes_;
+    }
+    [[nodiscard]] std::uint64_t instructions() const { return instructions_; }
+    [[nodiscard]] std::uint64_t total_cycles() const { return total_cycles_; }
+
+    /** @brief Every function that ran, by exclusive cycles (descending). */
+    [[nodiscard]] std::vector<FunctionProfile> functions() const;
+    /** @brief The `limit` most expensive source spans, by cycles (descending). */
+    [[nodiscard]] std::vector<SpanProfile> hot_spans(std::size_t limit) const;
+    /**
+     * @brief Exclusive cycles per call stack in the collapsed format flame graph tools read:
+     * one `outer;inner;innermost <cycles>` line per distinct stack.
+     */
+    [[nodiscard]] std::string collapsed_stacks() const;
+
+  private:
+    struct StackNode
+    {
+        std::size_t function = 0;
+        std::uint64_t self_cycles = 0;
+        std::map<std::size_t, std::size_t> children; // function index -> node
+    };
+
+    struct Activation
+    {
+        std::size_t node = 0;
+        std::uint64_t start = 0;
+        std::uint64_t callee_cycles = 0;
+    };
+
+    struct FunctionState
+    {
+        FunctionProfile profile;
+        std::size_t active = 0;
+    };
+
+    void close_instruction(std::uint64_t now)
+    {
+        if (!has_current_)
+        {
+            return;
+        }
+        const std::uint64_t cycles = now - current_start_;
+        // Undefined opcode bytes still cost time but have no opcode row.
+        if (static_cast<std::size_t>(current_op_) < kOpCodeCount)
+        {
+            auto& op = opcodes_[static_cast<std::size_t>(current_op_)];
+            ++op.count;
+            op.cycles += cycles;
+        }
+        if (current_offset_ < offset_cycles_.size())
+        {
+            ++offset_counts_[current_offset_];
+            offset_cycles_[current_offset_] += cycles;
+        }
+        ++instructions_;
+        total_cycles_ += cycles;
+        has_current_ = false;
+    }
+
+    void enter(std::size_t entry, std::uint64_t now);
+    void leave(std::uint64_t now);
+    [[nodiscard]] std::size_t function_index(std::size_t entry);
+
+    const Chunk* chunk_ = nullptr;
+    std::array<OpcodeProfile, kOpCodeCount> opcodes_{};
+    std::vector<std::uint64_t> offset_counts_;
+    std::vector<std::uint64_t> offset_cycles_;
+    std::uint64_t instructions_ = 0;
+    std::uint64_t total_cycles_ = 0;
+
+    bool has_current_ = false;
+    std::size_t current_offset_ = 0;
+    OpCode current_op_ = OpCode::Constant;
+    std::uint64_t current_start_ = 0;
+
+    std::vector<FunctionState> functions_;
+    std::map<std::size_t, std::size_t> function_by_entry_;
+    std::vector<StackNode> nodes_;
+    std::vector<Activation> activations_;
+};
+
+/**
+ * @brief Render a profile as a text report (opcodes, functions, hot spans).
+ *
+ * `where` turns a span into a location for the report, e.g. `file.curlee:3:5`.
+ */
+[[nodiscard]] std::string
+render_profile_report(const Profiler& profiler,
+                      const std::function<std::string(const curlee::source::Span&)>& where,
+                      std::size_t max_spans = 10);
+
+} // namespace curlee::vm
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <curlee/source/span.h>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @file span_table.h
+ * @brief Compact bytecode-offset to source-span map for VM chunks.
+ */
+
+namespace curlee::vm
+{
+
+/**
+ * @brief Source spans keyed by instruction start, delta/run-length encoded.
+ *
+ * Each record is three LEB128 varints: the offset delta from the previous record, and the
+ * zigzag deltas of `start` and `end` from the previous record's span. A record covers every
+ * offset up to the next record, so operand bytes and consecutive instructions with the same span
+ * cost nothing. Offsets at or beyond `size()` have no span.
+ *
+ * Lookups decode on demand (error reporting, profiles); nothing is decoded while running.
+ */
+class SpanTable
+{
+  public:
+    /** @brief One decoded record: the span of every offset in [offset, next record's offset). */
+    struct Entry
+    {
+        std::size_t offset = 0;
+        curlee::source::Span span{};
+    };
+
+    /** @brief Record `span` for the instruction starting at `offset` (at or past `size()`). */
+    void add(std::size_t offset, curlee::source::Span span)
+    {
+        if (records_ == 0 || span.start != last_.start || span.end != last_.end)
+        {
+            append_varint(offset - last_offset_);
+            append_varint(zigzag(static_cast<std::int64_t>(span.start - last_.start)));
+            append_varint(zigzag(static_cast<std::int64_t>(span.end - last_.end)));
+            last_offset_ = offset;
+            last_ = span;
+            ++records_;
+        }
+        extend(offset + 1);
+    }
+
+    /** @brief Extend the last record over operand bytes up to (excluding) `end`. */
+    void extend(std::size_t end)
+    {
+        if (records_ != 0 && end > size_)
+        {
+            size_ = end;
+        }
+    }
+
+    /** @brief The span of the instruction at `offset`, decoded from the table. */
+    [[nodiscard]] std::optional<curlee::source::Span> lookup(std::size_t offset) const
+    {
+        if (offset >= size_)
+        {
+            return std::nullopt;
+        }
+        std::optional<curlee::source::Span> found;
+        for_each(
+            [&](const Entry& entry)
+            {
+                if (entry.offset > offset)
+                {
+                    return false;
+                }
+                found = entry.span;
+                return true;
+            });
+        return found;
+    }
+
+    /** @brief Decode every record, in offset order. */
+    [[nodiscard]] std::vector<Entry> entries() const
+    {
+        std::vector<Entry> out;
+        out.reserve(records_);
+        for_each(
+            [&](const Entry& entry)
+            {
+                out.push_back(entry);
+                return true;
+            });
+        return out;
+    }
+
+    /** @brief Number of code bytes covered (one past the last covered offset). */
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    [[nodiscard]] std::size_t record_count() const { return records_; }
+
+    /** @brief The encoded records, as serialized by chunk codec v4. */
+    [[nodiscard]] const std::vector<std::uint8_t>& bytes() const { return bytes_; }
+
+    void clear() { *this = SpanTable{}; }
+
+    /**
+     * @brief Rebuild a table from serialized records covering `size` bytes.
+     *
+     * Returns nullopt when the records are malformed: truncated varints, offsets that do not
+     * increase, or a record at or beyond `size`.
+     */
+    [[nodiscard]] static std::optional<SpanTable> from_bytes(std::vector<std::uint8_t> bytes,
+                                                             std::size_t size)
+    {
+        SpanTable table;
+        std::size_t pos = 0;
+        while (pos < bytes.size())
+        {
+            std::uint64_t fields[3] = {};
+            for (auto& field : fields)
+            {
+                const auto v = read_varint(bytes, pos);
+                if (!v.has_value())
+                {
+                    return std::nullopt;
+                }
+                field = *v;
+            }
+            if ((table.records_ != 0 && fields[0] == 0) || fields[0] >= size - table.last_offset_)
+            {
+                return std::nullopt;
+            }
+            table.last_offset_ += static_cast<std::size_t>(fields[0]);
+            table.last_.start += static_cast<std::size_t>(unzigzag(fields[1]));
+            table.last_.end += static_cast<std::size_t>(unzigzag(fields[2]));
+            ++table.records_;
+        }
+        if (table.records_ == 0 && size != 0)
+        {
+            return std::nullopt;
+        }
+        table.bytes_ = std::move(bytes);
+        table.size_ = size;
+        return table;
+    }
+
+    /** @brief Tables are equal when they encode the same records over the same bytes. */
+    friend bool operator==(const SpanTable& a, const SpanTable& b)
+    {
+        return a.size_ == b.size_ && a.bytes_ == b.bytes_;
+    }
+
+  private:
+    [[nodiscard]] static constexpr std::uint64_t zigzag(std::int64_t v)
+    {
+        return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+    }
+
+    [[nodiscard]] static constexpr std::int64_t unzigzag(std::uint64_t v)
+    {
+        return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+    }
+
+    void append_varint(std::uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            bytes_.push_back(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        bytes_.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    [[nodiscard]] static std::optional<std::uint64_t>
+    read_varint(const std::vector<std::uint8_t>& bytes, std::size_t& pos)
+    {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64 && pos < bytes.size(); shift += 7)
+        {
+            const std::uint8_t byte = bytes[pos++];
+            v |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return v;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /** @brief Decode records in order, stopping early when `visit` returns false. */
+    template <typename Visit> void for_each(Visit&& visit) const
+    {
+        Entry entry;
+        std::size_t pos = 0;
+        while (pos < bytes_.size())
+        {
+            // Validated on construction, so every record is complete.
+            entry.offset += static_cast<std::size_t>(*read_varint(bytes_, pos));
+            entry.span.start += static_cast<std::size_t>(unzigzag(*read_varint(bytes_, pos)));
+            entry.span.end += static_cast<std::size_t>(unzigzag(*read_varint(bytes_, pos)));
+            if (!visit(entry))
+            {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::uint8_t> bytes_;
+    std::size_t size_ = 0;
+    std::size_t records_ = 0;
+    std::size_t last_offset_ = 0;
+    curlee::source::Span last_{};
+};
+
+} // namespace curlee::vm
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <curlee/vm/bytecode.h>
+#include <optional>
+#include <vector>
+
+/**
+ * @file threaded_code.h
+ * @brief Pre-decoded, direct-threaded form of a Chunk used by the VM's fast dispatch loop.
+ */
+
+namespace curlee::vm
+{
+
+/**
+ * @brief Handlers that exist only in threaded code, numbered after the real opcodes.
+ *
+ * - Nop: an unknown opcode byte (the switch loop skips these as well).
+ * - Truncated: an opcode whose u16 operand runs past the end of the code; executing it
+ *   reports the same "truncated ..." error as the switch loop. Its operand is the OpCode.
+ * - End: sentinel placed at the end of the stream ("no return", consumes no fuel).
+ * - Verified*: check-free variants installed by verify_bytecode (see verifier.h). The `Int`,
+ *   `String` and `Bool` suffixes mean the operand kinds were proven as well. Checked Int
+ *   arithmetic keeps its overflow (and zero divisor) check; the `IntUnchecked` variants of
+ *   the unchecked opcodes have none left.
+ */
+enum class ThreadedPseudoOp : std::uint8_t
+{
+    Nop = static_cast<std::uint8_t>(kOpCodeCount),
+    Truncated,
+    End,
+    VerifiedConstant,
+    VerifiedLoadLocal,
+    VerifiedStoreLocal,
+    VerifiedPop,
+    VerifiedEqual,
+    VerifiedNotEqual,
+    VerifiedAddInt,
+    VerifiedAddString,
+    VerifiedSubInt,
+    VerifiedMulInt,
+    VerifiedDivInt,
+    VerifiedNegInt,
+    VerifiedNotBool,
+    VerifiedLessInt,
+    VerifiedLessEqualInt,
+    VerifiedGreaterInt,
+    VerifiedGreaterEqualInt,
+    VerifiedReturn,
+    VerifiedJump,
+    VerifiedJumpIfFalse,
+    VerifiedCall,
+    VerifiedRet,
+    VerifiedPrint,
+    VerifiedAddIntUnchecked,
+    VerifiedSubIntUnchecked,
+    VerifiedMulIntUnchecked,
+    VerifiedDivIntUnchecked,
+    VerifiedNegIntUnchecked,
+};
+
+/** @brief Size of the VM handler table (real opcodes plus pseudo ops). */
+inline constexpr std::size_t kThreadedHandlerCount =
+    static_cast<std::size_t>(ThreadedPseudoOp::VerifiedNegIntUnchecked) + 1;
+
+/** @brief Operand value for jumps/calls whose byte target lies outside the chunk. */
+inline constexpr std::uint32_t kThreadedInvalidTarget = 0xFFFFFFFFu;
+
+/** @brief `ThreadedInstr::callee` of a call whose target has no FunctionInfo (shared frame). */
+inline constexpr std::uint16_t kThreadedNoFunction = 0xFFFF;
+
+/** @brief One instruction with its operand decoded once, ahead of execution. */
+struct ThreadedInstr
+{
+    /** Handler label address (computed-goto builds); filled by the VM before the first run. */
+    const void* handler = nullptr;
+    /** Constant/local index, instruction index for jumps/calls, or OpCode for Truncated. */
+    std::uint32_t operand = 0;
+    /** Byte offset of the opcode in Chunk::code, used to look up spans on error. */
+    std::uint32_t offset = 0;
+    /** Call only: index of the callee's Chunk::functions descriptor, or kThreadedNoFunction. */
+    std::uint16_t callee = kThreadedNoFunction;
+    /** OpCode value, or a ThreadedPseudoOp. */
+    std::uint8_t handler_id = 0;
+};
+
+/** @brief A Chunk lowered to a direct-threaded instruction stream. */
+struct ThreadedCode
+{
+    std::vector<ThreadedInstr> instrs;
+    bool handlers_resolved = false;
+    /** Set by verify_bytecode once the stream has been proven safe and specialised. */
+    bool verified = false;
+};
+
+/**
+ * @brief Pre-decode a chunk into threaded code.
+ *
+ * Returns nullopt when the chunk cannot be represented faithfully (a jump or call targets
+ * the middle of an instruction, or the code is too large for 32-bit offsets); callers then
+ * fall back to the byte-decoding switch loop.
+ */
+[[nodiscard]] std::optional<ThreadedCode> predecode(const Chunk& chunk);
+
+/**
+ * @brief For each byte offset of `chunk.code`, the index into Chunk::functions of the
+ * descriptor starting there (the first one wins), or kThreadedNoFunction; resolves call targets
+ * without Chunk::function_at()'s scan.
+ */
+[[nodiscard]] std::vector<std::uint16_t> function_index(const Chunk& chunk);
+
+} // namespace curlee::vm
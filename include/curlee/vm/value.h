@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <utility>
 
 /**
  * @file value.h
@@ -12,7 +14,7 @@ namespace curlee::vm
 {
 
 /** @brief Kind of a runtime value. */
-enum class ValueKind
+enum class ValueKind : std::uint8_t
 {
     Int,
     Bool,
@@ -20,42 +22,153 @@ enum class ValueKind
     Unit,
 };
 
+namespace detail
+{
+
+/**
+ * @brief Immutable, reference-counted string payload shared between Values.
+ *
+ * Copying a String value only bumps the count; the text itself is never copied.
+ */
+struct StringObject
+{
+    std::atomic<std::uint32_t> refs{1};
+    std::string text;
+
+    explicit StringObject(std::string t) : text(std::move(t)) {}
+};
+
+} // namespace detail
+
 /**
- * @brief A simple value container used by the VM.
+ * @brief A compact tagged value used by the VM stack, locals and chunk constants.
  *
- * Uses explicit fields for each variant for simplicity and testing convenience.
+ * The payload is a union of an Int, a Bool and a handle into the ref-counted string heap,
+ * so a Value is 16 bytes and copying a non-String value is a plain register copy.
  */
 struct Value
 {
     ValueKind kind = ValueKind::Unit;
-    std::int64_t int_value = 0;
-    bool bool_value = false;
-    std::string string_value;
 
-    static Value int_v(std::int64_t v)
+    Value() noexcept : payload_{.int_value = 0} {}
+
+    Value(const Value& other) noexcept : kind(other.kind), payload_(other.payload_) { retain(); }
+
+    Value(Value&& other) noexcept : kind(other.kind), payload_(other.payload_)
     {
-        return Value{
-            .kind = ValueKind::Int, .int_value = v, .bool_value = false, .string_value = {}};
+        other.kind = ValueKind::Unit;
+        other.payload_.int_value = 0;
+    }
+
+    Value& operator=(const Value& other) noexcept
+    {
+        if (this != &other)
+        {
+            Value tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    Value& operator=(Value&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Value tmp(std::move(other));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~Value() { release(); }
+
+    static Value int_v(std::int64_t v) noexcept
+    {
+        Value out;
+        out.kind = ValueKind::Int;
+        out.payload_.int_value = v;
+        return out;
     }
 
-    static Value bool_v(bool v)
+    static Value bool_v(bool v) noexcept
     {
-        return Value{.kind = ValueKind::Bool, .int_value = 0, .bool_value = v, .string_value = {}};
+        Value out;
+        out.kind = ValueKind::Bool;
+        out.payload_.bool_value = v;
+        return out;
     }
 
     static Value string_v(std::string v)
     {
         Value out;
         out.kind = ValueKind::String;
-        out.int_value = 0;
-        out.bool_value = false;
-        out.string_value = std::move(v);
+        out.payload_.string_object = new detail::StringObject(std::move(v));
         return out;
     }
 
-    static Value unit_v() { return Value{}; }
+    static Value unit_v() noexcept { return Value{}; }
+
+    /** @brief Int payload (only meaningful when kind == Int). */
+    [[nodiscard]] std::int64_t as_int() const noexcept { return payload_.int_value; }
+
+    /** @brief Bool payload (only meaningful when kind == Bool). */
+    [[nodiscard]] bool as_bool() const noexcept { return payload_.bool_value; }
+
+    /** @brief String payload; empty for non-String values. */
+    [[nodiscard]] const std::string& as_string() const noexcept
+    {
+        static const std::string kEmpty;
+        if (kind != ValueKind::String || payload_.string_object == nullptr)
+        {
+            return kEmpty;
+        }
+        return payload_.string_object->text;
+    }
+
+    /** @brief True when both values share the same string heap object. */
+    [[nodiscard]] bool same_string_object(const Value& other) const noexcept
+    {
+        return kind == ValueKind::String && other.kind == ValueKind::String &&
+               payload_.string_object == other.payload_.string_object;
+    }
+
+  private:
+    union Payload
+    {
+        std::int64_t int_value;
+        bool bool_value;
+        detail::StringObject* string_object;
+    } payload_;
+
+    void swap(Value& other) noexcept
+    {
+        std::swap(kind, other.kind);
+        std::swap(payload_, other.payload_);
+    }
+
+    void retain() const noexcept
+    {
+        if (kind == ValueKind::String && payload_.string_object != nullptr)
+        {
+            payload_.string_object->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void release() noexcept
+    {
+        if (kind == ValueKind::String && payload_.string_object != nullptr)
+        {
+            if (payload_.string_object->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete payload_.string_object;
+            }
+            payload_.string_object = nullptr;
+        }
+    }
 };
 
+static_assert(sizeof(Value) <= 16, "vm::Value must stay compact");
+
 /** @brief Equality comparison for values. */
 inline bool operator==(const Value& a, const Value& b)
 {
@@ -66,11 +179,11 @@ inline bool operator==(const Value& a, const Value& b)
     switch (a.kind)
     {
     case ValueKind::Int:
-        return a.int_value == b.int_value;
+        return a.as_int() == b.as_int();
     case ValueKind::Bool:
-        return a.bool_value == b.bool_value;
+        return a.as_bool() == b.as_bool();
     case ValueKind::String:
-        return a.string_value == b.string_value;
+        return a.same_string_object(b) || a.as_string() == b.as_string();
     case ValueKind::Unit:
         return true;
     }
@@ -83,11 +196,11 @@ inline std::string to_string(const Value& v)
     switch (v.kind)
     {
     case ValueKind::Int:
-        return std::to_string(v.int_value);
+        return std::to_string(v.as_int());
     case ValueKind::Bool:
-        return v.bool_value ? "true" : "false";
+        return v.as_bool() ? "true" : "false";
     case ValueKind::String:
-        return v.string_value;
+        return v.as_string();
     case ValueKind::Unit:
         return "()";
     }
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <curlee/vm/bytecode.h>
+#include <curlee/vm/threaded_code.h>
+#include <optional>
+#include <string>
+
+/**
+ * @file verifier.h
+ * @brief Load-time bytecode verifier that lets the VM drop per-instruction safety checks.
+ */
+
+namespace curlee::vm
+{
+
+/** @brief Why a chunk could not be verified, and the byte offset of the offending opcode. */
+struct BytecodeVerifyError
+{
+    std::string message;
+    std::size_t offset = 0;
+};
+
+/**
+ * @brief Verify threaded code once and switch proven instructions to check-free handlers.
+ *
+ * The verifier abstractly interprets every instruction reachable from ip=0 and from each call
+ * target, tracking the operand stack (depth and value kinds) and local slot kinds. It proves:
+ * - every reachable operand is decodable and every jump/call target is in range,
+ * - stack depth is consistent at every join point and never underflows (callees are
+ *   summarised by how many caller values they consume and what they leave at `Ret`),
+ * - constant indices are in bounds, local indices fit the executing call frame, and `Ret` is
+ *   never reached outside a call,
+ * - operand kinds, per instruction, wherever they are statically known.
+ *
+ * On success every reachable instruction gets a `Verified*` handler that skips the structural
+ * checks (and the kind checks where kinds were proven); fuel, capability, overflow and
+ * divide-by-zero checks remain, except on the unchecked arithmetic opcodes whose safety the
+ * source verifier already proved. On failure `code` is left untouched and runs fully checked.
+ */
+[[nodiscard]] std::optional<BytecodeVerifyError> verify_bytecode(const Chunk& chunk,
+                                                                 ThreadedCode& code);
+
+} // namespace curlee::vm
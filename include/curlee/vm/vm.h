@@ -4,6 +4,9 @@
 #include <curlee/runtime/capabilities.h>
 #include <curlee/source/span.h>
 #include <curlee/vm/bytecode.h>
+#include <curlee/vm/profiler.h>
+#include <curlee/vm/threaded_code.h>
+#include <curlee/vm/verifier.h>
 #include <optional>
 #include <string>
 
@@ -24,13 +27,66 @@ struct VmResult
     std::optional<curlee::source::Span> error_span;
 };
 
+/** @brief How VM::run dispatches instructions. */
+enum class DispatchMode
+{
+    /** Decode bytes from Chunk::code through a switch on every instruction (portable). */
+    Switch,
+    /** Pre-decode the chunk once, then run direct-threaded code (computed goto when available).
+     */
+    Threaded,
+};
+
+/**
+ * @brief A chunk decoded and verified once, for hosts that execute the same code many times.
+ *
+ * When verification succeeds the threaded dispatch loop runs check-free handlers; otherwise
+ * the chunk still runs, fully checked, and verify_error() explains what could not be proven.
+ * Like VM, a PreparedChunk must not be run from several threads at once.
+ */
+class PreparedChunk
+{
+  public:
+    explicit PreparedChunk(Chunk chunk);
+
+    [[nodiscard]] const Chunk& chunk() const { return chunk_; }
+    [[nodiscard]] bool verified() const { return !verify_error_.has_value(); }
+    [[nodiscard]] const std::optional<BytecodeVerifyError>& verify_error() const
+    {
+        return verify_error_;
+    }
+
+  private:
+    friend class VM;
+
+    Chunk chunk_;
+    /** Handler addresses are resolved lazily by the first threaded run. */
+    mutable std::optional<ThreadedCode> code_;
+    std::optional<BytecodeVerifyError> verify_error_;
+};
+
 /**
  * @brief Simple deterministic virtual machine used by the test harness and runtime.
+ *
+ * Both dispatch modes produce identical VmResults for the same chunk, fuel and capabilities.
  */
 class VM
 {
   public:
     using Capabilities = curlee::runtime::Capabilities;
+    using CapabilityMask = curlee::runtime::CapabilityMask;
+
+    /** @brief Select the dispatch loop used by subsequent runs (default: Threaded). */
+    void set_dispatch_mode(DispatchMode mode) { dispatch_mode_ = mode; }
+    [[nodiscard]] DispatchMode dispatch_mode() const { return dispatch_mode_; }
+
+    /**
+     * @brief Record subsequent runs into `profiler` (nullptr stops profiling).
+     *
+     * Profiled runs use the switch loop with profiling hooks compiled in, whatever the dispatch
+     * mode; runs without a profiler execute loops that contain no profiling code at all.
+     */
+    void set_profiler(Profiler* profiler) { profiler_ = profiler; }
 
     /** @brief Run a chunk to completion using default fuel and capabilities. */
     [[nodiscard]] VmResult run(const Chunk& chunk);
@@ -42,12 +98,40 @@ class VM
     /** @brief Run with fuel and explicit capabilities. */
     [[nodiscard]] VmResult run(const Chunk& chunk, std::size_t fuel,
                                const Capabilities& capabilities);
+    /**
+     * @brief Run with fuel and capabilities already resolved by runtime::resolve_capabilities.
+     *
+     * The string-set overloads resolve once and forward here; hosts that run many chunks under
+     * the same grant can resolve once themselves.
+     */
+    [[nodiscard]] VmResult run(const Chunk& chunk, std::size_t fuel, CapabilityMask capabilities);
+
+    /** @brief Run a prepared chunk (same results as running its Chunk, without re-verifying). */
+    [[nodiscard]] VmResult run(const PreparedChunk& prepared);
+    [[nodiscard]] VmResult run(const PreparedChunk& prepared, std::size_t fuel);
+    [[nodiscard]] VmResult run(const PreparedChunk& prepared, const Capabilities& capabilities);
+    [[nodiscard]] VmResult run(const PreparedChunk& prepared, std::size_t fuel,
+                               const Capabilities& capabilities);
+    [[nodiscard]] VmResult run(const PreparedChunk& prepared, std::size_t fuel,
+                               CapabilityMask capabilities);
 
   private:
     std::vector<Value> stack_;
+    /** Locals of every live call frame, innermost last; capacity is reused across runs. */
+    std::vector<Value> locals_;
+    DispatchMode dispatch_mode_ = DispatchMode::Threaded;
+    Profiler* profiler_ = nullptr;
 
     bool push(Value value);
     std::optional<Value> pop();
+
+    template <bool kProfile>
+    [[nodiscard]] VmResult run_switch(const Chunk& chunk, std::size_t fuel,
+                                      CapabilityMask capabilities);
+    [[nodiscard]] VmResult run_profiled(const Chunk& chunk, std::size_t fuel,
+                                        CapabilityMask capabilities);
+    [[nodiscard]] VmResult run_threaded(ThreadedCode& code, const Chunk& chunk, std::size_t fuel,
+                                        CapabilityMask capabilities);
 };
 
 } // namespace curlee::vm
@@ -20,6 +20,14 @@ def main() -> int:
     parser.add_argument("--curlee", type=Path, default=Path("build/linux-debug/curlee"))
     parser.add_argument("--runs", type=int, default=1)
     parser.add_argument("--dirs", nargs="*", type=Path, default=[Path("tests/run")])
+    # Comparing theories runs corpora with failing samples (e.g. tests/fixtures), so it reports
+    # how many verified instead of stopping at the first failure.
+    parser.add_argument(
+        "--int-theories",
+        nargs="*",
+        choices=["int", "bv", "auto"],
+        help="time `curlee check --int-theory <t>` for each theory",
+    )
     args = parser.parse_args()
 
     curlee = args.curlee
@@ -30,15 +38,38 @@ def main() -> int:
     if not samples:
         raise SystemExit("no samples found")
 
-    total = 0.0
-    for _ in range(args.runs):
-        start = time.perf_counter()
-        for sample in samples:
-            subprocess.run([str(curlee), "check", str(sample)], check=True)
-        total += time.perf_counter() - start
+    if not args.int_theories:
+        total = 0.0
+        for _ in range(args.runs):
+            start = time.perf_counter()
+            for sample in samples:
+                subprocess.run([str(curlee), "check", str(sample)], check=True)
+            total += time.perf_counter() - start
 
-    avg = total / args.runs
-    print(f"samples={len(samples)} runs={args.runs} avg_seconds={avg:.4f}")
+        avg = total / args.runs
+        print(f"samples={len(samples)} runs={args.runs} avg_seconds={avg:.4f}")
+        return 0
+
+    for theory in args.int_theories:
+        total = 0.0
+        verified = 0
+        for _ in range(args.runs):
+            verified = 0
+            start = time.perf_counter()
+            for sample in samples:
+                result = subprocess.run(
+                    [str(curlee), "check", "--int-theory", theory, str(sample)],
+                    stdout=subprocess.DEVNULL,
+                    stderr=subprocess.DEVNULL,
+                )
+                verified += result.returncode == 0
+            total += time.perf_counter() - start
+
+        avg = total / args.runs
+        print(
+            f"theory={theory} samples={len(samples)} verified={verified} runs={args.runs} "
+            f"avg_seconds={avg:.4f}"
+        )
     return 0
 
 
@@ -1,21 +1,28 @@
 #include <algorithm>
+#include <array>
 #include <charconv>
 #include <cstdlib>
 #include <curlee/bundle/bundle.h>
 #include <curlee/cli/cli.h>
+#include <curlee/cli/compile_cache.h>
 #include <curlee/compiler/emitter.h>
 #include <curlee/diag/render.h>
 #include <curlee/lexer/lexer.h>
 #include <curlee/parser/parser.h>
 #include <curlee/resolver/resolver.h>
+#include <curlee/source/line_map.h>
 #include <curlee/source/source_file.h>
 #include <curlee/types/type_check.h>
+#include <curlee/verification/cache_file.h>
+#include <curlee/verification/certificate.h>
 #include <curlee/verification/checker.h>
 #include <curlee/vm/chunk_codec.h>
 #include <curlee/vm/value.h>
 #include <curlee/vm/vm.h>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -48,6 +55,12 @@ constexpr int kExitUsage = 2;
 
 constexpr std::size_t kDefaultFuel = 10000;
 
+/**
+ * Folded into compile cache keys, along with the flags that change what check/emit produce
+ * (only `--int-theory`); bump it when checking or emission changes without a version bump.
+ */
+constexpr std::string_view kCacheOptions = "check+emit";
+
 curlee::runtime::Capabilities empty_caps()
 {
     return {};
@@ -62,11 +75,13 @@ void print_usage(std::ostream& out)
     out << "  curlee <file.curlee>\n";
     out << "  curlee lex <file.curlee>\n";
     out << "  curlee parse <file.curlee>\n";
-    out << "  curlee check <file.curlee>\n";
+    out << "  curlee check [-j <n>] [--solver-timeout <ms>] [--solver-rlimit <n>] [--portfolio] "
+           "[--int-theory <int|bv|auto>] [--stats[=json]] <file.curlee>\n";
     out << "  curlee run [--fuel <n>] [--bundle <file.bundle>] [--cap <capability>]... "
-           "<file.curlee>\n";
+           "[--profile] [--profile-stacks <file>] <file.curlee>\n";
     out << "  curlee fmt [--check] <file>\n";
-    out << "  curlee bundle verify <file.bundle>\n";
+    out << "  curlee bundle create [--cap <capability>]... <file.curlee> <file.bundle>\n";
+    out << "  curlee bundle verify <file.bundle> [<file.curlee>]\n";
     out << "  curlee bundle info <file.bundle>\n";
 }
 
@@ -123,8 +138,139 @@ std::string join_import_pins(const std::vector<curlee::bundle::ImportPin>& pins)
     return out;
 } // GCOVR_EXCL_LINE
 
+/** @brief `curlee run --profile` settings. */
+struct ProfileOptions
+{
+    bool enabled = false;
+    /** Where to write collapsed stacks for flame graph tools (implies `enabled`). */
+    std::optional<std::string> stacks_path;
+};
+
+/** @brief `curlee check --stats` output: none, a table on stderr, or JSON on stdout. */
+enum class StatsFormat
+{
+    None,
+    Table,
+    Json,
+};
+
+/** @brief What cmd_read_only's `create` and `certify` commands work on. */
+struct BundleOptions
+{
+    /** `create`: where to write the bundle. */
+    std::string output;
+    /** `create`: capabilities to declare in the manifest. */
+    std::vector<std::string> capabilities;
+    /** `certify`: the bundle whose bytecode the re-verified source must reproduce. */
+    const curlee::bundle::Bundle* input = nullptr;
+    /** `certify`: the certificate `input` carries. */
+    const verification::ProofCertificate* certificate = nullptr;
+};
+
+/** @brief The proof certificate a bundle carries, if its proof is one. */
+std::optional<verification::ProofCertificate> bundle_certificate(const curlee::bundle::Bundle& b)
+{
+    if (!b.manifest.proof.has_value())
+    {
+        return std::nullopt;
+    }
+    return verification::decode_certificate(*b.manifest.proof);
+}
+
+/** @brief `file:line:col-col`, or `file:line:col-line:col` for a multi-line span. */
+std::string span_location(const std::string& path, const source::LineMap& lines,
+                          const source::Span& span)
+{
+    const auto begin = lines.offset_to_line_col(span.start);
+    const auto end = lines.offset_to_line_col(span.end);
+    std::string where =
+        path + ":" + std::to_string(begin.line) + ":" + std::to_string(begin.col) + "-";
+    if (end.line != begin.line)
+    {
+        where += std::to_string(end.line) + ":";
+    }
+    return where + std::to_string(end.col);
+}
+
+/** @brief Print the obligations `curlee check --stats` collected; `files[i]` holds the i-th. */
+void print_verification_stats(StatsFormat format,
+                              const std::vector<verification::ObligationProfile>& profiles,
+                              const std::vector<const source::SourceFile*>& files)
+{
+    std::unordered_map<const source::SourceFile*, source::LineMap> lines;
+    auto where = [&](const verification::ObligationProfile& profile)
+    {
+        const source::SourceFile* file = files[&profile - profiles.data()];
+        auto it = lines.find(file);
+        if (it == lines.end())
+        {
+            it = lines.emplace(file, source::LineMap(file->contents)).first;
+        }
+        return span_location(file->path, it->second, profile.span);
+    };
+    if (format == StatsFormat::Json)
+    {
+        std::cout << verification::verification_profile_json(profiles, where);
+    }
+    else
+    {
+        std::cerr << verification::render_verification_profile(profiles, where);
+    }
+}
+
+/** @brief Run a compiled chunk, print its result (and profile), and return the exit code. */
+int run_chunk(const vm::Chunk& chunk, const source::SourceFile& file, std::size_t fuel,
+              const curlee::runtime::Capabilities& caps, const ProfileOptions& profile)
+{
+    vm::VM machine;
+    vm::Profiler profiler;
+    if (profile.enabled)
+    {
+        machine.set_profiler(&profiler);
+    }
+
+    // Host grant and bundle manifest meet here as names; the VM only ever tests bits.
+    const auto result = machine.run(chunk, fuel, curlee::runtime::resolve_capabilities(caps));
+    if (!result.ok)
+    {
+        diag::Diagnostic d;
+        d.severity = diag::Severity::Error;
+        d.message = result.error;
+        d.span = result.error_span;
+        std::cerr << diag::render(d, file);
+    }
+    else
+    {
+        std::cout << "curlee run: result " << vm::to_string(result.value) << "\n";
+    }
+
+    if (profile.enabled)
+    {
+        const source::LineMap lines(file.contents);
+        std::cerr << vm::render_profile_report(profiler, [&](const source::Span& span)
+                                               { return span_location(file.path, lines, span); });
+
+        if (profile.stacks_path.has_value())
+        {
+            std::ofstream out(*profile.stacks_path, std::ios::binary | std::ios::trunc);
+            out << profiler.collapsed_stacks();
+            if (!out)
+            {
+                std::cerr << "error: failed to write profile stacks: " << *profile.stacks_path
+                          << "\n";
+                return kExitError;
+            }
+        }
+    }
+
+    return result.ok ? kExitOk : kExitError;
+}
+
 int cmd_read_only(std::string_view cmd, const std::string& path,
-                  const curlee::runtime::Capabilities& granted_caps, std::size_t fuel)
+                  const curlee::runtime::Capabilities& granted_caps, std::size_t fuel,
+                  const ProfileOptions& profile = {},
+                  const verification::VerifyOptions& verify_options = {},
+                  const BundleOptions& bundle_options = {}, StatsFormat stats = StatsFormat::None)
 {
     auto loaded = source::load_source_file(path);
     if (auto* err = std::get_if<source::LoadError>(&loaded))
@@ -151,6 +297,68 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
     std::vector<parser::Program> imported_programs;
     std::unordered_map<std::string, std::size_t> imported_by_path;
 
+    // Only successful checks are cached, so a hit means the program (and its imports) verified.
+    const auto cache = (cmd == "check" || cmd == "run") ? CompileCache::from_environment()
+                                                        : std::nullopt;
+
+    // Solved obligations and verified functions live next to the compile cache. Unlike its
+    // entries they are reused after an edit, for every obligation whose query and every
+    // function whose dependencies did not change. Without a cache directory the session still
+    // spares imported functions a second verification in the merged program.
+    std::optional<verification::ObligationCache> obligations;
+    std::optional<verification::VerificationSession> session;
+    verification::VerifyOptions checker_options = verify_options;
+    if (cache.has_value())
+    {
+        obligations.emplace(cache->dir() / "obligations");
+        checker_options.cache = &*obligations;
+    }
+    // `--stats` measures every function again; cached obligations are still reported as such.
+    if (cache.has_value() && stats == StatsFormat::None)
+    {
+        session.emplace(cache->dir() / "functions");
+    }
+    else
+    {
+        session.emplace();
+    }
+    checker_options.session = &*session;
+
+    // `create` records a certificate for the bundle; `certify` re-verifies with the one a
+    // bundle carries, so the receiver checks small cores instead of searching again.
+    verification::ProofCertificate recorded_certificate;
+    if (cmd == "create")
+    {
+        checker_options.record_certificate = &recorded_certificate;
+    }
+    else if (cmd == "certify")
+    {
+        checker_options.certificate = bundle_options.certificate;
+    }
+
+    // `--stats`: every verified obligation, and the file its span points into.
+    std::vector<verification::ObligationProfile> obligation_profiles;
+    std::vector<const source::SourceFile*> profile_files;
+    if (stats != StatsFormat::None)
+    {
+        checker_options.profile = &obligation_profiles;
+    }
+
+    // Set by a successful run_checks; names the arithmetic the compiler may leave unchecked.
+    verification::Verified verified_program;
+
+    // Every import run_checks opened or probed for, so a cached result can be invalidated.
+    std::vector<CacheDependency> cache_dependencies;
+    std::unordered_set<std::string> cache_dependency_paths;
+    auto record_dependency = [&](const std::string& dep_path, std::string hash)
+    {
+        if (cache_dependency_paths.insert(dep_path).second)
+        {
+            cache_dependencies.push_back(
+                CacheDependency{.path = dep_path, .hash = std::move(hash)});
+        }
+    };
+
     auto run_checks = [&](parser::Program& program) -> bool
     {
         namespace fs = std::filesystem;
@@ -166,6 +374,8 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
         imported_file_by_path.clear();
         imported_programs.clear();
         imported_by_path.clear();
+        cache_dependencies.clear();
+        cache_dependency_paths.clear();
 
         std::unordered_set<std::string> visiting;
         std::unordered_set<std::string> visited;
@@ -231,10 +441,13 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
                         std::cerr << "[import] failed: " << err->message << "\n";
                     }
                     last_err = err->message;
+                    record_dependency(module_path.string(), "");
                     continue;
                 }
 
                 auto dep_file = std::get<source::SourceFile>(loaded);
+                record_dependency(module_path.string(),
+                                  verification::sha256_hex(dep_file.contents));
 
                 ImportLoadResult ok;
                 ok.file = std::move(dep_file);
@@ -389,7 +602,10 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
             }
 
             const auto& type_info = std::get<types::TypeInfo>(typed);
-            const auto verified = verification::verify(mod_program, type_info);
+            verification::VerifyOptions module_options = checker_options;
+            module_options.imported_module = true;
+            const auto verified = verification::verify(mod_program, type_info, module_options);
+            profile_files.resize(obligation_profiles.size(), &stable_file);
             if (std::holds_alternative<std::vector<diag::Diagnostic>>(verified))
             {
                 render_diags(std::get<std::vector<diag::Diagnostic>>(verified), stable_file);
@@ -530,7 +746,8 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
         }
 
         const auto& type_info = std::get<types::TypeInfo>(typed);
-        const auto verified = verification::verify(program, type_info);
+        const auto verified = verification::verify(program, type_info, checker_options);
+        profile_files.resize(obligation_profiles.size(), &file);
         if (std::holds_alternative<std::vector<diag::Diagnostic>>(verified))
         {
             const auto& ds = std::get<std::vector<diag::Diagnostic>>(verified);
@@ -541,6 +758,7 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
             return false;
         }
 
+        verified_program = std::get<verification::Verified>(verified);
         return true;
     };
 
@@ -584,18 +802,102 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
         return kExitOk;
     }
 
+    // int64 variables prove more, and unchecked arithmetic makes it into the chunk.
+    const std::string cache_options =
+        std::string(kCacheOptions) +
+        (verify_options.solver.theory != verification::IntTheory::Integer ? "+int64" : "");
+    const std::string cache_key =
+        cache.has_value() ? CompileCache::key(file.path, file.contents, cache_options) : "";
+
+    // Emit a checked program and remember the result, so later checks and runs skip both.
+    auto emit_and_cache = [&](const parser::Program& program) -> compiler::EmitResult
+    {
+        auto emitted = compiler::emit_bytecode(program, verified_program.proven_arithmetic);
+        if (cache.has_value())
+        {
+            CacheEntry entry{.dependencies = cache_dependencies, .chunk = std::nullopt};
+            if (const auto* chunk = std::get_if<vm::Chunk>(&emitted))
+            {
+                entry.chunk = vm::encode_chunk(*chunk);
+            }
+            cache->store(cache_key, entry);
+        }
+        return emitted;
+    };
+
     if (cmd == "check")
     {
+        // A cached result would leave nothing to measure.
+        if (cache.has_value() && stats == StatsFormat::None &&
+            cache->lookup(cache_key).has_value())
+        {
+            return kExitOk;
+        }
+
         parser::Program program;
-        if (!run_checks(program))
+        const bool checked = run_checks(program);
+        if (stats != StatsFormat::None)
         {
+            print_verification_stats(stats, obligation_profiles, profile_files);
+        }
+        if (!checked)
+        {
+            // Nothing is stored for a failure, but its solved obligations were.
+            if (cache.has_value())
+            {
+                cache->evict();
+            }
             return kExitError;
         }
 
+        if (cache.has_value())
+        {
+            (void)emit_and_cache(program);
+        }
         return kExitOk;
     }
 
     if (cmd == "run")
+    {
+        // Encoded chunks drop function names, which only the profile report needs.
+        if (cache.has_value() && !profile.enabled)
+        {
+            const auto entry = cache->lookup(cache_key);
+            if (entry.has_value() && entry->chunk.has_value())
+            {
+                const auto decoded = vm::decode_chunk(*entry->chunk);
+                if (const auto* chunk = std::get_if<vm::Chunk>(&decoded))
+                {
+                    return run_chunk(*chunk, file, fuel, granted_caps, profile);
+                }
+            }
+        }
+
+        parser::Program program;
+        if (!run_checks(program))
+        {
+            if (cache.has_value())
+            {
+                cache->evict();
+            }
+            return kExitError;
+        }
+
+        const auto emitted = emit_and_cache(program);
+        if (std::holds_alternative<std::vector<diag::Diagnostic>>(emitted))
+        {
+            const auto& ds = std::get<std::vector<diag::Diagnostic>>(emitted);
+            for (const auto& d : ds)
+            {
+                std::cerr << diag::render(d, file);
+            }
+            return kExitError;
+        }
+
+        return run_chunk(std::get<vm::Chunk>(emitted), file, fuel, granted_caps, profile);
+    }
+
+    if (cmd == "create" || cmd == "certify")
     {
         parser::Program program;
         if (!run_checks(program))
@@ -603,7 +905,7 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
             return kExitError;
         }
 
-        const auto emitted = compiler::emit_bytecode(program);
+        const auto emitted = compiler::emit_bytecode(program, verified_program.proven_arithmetic);
         if (std::holds_alternative<std::vector<diag::Diagnostic>>(emitted))
         {
             const auto& ds = std::get<std::vector<diag::Diagnostic>>(emitted);
@@ -613,21 +915,38 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
             }
             return kExitError;
         }
+        const auto bytecode = vm::encode_chunk(std::get<vm::Chunk>(emitted));
 
-        const auto& chunk = std::get<vm::Chunk>(emitted);
-        vm::VM machine;
-        const auto result = machine.run(chunk, fuel, granted_caps);
-        if (!result.ok)
+        if (cmd == "certify")
         {
+            if (bytecode == bundle_options.input->bytecode)
+            {
+                return kExitOk;
+            }
             diag::Diagnostic d;
             d.severity = diag::Severity::Error;
-            d.message = result.error;
-            d.span = result.error_span;
+            d.message = "bundle bytecode does not match the verified program";
+            d.span = std::nullopt;
+            const diag::Related note{
+                .message = "rebuild it with: curlee bundle create <file.curlee> <file.bundle>",
+                .span = std::nullopt,
+            };
+            d.notes.push_back(note);
             std::cerr << diag::render(d, file);
             return kExitError;
         }
 
-        std::cout << "curlee run: result " << vm::to_string(result.value) << "\n";
+        curlee::bundle::Bundle bundle;
+        bundle.manifest.capabilities = bundle_options.capabilities;
+        bundle.manifest.proof = verification::encode_certificate(recorded_certificate);
+        bundle.bytecode = bytecode;
+        const auto write_err = curlee::bundle::write_bundle(bundle_options.output, bundle);
+        if (!write_err.message.empty())
+        {
+            std::cerr << "error: bundle create failed: " << write_err.message << "\n";
+            return kExitError;
+        }
+        std::cout << "curlee bundle create: ok\n";
         return kExitOk;
     }
 
@@ -636,7 +955,8 @@ int cmd_read_only(std::string_view cmd, const std::string& path,
 }
 
 int cmd_run_bundle(const curlee::bundle::Bundle& bundle, const std::string& entry_path,
-                   const curlee::runtime::Capabilities& granted_caps, std::size_t fuel)
+                   const curlee::runtime::Capabilities& granted_caps, std::size_t fuel,
+                   const ProfileOptions& profile)
 {
     auto loaded = source::load_source_file(entry_path);
     if (auto* err = std::get_if<source::LoadError>(&loaded))
@@ -684,7 +1004,7 @@ int cmd_run_bundle(const curlee::bundle::Bundle& bundle, const std::string& entr
         effective_caps.insert(cap);
     }
 
-    const auto decoded = curlee::vm::decode_chunk(bundle.bytecode);
+    auto decoded = curlee::vm::decode_chunk(bundle.bytecode);
     if (const auto* decode_err = std::get_if<curlee::vm::ChunkDecodeError>(&decoded))
     {
         const diag::Diagnostic d{
@@ -697,22 +1017,24 @@ int cmd_run_bundle(const curlee::bundle::Bundle& bundle, const std::string& entr
         return kExitError;
     }
 
-    const auto& chunk = std::get<curlee::vm::Chunk>(decoded);
-    vm::VM machine;
-
-    const auto result = machine.run(chunk, fuel, effective_caps);
-    if (!result.ok)
+    // Arithmetic the producer left unchecked stays unchecked only once the entry source has
+    // been re-verified with the bundle's certificate and compiles to the same bytecode.
+    // Other proofs cannot be checked, so that arithmetic is checked again.
+    auto& chunk = std::get<curlee::vm::Chunk>(decoded);
+    if (const auto certificate = bundle_certificate(bundle); certificate.has_value())
     {
-        diag::Diagnostic d;
-        d.severity = diag::Severity::Error;
-        d.message = result.error;
-        d.span = result.error_span;
-        std::cerr << diag::render(d, file);
-        return kExitError;
+        const BundleOptions certify{
+            .output = {}, .capabilities = {}, .input = &bundle, .certificate = &*certificate};
+        if (cmd_read_only("certify", entry_path, granted_caps, fuel, {}, {}, certify) != kExitOk)
+        {
+            return kExitError;
+        }
     }
-
-    std::cout << "curlee run: result " << vm::to_string(result.value) << "\n";
-    return kExitOk;
+    else
+    {
+        chunk.demote_unchecked_arithmetic();
+    }
+    return run_chunk(chunk, file, fuel, effective_caps, profile);
 }
 
 std::optional<std::size_t> parse_size(std::string_view s)
@@ -816,7 +1138,33 @@ int run(int argc, char** argv)
 
     if (cmd == "bundle")
     {
-        if (args.size() != 2)
+        if (!args.empty() && args[0] == "create")
+        {
+            BundleOptions options;
+            std::vector<std::string_view> paths;
+            for (std::size_t i = 1; i < args.size(); ++i)
+            {
+                if (args[i] == "--cap" && i + 1 < args.size())
+                {
+                    options.capabilities.emplace_back(args[++i]);
+                    continue;
+                }
+                paths.push_back(args[i]);
+            }
+            if (paths.size() != 2)
+            {
+                std::cerr << "error: expected curlee bundle create [--cap <capability>]... "
+                             "<file.curlee> <file.bundle>\n\n";
+                print_usage(std::cerr);
+                return kExitUsage;
+            }
+            options.output = std::string(paths[1]);
+            return cmd_read_only("create", std::string(paths[0]), empty_caps(), kDefaultFuel, {},
+                                 {}, options);
+        }
+
+        const bool with_source = args.size() == 3 && args[0] == "verify";
+        if (args.size() != 2 && !with_source)
         {
             std::cerr << "error: expected curlee bundle <verify|info> <file.bundle>\n\n";
             print_usage(std::cerr);
@@ -837,6 +1185,22 @@ int run(int argc, char** argv)
 
         if (sub == "verify")
         {
+            if (with_source)
+            {
+                const auto certificate = bundle_certificate(b);
+                if (!certificate.has_value())
+                {
+                    std::cerr << "error: bundle verify failed: bundle has no proof certificate\n";
+                    return kExitError;
+                }
+                const BundleOptions certify{
+                    .output = {}, .capabilities = {}, .input = &b, .certificate = &*certificate};
+                if (cmd_read_only("certify", std::string(args[2]), empty_caps(), kDefaultFuel, {},
+                                  {}, certify) != kExitOk)
+                {
+                    return kExitError;
+                }
+            }
             std::cout << "curlee bundle verify: ok\n";
             return kExitOk;
         }
@@ -864,10 +1228,48 @@ int run(int argc, char** argv)
         std::optional<curlee::bundle::Bundle> bundle;
         std::optional<std::string> path;
         std::size_t fuel = kDefaultFuel;
+        ProfileOptions profile;
 
         for (std::size_t i = 0; i < args.size();)
         {
             const std::string_view a = args[i];
+            if (a == "--profile")
+            {
+                profile.enabled = true;
+                ++i;
+                continue;
+            }
+
+            if (a == "--profile-stacks" || a.starts_with("--profile-stacks="))
+            {
+                std::string_view out_path;
+                if (a == "--profile-stacks")
+                {
+                    if (i + 1 >= args.size())
+                    {
+                        std::cerr << "error: expected file path after --profile-stacks\n\n";
+                        print_usage(std::cerr);
+                        return kExitUsage;
+                    }
+                    out_path = args[i + 1];
+                    i += 2;
+                }
+                else
+                {
+                    out_path = a.substr(std::string_view("--profile-stacks=").size());
+                    ++i;
+                }
+                if (out_path.empty())
+                {
+                    std::cerr << "error: expected file path after --profile-stacks=\n\n";
+                    print_usage(std::cerr);
+                    return kExitUsage;
+                }
+                profile.enabled = true;
+                profile.stacks_path = std::string(out_path);
+                continue;
+            }
+
             if (a == "--cap" || a == "--capability")
             {
                 if (i + 1 >= args.size())
@@ -1007,10 +1409,154 @@ int run(int argc, char** argv)
 
         if (bundle.has_value())
         {
-            return cmd_run_bundle(*bundle, *path, caps, fuel);
+            return cmd_run_bundle(*bundle, *path, caps, fuel, profile);
+        }
+
+        return cmd_read_only(cmd, *path, caps, fuel, profile);
+    }
+
+    if (cmd == "check")
+    {
+        std::size_t jobs = 1;
+        verification::SolverOptions solver;
+        StatsFormat stats = StatsFormat::None;
+        std::optional<std::string> path;
+        for (std::size_t i = 0; i < args.size();)
+        {
+            const std::string_view a = args[i];
+            if (a == "--portfolio")
+            {
+                solver.portfolio = true;
+                ++i;
+                continue;
+            }
+            if (a == "--stats" || a == "--stats=table")
+            {
+                stats = StatsFormat::Table;
+                ++i;
+                continue;
+            }
+            if (a == "--stats=json")
+            {
+                stats = StatsFormat::Json;
+                ++i;
+                continue;
+            }
+            if (a == "--int-theory" || a.starts_with("--int-theory="))
+            {
+                std::string_view name;
+                if (a == "--int-theory")
+                {
+                    if (i + 1 >= args.size())
+                    {
+                        std::cerr << "error: expected int, bv or auto after --int-theory\n\n";
+                        print_usage(std::cerr);
+                        return kExitUsage;
+                    }
+                    name = args[i + 1];
+                    i += 2;
+                }
+                else
+                {
+                    name = a.substr(std::string_view("--int-theory=").size());
+                    ++i;
+                }
+                const std::array theories{verification::IntTheory::Integer,
+                                          verification::IntTheory::BitVector,
+                                          verification::IntTheory::Auto};
+                const auto it =
+                    std::find_if(theories.begin(), theories.end(), [&](auto theory)
+                                 { return verification::int_theory_name(theory) == name; });
+                if (it == theories.end())
+                {
+                    std::cerr << "error: unknown --int-theory: " << name
+                              << " (expected int, bv or auto)\n\n";
+                    print_usage(std::cerr);
+                    return kExitUsage;
+                }
+                solver.theory = *it;
+                continue;
+            }
+
+            // Integer options, as `<flag> <n>` or `<flag>=<n>` (and `-j<n>`).
+            std::string_view flag = a.substr(0, a.find('='));
+            std::optional<std::string_view> raw;
+            if (flag.size() < a.size())
+            {
+                raw = a.substr(flag.size() + 1);
+            }
+            else if (a.starts_with("-j") && a.size() > 2)
+            {
+                flag = "-j";
+                raw = a.substr(2);
+            }
+            if (flag == "-j" || flag == "--jobs" || flag == "--solver-timeout" ||
+                flag == "--solver-rlimit")
+            {
+                if (!raw.has_value())
+                {
+                    if (i + 1 >= args.size())
+                    {
+                        std::cerr << "error: expected integer after " << flag << "\n\n";
+                        print_usage(std::cerr);
+                        return kExitUsage;
+                    }
+                    raw = args[++i];
+                }
+                ++i;
+                const auto parsed = parse_size(*raw);
+                const bool is_budget = flag.starts_with("--solver-");
+                if (!parsed.has_value() ||
+                    (is_budget && *parsed > std::numeric_limits<unsigned>::max()))
+                {
+                    std::cerr << "error: expected non-negative integer for " << flag << "\n\n";
+                    print_usage(std::cerr);
+                    return kExitUsage;
+                }
+                if (flag == "--solver-timeout")
+                {
+                    solver.timeout_ms = static_cast<unsigned>(*parsed);
+                }
+                else if (flag == "--solver-rlimit")
+                {
+                    solver.rlimit = static_cast<unsigned>(*parsed);
+                }
+                else
+                {
+                    // 0 means one worker per hardware thread.
+                    jobs = *parsed;
+                }
+                continue;
+            }
+
+            if (a.starts_with('-'))
+            {
+                std::cerr << "error: unknown option: " << a << "\n\n";
+                print_usage(std::cerr);
+                return kExitUsage;
+            }
+
+            if (path.has_value())
+            {
+                std::cerr << "error: expected a single <file.curlee>\n\n";
+                print_usage(std::cerr);
+                return kExitUsage;
+            }
+
+            path = std::string(a);
+            ++i;
+        }
+
+        if (!path.has_value())
+        {
+            std::cerr << "error: expected <file.curlee>\n\n";
+            print_usage(std::cerr);
+            return kExitUsage;
         }
 
-        return cmd_read_only(cmd, *path, caps, fuel);
+        return cmd_read_only(cmd, *path, empty_caps(), kDefaultFuel, {},
+                             verification::VerifyOptions{.jobs = jobs, .solver = solver}, {},
+                             stats);
     }
 
     if (argc != 3)
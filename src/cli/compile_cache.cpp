@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <curlee/cli/compile_cache.h>
+#include <curlee/verification/cache_file.h>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+namespace curlee::cli
+{
+
+namespace
+{
+
+#ifndef CURLEE_VERSION
+#define CURLEE_VERSION "0.0.0"
+#endif
+
+#ifndef CURLEE_GIT_SHA
+#define CURLEE_GIT_SHA "unknown"
+#endif
+
+namespace fs = std::filesystem;
+
+/** Bumped whenever the entry layout or anything folded into keys changes meaning. */
+constexpr std::string_view kEntryHeader = "curlee-cache 1";
+constexpr std::string_view kEntrySuffix = ".entry";
+constexpr std::chrono::hours kStaleTemporaryAge{1};
+
+/** Appends `field` so that no two different field sequences produce the same key material. */
+void append_field(std::string& out, std::string_view field)
+{
+    out += std::to_string(field.size());
+    out += ':';
+    out += field;
+}
+
+[[nodiscard]] std::optional<std::string> read_file(const fs::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (in.bad())
+    {
+        return std::nullopt; // GCOVR_EXCL_LINE
+    }
+    return contents;
+}
+
+[[nodiscard]] bool dependency_unchanged(const CacheDependency& dep)
+{
+    std::error_code ec;
+    if (dep.hash.empty())
+    {
+        return !fs::exists(dep.path, ec) && !ec;
+    }
+    const auto contents = read_file(dep.path);
+    return contents.has_value() && verification::sha256_hex(*contents) == dep.hash;
+}
+
+[[nodiscard]] std::string serialize(const CacheEntry& entry)
+{
+    std::string out(kEntryHeader);
+    out += '\n';
+    for (const auto& dep : entry.dependencies)
+    {
+        out += dep.hash.empty() ? "absent " : "dep " + dep.hash + " ";
+        out += dep.path;
+        out += '\n';
+    }
+    if (entry.chunk.has_value())
+    {
+        out += "chunk " + std::to_string(entry.chunk->size()) + "\n";
+        out.append(entry.chunk->begin(), entry.chunk->end());
+    }
+    else
+    {
+        out += "end\n";
+    }
+    return out;
+}
+
+[[nodiscard]] std::optional<CacheEntry> deserialize(const std::string& bytes)
+{
+    std::size_t pos = 0;
+    auto next_line = [&]() -> std::optional<std::string_view>
+    {
+        const auto nl = bytes.find('\n', pos);
+        if (nl == std::string::npos)
+        {
+            return std::nullopt;
+        }
+        const std::string_view line(bytes.data() + pos, nl - pos);
+        pos = nl + 1;
+        return line;
+    };
+
+    if (next_line() != kEntryHeader)
+    {
+        return std::nullopt;
+    }
+
+    CacheEntry entry;
+    while (const auto line = next_line())
+    {
+        if (line->starts_with("absent "))
+        {
+            entry.dependencies.push_back(
+                CacheDependency{.path = std::string(line->substr(7)), .hash = ""});
+            continue;
+        }
+        if (line->starts_with("dep "))
+        {
+            const auto rest = line->substr(4);
+            const auto space = rest.find(' ');
+            if (space == std::string_view::npos || space == 0)
+            {
+                return std::nullopt;
+            }
+            entry.dependencies.push_back(CacheDependency{
+                .path = std::string(rest.substr(space + 1)),
+                .hash = std::string(rest.substr(0, space)),
+            });
+            continue;
+        }
+        if (*line == "end")
+        {
+            return pos == bytes.size() ? std::optional(std::move(entry)) : std::nullopt;
+        }
+        if (line->starts_with("chunk "))
+        {
+            const auto digits = line->substr(6);
+            std::size_t size = 0;
+            const auto [ptr, ec] =
+                std::from_chars(digits.data(), digits.data() + digits.size(), size);
+            if (ec != std::errc{} || ptr != digits.data() + digits.size() ||
+                size != bytes.size() - pos)
+            {
+                return std::nullopt;
+            }
+            entry.chunk = std::vector<std::uint8_t>(
+                bytes.begin() + static_cast<std::ptrdiff_t>(pos), bytes.end());
+            return entry;
+        }
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] fs::path entry_path(const fs::path& dir, const std::string& key)
+{
+    return dir / (key + std::string(kEntrySuffix));
+}
+
+} // namespace
+
+CompileCache::CompileCache(fs::path dir, std::uintmax_t max_bytes)
+    : dir_(std::move(dir)), max_bytes_(max_bytes)
+{
+}
+
+std::optional<CompileCache> CompileCache::from_environment()
+{
+    const char* dir = std::getenv("CURLEE_CACHE_DIR");
+    if (dir == nullptr || *dir == '\0')
+    {
+        return std::nullopt;
+    }
+
+    std::uintmax_t max_bytes = kDefaultMaxBytes;
+    if (const char* raw = std::getenv("CURLEE_CACHE_MAX_BYTES"); raw != nullptr)
+    {
+        const std::string_view digits(raw);
+        std::uintmax_t parsed = 0;
+        const auto [ptr, ec] =
+            std::from_chars(digits.data(), digits.data() + digits.size(), parsed);
+        if (ec == std::errc{} && ptr == digits.data() + digits.size())
+        {
+            max_bytes = parsed;
+        }
+    }
+    return CompileCache(fs::path(dir), max_bytes);
+}
+
+std::string CompileCache::key(std::string_view path, std::string_view contents,
+                              std::string_view options)
+{
+    std::string material;
+    append_field(material, kEntryHeader);
+    append_field(material, CURLEE_VERSION);
+    append_field(material, CURLEE_GIT_SHA);
+    append_field(material, options);
+    append_field(material, path);
+    append_field(material, contents);
+    return verification::sha256_hex(material);
+}
+
+std::optional<CacheEntry> CompileCache::lookup(const std::string& key) const
+{
+    const fs::path path = entry_path(dir_, key);
+    const auto bytes = read_file(path);
+    if (!bytes.has_value())
+    {
+        return std::nullopt;
+    }
+    auto entry = deserialize(*bytes);
+    if (!entry.has_value())
+    {
+        return std::nullopt;
+    }
+    for (const auto& dep : entry->dependencies)
+    {
+        if (!dependency_unchanged(dep))
+        {
+            return std::nullopt;
+        }
+    }
+
+    // Recency for eviction; losing this race to another process is harmless.
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return entry;
+}
+
+void CompileCache::store(const std::string& key, const CacheEntry& entry) const
+{
+    // The entry format is line based; such paths are not worth a quoting scheme.
+    for (const auto& dep : entry.dependencies)
+    {
+        if (dep.path.find('\n') != std::string::npos)
+        {
+            return;
+        }
+    }
+
+    if (verification::write_file_atomically(entry_path(dir_, key), serialize(entry)))
+    {
+        evict();
+    }
+}
+
+void CompileCache::evict() const
+{
+    struct Stored
+    {
+        fs::path path;
+        fs::file_time_type used;
+        std::uintmax_t size = 0;
+    };
+
+    // The obligation cache and the verification session keep their files in subdirectories;
+    // they share the bound, and refresh modification times on hits the same way.
+    std::error_code ec;
+    std::vector<Stored> stored;
+    std::uintmax_t total = 0;
+    for (fs::recursive_directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec))
+    {
+        const fs::path& path = it->path();
+        std::error_code stat_ec;
+        if (!it->is_regular_file(stat_ec))
+        {
+            continue;
+        }
+        const auto size = fs::file_size(path, stat_ec);
+        const auto used = fs::last_write_time(path, stat_ec);
+        if (stat_ec)
+        {
+            continue; // Removed by a concurrent eviction.
+        }
+        if (path.filename().string().find(".tmp.") != std::string::npos)
+        {
+            // Temporaries left behind by interrupted writers.
+            if (used + kStaleTemporaryAge < fs::file_time_type::clock::now())
+            {
+                fs::remove(path, stat_ec);
+            }
+            continue;
+        }
+        stored.push_back(Stored{.path = path, .used = used, .size = size});
+        total += size;
+    }
+    if (total <= max_bytes_)
+    {
+        return;
+    }
+
+    std::sort(stored.begin(), stored.end(),
+              [](const Stored& a, const Stored& b) { return a.used < b.used; });
+    for (const auto& entry : stored)
+    {
+        if (total <= max_bytes_)
+        {
+            break;
+        }
+        fs::remove(entry.path, ec);
+        total -= entry.size;
+    }
+}
+
+} // namespace curlee::cli
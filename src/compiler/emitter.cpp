@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <curlee/compiler/emitter.h>
 #include <curlee/lexer/token.h>
 #include <limits>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -86,6 +88,11 @@ Diagnostic error_at(Span span, std::string message)
 class Emitter
 {
   public:
+    explicit Emitter(const std::unordered_set<std::size_t>& proven_arithmetic)
+        : proven_arithmetic_(proven_arithmetic)
+    {
+    }
+
     EmitResult run(const curlee::parser::Program& program)
     {
         imported_module_keys_.clear();
@@ -173,15 +180,26 @@ class Emitter
         {
             return diags_; // GCOVR_EXCL_LINE
         }
+
+        // Functions are laid out back to back, so each one ends where the next begins.
+        for (std::size_t i = 0; i < chunk_.functions.size(); ++i)
+        {
+            auto& fn = chunk_.functions[i];
+            const std::size_t end = (i + 1 < chunk_.functions.size())
+                                        ? chunk_.functions[i + 1].entry
+                                        : chunk_.code.size();
+            fn.max_stack = max_stack_depth(fn.entry, end);
+        }
+        chunk_.max_locals = chunk_.functions.front().locals;
         return chunk_;
     }
 
   private:
+    const std::unordered_set<std::size_t>& proven_arithmetic_;
     Chunk chunk_;
     std::vector<Diagnostic> diags_;
     std::unordered_map<std::string_view, std::uint16_t> locals_;
-    std::uint16_t local_base_ = 0;
-    std::uint16_t next_local_base_ = 0;
+    std::size_t frame_size_ = 0;
     bool current_is_main_ = false;
 
     std::unordered_map<std::string_view, const Function*> functions_;
@@ -206,10 +224,10 @@ class Emitter
 
     std::size_t ip() const { return chunk_.code.size(); }
 
-    std::size_t emit_u16_placeholder(Span span)
+    std::size_t emit_u16_placeholder()
     {
         const auto pos = chunk_.code.size();
-        chunk_.emit_u16(0, span);
+        chunk_.emit_u16(0);
         return pos;
     }
 
@@ -219,6 +237,78 @@ class Emitter
         chunk_.code[pos + 1] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
     }
 
+    [[nodiscard]] std::uint16_t read_u16(std::size_t pos) const
+    {
+        return static_cast<std::uint16_t>(chunk_.code[pos] | (chunk_.code[pos + 1] << 8));
+    }
+
+    // Deepest operand stack built by the code in [begin, end), relative to the frame's stack
+    // base. Statements leave the stack balanced, so every offset is reached at one depth.
+    [[nodiscard]] std::size_t max_stack_depth(std::size_t begin, std::size_t end) const
+    {
+        std::vector<std::optional<std::size_t>> depth_at(end - begin);
+        std::vector<std::size_t> work{begin};
+        depth_at[0] = 0;
+        std::size_t max_depth = 0;
+
+        const auto visit = [&](std::size_t at, std::size_t depth)
+        {
+            if (at >= begin && at < end && !depth_at[at - begin].has_value())
+            {
+                depth_at[at - begin] = depth;
+                work.push_back(at);
+            }
+        };
+        const auto drop = [](std::size_t depth, std::size_t n)
+        { return depth - std::min(depth, n); };
+
+        while (!work.empty())
+        {
+            const std::size_t pos = work.back();
+            work.pop_back();
+            std::size_t depth = *depth_at[pos - begin];
+            const auto op = static_cast<OpCode>(chunk_.code[pos]);
+            const std::size_t next = pos + (curlee::vm::has_u16_operand(op) ? 3 : 1);
+
+            switch (op)
+            {
+            case OpCode::Constant:
+            case OpCode::LoadLocal:
+            case OpCode::PythonCall:
+                ++depth;
+                break;
+            case OpCode::Neg:
+            case OpCode::NegUnchecked:
+            case OpCode::Not:
+            case OpCode::Print:
+                break;
+            case OpCode::Return:
+            case OpCode::Ret:
+                continue;
+            case OpCode::Jump:
+                visit(read_u16(pos + 1), depth);
+                continue;
+            case OpCode::JumpIfFalse:
+                depth = drop(depth, 1);
+                visit(read_u16(pos + 1), depth);
+                break;
+            case OpCode::Call:
+            {
+                const auto* callee = chunk_.function_at(read_u16(pos + 1));
+                depth = drop(depth, callee != nullptr ? callee->arity : 0) + 1;
+                break;
+            }
+            default:
+                // StoreLocal, Pop and the binary operators.
+                depth = drop(depth, 1);
+                break;
+            }
+            max_depth = std::max(max_depth, depth);
+            visit(next, depth);
+        }
+        return max_depth;
+    }
+
     void emit_function(const Function& fn, bool is_main)
     {
         current_is_main_ = is_main;
@@ -226,10 +316,12 @@ class Emitter
         // Track function start address for calls.
         function_addrs_.emplace(fn.name, ip());
 
-        // Allocate locals in a disjoint slot range per function to avoid clobbering
-        // across calls without requiring VM local snapshots.
+        // Every function gets its own call frame; slots are frame-relative and parameters
+        // occupy the first ones (the VM moves call arguments there on entry).
         locals_.clear();
-        local_base_ = next_local_base_;
+        frame_size_ = 0;
+        chunk_.functions.push_back(curlee::vm::FunctionInfo{
+            .entry = ip(), .arity = fn.params.size(), .name = std::string(fn.name)});
 
         if (is_main && !fn.params.empty())
         {
@@ -249,18 +341,9 @@ class Emitter
                 return;
             }
 
-            const auto slot = static_cast<std::uint16_t>(local_base_ + i);
-            locals_.emplace(p.name, slot);
-        }
-
-        // Callee prologue: pop call arguments into parameter locals.
-        // Call sites evaluate args left-to-right, so we pop into params right-to-left.
-        for (std::size_t i = fn.params.size(); i > 0; --i)
-        {
-            const auto& p = fn.params[i - 1];
-            const auto slot = static_cast<std::uint16_t>(local_base_ + (i - 1));
-            chunk_.emit_local(OpCode::StoreLocal, slot, p.span);
+            locals_.emplace(p.name, static_cast<std::uint16_t>(i));
         }
+        frame_size_ = fn.params.size();
 
         for (const auto& stmt : fn.body.stmts)
         {
@@ -275,8 +358,7 @@ class Emitter
         chunk_.emit_constant(Value::unit_v(), fn.span);
         chunk_.emit(is_main ? OpCode::Return : OpCode::Ret, fn.span);
 
-        // Reserve this function's locals slot range.
-        next_local_base_ = static_cast<std::uint16_t>(local_base_ + locals_.size());
+        chunk_.functions.back().locals = frame_size_;
     }
 
     void emit_stmt(const Stmt& stmt)
@@ -292,8 +374,9 @@ class Emitter
             return;
         }
 
-        const auto slot = static_cast<std::uint16_t>(local_base_ + locals_.size());
+        const auto slot = static_cast<std::uint16_t>(locals_.size());
         locals_.emplace(stmt.name, slot);
+        frame_size_ = std::max(frame_size_, static_cast<std::size_t>(slot) + 1);
         chunk_.emit_local(OpCode::StoreLocal, slot, span);
     }
 
@@ -357,7 +440,7 @@ class Emitter
         }
 
         chunk_.emit(OpCode::JumpIfFalse, stmt.cond.span);
-        const auto else_patch = emit_u16_placeholder(stmt.cond.span);
+        const auto else_patch = emit_u16_placeholder();
 
         for (const auto& s : stmt.then_block->stmts)
         {
@@ -371,7 +454,7 @@ class Emitter
         if (stmt.else_block != nullptr)
         {
             chunk_.emit(OpCode::Jump, stmt.cond.span);
-            const auto end_patch = emit_u16_placeholder(stmt.cond.span);
+            const auto end_patch = emit_u16_placeholder();
 
             patch_u16(else_patch, static_cast<std::uint16_t>(ip()));
             for (const auto& s : stmt.else_block->stmts)
@@ -401,7 +484,7 @@ class Emitter
         }
 
         chunk_.emit(OpCode::JumpIfFalse, stmt.cond.span);
-        const auto exit_patch = emit_u16_placeholder(stmt.cond.span);
+        const auto exit_patch = emit_u16_placeholder();
 
         for (const auto& s : stmt.body->stmts)
         {
@@ -413,13 +496,27 @@ class Emitter
         }
 
         chunk_.emit(OpCode::Jump, stmt.cond.span);
-        chunk_.emit_u16(static_cast<std::uint16_t>(loop_start), stmt.cond.span);
+        chunk_.emit_u16(static_cast<std::uint16_t>(loop_start));
         patch_u16(exit_patch, static_cast<std::uint16_t>(ip()));
     }
 
     void emit_expr(const Expr& expr)
     {
-        std::visit([&](const auto& node) { emit_expr_node(node, expr.span); }, expr.node);
+        std::visit(
+            [&](const auto& node)
+            {
+                using Node = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<Node, BinaryExpr> ||
+                              std::is_same_v<Node, curlee::parser::UnaryExpr>)
+                {
+                    emit_expr_node(node, expr.span, proven_arithmetic_.contains(expr.id));
+                }
+                else
+                {
+                    emit_expr_node(node, expr.span);
+                }
+            },
+            expr.node);
     }
 
     void emit_expr_node(const curlee::parser::IntExpr& expr, Span span)
@@ -525,7 +622,9 @@ class Emitter
         diags_.push_back(error_at(span, "struct literals not supported in emitter yet"));
     }
 
-    void emit_expr_node(const curlee::parser::UnaryExpr& expr, Span span)
+    // `proven`: the verifier showed this arithmetic cannot overflow (or divide by zero), so it
+    // is lowered to an unchecked opcode.
+    void emit_expr_node(const curlee::parser::UnaryExpr& expr, Span span, bool proven)
     {
         using curlee::lexer::TokenKind;
 
@@ -541,7 +640,7 @@ class Emitter
             chunk_.emit(OpCode::Not, span);
             return;
         case TokenKind::Minus:
-            chunk_.emit(OpCode::Neg, span);
+            chunk_.emit(proven ? OpCode::NegUnchecked : OpCode::Neg, span);
             return;
         default:
             diags_.push_back(error_at(span, "unsupported unary operator in emitter"));
@@ -549,7 +648,7 @@ class Emitter
         }
     }
 
-    void emit_expr_node(const BinaryExpr& expr, Span span)
+    void emit_expr_node(const BinaryExpr& expr, Span span, bool proven)
     {
         using curlee::lexer::TokenKind;
 
@@ -563,7 +662,7 @@ class Emitter
             }
 
             chunk_.emit(OpCode::JumpIfFalse, span);
-            const auto false_patch = emit_u16_placeholder(span);
+            const auto false_patch = emit_u16_placeholder();
 
             emit_expr(*expr.rhs);
             if (!diags_.empty())
@@ -572,7 +671,7 @@ class Emitter
             }
 
             chunk_.emit(OpCode::Jump, span);
-            const auto end_patch = emit_u16_placeholder(span);
+            const auto end_patch = emit_u16_placeholder();
 
             patch_u16(false_patch, static_cast<std::uint16_t>(ip()));
             chunk_.emit_constant(Value::bool_v(false), span);
@@ -591,7 +690,7 @@ class Emitter
 
             chunk_.emit(OpCode::Not, span);
             chunk_.emit(OpCode::JumpIfFalse, span);
-            const auto true_patch = emit_u16_placeholder(span);
+            const auto true_patch = emit_u16_placeholder();
 
             emit_expr(*expr.rhs);
             if (!diags_.empty())
@@ -600,7 +699,7 @@ class Emitter
             }
 
             chunk_.emit(OpCode::Jump, span);
-            const auto end_patch = emit_u16_placeholder(span);
+            const auto end_patch = emit_u16_placeholder();
 
             patch_u16(true_patch, static_cast<std::uint16_t>(ip()));
             chunk_.emit_constant(Value::bool_v(true), span);
@@ -618,16 +717,16 @@ class Emitter
         switch (expr.op)
         {
         case TokenKind::Plus:
-            chunk_.emit(OpCode::Add, span);
+            chunk_.emit(proven ? OpCode::AddUnchecked : OpCode::Add, span);
             return;
         case TokenKind::Minus:
-            chunk_.emit(OpCode::Sub, span);
+            chunk_.emit(proven ? OpCode::SubUnchecked : OpCode::Sub, span);
             return;
         case TokenKind::Star:
-            chunk_.emit(OpCode::Mul, span);
+            chunk_.emit(proven ? OpCode::MulUnchecked : OpCode::Mul, span);
             return;
         case TokenKind::Slash:
-            chunk_.emit(OpCode::Div, span);
+            chunk_.emit(proven ? OpCode::DivUnchecked : OpCode::Div, span);
             return;
         case TokenKind::EqualEqual:
             chunk_.emit(OpCode::Equal, span);
@@ -656,7 +755,7 @@ class Emitter
     void emit_call(std::string_view callee, Span span)
     {
         chunk_.emit(OpCode::Call, span);
-        const auto pos = emit_u16_placeholder(span);
+        const auto pos = emit_u16_placeholder();
         pending_calls_[callee].push_back(pos);
     }
 
@@ -786,7 +885,13 @@ class Emitter
 
 EmitResult emit_bytecode(const curlee::parser::Program& program)
 {
-    Emitter emitter;
+    return emit_bytecode(program, {});
+}
+
+EmitResult emit_bytecode(const curlee::parser::Program& program,
+                         const std::unordered_set<std::size_t>& proven_arithmetic)
+{
+    Emitter emitter(proven_arithmetic);
     return emitter.run(program);
 }
 
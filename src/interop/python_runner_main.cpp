@@ -2,6 +2,7 @@
 #include <cctype>
 #include <cmath>
 #include <cstdlib>
+#include <curlee/diag/json.h>
 #include <iostream>
 #include <map>
 #include <optional>
@@ -314,36 +315,7 @@ std::optional<Json> parse_json(std::string_view input)
     return result;
 }
 
-std::string json_escape(std::string_view input)
-{
-    std::string out;
-    out.reserve(input.size() + 8);
-    for (char c : input)
-    {
-        switch (c)
-        {
-        case '"':
-            out += "\\\"";
-            break;
-        case '\\':
-            out += "\\\\";
-            break;
-        case '\n':
-            out += "\\n";
-            break;
-        case '\r':
-            out += "\\r";
-            break;
-        case '\t':
-            out += "\\t";
-            break;
-        default:
-            out.push_back(c);
-            break;
-        }
-    }
-    return out;
-} // GCOVR_EXCL_LINE
+using curlee::diag::json_escape;
 
 std::string json_serialize(const Json& value)
 {
@@ -460,24 +432,14 @@ Json make_success_response(std::string id, std::string value)
     return Json{top};
 }
 
-} // namespace
-
-int main()
+/** @brief Answer one request line; `status` is the exit code a one-shot runner reports. */
+Json handle_request(std::string_view line, int& status)
 {
-    std::string line;
-    if (!std::getline(std::cin, line))
-    {
-        const auto resp = make_error_response("", "invalid_request", "empty input");
-        std::cout << json_serialize(resp) << "\n";
-        return 2;
-    }
-
+    status = 2;
     const auto parsed = parse_json(line);
     if (!parsed.has_value() || !parsed->is_object())
     {
-        const auto resp = make_error_response("", "invalid_request", "malformed json");
-        std::cout << json_serialize(resp) << "\n";
-        return 2;
+        return make_error_response("", "invalid_request", "malformed json");
     }
 
     const auto& obj = *parsed->as_object();
@@ -492,25 +454,20 @@ int main()
     const auto v = json_get_number(obj, "protocol_version");
     if (!v.has_value() || !is_integral(*v) || static_cast<int>(*v) != 1)
     {
-        const auto resp =
-            make_error_response(id, "protocol_version_unsupported", "unsupported protocol version");
-        std::cout << json_serialize(resp) << "\n";
-        return 2;
+        return make_error_response(id, "protocol_version_unsupported",
+                                   "unsupported protocol version");
     }
 
     const auto op = json_get_string(obj, "op");
     if (!op.has_value())
     {
-        const auto resp = make_error_response(id, "invalid_request", "missing op");
-        std::cout << json_serialize(resp) << "\n";
-        return 2;
+        return make_error_response(id, "invalid_request", "missing op");
     }
 
     if (*op == "handshake")
     {
-        const auto resp = make_success_response(id, "ok");
-        std::cout << json_serialize(resp) << "\n";
-        return 0;
+        status = 0;
+        return make_success_response(id, "ok");
     }
 
     if (*op == "echo")
@@ -519,24 +476,50 @@ int main()
         const bool echo_obj_ok = echo_obj.has_value() && echo_obj->is_object(); // GCOVR_EXCL_LINE
         if (!echo_obj_ok)
         {
-            const auto resp = make_error_response(id, "invalid_request", "missing echo payload");
-            std::cout << json_serialize(resp) << "\n";
-            return 2;
+            return make_error_response(id, "invalid_request", "missing echo payload");
         }
         const auto payload = json_get_string(*echo_obj->as_object(), "value");
         if (!payload.has_value())
         {
-            const auto resp =
-                make_error_response(id, "invalid_request", "echo.value must be string");
-            std::cout << json_serialize(resp) << "\n";
-            return 2;
+            return make_error_response(id, "invalid_request", "echo.value must be string");
+        }
+        status = 0;
+        return make_success_response(id, *payload);
+    }
+
+    return make_error_response(id, "invalid_request", "unknown op");
+}
+
+} // namespace
+
+// Usage: curlee_python_runner [--serve]
+//
+// By default the runner answers the first request line and exits with its status. With
+// `--serve` it answers every line until stdin closes, flushing each response, so the VM can keep
+// one warm process (and sandbox) per configuration across calls.
+int main(int argc, char** argv)
+{
+    const bool serve = argc > 1 && std::string_view(argv[1]) == "--serve";
+
+    std::string line;
+    if (serve)
+    {
+        while (std::getline(std::cin, line))
+        {
+            int status = 0;
+            std::cout << json_serialize(handle_request(line, status)) << "\n" << std::flush;
         }
-        const auto resp = make_success_response(id, *payload);
-        std::cout << json_serialize(resp) << "\n";
         return 0;
     }
 
-    const auto resp = make_error_response(id, "invalid_request", "unknown op");
-    std::cout << json_serialize(resp) << "\n";
-    return 2;
+    if (!std::getline(std::cin, line))
+    {
+        const auto resp = make_error_response("", "invalid_request", "empty input");
+        std::cout << json_serialize(resp) << "\n";
+        return 2;
+    }
+
+    int status = 0;
+    std::cout << json_serialize(handle_request(line, status)) << "\n";
+    return status;
 }
@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <cassert>
 #include <cctype>
 #include <cstddef>
 #include <curlee/lexer/lexer.h>
+#include <functional>
 #include <optional>
 
 namespace curlee::lexer
@@ -11,13 +14,19 @@ namespace
 class Lexer
 {
   public:
-    explicit Lexer(std::string_view input) : input_(input) {}
+    explicit Lexer(std::string_view input, std::size_t start = 0) : input_(input), pos_(start) {}
 
-    [[nodiscard]] LexResult lex_all()
+    // Lex until EOF, or until `stop` accepts the token just lexed (which is kept).
+    [[nodiscard]] LexResult lex_all(const std::function<bool(const Token&)>& stop = {})
     {
         std::vector<Token> tokens;
         while (true)
         {
+            if (stop && !tokens.empty() && stop(tokens.back()))
+            {
+                return tokens;
+            }
+
             if (auto err = skip_trivia())
             {
                 return *err;
@@ -402,4 +411,62 @@ LexResult lex(std::string_view input)
     return Lexer(input).lex_all();
 }
 
+RelexResult relex(std::span<const Token> old_tokens, std::string_view input,
+                  const curlee::source::TextEdit& edit)
+{
+    assert(!old_tokens.empty() && old_tokens.back().kind == TokenKind::Eof); // GCOVR_EXCL_LINE
+
+    // A token ending right at the edit could grow into it, but one ending before it was cut
+    // short by a byte the edit kept, so lexing resumes where the last such token stopped.
+    const auto kept = std::partition_point(old_tokens.begin(), old_tokens.end(),
+                                           [&](const Token& t) { return t.span.end < edit.start; });
+    const auto first = static_cast<std::size_t>(kept - old_tokens.begin());
+    const std::size_t restart = first == 0 ? 0 : old_tokens[first - 1].span.end;
+
+    // Past the edit the text is the old text shifted, so once a new token starts where an old one
+    // did, the lexer would go on exactly as it did before.
+    const auto to_old = [&](std::size_t offset) { return offset + edit.old_end - edit.new_end; };
+    const auto old_token_at = [&](std::size_t new_offset)
+    {
+        const auto it = std::partition_point(
+            kept, old_tokens.end(),
+            [&](const Token& t) { return t.span.start < to_old(new_offset); });
+        return it != old_tokens.end() && it->span.start == to_old(new_offset) ? it
+                                                                               : old_tokens.end();
+    };
+    const auto resynced = [&](const Token& t)
+    { return t.span.start >= edit.new_end && old_token_at(t.span.start) != old_tokens.end(); };
+
+    auto lexed = Lexer(input, restart).lex_all(resynced);
+    if (auto* err = std::get_if<curlee::diag::Diagnostic>(&lexed))
+    {
+        return std::move(*err);
+    }
+    auto& fresh = std::get<std::vector<Token>>(lexed);
+
+    // Both lexers end on EOF, so the last token always lines up with an old one.
+    const auto resume = old_token_at(fresh.back().span.start);
+    assert(resume != old_tokens.end()); // GCOVR_EXCL_LINE
+
+    Relexed out;
+    out.tokens.reserve(first + fresh.size() + static_cast<std::size_t>(old_tokens.end() - resume));
+    out.tokens.assign(old_tokens.begin(), kept);
+    for (auto& token : out.tokens)
+    {
+        token.lexeme = input.substr(token.span.start, token.lexeme.size());
+    }
+    out.tokens.insert(out.tokens.end(), fresh.begin(), fresh.end() - 1);
+    out.edit = TokenEdit{.first = first,
+                         .old_end = static_cast<std::size_t>(resume - old_tokens.begin()),
+                         .new_end = out.tokens.size()};
+    for (auto it = resume; it != old_tokens.end(); ++it)
+    {
+        const std::size_t start = it->span.start - edit.old_end + edit.new_end;
+        out.tokens.push_back(Token{.kind = it->kind,
+                                   .lexeme = input.substr(start, it->lexeme.size()),
+                                   .span = {start, start + it->span.length()}});
+    }
+    return out;
+}
+
 } // namespace curlee::lexer
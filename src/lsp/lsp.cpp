@@ -1,22 +1,33 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <curlee/diag/diagnostic.h>
+#include <curlee/diag/json.h>
 #include <curlee/lexer/lexer.h>
 #include <curlee/parser/ast.h>
 #include <curlee/parser/parser.h>
 #include <curlee/resolver/resolver.h>
 #include <curlee/source/line_map.h>
+#include <curlee/source/rope.h>
 #include <curlee/source/source_file.h>
 #include <curlee/types/type.h>
 #include <curlee/types/type_check.h>
+#include <curlee/verification/checker.h>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
@@ -304,36 +315,7 @@ struct JsonParser
     }
 };
 
-std::string json_escape(std::string_view input)
-{
-    std::string out;
-    out.reserve(input.size() + 8);
-    for (char c : input)
-    {
-        switch (c)
-        {
-        case '"':
-            out += "\\\"";
-            break;
-        case '\\':
-            out += "\\\\";
-            break;
-        case '\n':
-            out += "\\n";
-            break;
-        case '\r':
-            out += "\\r";
-            break;
-        case '\t':
-            out += "\\t";
-            break;
-        default:
-            out.push_back(c);
-            break;
-        }
-    }
-    return out;
-} // GCOVR_EXCL_LINE
+using curlee::diag::json_escape;
 
 std::string json_serialize(const Json& value)
 {
@@ -651,16 +633,13 @@ bool read_lsp_message(std::istream& in, std::string& payload)
 
 void write_lsp_message(const std::string& payload)
 {
+    // The verification worker publishes from its own thread.
+    static std::mutex mutex;
+    const std::lock_guard lock(mutex);
     std::cout << "Content-Length: " << payload.size() << "\r\n\r\n" << payload;
     std::cout.flush();
 }
 
-struct Document
-{
-    std::string uri;
-    std::string text;
-};
-
 std::string uri_to_path(std::string_view uri)
 {
     constexpr std::string_view kPrefix = "file://";
@@ -694,16 +673,16 @@ struct LspPosition
     std::size_t character = 0;
 };
 
-std::optional<std::size_t> offset_from_position(const curlee::source::LineMap& line_map,
+// LSP counts `character` in UTF-16 code units, not bytes.
+std::optional<std::size_t> offset_from_position(const curlee::source::Rope& text,
                                                 const LspPosition& pos)
 {
     const auto line_index = pos.line + 1;
-    if (line_index == 0 || line_index > line_map.line_count())
+    if (line_index == 0 || line_index > text.line_count())
     {
         return std::nullopt;
     }
-    const auto line_start = line_map.line_start_offset(line_index);
-    return line_start + pos.character;
+    return text.utf16_offset(line_index, pos.character);
 }
 
 struct LspRange
@@ -728,7 +707,8 @@ Json lsp_range_json(const LspRange& range)
     return Json{out};
 }
 
-LspRange to_lsp_range(const curlee::source::Span& span, const curlee::source::LineMap& map)
+template <typename Lines>
+LspRange to_lsp_range(const curlee::source::Span& span, const Lines& map)
 {
     const auto start_lc = map.offset_to_line_col(span.start);
     const auto end_lc = map.offset_to_line_col(span.end);
@@ -789,208 +769,152 @@ int lsp_severity(curlee::diag::Severity sev)
     return 3;
 }
 
-std::vector<curlee::diag::Diagnostic> collect_diagnostics(const curlee::source::SourceFile& file)
-{
-    const auto lexed = curlee::lexer::lex(file.contents);
-    if (std::holds_alternative<curlee::diag::Diagnostic>(lexed))
-    {
-        std::vector<curlee::diag::Diagnostic> out;
-        out.push_back(std::get<curlee::diag::Diagnostic>(lexed));
-        return out;
-    }
-
-    const auto& toks = std::get<std::vector<curlee::lexer::Token>>(lexed);
-    const auto parsed = curlee::parser::parse(toks);
-    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(parsed))
-    {
-        return std::get<std::vector<curlee::diag::Diagnostic>>(parsed);
-    }
-
-    const auto& program = std::get<curlee::parser::Program>(parsed);
-    const auto resolved = curlee::resolver::resolve(program, file);
-    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(resolved))
-    {
-        return std::get<std::vector<curlee::diag::Diagnostic>>(resolved);
-    }
-
-    const auto typed = curlee::types::type_check(program);
-    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
-    {
-        return std::get<std::vector<curlee::diag::Diagnostic>>(typed);
-    }
-
-    return {};
-}
-
-struct Analysis
-{
-    curlee::parser::Program program;
-    curlee::resolver::Resolution resolution;
-    curlee::types::TypeInfo type_info;
-};
-
-std::optional<Analysis> analyze(const curlee::source::SourceFile& file)
+/**
+ * @brief Nodes keyed by source span, answering "innermost node containing an offset".
+ *
+ * Spans from one AST nest or are disjoint. Sorted by start (outermost first), the innermost
+ * span containing an offset is the last one starting at or before it, or the nearest enclosing
+ * span of that one which still contains the offset: a binary search, then a walk no longer than
+ * the nesting depth. Of equal spans, the node added first wins.
+ */
+template <typename Node> class SpanIndex
 {
-    const auto lexed = curlee::lexer::lex(file.contents);
-    if (std::holds_alternative<curlee::diag::Diagnostic>(lexed))
+  public:
+    /** Add nodes in the order that should break ties, e.g. AST pre-order. */
+    void add(const curlee::source::Span& span, const Node* node)
     {
-        return std::nullopt;
-    }
-
-    const auto& toks = std::get<std::vector<curlee::lexer::Token>>(lexed);
-    auto parsed = curlee::parser::parse(toks);
-    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(parsed))
-    {
-        return std::nullopt;
-    }
-
-    auto program = std::move(std::get<curlee::parser::Program>(parsed));
-    const auto resolved = curlee::resolver::resolve(program, file);
-    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(resolved))
-    {
-        return std::nullopt;
-    }
-
-    const auto& resolution = std::get<curlee::resolver::Resolution>(resolved);
-    const auto typed = curlee::types::type_check(program);
-    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
-    {
-        return std::nullopt;
-    }
-
-    const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
-
-    Analysis out;
-    out.program = std::move(program);
-    out.resolution = resolution;
-    out.type_info = type_info;
-    return out;
-}
-
-bool span_contains(const curlee::source::Span& span, std::size_t offset)
-{
-    return offset >= span.start && offset < span.end;
-}
-
-const curlee::parser::Expr* find_expr_at(const curlee::parser::Expr& expr, std::size_t offset,
-                                         const curlee::parser::Expr* best)
-{
-    if (span_contains(expr.span, offset))
-    {
-        if (!best || expr.span.length() < best->span.length())
+        if (span.end > span.start)
         {
-            best = &expr;
+            entries_.push_back(Entry{.span = span, .node = node, .order = entries_.size()});
         }
     }
 
-    if (const auto* unary = std::get_if<curlee::parser::UnaryExpr>(&expr.node))
-    {
-        if (unary->rhs)
-        {
-            best = find_expr_at(*unary->rhs, offset, best);
-        }
-    }
-    else if (const auto* binary = std::get_if<curlee::parser::BinaryExpr>(&expr.node))
+    /** Sort the added nodes; call once after the last add(). */
+    void build()
     {
-        if (binary->lhs)
-        {
-            best = find_expr_at(*binary->lhs, offset, best);
-        }
-        if (binary->rhs)
-        {
-            best = find_expr_at(*binary->rhs, offset, best);
-        }
-    }
-    else if (const auto* call = std::get_if<curlee::parser::CallExpr>(&expr.node))
-    {
-        if (call->callee)
-        {
-            best = find_expr_at(*call->callee, offset, best);
-        }
-        for (const auto& arg : call->args)
+        std::sort(entries_.begin(), entries_.end(),
+                  [](const Entry& a, const Entry& b)
+                  {
+                      if (a.span.start != b.span.start)
+                      {
+                          return a.span.start < b.span.start;
+                      }
+                      if (a.span.end != b.span.end)
+                      {
+                          return a.span.end > b.span.end;
+                      }
+                      // Of equal spans the earliest added ends up innermost.
+                      return a.order > b.order;
+                  });
+        std::vector<std::size_t> open;
+        for (std::size_t i = 0; i < entries_.size(); ++i)
         {
-            best = find_expr_at(arg, offset, best);
+            while (!open.empty() && entries_[open.back()].span.end < entries_[i].span.end)
+            {
+                open.pop_back();
+            }
+            entries_[i].parent = open.empty() ? kNone : open.back();
+            open.push_back(i);
         }
     }
-    else if (const auto* member = std::get_if<curlee::parser::MemberExpr>(&expr.node))
+
+    [[nodiscard]] const Node* innermost(std::size_t offset) const
     {
-        if (member->base)
+        const auto after =
+            std::upper_bound(entries_.begin(), entries_.end(), offset,
+                             [](std::size_t off, const Entry& e) { return off < e.span.start; });
+        if (after == entries_.begin())
         {
-            best = find_expr_at(*member->base, offset, best);
+            return nullptr;
         }
-    }
-    else if (const auto* group = std::get_if<curlee::parser::GroupExpr>(&expr.node))
-    {
-        if (group->inner)
+        for (auto i = static_cast<std::size_t>(after - entries_.begin()) - 1; i != kNone;
+             i = entries_[i].parent)
         {
-            best = find_expr_at(*group->inner, offset, best);
+            if (offset < entries_[i].span.end)
+            {
+                return entries_[i].node;
+            }
         }
+        return nullptr;
     }
 
-    return best;
-}
+  private:
+    static constexpr std::size_t kNone = static_cast<std::size_t>(-1);
 
-const curlee::parser::Expr* find_call_expr_at(const curlee::parser::Expr& expr, std::size_t offset,
-                                              const curlee::parser::Expr* best)
-{
-    if (span_contains(expr.span, offset) &&
-        std::holds_alternative<curlee::parser::CallExpr>(expr.node))
+    struct Entry
     {
-        if (!best || expr.span.length() < best->span.length())
-        {
-            best = &expr;
-        }
-    }
+        curlee::source::Span span;
+        const Node* node = nullptr;
+        std::size_t order = 0;
+        /** The nearest entry whose span contains this one's. */
+        std::size_t parent = kNone;
+    };
+
+    std::vector<Entry> entries_;
+};
+
+/** @brief Where hover and definition look up the node under the cursor. */
+struct PositionIndex
+{
+    /** Expressions in function bodies. */
+    SpanIndex<curlee::parser::Expr> exprs;
+    /** The call expressions among them. */
+    SpanIndex<curlee::parser::Expr> calls;
+    SpanIndex<curlee::resolver::NameUse> uses;
+};
 
+void index_expr(const curlee::parser::Expr& expr, PositionIndex& index)
+{
+    index.exprs.add(expr.span, &expr);
     if (const auto* unary = std::get_if<curlee::parser::UnaryExpr>(&expr.node))
     {
         if (unary->rhs)
         {
-            best = find_call_expr_at(*unary->rhs, offset, best);
+            index_expr(*unary->rhs, index);
         }
     }
     else if (const auto* binary = std::get_if<curlee::parser::BinaryExpr>(&expr.node))
     {
         if (binary->lhs)
         {
-            best = find_call_expr_at(*binary->lhs, offset, best);
+            index_expr(*binary->lhs, index);
         }
         if (binary->rhs)
         {
-            best = find_call_expr_at(*binary->rhs, offset, best);
+            index_expr(*binary->rhs, index);
         }
     }
     else if (const auto* call = std::get_if<curlee::parser::CallExpr>(&expr.node))
     {
+        index.calls.add(expr.span, &expr);
         if (call->callee)
         {
-            best = find_call_expr_at(*call->callee, offset, best);
+            index_expr(*call->callee, index);
         }
         for (const auto& arg : call->args)
         {
-            best = find_call_expr_at(arg, offset, best);
+            index_expr(arg, index);
         }
     }
     else if (const auto* member = std::get_if<curlee::parser::MemberExpr>(&expr.node))
     {
         if (member->base)
         {
-            best = find_call_expr_at(*member->base, offset, best);
+            index_expr(*member->base, index);
         }
     }
     else if (const auto* group = std::get_if<curlee::parser::GroupExpr>(&expr.node))
     {
         if (group->inner)
         {
-            best = find_call_expr_at(*group->inner, offset, best);
+            index_expr(*group->inner, index);
         }
     }
-
-    return best;
 }
 
-void find_call_exprs_in_stmt(const curlee::parser::Stmt& stmt, std::size_t offset,
-                             const curlee::parser::Expr*& best)
+void index_block(const curlee::parser::Block* block, PositionIndex& index);
+
+void index_stmt(const curlee::parser::Stmt& stmt, PositionIndex& index)
 {
     std::visit(
         [&](const auto& node)
@@ -998,67 +922,37 @@ void find_call_exprs_in_stmt(const curlee::parser::Stmt& stmt, std::size_t offse
             using T = std::decay_t<decltype(node)>;
             if constexpr (std::is_same_v<T, curlee::parser::LetStmt>)
             {
-                best = find_call_expr_at(node.value, offset, best);
+                index_expr(node.value, index);
             }
             else if constexpr (std::is_same_v<T, curlee::parser::ReturnStmt>)
             {
                 if (node.value)
                 {
-                    best = find_call_expr_at(*node.value, offset, best);
+                    index_expr(*node.value, index);
                 }
             }
             else if constexpr (std::is_same_v<T, curlee::parser::ExprStmt>)
             {
-                best = find_call_expr_at(node.expr, offset, best);
+                index_expr(node.expr, index);
             }
             else if constexpr (std::is_same_v<T, curlee::parser::IfStmt>)
             {
-                best = find_call_expr_at(node.cond, offset, best);
-                if (node.then_block)
-                {
-                    for (const auto& inner : node.then_block->stmts)
-                    {
-                        find_call_exprs_in_stmt(inner, offset, best);
-                    }
-                }
-                if (node.else_block)
-                {
-                    for (const auto& inner : node.else_block->stmts)
-                    {
-                        find_call_exprs_in_stmt(inner, offset, best);
-                    }
-                }
+                index_expr(node.cond, index);
+                index_block(node.then_block.get(), index);
+                index_block(node.else_block.get(), index);
             }
             else if constexpr (std::is_same_v<T, curlee::parser::WhileStmt>)
             {
-                best = find_call_expr_at(node.cond, offset, best);
-                if (node.body)
-                {
-                    for (const auto& inner : node.body->stmts)
-                    {
-                        find_call_exprs_in_stmt(inner, offset, best);
-                    }
-                }
+                index_expr(node.cond, index);
+                index_block(node.body.get(), index);
             }
             else if constexpr (std::is_same_v<T, curlee::parser::BlockStmt>)
             {
-                if (node.block)
-                {
-                    for (const auto& inner : node.block->stmts)
-                    {
-                        find_call_exprs_in_stmt(inner, offset, best);
-                    }
-                }
+                index_block(node.block.get(), index);
             }
             else if constexpr (std::is_same_v<T, curlee::parser::UnsafeStmt>)
             {
-                if (node.body)
-                {
-                    for (const auto& inner : node.body->stmts)
-                    {
-                        find_call_exprs_in_stmt(inner, offset, best);
-                    }
-                }
+                index_block(node.body.get(), index);
             }
             else
             {
@@ -1068,87 +962,163 @@ void find_call_exprs_in_stmt(const curlee::parser::Stmt& stmt, std::size_t offse
         stmt.node);
 }
 
-void find_exprs_in_stmt(const curlee::parser::Stmt& stmt, std::size_t offset,
-                        const curlee::parser::Expr*& best)
+void index_block(const curlee::parser::Block* block, PositionIndex& index)
 {
-    std::visit(
-        [&](const auto& node)
+    if (block == nullptr)
+    {
+        return;
+    }
+    for (const auto& stmt : block->stmts)
+    {
+        index_stmt(stmt, index);
+    }
+}
+
+/**
+ * @brief The front end's results for one document version.
+ *
+ * The AST and resolution point into `file.contents`, so an Analysis stays where it was built,
+ * behind a shared_ptr that hover, definition and the verification worker share.
+ */
+struct Analysis
+{
+    curlee::source::SourceFile file;
+    curlee::parser::Program program;
+    curlee::resolver::Resolution resolution;
+    curlee::types::TypeInfo type_info;
+    PositionIndex positions;
+};
+
+using FrontEndResult =
+    std::variant<std::shared_ptr<const Analysis>, std::vector<curlee::diag::Diagnostic>>;
+
+/** @brief Lex, parse, resolve and type check `file`, stopping at the first stage that fails. */
+FrontEndResult run_front_end(curlee::source::SourceFile file)
+{
+    auto out = std::make_shared<Analysis>();
+    out->file = std::move(file);
+
+    const auto lexed = curlee::lexer::lex(out->file.contents);
+    if (std::holds_alternative<curlee::diag::Diagnostic>(lexed))
+    {
+        return std::vector<curlee::diag::Diagnostic>{std::get<curlee::diag::Diagnostic>(lexed)};
+    }
+
+    const auto& toks = std::get<std::vector<curlee::lexer::Token>>(lexed);
+    auto parsed = curlee::parser::parse(toks);
+    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(parsed))
+    {
+        return std::get<std::vector<curlee::diag::Diagnostic>>(std::move(parsed));
+    }
+
+    out->program = std::move(std::get<curlee::parser::Program>(parsed));
+    auto resolved = curlee::resolver::resolve(out->program, out->file);
+    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(resolved))
+    {
+        return std::get<std::vector<curlee::diag::Diagnostic>>(std::move(resolved));
+    }
+    out->resolution = std::get<curlee::resolver::Resolution>(std::move(resolved));
+
+    auto typed = curlee::types::type_check(out->program);
+    if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+    {
+        return std::get<std::vector<curlee::diag::Diagnostic>>(std::move(typed));
+    }
+    out->type_info = std::get<curlee::types::TypeInfo>(std::move(typed));
+
+    for (const auto& func : out->program.functions)
+    {
+        for (const auto& stmt : func.body.stmts)
         {
-            using T = std::decay_t<decltype(node)>;
-            if constexpr (std::is_same_v<T, curlee::parser::LetStmt>)
-            {
-                best = find_expr_at(node.value, offset, best);
-            }
-            else if constexpr (std::is_same_v<T, curlee::parser::ReturnStmt>)
-            {
-                if (node.value)
-                {
-                    best = find_expr_at(*node.value, offset, best);
-                }
-            }
-            else if constexpr (std::is_same_v<T, curlee::parser::ExprStmt>)
-            {
-                best = find_expr_at(node.expr, offset, best);
-            }
-            else if constexpr (std::is_same_v<T, curlee::parser::IfStmt>)
-            {
-                best = find_expr_at(node.cond, offset, best);
-                if (node.then_block)
-                {
-                    for (const auto& inner : node.then_block->stmts)
-                    {
-                        find_exprs_in_stmt(inner, offset, best);
-                    }
-                }
-                if (node.else_block)
-                {
-                    for (const auto& inner : node.else_block->stmts)
-                    {
-                        find_exprs_in_stmt(inner, offset, best);
-                    }
-                }
-            }
-            else if constexpr (std::is_same_v<T, curlee::parser::WhileStmt>)
-            {
-                best = find_expr_at(node.cond, offset, best);
-                if (node.body)
-                {
-                    for (const auto& inner : node.body->stmts)
-                    {
-                        find_exprs_in_stmt(inner, offset, best);
-                    }
-                }
-            }
-            else if constexpr (std::is_same_v<T, curlee::parser::BlockStmt>)
-            {
-                if (node.block)
-                {
-                    for (const auto& inner : node.block->stmts)
-                    {
-                        find_exprs_in_stmt(inner, offset, best);
-                    }
-                }
-            }
-            else if constexpr (std::is_same_v<T, curlee::parser::UnsafeStmt>)
-            {
-                if (node.body)
-                {
-                    for (const auto& inner : node.body->stmts)
-                    {
-                        find_exprs_in_stmt(inner, offset, best);
-                    }
-                }
-            }
-            else
-            {
-                static_assert(!sizeof(T), "unhandled Stmt node");
-            }
-        },
-        stmt.node);
+            index_stmt(stmt, out->positions);
+        }
+    }
+    for (const auto& use : out->resolution.uses)
+    {
+        out->positions.uses.add(use.span, &use);
+    }
+    out->positions.exprs.build();
+    out->positions.calls.build();
+    out->positions.uses.build();
+
+    return std::shared_ptr<const Analysis>(std::move(out));
 }
 
+struct Document
+{
+    std::string uri;
+    /** Edited in place by incremental changes; also answers line queries for `text`. */
+    curlee::source::Rope text;
+    /** The client's version of `text`, when it sent one. */
+    std::optional<std::int64_t> version;
+    /** The analysis of `text`, built once per version; null while `text` has errors. */
+    std::shared_ptr<const Analysis> analysis;
+};
+
+// Unlike offset_from_position, a line past the end of the text clamps to that end, as the
+// protocol asks of edit ranges. Columns count UTF-16 code units, so the server's copy stays in
+// step with the client's after non-ASCII text.
+std::size_t clamped_offset(const curlee::source::Rope& text, const LspPosition& pos)
+{
+    return text.utf16_offset(pos.line + 1, pos.character);
+}
+
+std::optional<LspPosition> json_get_position(const Json::Object& obj, const std::string& key)
+{
+    const auto pos = json_get_object(obj, key);
+    if (!pos.has_value())
+    {
+        return std::nullopt;
+    }
+    const auto line = json_get_number(*pos->as_object(), "line");
+    const auto character = json_get_number(*pos->as_object(), "character");
+    if (!line.has_value() || !character.has_value() || *line < 0 || *character < 0)
+    {
+        return std::nullopt;
+    }
+    return LspPosition{static_cast<std::size_t>(*line), static_cast<std::size_t>(*character)};
+}
+
+/**
+ * Apply one entry of didChange's contentChanges: a ranged edit of `text`, or, without a range,
+ * a replacement of all of it. Returns false, leaving `text` alone, for a malformed change.
+ */
+bool apply_content_change(curlee::source::Rope& text, const Json& change)
+{
+    if (!change.is_object())
+    {
+        return false;
+    }
+    const auto& obj = *change.as_object();
+    const auto new_text = json_get_string(obj, "text");
+    if (!new_text.has_value())
+    {
+        return false;
+    }
+    if (obj.find("range") == obj.end())
+    {
+        text = curlee::source::Rope(*new_text);
+        return true;
+    }
+
+    const auto range = json_get_object(obj, "range");
+    if (!range.has_value())
+    {
+        return false;
+    }
+    const auto start = json_get_position(*range->as_object(), "start");
+    const auto end = json_get_position(*range->as_object(), "end");
+    if (!start.has_value() || !end.has_value())
+    {
+        return false;
+    }
+    text.replace(clamped_offset(text, *start), clamped_offset(text, *end), *new_text);
+    return true;
+}
+
+template <typename Lines>
 std::string diagnostics_to_json(const std::vector<curlee::diag::Diagnostic>& diags,
-                                const curlee::source::LineMap& map)
+                                const Lines& map)
 {
     std::string out = "[";
     for (std::size_t i = 0; i < diags.size(); ++i)
@@ -1173,11 +1143,194 @@ std::string diagnostics_to_json(const std::vector<curlee::diag::Diagnostic>& dia
     return out;
 } // GCOVR_EXCL_LINE
 
+template <typename Lines>
+std::string publish_diagnostics_message(std::string_view uri, std::optional<std::int64_t> version,
+                                        const std::vector<curlee::diag::Diagnostic>& diags,
+                                        const Lines& map)
+{
+    std::ostringstream oss;
+    oss << "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",";
+    oss << "\"params\":{\"uri\":\"" << json_escape(uri) << "\",";
+    if (version.has_value())
+    {
+        oss << "\"version\":" << *version << ",";
+    }
+    oss << "\"diagnostics\":" << diagnostics_to_json(diags, map) << "}}";
+    return oss.str();
+}
+
+/** @brief A document version to verify. */
+struct VerificationJob
+{
+    std::string uri;
+    std::optional<std::int64_t> version;
+    std::shared_ptr<const Analysis> analysis;
+};
+
+/**
+ * @brief Verifies documents on a background thread, so proofs never stall the message loop.
+ *
+ * A job starts once its document has gone `debounce` without a newer version. Scheduling a
+ * newer version (or forgetting the document) drops a pending job and cancels a running one,
+ * interrupting Z3; a cancelled result is never published. Results are passed to `publish` on
+ * the worker thread, with the job they were computed from. Proofs of unchanged functions and
+ * solved obligations carry over from one version to the next.
+ */
+class VerificationWorker
+{
+  public:
+    using Publish = std::function<void(const VerificationJob& job,
+                                       const std::vector<curlee::diag::Diagnostic>& diags)>;
+
+    VerificationWorker(std::chrono::milliseconds debounce, Publish publish)
+        : debounce_(debounce), publish_(std::move(publish)), thread_([this] { run(); })
+    {
+    }
+
+    VerificationWorker(const VerificationWorker&) = delete;
+    VerificationWorker& operator=(const VerificationWorker&) = delete;
+
+    ~VerificationWorker()
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+            cancel_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void schedule(VerificationJob job)
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            forget_locked(job.uri);
+            std::string uri = job.uri;
+            pending_.insert_or_assign(
+                std::move(uri),
+                Pending{.job = std::move(job),
+                        .due = std::chrono::steady_clock::now() + debounce_});
+        }
+        cv_.notify_all();
+    }
+
+    /** @brief Drop any pending or running job for `uri`, e.g. when it no longer type checks. */
+    void forget(const std::string& uri)
+    {
+        const std::lock_guard lock(mutex_);
+        forget_locked(uri);
+    }
+
+  private:
+    struct Pending
+    {
+        VerificationJob job;
+        std::chrono::steady_clock::time_point due;
+    };
+
+    void forget_locked(const std::string& uri)
+    {
+        pending_.erase(uri);
+        if (running_ == uri)
+        {
+            cancel_ = true;
+        }
+    }
+
+    void run()
+    {
+        std::unique_lock lock(mutex_);
+        while (!stopping_)
+        {
+            if (pending_.empty())
+            {
+                cv_.wait(lock);
+                continue;
+            }
+            const auto next =
+                std::min_element(pending_.begin(), pending_.end(), [](const auto& a, const auto& b)
+                                 { return a.second.due < b.second.due; });
+            if (next->second.due > std::chrono::steady_clock::now())
+            {
+                cv_.wait_until(lock, next->second.due);
+                continue;
+            }
+
+            const VerificationJob job = std::move(next->second.job);
+            pending_.erase(next);
+            running_ = job.uri;
+            cancel_ = false;
+            lock.unlock();
+            const auto diags = verify_document(job);
+            lock.lock();
+            running_.reset();
+            // Publishing under the lock keeps a stale result from landing after schedule() or
+            // forget() returns.
+            if (!cancel_)
+            {
+                publish_(job, diags);
+            }
+        }
+    }
+
+    std::vector<curlee::diag::Diagnostic> verify_document(const VerificationJob& job)
+    {
+        curlee::verification::VerifyOptions options;
+        options.solver.cancel = &cancel_;
+        options.cache = &obligations_;
+        options.session = &session_;
+        const auto verified = curlee::verification::verify(job.analysis->program,
+                                                           job.analysis->type_info, options);
+        if (const auto* diags = std::get_if<std::vector<curlee::diag::Diagnostic>>(&verified))
+        {
+            return *diags;
+        }
+        return std::vector<curlee::diag::Diagnostic>{};
+    }
+
+    std::chrono::milliseconds debounce_;
+    Publish publish_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::unordered_map<std::string, Pending> pending_;
+    std::optional<std::string> running_;
+    std::atomic<bool> cancel_{false};
+    // Only the worker thread touches these. Bounded, since the server runs for a whole editing
+    // session and every edit adds new queries.
+    curlee::verification::ObligationCache obligations_{std::size_t{4096}};
+    curlee::verification::VerificationSession session_{std::size_t{1024}};
+    std::thread thread_;
+};
+
+/** @brief How long a document must go without edits before it is verified. */
+std::chrono::milliseconds verify_debounce()
+{
+    if (const char* raw = std::getenv("CURLEE_LSP_VERIFY_DEBOUNCE_MS"); raw != nullptr)
+    {
+        char* end = nullptr;
+        const unsigned long value = std::strtoul(raw, &end, 10);
+        if (end != raw && *end == '\0')
+        {
+            return std::chrono::milliseconds(value);
+        }
+    }
+    return std::chrono::milliseconds(300);
+}
+
 } // namespace
 
 int main()
 {
     std::unordered_map<std::string, Document> documents;
+    VerificationWorker verifier(
+        verify_debounce(),
+        [](const VerificationJob& job, const std::vector<curlee::diag::Diagnostic>& diags)
+        {
+            const curlee::source::LineMap map(job.analysis->file.contents);
+            write_lsp_message(publish_diagnostics_message(job.uri, job.version, diags, map));
+        });
 
     std::string payload;
     while (read_lsp_message(std::cin, payload))
@@ -1200,7 +1353,8 @@ int main()
         if (*method == "initialize")
         {
             Json::Object capabilities;
-            capabilities["textDocumentSync"] = Json{1.0};
+            // Incremental: didChange sends only the edited ranges.
+            capabilities["textDocumentSync"] = Json{2.0};
             capabilities["definitionProvider"] = Json{true};
             capabilities["hoverProvider"] = Json{true};
 
@@ -1257,51 +1411,72 @@ int main()
                 continue;
             }
 
-            std::string text;
+            std::optional<std::string> opened_text;
+            std::optional<Json> changes;
             if (*method == "textDocument/didOpen")
             {
-                const auto text_value = json_get_string(*text_doc->as_object(), "text");
-                if (!text_value.has_value())
+                opened_text = json_get_string(*text_doc->as_object(), "text");
+                if (!opened_text.has_value())
                 {
                     continue;
                 }
-                text = *text_value;
             }
             else
             {
-                const auto changes = json_get_array(*params->as_object(), "contentChanges");
+                changes = json_get_array(*params->as_object(), "contentChanges");
                 if (!changes.has_value() || changes->as_array()->empty())
                 {
                     continue;
                 }
-                const auto& first = changes->as_array()->front();
-                if (!first.is_object())
-                {
-                    continue;
-                }
-                const auto new_text = json_get_string(*first.as_object(), "text");
-                if (!new_text.has_value())
-                {
-                    continue;
-                }
-                text = *new_text;
             }
 
             auto& doc = documents[*uri];
             doc.uri = *uri;
-            doc.text = text;
-
-            curlee::source::SourceFile file;
-            file.path = uri_to_path(*uri);
-            file.contents = text;
-            curlee::source::LineMap map(text);
-            const auto diagnostics = collect_diagnostics(file);
-
-            std::ostringstream oss;
-            oss << "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",";
-            oss << "\"params\":{\"uri\":\"" << json_escape(*uri) << "\",";
-            oss << "\"diagnostics\":" << diagnostics_to_json(diagnostics, map) << "}}";
-            write_lsp_message(oss.str());
+            if (opened_text.has_value())
+            {
+                doc.text = curlee::source::Rope(*opened_text);
+            }
+            else
+            {
+                // In place and in order: each change is relative to the text the ones before it
+                // left. A malformed change is dropped rather than guessed at.
+                for (const auto& change : *changes->as_array())
+                {
+                    apply_content_change(doc.text, change);
+                }
+            }
+            doc.version.reset();
+            if (const auto version = json_get_number(*text_doc->as_object(), "version");
+                version.has_value())
+            {
+                doc.version = static_cast<std::int64_t>(*version);
+            }
+
+            auto front_end = run_front_end(
+                curlee::source::SourceFile{.path = uri_to_path(*uri), .contents = doc.text.str()});
+            std::vector<curlee::diag::Diagnostic> diagnostics;
+            doc.analysis = nullptr;
+            if (auto* analysis = std::get_if<std::shared_ptr<const Analysis>>(&front_end))
+            {
+                doc.analysis = std::move(*analysis);
+            }
+            else
+            {
+                diagnostics = std::get<std::vector<curlee::diag::Diagnostic>>(std::move(front_end));
+            }
+
+            // Settle the worker first, so no result for an older version lands after these.
+            if (doc.analysis != nullptr)
+            {
+                verifier.schedule(VerificationJob{
+                    .uri = *uri, .version = doc.version, .analysis = doc.analysis});
+            }
+            else
+            {
+                verifier.forget(*uri);
+            }
+            write_lsp_message(
+                publish_diagnostics_message(*uri, doc.version, diagnostics, doc.text));
             continue;
         }
 
@@ -1337,7 +1512,12 @@ int main()
                 continue;
             }
             const auto& doc = doc_it->second;
-            curlee::source::LineMap map(doc.text);
+            const auto& analysis = doc.analysis;
+            if (analysis == nullptr)
+            {
+                continue;
+            }
+            const auto& map = doc.text;
             const auto offset_opt =
                 offset_from_position(map, LspPosition{static_cast<std::size_t>(*line),
                                                       static_cast<std::size_t>(*character)});
@@ -1346,29 +1526,16 @@ int main()
                 continue;
             }
 
-            curlee::source::SourceFile file;
-            file.path = uri_to_path(*uri);
-            file.contents = doc.text;
-            const auto analysis = analyze(file);
-            if (!analysis.has_value())
-            {
-                continue;
-            }
-
             if (*method == "textDocument/definition")
             {
                 std::optional<curlee::source::Span> target_span;
-                for (const auto& use : analysis->resolution.uses)
+                if (const auto* use = analysis->positions.uses.innermost(*offset_opt))
                 {
-                    if (span_contains(use.span, *offset_opt))
-                    {
-                        const auto sym_index = static_cast<std::size_t>(use.target.value);
-                        assert(sym_index < analysis->resolution.symbols.size()); // GCOVR_EXCL_LINE
-                        const auto& sym = analysis->resolution.symbols[sym_index];
-                        target_span =
-                            identifier_span_in_definition(sym, doc.text).value_or(sym.span);
-                        break;
-                    }
+                    const auto sym_index = static_cast<std::size_t>(use->target.value);
+                    assert(sym_index < analysis->resolution.symbols.size()); // GCOVR_EXCL_LINE
+                    const auto& sym = analysis->resolution.symbols[sym_index];
+                    target_span = identifier_span_in_definition(sym, analysis->file.contents)
+                                      .value_or(sym.span);
                 }
 
                 Json::Object response;
@@ -1394,23 +1561,8 @@ int main()
                 continue;
             }
 
-            const curlee::parser::Expr* best_call = nullptr;
-            for (const auto& func : analysis->program.functions)
-            {
-                for (const auto& stmt : func.body.stmts)
-                {
-                    find_call_exprs_in_stmt(stmt, *offset_opt, best_call);
-                }
-            }
-
-            const curlee::parser::Expr* best_expr = nullptr;
-            for (const auto& func : analysis->program.functions)
-            {
-                for (const auto& stmt : func.body.stmts)
-                {
-                    find_exprs_in_stmt(stmt, *offset_opt, best_expr);
-                }
-            }
+            const auto* best_call = analysis->positions.calls.innermost(*offset_opt);
+            const auto* best_expr = analysis->positions.exprs.innermost(*offset_opt);
 
             Json::Object response;
             response["jsonrpc"] = Json{std::string("2.0")};
@@ -1438,7 +1590,7 @@ int main()
                             {
                                 substitutions.emplace(
                                     std::string(f->params[i].name),
-                                    slice_span_text(doc.text, call->args[i].span));
+                                    slice_span_text(analysis->file.contents, call->args[i].span));
                             }
 
                             std::vector<std::string> obligations;
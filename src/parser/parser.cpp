@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <curlee/lexer/token.h>
 #include <curlee/parser/parser.h>
+#include <functional>
 #include <optional>
 #include <sstream>
 #include <string_view>
@@ -131,27 +133,321 @@ void assign_expr_ids_program(curlee::parser::Program& program)
     }
 }
 
+// Carries a node parsed from one text over to an edited copy of it: every offset moves from
+// `old_at` to `new_at`, and every name is re-pointed at the same bytes of the new text.
+class Rebase
+{
+  public:
+    Rebase(const char* old_text, const char* new_text, std::size_t old_at, std::size_t new_at)
+        : old_text_(old_text), new_text_(new_text), old_at_(old_at), new_at_(new_at)
+    {
+    }
+
+    void operator()(curlee::source::Span& span) const
+    {
+        span.start = offset(span.start);
+        span.end = offset(span.end);
+    }
+
+    void operator()(std::string_view& view) const
+    {
+        if (view.data() != nullptr)
+        {
+            view = std::string_view(
+                new_text_ + offset(static_cast<std::size_t>(view.data() - old_text_)),
+                view.size());
+        }
+    }
+
+    void operator()(TypeName& type) const
+    {
+        (*this)(type.span);
+        (*this)(type.name);
+    }
+
+    void operator()(Pred& pred) const
+    {
+        (*this)(pred.span);
+        std::visit(
+            [&](auto& node)
+            {
+                using Node = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<Node, PredInt>)
+                {
+                    (*this)(node.lexeme);
+                }
+                else if constexpr (std::is_same_v<Node, PredName>)
+                {
+                    (*this)(node.name);
+                }
+                else if constexpr (std::is_same_v<Node, PredUnary>)
+                {
+                    (*this)(*node.rhs);
+                }
+                else if constexpr (std::is_same_v<Node, PredBinary>)
+                {
+                    (*this)(*node.lhs);
+                    (*this)(*node.rhs);
+                }
+                else if constexpr (std::is_same_v<Node, PredGroup>)
+                {
+                    (*this)(*node.inner);
+                }
+            },
+            pred.node);
+    }
+
+    void operator()(Expr& expr) const
+    {
+        (*this)(expr.span);
+        std::visit(
+            [&](auto& node)
+            {
+                using Node = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<Node, IntExpr> || std::is_same_v<Node, StringExpr>)
+                {
+                    (*this)(node.lexeme);
+                }
+                else if constexpr (std::is_same_v<Node, NameExpr>)
+                {
+                    (*this)(node.name);
+                }
+                else if constexpr (std::is_same_v<Node, ScopedNameExpr>)
+                {
+                    (*this)(node.lhs);
+                    (*this)(node.rhs);
+                }
+                else if constexpr (std::is_same_v<Node, MemberExpr>)
+                {
+                    (*this)(*node.base);
+                    (*this)(node.member);
+                }
+                else if constexpr (std::is_same_v<Node, UnaryExpr>)
+                {
+                    (*this)(*node.rhs);
+                }
+                else if constexpr (std::is_same_v<Node, BinaryExpr>)
+                {
+                    (*this)(*node.lhs);
+                    (*this)(*node.rhs);
+                }
+                else if constexpr (std::is_same_v<Node, CallExpr>)
+                {
+                    (*this)(*node.callee);
+                    for (auto& arg : node.args)
+                    {
+                        (*this)(arg);
+                    }
+                }
+                else if constexpr (std::is_same_v<Node, GroupExpr>)
+                {
+                    (*this)(*node.inner);
+                }
+                else if constexpr (std::is_same_v<Node, StructLiteralExpr>)
+                {
+                    (*this)(node.type_name);
+                    for (auto& field : node.fields)
+                    {
+                        (*this)(field.span);
+                        (*this)(field.name);
+                        if (field.value != nullptr)
+                        {
+                            (*this)(*field.value);
+                        }
+                    }
+                }
+            },
+            expr.node);
+    }
+
+    void operator()(Block& block) const
+    {
+        (*this)(block.span);
+        for (auto& stmt : block.stmts)
+        {
+            (*this)(stmt);
+        }
+    }
+
+    void operator()(Stmt& stmt) const
+    {
+        (*this)(stmt.span);
+        std::visit(
+            [&](auto& node)
+            {
+                using Node = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<Node, LetStmt>)
+                {
+                    (*this)(node.name);
+                    (*this)(node.type);
+                    if (node.refinement.has_value())
+                    {
+                        (*this)(*node.refinement);
+                    }
+                    (*this)(node.value);
+                }
+                else if constexpr (std::is_same_v<Node, ReturnStmt>)
+                {
+                    if (node.value.has_value())
+                    {
+                        (*this)(*node.value);
+                    }
+                }
+                else if constexpr (std::is_same_v<Node, ExprStmt>)
+                {
+                    (*this)(node.expr);
+                }
+                else if constexpr (std::is_same_v<Node, BlockStmt>)
+                {
+                    (*this)(*node.block);
+                }
+                else if constexpr (std::is_same_v<Node, IfStmt>)
+                {
+                    (*this)(node.cond);
+                    (*this)(*node.then_block);
+                    if (node.else_block != nullptr)
+                    {
+                        (*this)(*node.else_block);
+                    }
+                }
+                else if constexpr (std::is_same_v<Node, WhileStmt>)
+                {
+                    (*this)(node.cond);
+                    (*this)(*node.body);
+                }
+                else if constexpr (std::is_same_v<Node, UnsafeStmt>)
+                {
+                    (*this)(*node.body);
+                }
+            },
+            stmt.node);
+    }
+
+    void operator()(Function& function) const
+    {
+        (*this)(function.span);
+        (*this)(function.name);
+        for (auto& param : function.params)
+        {
+            (*this)(param.span);
+            (*this)(param.name);
+            (*this)(param.type);
+            if (param.refinement.has_value())
+            {
+                (*this)(*param.refinement);
+            }
+        }
+        for (auto& pred : function.requires_clauses)
+        {
+            (*this)(pred);
+        }
+        for (auto& pred : function.ensures)
+        {
+            (*this)(pred);
+        }
+        if (function.return_type.has_value())
+        {
+            (*this)(*function.return_type);
+        }
+        (*this)(function.body);
+    }
+
+    void operator()(ImportDecl& decl) const
+    {
+        (*this)(decl.span);
+        for (auto& segment : decl.path)
+        {
+            (*this)(segment);
+        }
+        if (decl.alias.has_value())
+        {
+            (*this)(*decl.alias);
+        }
+    }
+
+    void operator()(StructDecl& decl) const
+    {
+        (*this)(decl.span);
+        (*this)(decl.name);
+        for (auto& field : decl.fields)
+        {
+            (*this)(field.span);
+            (*this)(field.name);
+            (*this)(field.type);
+        }
+    }
+
+    void operator()(EnumDecl& decl) const
+    {
+        (*this)(decl.span);
+        (*this)(decl.name);
+        for (auto& variant : decl.variants)
+        {
+            (*this)(variant.span);
+            (*this)(variant.name);
+            if (variant.payload.has_value())
+            {
+                (*this)(*variant.payload);
+            }
+        }
+    }
+
+  private:
+    const char* old_text_;
+    const char* new_text_;
+    std::size_t old_at_;
+    std::size_t new_at_;
+
+    [[nodiscard]] std::size_t offset(std::size_t old_offset) const
+    {
+        return old_offset - old_at_ + new_at_;
+    }
+};
+
 class Parser
 {
   public:
     explicit Parser(std::span<const Token> tokens) : tokens_(tokens) {}
 
+    // Resume at top-level item `start`, after items whose first non-import began at
+    // `first_non_import` (if any did).
+    Parser(std::span<const Token> tokens, std::size_t start,
+           std::optional<curlee::source::Span> first_non_import)
+        : tokens_(tokens), pos_(start), first_non_import_(first_non_import)
+    {
+    }
+
     [[nodiscard]] ParseResult parse_program()
     {
         Program program;
-        bool seen_non_import = false;
-        curlee::source::Span first_non_import_span;
+        parse_items(program, {});
+        if (!diagnostics_.empty())
+        {
+            return diagnostics_;
+        }
+        return program;
+    }
+
+    // Parse top-level items into `program` until EOF, or until `stop` accepts the position of the
+    // next item. Returns the position reached.
+    std::size_t parse_items(Program& program, const std::function<bool(std::size_t)>& stop)
+    {
         while (!is_at_end())
         {
+            if (stop && stop(pos_))
+            {
+                break;
+            }
+
             if (check(TokenKind::KwImport))
             {
-                if (seen_non_import)
+                if (first_non_import_.has_value())
                 {
                     auto d = error_at(
                         peek(),
                         "import declarations must appear before any other top-level declarations");
                     d.notes.push_back(curlee::diag::Related{.message = "move this import above the first declaration", .span = std::nullopt}); // GCOVR_EXCL_LINE
-                    d.notes.push_back(curlee::diag::Related{.message = "first declaration is here", .span = first_non_import_span});           // GCOVR_EXCL_LINE
+                    d.notes.push_back(curlee::diag::Related{.message = "first declaration is here", .span = first_non_import_});           // GCOVR_EXCL_LINE
                     diagnostics_.push_back(std::move(d));
                     // Make progress: consume `import` and then skip to the next top-level item.
                     advance();
@@ -171,11 +467,10 @@ class Parser
 
             if (check(TokenKind::KwStruct))
             {
-                if (!seen_non_import)
+                if (!first_non_import_.has_value())
                 {
-                    first_non_import_span = peek().span;
+                    first_non_import_ = peek().span;
                 }
-                seen_non_import = true;
 
                 auto s = parse_struct_decl();
                 if (std::holds_alternative<curlee::diag::Diagnostic>(s))
@@ -190,11 +485,10 @@ class Parser
 
             if (check(TokenKind::KwEnum))
             {
-                if (!seen_non_import)
+                if (!first_non_import_.has_value())
                 {
-                    first_non_import_span = peek().span;
+                    first_non_import_ = peek().span;
                 }
-                seen_non_import = true;
 
                 auto e = parse_enum_decl();
                 if (std::holds_alternative<curlee::diag::Diagnostic>(e))
@@ -209,11 +503,10 @@ class Parser
 
             if (check(TokenKind::KwFn))
             {
-                if (!seen_non_import)
+                if (!first_non_import_.has_value())
                 {
-                    first_non_import_span = peek().span;
+                    first_non_import_ = peek().span;
                 }
-                seen_non_import = true;
                 auto fun = parse_function();
                 if (std::holds_alternative<curlee::diag::Diagnostic>(fun))
                 {
@@ -229,18 +522,21 @@ class Parser
                 error_at(peek(), "expected 'import', 'struct', 'enum', or 'fn'"));
             advance();
         }
+        return pos_;
+    }
 
-        if (!diagnostics_.empty())
-        {
-            return diagnostics_;
-        }
-        return program;
+    [[nodiscard]] bool seen_non_import() const { return first_non_import_.has_value(); }
+    [[nodiscard]] std::vector<curlee::diag::Diagnostic> take_diagnostics()
+    {
+        return std::move(diagnostics_);
     }
 
   private:
     std::span<const Token> tokens_;
     std::size_t pos_ = 0;
     std::vector<curlee::diag::Diagnostic> diagnostics_;
+    // Where the first struct, enum or fn began; imports after it are errors.
+    std::optional<curlee::source::Span> first_non_import_;
 
     [[nodiscard]] bool is_at_end() const { return peek().kind == TokenKind::Eof; }
 
@@ -1777,34 +2073,6 @@ class Dumper
         }
     }
 
-  private:
-    std::ostringstream& out_;
-
-    void dump_struct_decl(const StructDecl& s)
-    {
-        out_ << "struct " << s.name << " {";
-        for (const auto& f : s.fields)
-        {
-            out_ << " " << f.name << ": " << f.type.name << ";";
-        }
-        out_ << " }\n";
-    }
-
-    void dump_enum_decl(const EnumDecl& e)
-    {
-        out_ << "enum " << e.name << " {";
-        for (const auto& v : e.variants)
-        {
-            out_ << " " << v.name;
-            if (v.payload.has_value())
-            {
-                out_ << "(" << v.payload->name << ")";
-            }
-            out_ << ";";
-        }
-        out_ << " }\n";
-    }
-
     void dump_function(const Function& f)
     {
         out_ << "fn " << f.name << "(";
@@ -1849,6 +2117,34 @@ class Dumper
         dump_block(f.body);
     }
 
+  private:
+    std::ostringstream& out_;
+
+    void dump_struct_decl(const StructDecl& s)
+    {
+        out_ << "struct " << s.name << " {";
+        for (const auto& f : s.fields)
+        {
+            out_ << " " << f.name << ": " << f.type.name << ";";
+        }
+        out_ << " }\n";
+    }
+
+    void dump_enum_decl(const EnumDecl& e)
+    {
+        out_ << "enum " << e.name << " {";
+        for (const auto& v : e.variants)
+        {
+            out_ << " " << v.name;
+            if (v.payload.has_value())
+            {
+                out_ << "(" << v.payload->name << ")";
+            }
+            out_ << ";";
+        }
+        out_ << " }\n";
+    }
+
     void dump_block(const Block& b)
     {
         out_ << "{";
@@ -2045,6 +2341,172 @@ ParseResult parse(std::span<const curlee::lexer::Token> tokens)
     return result;
 } // GCOVR_EXCL_LINE
 
+namespace
+{
+
+// A declaration's tokens [first, last], by index into the tokens it was parsed from.
+struct DeclTokens
+{
+    std::size_t first = 0;
+    std::size_t last = 0;
+};
+
+template <typename Decl>
+std::vector<DeclTokens> decl_tokens(const std::vector<Decl>& decls, std::span<const Token> tokens)
+{
+    std::vector<DeclTokens> out;
+    out.reserve(decls.size());
+    for (const auto& decl : decls)
+    {
+        const auto first = std::partition_point(tokens.begin(), tokens.end(),
+                                                [&](const Token& t)
+                                                { return t.span.start < decl.span.start; });
+        const auto last = std::partition_point(first, tokens.end(), [&](const Token& t)
+                                               { return t.span.end < decl.span.end; });
+        auto range = DeclTokens{.first = static_cast<std::size_t>(first - tokens.begin()),
+                                .last = static_cast<std::size_t>(last - tokens.begin())};
+        if constexpr (std::is_same_v<Decl, Function>)
+        {
+            // A function's span starts at its name, after `fn`.
+            --range.first;
+        }
+        out.push_back(range);
+    }
+    return out;
+}
+
+// Old declarations [0, kept) and [resume, size) around the newly parsed ones, in source order.
+template <typename Decl>
+std::vector<Decl> splice_decls(std::vector<Decl>& old, std::size_t kept, std::size_t resume,
+                               std::vector<Decl>& fresh, const Rebase& before,
+                               const Rebase& after)
+{
+    std::vector<Decl> out;
+    out.reserve(kept + fresh.size() + (old.size() - resume));
+    for (std::size_t i = 0; i < kept; ++i)
+    {
+        before(old[i]);
+        out.push_back(std::move(old[i]));
+    }
+    for (auto& decl : fresh)
+    {
+        out.push_back(std::move(decl));
+    }
+    for (std::size_t i = resume; i < old.size(); ++i)
+    {
+        after(old[i]);
+        out.push_back(std::move(old[i]));
+    }
+    return out;
+}
+
+// Start of the text a token stream was lexed from.
+const char* text_of(std::span<const Token> tokens)
+{
+    return tokens.front().lexeme.data() - tokens.front().span.start;
+}
+
+} // namespace
+
+ParseResult reparse(Program program, std::span<const curlee::lexer::Token> old_tokens,
+                    const curlee::lexer::Relexed& relexed)
+{
+    const std::span<const Token> tokens = relexed.tokens;
+    const auto& edit = relexed.edit;
+
+    const auto imports = decl_tokens(program.imports, old_tokens);
+    const auto structs = decl_tokens(program.structs, old_tokens);
+    const auto enums = decl_tokens(program.enums, old_tokens);
+    const auto functions = decl_tokens(program.functions, old_tokens);
+
+    // Each declaration stops at its final `;` or `}` without looking past it, so one whose tokens
+    // all come before the edit parses the same way again. A clean parse leaves nothing between
+    // declarations, so parsing restarts right after the last of those.
+    std::size_t restart = 0;
+    std::optional<curlee::source::Span> first_non_import;
+    const auto count_kept = [&](const std::vector<DeclTokens>& decls, bool is_import)
+    {
+        std::size_t kept = 0;
+        while (kept < decls.size() && decls[kept].last < edit.first)
+        {
+            restart = std::max(restart, decls[kept].last + 1);
+            ++kept;
+        }
+        if (!is_import && kept > 0)
+        {
+            const auto& span = tokens[decls.front().first].span;
+            if (!first_non_import.has_value() || span.start < first_non_import->start)
+            {
+                first_non_import = span;
+            }
+        }
+        return kept;
+    };
+    const std::size_t kept_imports = count_kept(imports, true);
+    const std::size_t kept_structs = count_kept(structs, false);
+    const std::size_t kept_enums = count_kept(enums, false);
+    const std::size_t kept_functions = count_kept(functions, false);
+
+    // Past the edit, parsing at the start of an old declaration would go on as it did before,
+    // unless an import there now follows a non-import.
+    std::vector<std::size_t> resume_points;
+    for (const auto* decls : {&imports, &structs, &enums, &functions})
+    {
+        for (const auto& decl : *decls)
+        {
+            if (decl.first >= edit.old_end)
+            {
+                resume_points.push_back(decl.first - edit.old_end + edit.new_end);
+            }
+        }
+    }
+    std::sort(resume_points.begin(), resume_points.end());
+    const auto to_old = [&](std::size_t pos) { return pos - edit.new_end + edit.old_end; };
+
+    Parser parser(tokens, restart, first_non_import);
+    Program fresh;
+    const std::size_t stop = parser.parse_items(
+        fresh,
+        [&](std::size_t pos)
+        {
+            return std::binary_search(resume_points.begin(), resume_points.end(), pos) &&
+                   (!parser.seen_non_import() || imports.empty() ||
+                    to_old(pos) > imports.back().first);
+        });
+    if (auto diagnostics = parser.take_diagnostics(); !diagnostics.empty())
+    {
+        return diagnostics;
+    }
+
+    const bool at_end = tokens[stop].kind == TokenKind::Eof;
+    const std::size_t old_stop = at_end ? old_tokens.size() : to_old(stop);
+    const auto count_before = [&](const std::vector<DeclTokens>& decls)
+    {
+        return static_cast<std::size_t>(
+            std::partition_point(decls.begin(), decls.end(),
+                                 [&](const DeclTokens& d) { return d.first < old_stop; }) -
+            decls.begin());
+    };
+
+    const char* old_text = text_of(old_tokens);
+    const char* new_text = text_of(tokens);
+    const Rebase before(old_text, new_text, 0, 0);
+    const Rebase after(old_text, new_text, at_end ? 0 : old_tokens[old_stop].span.start,
+                       tokens[stop].span.start);
+
+    Program out;
+    out.imports = splice_decls(program.imports, kept_imports, count_before(imports),
+                               fresh.imports, before, after);
+    out.structs = splice_decls(program.structs, kept_structs, count_before(structs),
+                               fresh.structs, before, after);
+    out.enums =
+        splice_decls(program.enums, kept_enums, count_before(enums), fresh.enums, before, after);
+    out.functions = splice_decls(program.functions, kept_functions, count_before(functions),
+                                 fresh.functions, before, after);
+    assign_expr_ids_program(out);
+    return out;
+} // GCOVR_EXCL_LINE
+
 void reassign_expr_ids(Program& program)
 {
     assign_expr_ids_program(program);
@@ -2058,4 +2520,12 @@ std::string dump(const Program& program)
     return out.str();
 }
 
+std::string dump(const Function& function)
+{
+    std::ostringstream out;
+    Dumper d(out);
+    d.dump_function(function);
+    return out.str();
+}
+
 } // namespace curlee::parser
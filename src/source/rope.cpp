@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <curlee/source/rope.h>
+#include <iterator>
+
+namespace curlee::source
+{
+
+namespace
+{
+
+// Small enough that rewriting a chunk on every keystroke is cheap, large enough that a long
+// file has few of them.
+constexpr std::size_t kChunkSize = 1024;
+
+} // namespace
+
+Rope::Rope(std::string_view text)
+{
+    splice(0, 0, text);
+}
+
+std::size_t Rope::size() const
+{
+    return bytes_before_.back();
+}
+
+void Rope::replace(std::size_t start, std::size_t end, std::string_view text)
+{
+    end = std::min(end, size());
+    start = std::min(start, end);
+    if (chunks_.empty())
+    {
+        splice(0, 0, text);
+        return;
+    }
+
+    // Rebuild the chunks the edit touches around the new text.
+    const std::size_t first = chunk_at(start);
+    const std::size_t last = chunk_at(end);
+    const std::string& head = chunks_[first].text;
+    const std::string& tail = chunks_[last].text;
+    const std::size_t head_keep = start - bytes_before_[first];
+    const std::size_t tail_skip = end - bytes_before_[last];
+
+    std::string merged;
+    merged.reserve(head_keep + text.size() + (tail.size() - tail_skip));
+    merged.append(head, 0, head_keep);
+    merged.append(text);
+    merged.append(tail, tail_skip);
+    splice(first, last + 1, merged);
+}
+
+std::string Rope::str() const
+{
+    std::string out;
+    out.reserve(size());
+    for (const auto& chunk : chunks_)
+    {
+        out += chunk.text;
+    }
+    return out;
+}
+
+LineCol Rope::offset_to_line_col(std::size_t offset) const
+{
+    // Clamp to end-of-text.
+    offset = std::min(offset, size());
+
+    std::size_t newlines = 0;
+    if (!chunks_.empty())
+    {
+        const std::size_t index = chunk_at(offset);
+        const auto& local = chunks_[index].newlines;
+        newlines = newlines_before_[index] +
+                   static_cast<std::size_t>(
+                       std::lower_bound(local.begin(), local.end(), offset - bytes_before_[index]) -
+                       local.begin());
+    }
+    const std::size_t line = newlines + 1;
+    return LineCol{.line = line, .col = 1 + (offset - line_start_offset(line))};
+}
+
+std::size_t Rope::line_start_offset(std::size_t line) const
+{
+    if (line <= 1)
+    {
+        return 0;
+    }
+
+    // Line `line` starts after the (line - 1)th newline.
+    const std::size_t newline = line - 2;
+    if (newline >= newlines_before_.back())
+    {
+        return size();
+    }
+    const auto after =
+        std::upper_bound(newlines_before_.begin(), newlines_before_.end() - 1, newline);
+    const auto index = static_cast<std::size_t>(after - newlines_before_.begin()) - 1;
+    return bytes_before_[index] + chunks_[index].newlines[newline - newlines_before_[index]] + 1;
+}
+
+std::size_t Rope::line_count() const
+{
+    return newlines_before_.back() + 1;
+}
+
+std::size_t Rope::utf16_offset(std::size_t line, std::size_t units) const
+{
+    if (line > line_count())
+    {
+        return size();
+    }
+    const std::size_t end = line < line_count() ? line_start_offset(line + 1) - 1 : size();
+    std::size_t offset = line_start_offset(line);
+    std::size_t index = chunks_.empty() ? 0 : chunk_at(offset);
+    while (offset < end && units > 0)
+    {
+        const std::string& text = chunks_[index].text;
+        const std::size_t local = offset - bytes_before_[index];
+        if (local >= text.size())
+        {
+            ++index;
+            continue;
+        }
+        // Decode only the UTF-8 lead byte: four-byte sequences are a surrogate pair in UTF-16,
+        // everything else (including stray continuation bytes) one unit.
+        const auto lead = static_cast<unsigned char>(text[local]);
+        const std::size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+        const std::size_t width = length == 4 ? 2 : 1;
+        if (width > units)
+        {
+            break;
+        }
+        units -= width;
+        offset = std::min(offset + length, end);
+    }
+    return offset;
+}
+
+void Rope::splice(std::size_t first, std::size_t last, std::string_view text)
+{
+    std::vector<Chunk> pieces;
+    pieces.reserve(text.size() / kChunkSize + 1);
+    for (std::size_t at = 0; at < text.size();)
+    {
+        const std::size_t rest = text.size() - at;
+        const std::size_t take = rest <= 2 * kChunkSize ? rest : kChunkSize;
+        Chunk chunk;
+        chunk.text.assign(text.substr(at, take));
+        for (std::size_t i = 0; i < chunk.text.size(); ++i)
+        {
+            if (chunk.text[i] == '\n')
+            {
+                chunk.newlines.push_back(i);
+            }
+        }
+        pieces.push_back(std::move(chunk));
+        at += take;
+    }
+
+    const auto at = chunks_.erase(chunks_.begin() + static_cast<std::ptrdiff_t>(first),
+                                  chunks_.begin() + static_cast<std::ptrdiff_t>(last));
+    chunks_.insert(at, std::make_move_iterator(pieces.begin()),
+                   std::make_move_iterator(pieces.end()));
+
+    // Totals before `first` are unchanged.
+    bytes_before_.resize(chunks_.size() + 1);
+    newlines_before_.resize(chunks_.size() + 1);
+    for (std::size_t i = first; i < chunks_.size(); ++i)
+    {
+        bytes_before_[i + 1] = bytes_before_[i] + chunks_[i].text.size();
+        newlines_before_[i + 1] = newlines_before_[i] + chunks_[i].newlines.size();
+    }
+}
+
+std::size_t Rope::chunk_at(std::size_t offset) const
+{
+    // No chunk is empty, so the last one starting at or before `offset` holds it.
+    const auto after = std::upper_bound(bytes_before_.begin(), bytes_before_.end() - 1, offset);
+    return static_cast<std::size_t>(after - bytes_before_.begin()) - 1;
+}
+
+} // namespace curlee::source
@@ -0,0 +1,134 @@
+#include <charconv>
+#include <curlee/verification/certificate.h>
+
+namespace curlee::verification
+{
+
+namespace
+{
+
+/** Bumped whenever the encoding or the meaning of fact indices changes. */
+constexpr std::string_view kHeader = "curlee-proof-1";
+
+std::vector<std::string_view> split(std::string_view text, char delim)
+{
+    std::vector<std::string_view> out;
+    std::size_t start = 0;
+    while (true)
+    {
+        const auto end = text.find(delim, start);
+        out.push_back(text.substr(start, end - start));
+        if (end == std::string_view::npos)
+        {
+            return out;
+        }
+        start = end + 1;
+    }
+}
+
+std::optional<ObligationHint> decode_hint(std::string_view text)
+{
+    if (text == "p")
+    {
+        return ObligationHint{.kind = ObligationHint::Kind::Presolved, .core = {}};
+    }
+    if (text == "u")
+    {
+        return ObligationHint{.kind = ObligationHint::Kind::Unproven, .core = {}};
+    }
+    if (!text.starts_with('c'))
+    {
+        return std::nullopt;
+    }
+
+    ObligationHint hint{.kind = ObligationHint::Kind::Core, .core = {}};
+    text.remove_prefix(1);
+    if (text.empty())
+    {
+        return hint;
+    }
+    for (const auto index : split(text, '.'))
+    {
+        std::size_t value = 0;
+        const auto [ptr, ec] = std::from_chars(index.data(), index.data() + index.size(), value);
+        if (ec != std::errc{} || ptr != index.data() + index.size())
+        {
+            return std::nullopt;
+        }
+        hint.core.push_back(value);
+    }
+    return hint;
+}
+
+} // namespace
+
+std::string encode_certificate(const ProofCertificate& certificate)
+{
+    std::string out(kHeader);
+    for (const auto& [key, hints] : certificate.functions)
+    {
+        out += " " + key + "=";
+        for (std::size_t i = 0; i < hints.size(); ++i)
+        {
+            if (i > 0)
+            {
+                out += ",";
+            }
+            switch (hints[i].kind)
+            {
+            case ObligationHint::Kind::Presolved:
+                out += "p";
+                break;
+            case ObligationHint::Kind::Unproven:
+                out += "u";
+                break;
+            case ObligationHint::Kind::Core:
+                out += "c";
+                for (std::size_t j = 0; j < hints[i].core.size(); ++j)
+                {
+                    out += (j > 0 ? "." : "") + std::to_string(hints[i].core[j]);
+                }
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+std::optional<ProofCertificate> decode_certificate(std::string_view text)
+{
+    const auto fields = split(text, ' ');
+    if (fields.front() != kHeader)
+    {
+        return std::nullopt;
+    }
+
+    ProofCertificate certificate;
+    for (std::size_t i = 1; i < fields.size(); ++i)
+    {
+        const auto eq = fields[i].find('=');
+        if (eq == std::string_view::npos || eq == 0)
+        {
+            return std::nullopt;
+        }
+        std::vector<ObligationHint> hints;
+        const auto list = fields[i].substr(eq + 1);
+        if (!list.empty())
+        {
+            for (const auto hint_text : split(list, ','))
+            {
+                auto hint = decode_hint(hint_text);
+                if (!hint.has_value())
+                {
+                    return std::nullopt;
+                }
+                hints.push_back(std::move(*hint));
+            }
+        }
+        certificate.functions.insert_or_assign(std::string(fields[i].substr(0, eq)),
+                                               std::move(hints));
+    }
+    return certificate;
+}
+
+} // namespace curlee::verification
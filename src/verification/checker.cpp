@@ -1,14 +1,31 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <curlee/lexer/token.h>
+#include <curlee/parser/parser.h>
 #include <curlee/types/type.h>
+#include <curlee/verification/cache_file.h>
+#include <curlee/verification/certificate.h>
 #include <curlee/verification/checker.h>
+#include <curlee/verification/fact_slicing.h>
+#include <curlee/verification/obligation_cache.h>
 #include <curlee/verification/predicate_lowering.h>
+#include <curlee/verification/presolver.h>
+#include <curlee/verification/session.h>
 #include <curlee/verification/solver.h>
+#include <exception>
+#include <iterator>
+#include <limits>
 #include <optional>
+#include <set>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -204,30 +221,322 @@ struct ScopeState
     std::unordered_map<std::string_view, z3::expr> int_vars;
     std::unordered_map<std::string_view, z3::expr> bool_vars;
     std::size_t facts_size = 0;
+    std::size_t guards_size = 0;
+    std::size_t declared_size = 0;
 };
 
-class Verifier
+/** @brief Whether `e` mentions a constant named in `names`. */
+bool mentions_any(const z3::expr& e, const std::vector<std::string_view>& names)
 {
-  public:
-    explicit Verifier(const curlee::types::TypeInfo& type_info)
-        : type_info_(type_info), solver_(), lower_ctx_(solver_.context())
+    if (names.empty())
+    {
+        return false;
+    }
+    std::vector<z3::expr> pending{e};
+    std::unordered_set<unsigned> seen;
+    while (!pending.empty())
+    {
+        const z3::expr next = pending.back();
+        pending.pop_back();
+        if (!next.is_app() || !seen.insert(next.id()).second)
+        {
+            continue;
+        }
+        if (next.is_const() && next.decl().decl_kind() == Z3_OP_UNINTERPRETED)
+        {
+            const std::string name = next.decl().name().str();
+            if (std::find(names.begin(), names.end(), name) != names.end())
+            {
+                return true;
+            }
+            continue;
+        }
+        for (unsigned i = 0; i < next.num_args(); ++i)
+        {
+            pending.push_back(next.arg(i));
+        }
+    }
+    return false;
+}
+
+using Signatures = std::unordered_map<std::string_view, FunctionSig>;
+
+std::optional<TypeKind> supported_type(const curlee::parser::TypeName& name,
+                                       std::vector<Diagnostic>& diags)
+{
+    auto t = curlee::types::core_type_from_name(name.name);
+    if (!t.has_value())
     {
+        diags.push_back(error_at(name.span, "unknown type '" + std::string(name.name) + "'"));
+        return std::nullopt;
     }
 
-    VerificationResult run(const curlee::parser::Program& program)
+    if (t->kind == TypeKind::Int || t->kind == TypeKind::Bool)
     {
-        collect_signatures(program);
+        return t->kind;
+    }
 
-        for (const auto& f : program.functions)
+    diags.push_back(error_at(name.span, "verification does not support type '" +
+                                            std::string(curlee::types::to_string(*t)) + "'"));
+    return std::nullopt;
+}
+
+Signatures collect_signatures(const curlee::parser::Program& program,
+                              std::vector<Diagnostic>& diags)
+{
+    Signatures functions;
+    for (const auto& f : program.functions)
+    {
+        if (!f.return_type.has_value())
         {
-            check_function(f);
+            continue;
         }
 
-        if (!diags_.empty())
+        auto result = supported_type(*f.return_type, diags);
+        if (!result.has_value())
+        {
+            continue;
+        }
+
+        FunctionSig sig;
+        sig.decl = &f;
+        sig.result = *result;
+
+        bool ok = true;
+        for (const auto& p : f.params)
+        {
+            auto param_t = supported_type(p.type, diags);
+            if (!param_t.has_value())
+            {
+                ok = false;
+                break;
+            }
+            sig.params.push_back(*param_t);
+        }
+
+        if (ok)
+        {
+            functions.emplace(f.name, std::move(sig));
+        }
+    }
+    return functions;
+}
+
+/** @brief What a function's verification reads besides its own text. */
+struct FunctionDeps
+{
+    /** Functions called by name, whose contracts the call sites are checked against. */
+    std::set<std::string_view> callees;
+    /**
+     * Functions called module-qualified (`m.f(...)`), by their last member. Such calls are not
+     * checked against the callee's contract.
+     */
+    std::set<std::string_view> qualified_callees;
+    /** The smallest expression id in the body; ids within a function are contiguous. */
+    std::optional<std::size_t> first_expr_id;
+};
+
+void collect_deps(const Block& block, FunctionDeps& deps);
+
+void collect_deps(const Expr& e, FunctionDeps& deps)
+{
+    deps.first_expr_id = std::min(deps.first_expr_id.value_or(e.id), e.id);
+    std::visit(
+        [&](const auto& node)
+        {
+            using Node = std::decay_t<decltype(node)>;
+            if constexpr (std::is_same_v<Node, CallExpr>)
+            {
+                if (const auto* name = std::get_if<NameExpr>(&node.callee->node))
+                {
+                    deps.callees.insert(name->name);
+                }
+                else if (const auto* member = std::get_if<MemberExpr>(&node.callee->node))
+                {
+                    deps.qualified_callees.insert(member->member);
+                }
+                collect_deps(*node.callee, deps);
+                for (const auto& arg : node.args)
+                {
+                    collect_deps(arg, deps);
+                }
+            }
+            else if constexpr (std::is_same_v<Node, MemberExpr>)
+            {
+                collect_deps(*node.base, deps);
+            }
+            else if constexpr (std::is_same_v<Node, curlee::parser::UnaryExpr>)
+            {
+                collect_deps(*node.rhs, deps);
+            }
+            else if constexpr (std::is_same_v<Node, curlee::parser::BinaryExpr>)
+            {
+                collect_deps(*node.lhs, deps);
+                collect_deps(*node.rhs, deps);
+            }
+            else if constexpr (std::is_same_v<Node, curlee::parser::GroupExpr>)
+            {
+                collect_deps(*node.inner, deps);
+            }
+            else if constexpr (std::is_same_v<Node, curlee::parser::StructLiteralExpr>)
+            {
+                for (const auto& field : node.fields)
+                {
+                    if (field.value != nullptr)
+                    {
+                        collect_deps(*field.value, deps);
+                    }
+                }
+            }
+        },
+        e.node);
+}
+
+void collect_deps(const Block& block, FunctionDeps& deps)
+{
+    for (const auto& stmt : block.stmts)
+    {
+        std::visit(
+            [&](const auto& node)
+            {
+                using Node = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<Node, LetStmt>)
+                {
+                    collect_deps(node.value, deps);
+                }
+                else if constexpr (std::is_same_v<Node, ReturnStmt>)
+                {
+                    if (node.value.has_value())
+                    {
+                        collect_deps(*node.value, deps);
+                    }
+                }
+                else if constexpr (std::is_same_v<Node, ExprStmt>)
+                {
+                    collect_deps(node.expr, deps);
+                }
+                else if constexpr (std::is_same_v<Node, BlockStmt>)
+                {
+                    collect_deps(*node.block, deps);
+                }
+                else if constexpr (std::is_same_v<Node, UnsafeStmt>)
+                {
+                    collect_deps(*node.body, deps);
+                }
+                else if constexpr (std::is_same_v<Node, IfStmt>)
+                {
+                    collect_deps(node.cond, deps);
+                    collect_deps(*node.then_block, deps);
+                    if (node.else_block != nullptr)
+                    {
+                        collect_deps(*node.else_block, deps);
+                    }
+                }
+                else if constexpr (std::is_same_v<Node, WhileStmt>)
+                {
+                    collect_deps(node.cond, deps);
+                    collect_deps(*node.body, deps);
+                }
+            },
+            stmt.node);
+    }
+}
+
+/** @brief The parts of `f` its callers are verified against. */
+std::string contract_text(const Function& f)
+{
+    std::string out = std::string(f.name) + "(";
+    for (std::size_t i = 0; i < f.params.size(); ++i)
+    {
+        const auto& p = f.params[i];
+        out += (i > 0 ? ", " : "") + std::string(p.name) + ": " + std::string(p.type.name);
+        if (p.refinement.has_value())
         {
-            return diags_;
+            out += " where " + pred_to_string(*p.refinement);
         }
-        return Verified{};
+    }
+    out += ")";
+    if (f.return_type.has_value())
+    {
+        out += " -> " + std::string(f.return_type->name);
+    }
+    for (const auto& req : f.requires_clauses)
+    {
+        out += " requires " + pred_to_string(req) + ";";
+    }
+    for (const auto& ens : f.ensures)
+    {
+        out += " ensures " + pred_to_string(ens) + ";";
+    }
+    return out;
+}
+
+/**
+ * @brief Everything verifying `f` depends on: its own text, whether `requires` clauses are
+ * trusted, the Int theory, and the contract of each function it calls (or that the callee is
+ * not verified).
+ */
+std::string fingerprint(const Function& f, const FunctionDeps& deps, const Signatures& functions,
+                        bool trust_requires, IntTheory theory)
+{
+    std::string out = curlee::parser::dump(f);
+    out += trust_requires ? "\ntrusted requires\n" : "\n";
+    // Bounding variables to int64 proves more, so those results are kept apart.
+    if (theory != IntTheory::Integer)
+    {
+        out += "int64 variables\n";
+    }
+    for (const auto callee : deps.callees)
+    {
+        const auto it = functions.find(callee);
+        out += "callee " + (it != functions.end() ? contract_text(*it->second.decl)
+                                                  : std::string(callee) + " unverified");
+        out += "\n";
+    }
+    return out;
+}
+
+/** @brief What verifying one function produced. */
+struct FunctionOutcome
+{
+    std::vector<Diagnostic> diags;
+    std::unordered_set<std::size_t> proven_arithmetic;
+    VerificationStats stats;
+    /** One per obligation, when VerifyOptions::record_certificate is set. */
+    std::vector<ObligationHint> hints;
+    /** One per obligation, when VerifyOptions::profile is set. */
+    std::vector<ObligationProfile> profile;
+};
+
+/**
+ * @brief Verifies a single function in its own Solver (and z3::context).
+ *
+ * Other functions are only seen through their signatures and contracts, so functions can be
+ * verified in any order, or concurrently, with identical results.
+ */
+class Verifier
+{
+  public:
+    Verifier(const curlee::types::TypeInfo& type_info, const Signatures& functions,
+             bool trust_requires, const VerifyOptions& options,
+             const std::vector<ObligationHint>* hints = nullptr)
+        : type_info_(type_info), solver_(options.solver), lower_ctx_(solver_.context()),
+          trust_requires_(trust_requires), presolve_(options.presolve), cache_(options.cache),
+          theory_(options.solver.theory), hints_(hints),
+          record_hints_(options.record_certificate != nullptr),
+          profiling_(options.profile != nullptr), functions_(functions)
+    {
+        lower_ctx_.nonlinear = theory_ != IntTheory::Integer;
+    }
+
+    FunctionOutcome run(const Function& f)
+    {
+        check_function(f);
+        return FunctionOutcome{.diags = std::move(diags_),
+                               .proven_arithmetic = std::move(proven_arithmetic_),
+                               .stats = stats_,
+                               .hints = std::move(recorded_hints_),
+                               .profile = std::move(profiles_)};
     }
 
   private:
@@ -236,8 +545,30 @@ class Verifier
     LoweringContext lower_ctx_;
     std::vector<Diagnostic> diags_;
     std::vector<z3::expr> facts_;
+    // Conditions that hold at run time (unlike `let` refinements, which are assumed), used
+    // for arithmetic safety proofs.
+    std::vector<z3::expr> guards_;
+    bool trust_requires_ = false;
+    bool presolve_ = true;
+    ObligationCache* cache_ = nullptr;
+    IntTheory theory_ = IntTheory::Integer;
+    // Certificate hints, consumed one per obligation in the order they are met.
+    const std::vector<ObligationHint>* hints_ = nullptr;
+    std::size_t next_hint_ = 0;
+    bool record_hints_ = false;
+    std::vector<ObligationHint> recorded_hints_;
+    VerificationStats stats_;
+    bool profiling_ = false;
+    std::vector<ObligationProfile> profiles_;
+    // When the current obligation (profiles_.back()) started.
+    std::chrono::steady_clock::time_point obligation_started_;
+    std::unordered_set<std::size_t> proven_arithmetic_;
     std::vector<ScopeState> scopes_;
-    std::unordered_map<std::string_view, FunctionSig> functions_;
+    // Names declared in the open scopes, innermost last. Variables are solver constants named
+    // after them, so a shadowing `let` reuses the outer constant.
+    std::vector<std::string_view> declared_;
+    FactSlicer slicer_;
+    const Signatures& functions_;
 
     void push_scope()
     {
@@ -246,6 +577,8 @@ class Verifier
         state.int_vars = lower_ctx_.int_vars;
         state.bool_vars = lower_ctx_.bool_vars;
         state.facts_size = facts_.size();
+        state.guards_size = guards_.size();
+        state.declared_size = declared_.size();
     }
 
     void pop_scope()
@@ -263,63 +596,9 @@ class Verifier
             facts_.erase(facts_.begin() + static_cast<std::ptrdiff_t>(state.facts_size),
                          facts_.end());
         }
-    }
-
-    std::optional<TypeKind> supported_type(const curlee::parser::TypeName& name)
-    {
-        auto t = curlee::types::core_type_from_name(name.name);
-        if (!t.has_value())
-        {
-            diags_.push_back(error_at(name.span, "unknown type '" + std::string(name.name) + "'"));
-            return std::nullopt;
-        }
-
-        if (t->kind == TypeKind::Int || t->kind == TypeKind::Bool)
-        {
-            return t->kind;
-        }
-
-        diags_.push_back(error_at(name.span, "verification does not support type '" +
-                                                 std::string(curlee::types::to_string(*t)) + "'"));
-        return std::nullopt;
-    }
-
-    void collect_signatures(const curlee::parser::Program& program)
-    {
-        for (const auto& f : program.functions)
-        {
-            if (!f.return_type.has_value())
-            {
-                continue;
-            }
-
-            auto result = supported_type(*f.return_type);
-            if (!result.has_value())
-            {
-                continue;
-            }
-
-            FunctionSig sig;
-            sig.decl = &f;
-            sig.result = *result;
-
-            bool ok = true;
-            for (const auto& p : f.params)
-            {
-                auto param_t = supported_type(p.type);
-                if (!param_t.has_value())
-                {
-                    ok = false;
-                    break;
-                }
-                sig.params.push_back(*param_t);
-            }
-
-            if (ok)
-            {
-                functions_.emplace(f.name, std::move(sig));
-            }
-        }
+        guards_.erase(guards_.begin() + static_cast<std::ptrdiff_t>(state.guards_size),
+                      guards_.end());
+        declared_.resize(std::min(declared_.size(), state.declared_size));
     }
 
     std::optional<ExprValue> lookup_var(std::string_view name)
@@ -342,12 +621,14 @@ class Verifier
         {
             auto expr = solver_.context().int_const(name_str.c_str());
             lower_ctx_.int_vars.insert_or_assign(name, expr);
+            declared_.push_back(name);
             return;
         }
         if (kind == TypeKind::Bool)
         {
             auto expr = solver_.context().bool_const(name_str.c_str());
             lower_ctx_.bool_vars.insert_or_assign(name, expr);
+            declared_.push_back(name);
             return;
         }
     }
@@ -453,7 +734,7 @@ class Verifier
                         {
                             return error_at(e.span, "'*' expects Int expressions");
                         }
-                        if (!lhs.is_literal && !rhs.is_literal)
+                        if (!lhs.is_literal && !rhs.is_literal && !lower_ctx_.nonlinear)
                         {
                             return error_at(e.span, "non-linear multiplication is not supported");
                         }
@@ -541,9 +822,8 @@ class Verifier
         d.notes.push_back(std::move(note));
     }
 
-    void add_model_note(Diagnostic& d, const std::vector<z3::expr>& vars)
+    void add_model_note(Diagnostic& d, const std::optional<Model>& model)
     {
-        auto model = solver_.model_for(vars);
         if (!model.has_value() || model->entries.empty())
         {
             return;
@@ -554,27 +834,75 @@ class Verifier
         d.notes.push_back(std::move(note));
     }
 
+    // Callers start the obligation with begin_obligation(), naming the site it is about.
     void check_obligation(const curlee::parser::Pred& pred, const LoweringContext& ctx,
                           const z3::expr& obligation, Span span,
                           const std::vector<z3::expr>& extra_facts, std::string_view message)
     {
-        solver_.push();
-        for (const auto& fact : facts_)
+        std::vector<z3::expr> facts = facts_;
+        facts.insert(facts.end(), extra_facts.begin(), extra_facts.end());
+        // The model note's variables seed the cone too, so their values stay consistent.
+        const auto model_vars = model_vars_for_pred(pred, ctx);
+        std::vector<z3::expr> seeds = model_vars;
+        seeds.push_back(obligation);
+
+        if (const ObligationHint* hint = take_hint();
+            hint != nullptr && hint->kind == ObligationHint::Kind::Core &&
+            certified(facts, hint->core, obligation))
         {
-            solver_.add(fact);
+            ++stats_.certified;
+            record_hint(*hint);
+            settle(Settlement::Certificate, CheckResult::Unsat, hint->core.size());
+            return;
         }
-        for (const auto& fact : extra_facts)
+
+        const auto relevant = slicer_.slice(facts, seeds);
+
+        if (presolve_)
         {
-            solver_.add(fact);
+            Presolver presolver;
+            for (const auto& fact : relevant)
+            {
+                presolver.assume(fact);
+            }
+            if (presolver.proves(obligation))
+            {
+                ++stats_.presolved;
+                record_hint({.kind = ObligationHint::Kind::Presolved, .core = {}});
+                settle(Settlement::Presolver, CheckResult::Unsat, relevant.size());
+                return;
+            }
+        }
+
+        auto decision = decide(relevant, obligation, model_vars);
+        bool sliced = true;
+        if (decision.result == CheckResult::Sat && relevant.size() < facts.size())
+        {
+            sliced = false;
+            // Facts outside the cone can only matter by contradicting each other (dead
+            // code), so confirm a counterexample against everything in scope.
+            const bool solved = decision.solved;
+            decision = decide(facts, obligation, model_vars);
+            decision.solved = decision.solved || solved;
         }
-        solver_.add(!obligation);
-        const auto res = solver_.check();
+        count(decision);
+        const CheckResult res = decision.result;
+        if (res == CheckResult::Unsat)
+        {
+            record_core(facts, sliced ? relevant : facts, obligation);
+        }
+        else
+        {
+            record_hint({.kind = ObligationHint::Kind::Unproven, .core = {}});
+        }
+        settle(decision.solved ? Settlement::Solver : Settlement::Cache, res,
+               sliced ? relevant.size() : facts.size());
 
         if (res == CheckResult::Sat)
         {
             Diagnostic d = error_at(span, std::string(message));
             add_goal_note(d, pred);
-            add_model_note(d, model_vars_for_pred(pred, ctx));
+            add_model_note(d, decision.model);
             add_hint_note(d);
             diags_.push_back(std::move(d));
         }
@@ -585,11 +913,379 @@ class Verifier
             add_hint_note(d);
             diags_.push_back(std::move(d));
         }
+        else if (res == CheckResult::BudgetExceeded)
+        {
+            Diagnostic d = error_at(span, std::string(message) + " (solver budget exhausted)");
+            add_goal_note(d, pred);
+            Related note;
+            note.message = "hint: raise --solver-timeout / --solver-rlimit, or simplify this "
+                           "contract";
+            note.span = std::nullopt;
+            d.notes.push_back(std::move(note));
+            diags_.push_back(std::move(d));
+        }
+    }
+
+    /** @brief Start timing an obligation about `span`, when profiling. */
+    void begin_obligation(ObligationKind kind, Span span)
+    {
+        if (!profiling_)
+        {
+            return;
+        }
+        profiles_.push_back({.function = std::string(function_name_),
+                             .kind = kind,
+                             .span = span,
+                             .facts = 0,
+                             .micros = 0,
+                             .settled_by = Settlement::Solver,
+                             .verdict = CheckResult::Unknown,
+                             .statistics = {}});
+        obligation_started_ = std::chrono::steady_clock::now();
+    }
+
+    /** @brief Record how the obligation begin_obligation() started ended, when profiling. */
+    void settle(Settlement settled_by, CheckResult verdict, std::size_t facts)
+    {
+        if (!profiling_)
+        {
+            return;
+        }
+        auto& profile = profiles_.back();
+        profile.facts = facts;
+        profile.settled_by = settled_by;
+        profile.verdict = verdict;
+        profile.micros = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - obligation_started_)
+                .count());
+    }
+
+    /** @brief The certificate's hint for the next obligation, if it has one. */
+    const ObligationHint* take_hint()
+    {
+        const std::size_t index = next_hint_++;
+        if (hints_ == nullptr || index >= hints_->size())
+        {
+            return nullptr;
+        }
+        return &(*hints_)[index];
+    }
+
+    void record_hint(ObligationHint hint)
+    {
+        if (record_hints_)
+        {
+            recorded_hints_.push_back(std::move(hint));
+        }
+    }
+
+    /** @brief Whether the facts at `core` alone entail `goal`, as a certificate claims. */
+    bool certified(const std::vector<z3::expr>& facts, const std::vector<std::size_t>& core,
+                   const z3::expr& goal)
+    {
+        std::vector<z3::expr> picked;
+        picked.reserve(core.size());
+        for (const std::size_t index : core)
+        {
+            if (index >= facts.size())
+            {
+                return false;
+            }
+            picked.push_back(facts[index]);
+        }
+        return decide(picked, goal, {}).result == CheckResult::Unsat;
+    }
+
+    /** @brief Record a minimal core of `facts` for a goal that `relevant` (a slice) proves. */
+    void record_core(const std::vector<z3::expr>& facts, const std::vector<z3::expr>& relevant,
+                     const z3::expr& goal)
+    {
+        if (!record_hints_)
+        {
+            return;
+        }
+        // The slice keeps the order of `facts`, so its positions are found in one pass.
+        std::vector<std::size_t> positions;
+        positions.reserve(relevant.size());
+        for (std::size_t i = 0, j = 0; i < relevant.size(); ++i, ++j)
+        {
+            while (!z3::eq(facts[j], relevant[i]))
+            {
+                ++j;
+            }
+            positions.push_back(j);
+        }
+
+        solver_.push();
+        solver_.add(!goal);
+        const auto core = solver_.minimal_core(relevant);
+        solver_.pop();
+
+        ObligationHint hint{.kind = ObligationHint::Kind::Core, .core = {}};
+        if (!core.has_value())
+        {
+            // Shrinking ran out of budget; the whole slice is still a valid core.
+            hint.core = std::move(positions);
+        }
+        else
+        {
+            for (const std::size_t index : *core)
+            {
+                hint.core.push_back(positions[index]);
+            }
+        }
+        recorded_hints_.push_back(std::move(hint));
+    }
+
+    /** @brief Whether some facts entail a goal, and the model note's values if not. */
+    struct Decision
+    {
+        CheckResult result = CheckResult::Unknown;
+        std::optional<Model> model;
+        /** False when the obligation cache answered without running Z3. */
+        bool solved = false;
+    };
+
+    Decision decide(const std::vector<z3::expr>& facts, const z3::expr& goal,
+                    const std::vector<z3::expr>& model_vars)
+    {
+        std::optional<ObligationQuery> query;
+        if (cache_ != nullptr)
+        {
+            query = normalize_query(facts, goal, model_vars, theory_);
+            if (const auto hit = cache_->lookup(*query);
+                hit.has_value() && hit->model_values.size() ==
+                                       (hit->result == CheckResult::Sat ? model_vars.size() : 0))
+            {
+                Decision decision{.result = hit->result, .model = std::nullopt, .solved = false};
+                if (hit->result == CheckResult::Sat)
+                {
+                    decision.model = Model{};
+                    for (std::size_t i = 0; i < model_vars.size(); ++i)
+                    {
+                        decision.model->entries.push_back(
+                            {model_vars[i].decl().name().str(), hit->model_values[i]});
+                    }
+                }
+                return decision;
+            }
+        }
 
+        solver_.push();
+        for (const auto& fact : facts)
+        {
+            solver_.add(fact);
+        }
+        solver_.add(!goal);
+        Decision decision{.result = solver_.check(), .model = std::nullopt, .solved = true};
+        if (profiling_)
+        {
+            // Certificate re-checks and counterexample confirmations add to the obligation.
+            auto& total = profiles_.back().statistics;
+            const auto& last = solver_.last_statistics();
+            total.conflicts += last.conflicts;
+            total.decisions += last.decisions;
+            total.memory_mb = std::max(total.memory_mb, last.memory_mb);
+        }
+        if (decision.result == CheckResult::Sat)
+        {
+            decision.model = solver_.model_for(model_vars);
+        }
         solver_.pop();
+
+        if (query.has_value() &&
+            (decision.result == CheckResult::Unsat ||
+             (decision.result == CheckResult::Sat && decision.model.has_value())))
+        {
+            ObligationVerdict verdict{.result = decision.result, .model_values = {}};
+            if (decision.model.has_value())
+            {
+                for (const auto& entry : decision.model->entries)
+                {
+                    verdict.model_values.push_back(entry.value);
+                }
+            }
+            cache_->store(*query, verdict);
+        }
+        return decision;
+    }
+
+    void count(const Decision& decision)
+    {
+        if (decision.solved)
+        {
+            ++stats_.solver;
+        }
+        else
+        {
+            ++stats_.cached;
+        }
+    }
+
+    // Record `e` as proven when `safe` holds under the run-time guards, given that every
+    // Int variable is an int64. Unproven sites simply keep their runtime checks.
+    void prove_arithmetic(const Expr& e, const z3::expr& safe)
+    {
+        begin_obligation(ObligationKind::Arithmetic, e.span);
+        const ObligationHint* hint = take_hint();
+        const z3::expr simplified = safe.simplify();
+        if (simplified.is_true())
+        {
+            ++stats_.presolved;
+            proven_arithmetic_.insert(e.id);
+            record_hint({.kind = ObligationHint::Kind::Presolved, .core = {}});
+            settle(Settlement::Presolver, CheckResult::Unsat, 0);
+            return;
+        }
+        if (simplified.is_false())
+        {
+            ++stats_.presolved;
+            record_hint({.kind = ObligationHint::Kind::Unproven, .core = {}});
+            settle(Settlement::Presolver, CheckResult::Sat, 0);
+            return;
+        }
+        if (hint != nullptr && hint->kind == ObligationHint::Kind::Unproven)
+        {
+            // The producer kept this runtime check, so searching for a proof it did not find
+            // would only change the bytecode.
+            record_hint(*hint);
+            settle(Settlement::Certificate, CheckResult::Unknown, 0);
+            return;
+        }
+
+        // Sorted by name, so certificate indices do not depend on hash map order.
+        std::vector<std::pair<std::string_view, z3::expr>> vars(lower_ctx_.int_vars.begin(),
+                                                               lower_ctx_.int_vars.end());
+        std::sort(vars.begin(), vars.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        std::vector<z3::expr> facts = guards_;
+        for (const auto& [name, var] : vars)
+        {
+            facts.push_back(in_int64_range(var));
+        }
+        if (hint != nullptr && hint->kind == ObligationHint::Kind::Core &&
+            certified(facts, hint->core, safe))
+        {
+            ++stats_.certified;
+            proven_arithmetic_.insert(e.id);
+            record_hint(*hint);
+            settle(Settlement::Certificate, CheckResult::Unsat, hint->core.size());
+            return;
+        }
+        // Unlike a contract failure, an unproven site just keeps its runtime check, so there
+        // is no confirmation against the facts outside the cone.
+        const auto relevant = slicer_.slice(facts, {safe});
+
+        if (presolve_)
+        {
+            Presolver presolver;
+            for (const auto& fact : relevant)
+            {
+                presolver.assume(fact);
+            }
+            if (presolver.proves(safe))
+            {
+                ++stats_.presolved;
+                proven_arithmetic_.insert(e.id);
+                record_hint({.kind = ObligationHint::Kind::Presolved, .core = {}});
+                settle(Settlement::Presolver, CheckResult::Unsat, relevant.size());
+                return;
+            }
+        }
+
+        const auto decision = decide(relevant, safe, {});
+        count(decision);
+        if (decision.result == CheckResult::Unsat)
+        {
+            proven_arithmetic_.insert(e.id);
+            record_core(facts, relevant, safe);
+        }
+        else
+        {
+            record_hint({.kind = ObligationHint::Kind::Unproven, .core = {}});
+        }
+        settle(decision.solved ? Settlement::Solver : Settlement::Cache, decision.result,
+               relevant.size());
     }
 
-    void check_call(const CallExpr& call)
+    [[nodiscard]] z3::expr in_int64_range(const z3::expr& value)
+    {
+        auto& ctx = solver_.context();
+        return value >= ctx.int_val(std::numeric_limits<std::int64_t>::min()) &&
+               value <= ctx.int_val(std::numeric_limits<std::int64_t>::max());
+    }
+
+    [[nodiscard]] std::optional<z3::expr> lower_int_operand(const Expr& e)
+    {
+        auto lowered = lower_expr(e);
+        if (const auto* value = std::get_if<ExprValue>(&lowered);
+            value != nullptr && value->kind == TypeKind::Int)
+        {
+            return value->expr;
+        }
+        return std::nullopt;
+    }
+
+    void check_arithmetic(const Expr& e, const curlee::parser::BinaryExpr& node)
+    {
+        using curlee::lexer::TokenKind;
+        if (node.op != TokenKind::Plus && node.op != TokenKind::Minus &&
+            node.op != TokenKind::Star && node.op != TokenKind::Slash)
+        {
+            return;
+        }
+
+        const auto rhs = lower_int_operand(*node.rhs);
+        if (!rhs.has_value())
+        {
+            return;
+        }
+        const auto lhs = lower_int_operand(*node.lhs);
+        if (node.op == TokenKind::Slash)
+        {
+            // Only MIN / -1 overflows; without the dividend, rule out -1 as well.
+            auto& ctx = solver_.context();
+            const z3::expr no_overflow =
+                lhs.has_value() ? !(*lhs == ctx.int_val(std::numeric_limits<std::int64_t>::min()) &&
+                                    *rhs == -1)
+                                : *rhs != -1;
+            prove_arithmetic(e, *rhs != 0 && no_overflow);
+            return;
+        }
+        if (!lhs.has_value())
+        {
+            return;
+        }
+        if (node.op == TokenKind::Star)
+        {
+            // Like contracts, products of two variables are only lowered under a bit-vector
+            // theory.
+            auto product = lower_expr(e);
+            if (const auto* value = std::get_if<ExprValue>(&product); value != nullptr)
+            {
+                prove_arithmetic(e, in_int64_range(value->expr));
+            }
+            return;
+        }
+        prove_arithmetic(e, in_int64_range(node.op == TokenKind::Plus ? *lhs + *rhs
+                                                                      : *lhs - *rhs));
+    }
+
+    void check_negation(const Expr& e, const curlee::parser::UnaryExpr& node)
+    {
+        if (node.op != curlee::lexer::TokenKind::Minus)
+        {
+            return;
+        }
+        if (const auto operand = lower_int_operand(*node.rhs); operand.has_value())
+        {
+            prove_arithmetic(e, in_int64_range(-*operand));
+        }
+    }
+
+    /** `span` is the whole call's, which the obligation profile points at. */
+    void check_call(const CallExpr& call, Span span)
     {
         const auto* callee_name = std::get_if<NameExpr>(&call.callee->node);
         if (callee_name == nullptr)
@@ -630,6 +1326,7 @@ class Verifier
 
         std::vector<z3::expr> call_facts;
         LoweringContext call_ctx(solver_.context());
+        call_ctx.nonlinear = lower_ctx_.nonlinear;
 
         for (std::size_t i = 0; i < sig.decl->params.size(); ++i)
         {
@@ -660,6 +1357,7 @@ class Verifier
                 continue;
             }
 
+            begin_obligation(ObligationKind::CallRequires, span);
             check_obligation(req, call_ctx, std::get<z3::expr>(lowered), req.span, call_facts,
                              "requires clause not satisfied");
         }
@@ -697,7 +1395,7 @@ class Verifier
                 {
                     if (!is_python_ffi_call(node))
                     {
-                        check_call(node);
+                        check_call(node, e.span);
                     }
                     for (const auto& arg : node.args)
                     {
@@ -714,11 +1412,37 @@ class Verifier
                 else if constexpr (std::is_same_v<Node, curlee::parser::UnaryExpr>)
                 {
                     check_expr_for_calls(*node.rhs);
+                    check_negation(e, node);
                 }
                 else if constexpr (std::is_same_v<Node, curlee::parser::BinaryExpr>)
                 {
                     check_expr_for_calls(*node.lhs);
+
+                    // The right operand of `&&` / `||` only runs when the left one was
+                    // true / false.
+                    using curlee::lexer::TokenKind;
+                    std::optional<z3::expr> short_circuit;
+                    if (node.op == TokenKind::AndAnd || node.op == TokenKind::OrOr)
+                    {
+                        auto lhs = lower_expr(*node.lhs);
+                        if (const auto* value = std::get_if<ExprValue>(&lhs);
+                            value != nullptr && value->kind == TypeKind::Bool)
+                        {
+                            short_circuit =
+                                node.op == TokenKind::AndAnd ? value->expr : !value->expr;
+                        }
+                    }
+                    if (short_circuit.has_value())
+                    {
+                        guards_.push_back(*short_circuit);
+                    }
                     check_expr_for_calls(*node.rhs);
+                    if (short_circuit.has_value())
+                    {
+                        guards_.pop_back();
+                    }
+
+                    check_arithmetic(e, node);
                 }
                 else if constexpr (std::is_same_v<Node, curlee::parser::GroupExpr>)
                 {
@@ -789,18 +1513,71 @@ class Verifier
                 continue;
             }
 
+            begin_obligation(ObligationKind::Ensures, ens.span);
             check_obligation(ens, ensure_ctx, std::get<z3::expr>(lowered_pred), ens.span,
                              ensure_facts, "ensures clause not satisfied");
         }
     }
 
-    void check_stmt(const Stmt& s, TypeKind expected_return)
+    // Each statement yields the condition under which control falls through to the next one:
+    // `true` unless some path returns, `false` when every path does. Bindings are immutable, so
+    // the only state that crosses a join is this path condition, and the branches' conditions
+    // merge into one formula, `(c && then) || (!c && else)`. Later statements are checked once,
+    // under one guard per join, rather than once per path through the conditionals before them.
+    z3::expr check_stmt(const Stmt& s, TypeKind expected_return)
+    {
+        return std::visit([&](const auto& node)
+                          { return check_stmt_node(node, s.span, expected_return); },
+                          s.node);
+    }
+
+    /** @brief Check `stmts` in order; returns the condition for falling out of the last one. */
+    z3::expr check_stmts(const std::vector<Stmt>& stmts, TypeKind expected_return)
+    {
+        z3::expr falls_through = solver_.context().bool_val(true);
+        for (const auto& stmt : stmts)
+        {
+            const z3::expr next = check_stmt(stmt, expected_return).simplify();
+            if (next.is_true())
+            {
+                continue;
+            }
+            falls_through = (falls_through && next).simplify();
+            // Code after an unconditional return stays checked as if it were reachable.
+            if (!next.is_false())
+            {
+                facts_.push_back(next);
+                guards_.push_back(next);
+            }
+        }
+        return falls_through;
+    }
+
+    /** @brief Check `stmts` in a new scope, entered only when `guard` holds. */
+    z3::expr check_block(const std::vector<Stmt>& stmts, TypeKind expected_return,
+                         const std::optional<z3::expr>& guard = std::nullopt)
     {
-        std::visit([&](const auto& node) { check_stmt_node(node, s.span, expected_return); },
-                   s.node);
+        push_scope();
+        if (guard.has_value())
+        {
+            facts_.push_back(*guard);
+            guards_.push_back(*guard);
+        }
+        z3::expr falls_through = check_stmts(stmts, expected_return);
+        // The block's own names go out of scope here, and a later `let` of the same name would
+        // reuse their constants, so a condition over them says nothing afterwards.
+        const std::vector<std::string_view> local(
+            declared_.begin() + static_cast<std::ptrdiff_t>(scopes_.back().declared_size),
+            declared_.end());
+        if (mentions_any(falls_through, local))
+        {
+            falls_through = solver_.context().bool_val(true);
+        }
+        pop_scope();
+        return falls_through;
     }
 
-    void check_stmt_node(const LetStmt& s, Span, TypeKind)
+    z3::expr check_stmt_node(const LetStmt& s, Span, TypeKind)
     {
         // Verification scope only reasons about Int/Bool values.
         // Non-scalar bindings (e.g. structs/enums) are allowed as long as we don't
@@ -816,7 +1593,7 @@ class Verifier
                                  std::string(s.type.name) + "'"));
             }
             check_expr_for_calls(s.value);
-            return;
+            return solver_.context().bool_val(true);
         }
 
         if (core_t->kind != TypeKind::Int && core_t->kind != TypeKind::Bool)
@@ -825,7 +1602,7 @@ class Verifier
                 error_at(s.type.span, "verification does not support type '" +
                                           std::string(curlee::types::to_string(*core_t)) + "'"));
             check_expr_for_calls(s.value);
-            return;
+            return solver_.context().bool_val(true);
         }
 
         declare_var(s.name, core_t->kind);
@@ -836,40 +1613,36 @@ class Verifier
         }
 
         check_expr_for_calls(s.value);
+        return solver_.context().bool_val(true);
     }
 
-    void check_stmt_node(const ReturnStmt& s, Span, TypeKind expected_return)
+    z3::expr check_stmt_node(const ReturnStmt& s, Span, TypeKind expected_return)
     {
         if (s.value.has_value())
         {
             check_expr_for_calls(*s.value);
         }
         check_return(s, expected_return);
+        return solver_.context().bool_val(false);
     }
 
-    void check_stmt_node(const ExprStmt& s, Span, TypeKind) { check_expr_for_calls(s.expr); }
+    z3::expr check_stmt_node(const ExprStmt& s, Span, TypeKind)
+    {
+        check_expr_for_calls(s.expr);
+        return solver_.context().bool_val(true);
+    }
 
-    void check_stmt_node(const BlockStmt& s, Span, TypeKind expected_return)
+    z3::expr check_stmt_node(const BlockStmt& s, Span, TypeKind expected_return)
     {
-        push_scope();
-        for (const auto& stmt : s.block->stmts)
-        {
-            check_stmt(stmt, expected_return);
-        }
-        pop_scope();
+        return check_block(s.block->stmts, expected_return);
     }
 
-    void check_stmt_node(const UnsafeStmt& s, Span, TypeKind expected_return)
+    z3::expr check_stmt_node(const UnsafeStmt& s, Span, TypeKind expected_return)
     {
-        push_scope();
-        for (const auto& stmt : s.body->stmts)
-        {
-            check_stmt(stmt, expected_return);
-        }
-        pop_scope();
+        return check_block(s.body->stmts, expected_return);
     }
 
-    void check_stmt_node(const IfStmt& s, Span, TypeKind expected_return)
+    z3::expr check_stmt_node(const IfStmt& s, Span, TypeKind expected_return)
     {
         check_expr_for_calls(s.cond);
 
@@ -886,33 +1659,26 @@ class Verifier
             }
         }
 
-        push_scope();
-        if (cond_fact.has_value())
-        {
-            facts_.push_back(*cond_fact);
-        }
-        for (const auto& stmt : s.then_block->stmts)
-        {
-            check_stmt(stmt, expected_return);
-        }
-        pop_scope();
-
+        const z3::expr then_falls = check_block(s.then_block->stmts, expected_return, cond_fact);
+        z3::expr else_falls = solver_.context().bool_val(true);
         if (s.else_block != nullptr)
         {
-            push_scope();
+            std::optional<z3::expr> else_fact;
             if (cond_fact.has_value())
             {
-                facts_.push_back(!*cond_fact);
-            }
-            for (const auto& stmt : s.else_block->stmts)
-            {
-                check_stmt(stmt, expected_return);
+                else_fact = !*cond_fact;
             }
-            pop_scope();
+            else_falls = check_block(s.else_block->stmts, expected_return, else_fact);
         }
+
+        if (!cond_fact.has_value())
+        {
+            return then_falls || else_falls;
+        }
+        return (*cond_fact && then_falls) || (!*cond_fact && else_falls);
     }
 
-    void check_stmt_node(const WhileStmt& s, Span, TypeKind expected_return)
+    z3::expr check_stmt_node(const WhileStmt& s, Span, TypeKind expected_return)
     {
         check_expr_for_calls(s.cond);
 
@@ -929,16 +1695,10 @@ class Verifier
             }
         }
 
-        push_scope();
-        if (cond_fact.has_value())
-        {
-            facts_.push_back(*cond_fact);
-        }
-        for (const auto& stmt : s.body->stmts)
-        {
-            check_stmt(stmt, expected_return);
-        }
-        pop_scope();
+        // Leaving the loop says nothing about how many iterations ran, or whether they
+        // returned, so no condition is carried past it.
+        (void)check_block(s.body->stmts, expected_return, cond_fact);
+        return solver_.context().bool_val(true);
     }
 
     void check_function(const Function& f)
@@ -950,11 +1710,13 @@ class Verifier
         }
 
         current_function_ = sig_it->second;
+        function_name_ = f.name;
         lower_ctx_.result_int.reset();
         lower_ctx_.result_bool.reset();
         lower_ctx_.int_vars.clear();
         lower_ctx_.bool_vars.clear();
         facts_.clear();
+        guards_.clear();
         scopes_.clear();
 
         push_scope();
@@ -973,18 +1735,24 @@ class Verifier
         for (const auto& req : f.requires_clauses)
         {
             add_fact(req);
+            if (trust_requires_ && f.name != "main")
+            {
+                auto lowered = lower_predicate(req, lower_ctx_);
+                if (const auto* guard = std::get_if<z3::expr>(&lowered); guard != nullptr)
+                {
+                    guards_.push_back(*guard);
+                }
+            }
         }
 
-        for (const auto& stmt : f.body.stmts)
-        {
-            check_stmt(stmt, sig_it->second.result);
-        }
+        (void)check_stmts(f.body.stmts, sig_it->second.result);
 
         pop_scope();
         current_function_.reset();
     }
 
     std::optional<FunctionSig> current_function_;
+    std::string_view function_name_;
 };
 
 } // namespace
@@ -992,8 +1760,188 @@ class Verifier
 VerificationResult verify(const curlee::parser::Program& program,
                           const curlee::types::TypeInfo& type_info)
 {
-    Verifier verifier(type_info);
-    return verifier.run(program);
+    return verify(program, type_info, VerifyOptions{});
+}
+
+VerificationResult verify(const curlee::parser::Program& program,
+                          const curlee::types::TypeInfo& type_info, const VerifyOptions& options)
+{
+    std::vector<Diagnostic> diags;
+    const Signatures signatures = collect_signatures(program, diags);
+    const std::size_t count = program.functions.size();
+    std::vector<FunctionDeps> deps(count);
+    std::set<std::string_view> qualified_callees;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        collect_deps(program.functions[i].body, deps[i]);
+        qualified_callees.insert(deps[i].qualified_callees.begin(),
+                                 deps[i].qualified_callees.end());
+    }
+    // A function may assume its `requires` only if every call to it is checked against them:
+    // every caller is verified, and none calls it module-qualified. Those calls (to functions
+    // merged in from an import) are not checked. Verified on its own, an imported module has
+    // no such calls in view, so it trusts none.
+    const bool all_verified = signatures.size() == count && !options.imported_module;
+    auto trusts_requires = [&](const Function& f)
+    { return all_verified && !qualified_callees.contains(f.name); };
+    std::vector<FunctionOutcome> outcomes(count);
+    // Sessions and certificates both identify a function by its fingerprint.
+    const bool keyed = options.session != nullptr || options.certificate != nullptr ||
+                       options.record_certificate != nullptr;
+    std::vector<std::string> certificate_keys(count);
+    auto cancelled = [&]
+    { return options.solver.cancel != nullptr && options.solver.cancel->load(); };
+    auto verify_function = [&](std::size_t i)
+    {
+        const auto& f = program.functions[i];
+        if (!signatures.contains(f.name) || cancelled())
+        {
+            return;
+        }
+        if (!keyed)
+        {
+            outcomes[i] = Verifier(type_info, signatures, trusts_requires(f), options).run(f);
+            return;
+        }
+
+        // Expression ids move with every edit above a function, so proofs are stored
+        // relative to its first one.
+        const std::size_t base = deps[i].first_expr_id.value_or(0);
+        const std::string key = fingerprint(f, deps[i], signatures, trusts_requires(f),
+                                            options.solver.theory);
+        certificate_keys[i] = sha256_hex(key);
+        if (options.session != nullptr && options.record_certificate == nullptr)
+        {
+            if (const auto prior = options.session->lookup(f.name, key); prior.has_value())
+            {
+                for (const std::size_t offset : prior->proven_arithmetic)
+                {
+                    outcomes[i].proven_arithmetic.insert(base + offset);
+                }
+                outcomes[i].stats.reused = 1;
+                return;
+            }
+        }
+
+        const std::vector<ObligationHint>* hints = nullptr;
+        if (options.certificate != nullptr)
+        {
+            if (const auto it = options.certificate->functions.find(certificate_keys[i]);
+                it != options.certificate->functions.end())
+            {
+                hints = &it->second;
+            }
+        }
+        outcomes[i] = Verifier(type_info, signatures, trusts_requires(f), options, hints).run(f);
+        if (options.session == nullptr)
+        {
+            return;
+        }
+        // A cancelled function may have left arithmetic unproven without a diagnostic.
+        if (outcomes[i].diags.empty() && !cancelled())
+        {
+            FunctionResult result;
+            for (const std::size_t id : outcomes[i].proven_arithmetic)
+            {
+                result.proven_arithmetic.push_back(id - base);
+            }
+            std::sort(result.proven_arithmetic.begin(), result.proven_arithmetic.end());
+            options.session->store(f.name, key, result);
+        }
+    };
+
+    std::size_t jobs = options.jobs != 0 ? options.jobs : std::thread::hardware_concurrency();
+    jobs = std::min(jobs, count);
+    if (jobs <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            verify_function(i);
+        }
+    }
+    else
+    {
+        // Workers claim functions in order; outcomes are merged by function index below, so
+        // the result does not depend on scheduling.
+        std::atomic<std::size_t> next{0};
+        std::vector<std::exception_ptr> errors(jobs);
+        std::vector<std::thread> workers;
+        workers.reserve(jobs);
+        for (std::size_t w = 0; w < jobs; ++w)
+        {
+            workers.emplace_back(
+                [&, w]
+                {
+                    try
+                    {
+                        for (std::size_t i = next++; i < count; i = next++)
+                        {
+                            verify_function(i);
+                        }
+                    }
+                    catch (...)
+                    {
+                        errors[w] = std::current_exception();
+                        next = count;
+                    }
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        for (const auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    std::unordered_set<std::size_t> proven_arithmetic;
+    VerificationStats stats;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto& outcome = outcomes[i];
+        stats.presolved += outcome.stats.presolved;
+        stats.solver += outcome.stats.solver;
+        stats.cached += outcome.stats.cached;
+        stats.reused += outcome.stats.reused;
+        stats.certified += outcome.stats.certified;
+        if (options.record_certificate != nullptr && !certificate_keys[i].empty())
+        {
+            options.record_certificate->functions.insert_or_assign(certificate_keys[i],
+                                                                   std::move(outcome.hints));
+        }
+        if (options.profile != nullptr)
+        {
+            options.profile->insert(options.profile->end(),
+                                    std::make_move_iterator(outcome.profile.begin()),
+                                    std::make_move_iterator(outcome.profile.end()));
+        }
+        diags.insert(diags.end(), std::make_move_iterator(outcome.diags.begin()),
+                     std::make_move_iterator(outcome.diags.end()));
+        proven_arithmetic.merge(outcome.proven_arithmetic);
+    }
+    if (options.stats != nullptr)
+    {
+        *options.stats = stats;
+    }
+    // Functions skipped once the flag went up were never checked, so diags is incomplete.
+    if (cancelled())
+    {
+        Diagnostic d;
+        d.severity = Severity::Error;
+        d.message = "verification cancelled";
+        return std::vector<Diagnostic>{std::move(d)};
+    }
+
+    if (!diags.empty())
+    {
+        return diags;
+    }
+    return Verified{.proven_arithmetic = std::move(proven_arithmetic)};
 }
 
 } // namespace curlee::verification
@@ -0,0 +1,90 @@
+#include <curlee/verification/fact_slicing.h>
+#include <unordered_set>
+
+namespace curlee::verification
+{
+
+const std::vector<unsigned>& FactSlicer::vars_of(const z3::expr& e)
+{
+    if (const auto it = vars_.find(e.id()); it != vars_.end())
+    {
+        return it->second.second;
+    }
+
+    std::vector<unsigned> vars;
+    std::unordered_set<unsigned> seen;
+    std::vector<z3::expr> pending{e};
+    while (!pending.empty())
+    {
+        const z3::expr next = pending.back();
+        pending.pop_back();
+        if (!next.is_app() || !seen.insert(next.id()).second)
+        {
+            continue;
+        }
+        if (next.num_args() == 0)
+        {
+            if (next.decl().decl_kind() == Z3_OP_UNINTERPRETED)
+            {
+                vars.push_back(next.id());
+            }
+            continue;
+        }
+        for (unsigned i = 0; i < next.num_args(); ++i)
+        {
+            pending.push_back(next.arg(i));
+        }
+    }
+    return vars_.emplace(e.id(), std::make_pair(e, std::move(vars))).first->second.second;
+}
+
+std::vector<z3::expr> FactSlicer::slice(const std::vector<z3::expr>& facts,
+                                        const std::vector<z3::expr>& seeds)
+{
+    std::unordered_set<unsigned> relevant;
+    for (const auto& seed : seeds)
+    {
+        const auto& vars = vars_of(seed);
+        relevant.insert(vars.begin(), vars.end());
+    }
+
+    // Grow the cone until no remaining fact touches it.
+    std::vector<bool> selected(facts.size(), false);
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (std::size_t i = 0; i < facts.size(); ++i)
+        {
+            if (selected[i])
+            {
+                continue;
+            }
+            const auto& vars = vars_of(facts[i]);
+            bool touches = vars.empty();
+            for (const unsigned var : vars)
+            {
+                touches = touches || relevant.contains(var);
+            }
+            if (!touches)
+            {
+                continue;
+            }
+            selected[i] = true;
+            const std::size_t before = relevant.size();
+            relevant.insert(vars.begin(), vars.end());
+            changed = changed || relevant.size() != before;
+        }
+    }
+
+    std::vector<z3::expr> out;
+    for (std::size_t i = 0; i < facts.size(); ++i)
+    {
+        if (selected[i])
+        {
+            out.push_back(facts[i]);
+        }
+    }
+    return out;
+}
+
+} // namespace curlee::verification
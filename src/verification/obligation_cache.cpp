@@ -0,0 +1,248 @@
+#include <charconv>
+#include <curlee/verification/cache_file.h>
+#include <curlee/verification/obligation_cache.h>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+
+namespace curlee::verification
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/** Bumped whenever the entry layout or the query rendering changes. */
+constexpr std::string_view kEntryHeader = "curlee-obligation 1";
+constexpr std::string_view kEntrySuffix = ".obligation";
+
+/** Appends the uninterpreted constants of `e` not yet in `seen`, in pre-order. */
+void collect_constants(const z3::expr& e, std::unordered_set<unsigned>& seen,
+                       std::vector<z3::expr>& out)
+{
+    std::vector<z3::expr> pending{e};
+    while (!pending.empty())
+    {
+        const z3::expr next = pending.back();
+        pending.pop_back();
+        if (!next.is_app() || !seen.insert(next.id()).second)
+        {
+            continue;
+        }
+        if (next.num_args() == 0)
+        {
+            if (next.decl().decl_kind() == Z3_OP_UNINTERPRETED)
+            {
+                out.push_back(next);
+            }
+            continue;
+        }
+        for (unsigned i = next.num_args(); i > 0; --i)
+        {
+            pending.push_back(next.arg(i - 1));
+        }
+    }
+}
+
+[[nodiscard]] std::string serialize(const ObligationQuery& query, const ObligationVerdict& verdict)
+{
+    std::string out(kEntryHeader);
+    out += '\n';
+    out += verdict.result == CheckResult::Sat ? "sat\n" : "unsat\n";
+    out += "values " + std::to_string(verdict.model_values.size()) + "\n";
+    for (const auto& value : verdict.model_values)
+    {
+        out += value;
+        out += '\n';
+    }
+    out += query.text;
+    return out;
+}
+
+[[nodiscard]] std::optional<ObligationVerdict> deserialize(const std::string& bytes,
+                                                           const ObligationQuery& query)
+{
+    std::size_t pos = 0;
+    auto next_line = [&]() -> std::optional<std::string_view>
+    {
+        const auto nl = bytes.find('\n', pos);
+        if (nl == std::string::npos)
+        {
+            return std::nullopt;
+        }
+        const std::string_view line(bytes.data() + pos, nl - pos);
+        pos = nl + 1;
+        return line;
+    };
+
+    if (next_line() != kEntryHeader)
+    {
+        return std::nullopt;
+    }
+
+    ObligationVerdict verdict;
+    const auto result = next_line();
+    if (result == "sat")
+    {
+        verdict.result = CheckResult::Sat;
+    }
+    else if (result != "unsat")
+    {
+        return std::nullopt;
+    }
+
+    const auto count_line = next_line();
+    if (!count_line.has_value() || !count_line->starts_with("values "))
+    {
+        return std::nullopt;
+    }
+    const auto digits = count_line->substr(7);
+    std::size_t count = 0;
+    const auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), count);
+    if (ec != std::errc{} || ptr != digits.data() + digits.size())
+    {
+        return std::nullopt;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto value = next_line();
+        if (!value.has_value())
+        {
+            return std::nullopt;
+        }
+        verdict.model_values.emplace_back(*value);
+    }
+
+    if (std::string_view(bytes).substr(pos) != query.text)
+    {
+        return std::nullopt;
+    }
+    return verdict;
+}
+
+} // namespace
+
+ObligationQuery normalize_query(const std::vector<z3::expr>& facts, const z3::expr& goal,
+                                const std::vector<z3::expr>& model_vars, IntTheory theory)
+{
+    std::unordered_set<unsigned> seen;
+    std::vector<z3::expr> constants;
+    for (const auto& fact : facts)
+    {
+        collect_constants(fact, seen, constants);
+    }
+    collect_constants(goal, seen, constants);
+    for (const auto& var : model_vars)
+    {
+        collect_constants(var, seen, constants);
+    }
+
+    // Every constant is renamed at once, so an original named like a canonical one is harmless.
+    auto& ctx = goal.ctx();
+    z3::expr_vector from(ctx);
+    z3::expr_vector to(ctx);
+    std::string text;
+    for (std::size_t i = 0; i < constants.size(); ++i)
+    {
+        const std::string name = "v" + std::to_string(i);
+        from.push_back(constants[i]);
+        to.push_back(ctx.constant(name.c_str(), constants[i].get_sort()));
+        text += "(declare-const " + name + " " + constants[i].get_sort().to_string() + ")\n";
+    }
+
+    auto rename = [&](z3::expr e) { return e.substitute(from, to).to_string(); };
+    for (const auto& fact : facts)
+    {
+        text += "(assert " + rename(fact) + ")\n";
+    }
+    text += "(goal " + rename(goal) + ")\n";
+    text += "(model";
+    for (const auto& var : model_vars)
+    {
+        text += " " + rename(var);
+    }
+    text += ")\n";
+    // Bit-vector and auto prove the same goals, so they share entries; integer queries keep
+    // the text they had before theories were selectable.
+    if (theory != IntTheory::Integer)
+    {
+        text += "(int64 variables)\n";
+    }
+
+    std::string key = sha256_hex(text);
+    return ObligationQuery{.text = std::move(text), .key = std::move(key)};
+}
+
+ObligationCache::ObligationCache(fs::path dir) : dir_(std::move(dir)) {}
+
+ObligationCache::ObligationCache(std::size_t max_verdicts) : verdicts_(max_verdicts) {}
+
+std::optional<ObligationVerdict> ObligationCache::lookup(const ObligationQuery& query)
+{
+    {
+        const std::lock_guard lock(mutex_);
+        if (const ObligationVerdict* verdict = verdicts_.find(query.text); verdict != nullptr)
+        {
+            return *verdict;
+        }
+    }
+    if (!dir_.has_value())
+    {
+        return std::nullopt;
+    }
+
+    const fs::path path = *dir_ / (query.key + std::string(kEntrySuffix));
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+    auto verdict = deserialize(bytes, query);
+    if (verdict.has_value())
+    {
+        // Recency for CompileCache::evict(); losing this race to another process is harmless.
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        const std::lock_guard lock(mutex_);
+        verdicts_.emplace(query.text, *verdict);
+    }
+    return verdict;
+}
+
+void ObligationCache::store(const ObligationQuery& query, const ObligationVerdict& verdict)
+{
+    if (verdict.result != CheckResult::Sat && verdict.result != CheckResult::Unsat)
+    {
+        return;
+    }
+    {
+        const std::lock_guard lock(mutex_);
+        if (!verdicts_.emplace(query.text, verdict))
+        {
+            return;
+        }
+    }
+    if (!dir_.has_value())
+    {
+        return;
+    }
+    // The entry format is line based.
+    for (const auto& value : verdict.model_values)
+    {
+        if (value.find('\n') != std::string::npos)
+        {
+            return;
+        }
+    }
+
+    write_file_atomically(*dir_ / (query.key + std::string(kEntrySuffix)),
+                          serialize(query, verdict));
+}
+
+} // namespace curlee::verification
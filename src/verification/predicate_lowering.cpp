@@ -172,7 +172,7 @@ TypedResult lower_node(const curlee::parser::Pred& pred, const LoweringContext&
                     {
                         return error_at(pred.span, "'*' expects Int predicates");
                     }
-                    if (!left.is_literal && !right.is_literal)
+                    if (!left.is_literal && !right.is_literal && !ctx.nonlinear)
                     {
                         return error_at(pred.span, "non-linear multiplication is not supported");
                     }
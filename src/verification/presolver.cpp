@@ -0,0 +1,591 @@
+#include <algorithm>
+#include <curlee/verification/presolver.h>
+#include <limits>
+#include <utility>
+
+namespace curlee::verification
+{
+namespace
+{
+
+using Bound = std::optional<std::int64_t>;
+
+// Interval arithmetic over int64 bounds. A bound that would overflow is dropped, which only
+// widens the interval, so every result still contains all possible values.
+[[nodiscard]] Bound add_bound(Bound a, Bound b)
+{
+    std::int64_t out = 0;
+    if (!a.has_value() || !b.has_value() || __builtin_add_overflow(*a, *b, &out))
+    {
+        return std::nullopt;
+    }
+    return out;
+}
+
+[[nodiscard]] Bound mul_bound(Bound a, std::int64_t b)
+{
+    std::int64_t out = 0;
+    if (!a.has_value() || __builtin_mul_overflow(*a, b, &out))
+    {
+        return std::nullopt;
+    }
+    return out;
+}
+
+[[nodiscard]] Bound neg_bound(Bound a)
+{
+    if (!a.has_value() || *a == std::numeric_limits<std::int64_t>::min())
+    {
+        return std::nullopt;
+    }
+    return -*a;
+}
+
+[[nodiscard]] std::optional<std::int64_t> point(const Interval& i)
+{
+    if (i.lo.has_value() && i.hi.has_value() && *i.lo == *i.hi)
+    {
+        return i.lo;
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] Interval add(const Interval& a, const Interval& b)
+{
+    return Interval{.lo = add_bound(a.lo, b.lo), .hi = add_bound(a.hi, b.hi)};
+}
+
+[[nodiscard]] Interval neg(const Interval& a)
+{
+    return Interval{.lo = neg_bound(a.hi), .hi = neg_bound(a.lo)};
+}
+
+[[nodiscard]] Interval scale(const Interval& a, std::int64_t c)
+{
+    if (c == 0)
+    {
+        return Interval{.lo = 0, .hi = 0};
+    }
+    const Bound lo = mul_bound(a.lo, c);
+    const Bound hi = mul_bound(a.hi, c);
+    return c > 0 ? Interval{.lo = lo, .hi = hi} : Interval{.lo = hi, .hi = lo};
+}
+
+[[nodiscard]] Interval mul(const Interval& a, const Interval& b)
+{
+    if (const auto c = point(b); c.has_value())
+    {
+        return scale(a, *c);
+    }
+    if (const auto c = point(a); c.has_value())
+    {
+        return scale(b, *c);
+    }
+    if (!a.lo.has_value() || !a.hi.has_value() || !b.lo.has_value() || !b.hi.has_value())
+    {
+        return Interval{};
+    }
+    Interval out{.lo = std::numeric_limits<std::int64_t>::max(),
+                 .hi = std::numeric_limits<std::int64_t>::min()};
+    for (const std::int64_t x : {*a.lo, *a.hi})
+    {
+        for (const std::int64_t y : {*b.lo, *b.hi})
+        {
+            std::int64_t corner = 0;
+            if (__builtin_mul_overflow(x, y, &corner))
+            {
+                return Interval{};
+            }
+            out.lo = std::min(*out.lo, corner);
+            out.hi = std::max(*out.hi, corner);
+        }
+    }
+    return out;
+}
+
+[[nodiscard]] Interval join(const Interval& a, const Interval& b)
+{
+    Interval out;
+    if (a.lo.has_value() && b.lo.has_value())
+    {
+        out.lo = std::min(*a.lo, *b.lo);
+    }
+    if (a.hi.has_value() && b.hi.has_value())
+    {
+        out.hi = std::max(*a.hi, *b.hi);
+    }
+    return out;
+}
+
+[[nodiscard]] Z3_decl_kind kind_of(const z3::expr& e)
+{
+    return e.is_app() ? e.decl().decl_kind() : Z3_OP_UNINTERPRETED;
+}
+
+[[nodiscard]] bool is_int_const(const z3::expr& e)
+{
+    return e.is_int() && e.is_app() && e.num_args() == 0 &&
+           e.decl().decl_kind() == Z3_OP_UNINTERPRETED;
+}
+
+[[nodiscard]] bool is_comparison(Z3_decl_kind kind)
+{
+    switch (kind)
+    {
+    case Z3_OP_LE:
+    case Z3_OP_LT:
+    case Z3_OP_GE:
+    case Z3_OP_GT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// `!(a op b)` as `a negated(op) b`.
+[[nodiscard]] Z3_decl_kind negated(Z3_decl_kind kind)
+{
+    switch (kind)
+    {
+    case Z3_OP_LE:
+        return Z3_OP_GT;
+    case Z3_OP_LT:
+        return Z3_OP_GE;
+    case Z3_OP_GE:
+        return Z3_OP_LT;
+    case Z3_OP_GT:
+        return Z3_OP_LE;
+    case Z3_OP_EQ:
+        return Z3_OP_DISTINCT;
+    default:
+        return Z3_OP_EQ;
+    }
+}
+
+// `a op b` as `b mirrored(op) a`.
+[[nodiscard]] Z3_decl_kind mirrored(Z3_decl_kind kind)
+{
+    switch (kind)
+    {
+    case Z3_OP_LE:
+        return Z3_OP_GE;
+    case Z3_OP_LT:
+        return Z3_OP_GT;
+    case Z3_OP_GE:
+        return Z3_OP_LE;
+    case Z3_OP_GT:
+        return Z3_OP_LT;
+    default:
+        return kind;
+    }
+}
+
+// Truth of `d op 0` given the interval of d.
+[[nodiscard]] std::optional<bool> compare_to_zero(Z3_decl_kind kind, const Interval& d)
+{
+    const bool pos = d.lo.has_value() && *d.lo > 0;
+    const bool nonneg = d.lo.has_value() && *d.lo >= 0;
+    const bool neg = d.hi.has_value() && *d.hi < 0;
+    const bool nonpos = d.hi.has_value() && *d.hi <= 0;
+    auto decide = [](bool yes, bool no) -> std::optional<bool>
+    {
+        if (yes)
+        {
+            return true;
+        }
+        if (no)
+        {
+            return false;
+        }
+        return std::nullopt;
+    };
+    switch (kind)
+    {
+    case Z3_OP_LE:
+        return decide(nonpos, pos);
+    case Z3_OP_LT:
+        return decide(neg, nonneg);
+    case Z3_OP_GE:
+        return decide(nonneg, neg);
+    case Z3_OP_GT:
+        return decide(pos, nonpos);
+    case Z3_OP_EQ:
+        return decide(nonneg && nonpos, pos || neg);
+    case Z3_OP_DISTINCT:
+        return decide(pos || neg, nonneg && nonpos);
+    default:
+        return std::nullopt;
+    }
+}
+
+/** @brief constant + sum(coefficient * term), with syntactically equal terms merged. */
+struct Linear
+{
+    std::int64_t constant = 0;
+    std::vector<std::pair<z3::expr, std::int64_t>> terms;
+};
+
+// Add `coef * e` to `out`; false when a coefficient overflows.
+[[nodiscard]] bool linearize(const z3::expr& e, std::int64_t coef, Linear& out)
+{
+    std::int64_t value = 0;
+    if (e.is_numeral_i64(value))
+    {
+        std::int64_t scaled = 0;
+        return !__builtin_mul_overflow(value, coef, &scaled) &&
+               !__builtin_add_overflow(out.constant, scaled, &out.constant);
+    }
+
+    const bool negatable = coef != std::numeric_limits<std::int64_t>::min();
+    switch (kind_of(e))
+    {
+    case Z3_OP_ADD:
+        for (unsigned i = 0; i < e.num_args(); ++i)
+        {
+            if (!linearize(e.arg(i), coef, out))
+            {
+                return false;
+            }
+        }
+        return true;
+    case Z3_OP_SUB:
+        if (!negatable)
+        {
+            return false;
+        }
+        for (unsigned i = 0; i < e.num_args(); ++i)
+        {
+            if (!linearize(e.arg(i), i == 0 ? coef : -coef, out))
+            {
+                return false;
+            }
+        }
+        return true;
+    case Z3_OP_UMINUS:
+        return negatable && linearize(e.arg(0), -coef, out);
+    case Z3_OP_MUL:
+        if (e.num_args() == 2)
+        {
+            for (unsigned i = 0; i < 2; ++i)
+            {
+                std::int64_t factor = 0;
+                std::int64_t scaled = 0;
+                if (e.arg(i).is_numeral_i64(factor))
+                {
+                    return !__builtin_mul_overflow(coef, factor, &scaled) &&
+                           linearize(e.arg(1 - i), scaled, out);
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    for (auto& [term, c] : out.terms)
+    {
+        if (term.id() == e.id())
+        {
+            return !__builtin_add_overflow(c, coef, &c);
+        }
+    }
+    out.terms.emplace_back(e, coef);
+    return true;
+}
+
+} // namespace
+
+void Presolver::assume(const z3::expr& fact)
+{
+    if (inconsistent_)
+    {
+        return;
+    }
+    if (eval_bool(fact) == false)
+    {
+        inconsistent_ = true;
+        return;
+    }
+    assume_atom(fact, true);
+}
+
+bool Presolver::proves(const z3::expr& goal) const
+{
+    // Contradictory facts have no models, so every goal holds (Z3 would answer unsat too).
+    return inconsistent_ || eval_bool(goal) == true;
+}
+
+void Presolver::assume_atom(const z3::expr& atom, bool value)
+{
+    auto& known = value ? known_true_ : known_false_;
+    const auto& opposite = value ? known_false_ : known_true_;
+    if (opposite.contains(atom.id()))
+    {
+        inconsistent_ = true;
+        return;
+    }
+    known.insert(atom.id());
+
+    const Z3_decl_kind kind = kind_of(atom);
+    if (kind == Z3_OP_NOT)
+    {
+        assume_atom(atom.arg(0), !value);
+        return;
+    }
+    if ((kind == Z3_OP_AND && value) || (kind == Z3_OP_OR && !value))
+    {
+        for (unsigned i = 0; i < atom.num_args(); ++i)
+        {
+            assume_atom(atom.arg(i), value);
+        }
+        return;
+    }
+    if (kind == Z3_OP_IMPLIES && !value)
+    {
+        assume_atom(atom.arg(0), true);
+        assume_atom(atom.arg(1), false);
+        return;
+    }
+    if (atom.num_args() != 2 ||
+        !(is_comparison(kind) || kind == Z3_OP_EQ || kind == Z3_OP_DISTINCT))
+    {
+        return;
+    }
+
+    const z3::expr lhs = atom.arg(0);
+    const z3::expr rhs = atom.arg(1);
+    if (lhs.is_bool())
+    {
+        // `b == <known>` (as in `result == true`) decides b.
+        const bool equal = (kind == Z3_OP_EQ) == value;
+        if (const auto r = eval_bool(rhs); r.has_value())
+        {
+            assume_atom(lhs, *r == equal);
+        }
+        else if (const auto l = eval_bool(lhs); l.has_value())
+        {
+            assume_atom(rhs, *l == equal);
+        }
+        return;
+    }
+
+    const Z3_decl_kind op = value ? kind : negated(kind);
+    auto constrain = [&](const z3::expr& var, Z3_decl_kind var_op, const Interval& other)
+    {
+        if (!is_int_const(var))
+        {
+            return;
+        }
+        switch (var_op)
+        {
+        case Z3_OP_LE:
+            bound(var, Interval{.lo = std::nullopt, .hi = other.hi});
+            break;
+        case Z3_OP_LT:
+            bound(var, Interval{.lo = std::nullopt, .hi = add_bound(other.hi, -1)});
+            break;
+        case Z3_OP_GE:
+            bound(var, Interval{.lo = other.lo, .hi = std::nullopt});
+            break;
+        case Z3_OP_GT:
+            bound(var, Interval{.lo = add_bound(other.lo, 1), .hi = std::nullopt});
+            break;
+        case Z3_OP_EQ:
+            bound(var, other);
+            break;
+        case Z3_OP_DISTINCT:
+            // Only an excluded endpoint tightens an interval.
+            if (const auto p = point(other); p.has_value())
+            {
+                const Interval current = eval_int(var);
+                if (current.lo == p)
+                {
+                    bound(var, Interval{.lo = add_bound(p, 1), .hi = std::nullopt});
+                }
+                else if (current.hi == p)
+                {
+                    bound(var, Interval{.lo = std::nullopt, .hi = add_bound(p, -1)});
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    };
+    const Interval lhs_range = eval_int(lhs);
+    constrain(lhs, op, eval_int(rhs));
+    constrain(rhs, mirrored(op), lhs_range);
+}
+
+void Presolver::bound(const z3::expr& var, const Interval& range)
+{
+    auto& current = bounds_[var.id()];
+    if (range.lo.has_value() && (!current.lo.has_value() || *range.lo > *current.lo))
+    {
+        current.lo = range.lo;
+    }
+    if (range.hi.has_value() && (!current.hi.has_value() || *range.hi < *current.hi))
+    {
+        current.hi = range.hi;
+    }
+    if (current.lo.has_value() && current.hi.has_value() && *current.lo > *current.hi)
+    {
+        inconsistent_ = true;
+    }
+}
+
+std::optional<bool> Presolver::eval_bool(const z3::expr& e) const
+{
+    if (known_true_.contains(e.id()))
+    {
+        return true;
+    }
+    if (known_false_.contains(e.id()))
+    {
+        return false;
+    }
+
+    const Z3_decl_kind kind = kind_of(e);
+    switch (kind)
+    {
+    case Z3_OP_TRUE:
+        return true;
+    case Z3_OP_FALSE:
+        return false;
+    case Z3_OP_NOT:
+        if (const auto v = eval_bool(e.arg(0)); v.has_value())
+        {
+            return !*v;
+        }
+        return std::nullopt;
+    case Z3_OP_AND:
+    case Z3_OP_OR:
+    {
+        // The absorbing value decides the whole connective; otherwise every operand must agree.
+        const bool absorbing = kind == Z3_OP_OR;
+        bool all_known = true;
+        for (unsigned i = 0; i < e.num_args(); ++i)
+        {
+            const auto v = eval_bool(e.arg(i));
+            if (v == absorbing)
+            {
+                return absorbing;
+            }
+            all_known = all_known && v.has_value();
+        }
+        return all_known ? std::optional<bool>(!absorbing) : std::nullopt;
+    }
+    case Z3_OP_IMPLIES:
+    {
+        const auto premise = eval_bool(e.arg(0));
+        const auto conclusion = eval_bool(e.arg(1));
+        if (premise == false || conclusion == true)
+        {
+            return true;
+        }
+        if (premise == true && conclusion == false)
+        {
+            return false;
+        }
+        return std::nullopt;
+    }
+    case Z3_OP_ITE:
+        if (const auto c = eval_bool(e.arg(0)); c.has_value())
+        {
+            return eval_bool(e.arg(*c ? 1 : 2));
+        }
+        return std::nullopt;
+    case Z3_OP_EQ:
+    case Z3_OP_DISTINCT:
+    case Z3_OP_LE:
+    case Z3_OP_LT:
+    case Z3_OP_GE:
+    case Z3_OP_GT:
+        break;
+    default:
+        return std::nullopt;
+    }
+
+    if (e.num_args() != 2)
+    {
+        return std::nullopt;
+    }
+    const z3::expr lhs = e.arg(0);
+    const z3::expr rhs = e.arg(1);
+    if (lhs.is_bool())
+    {
+        const auto l = eval_bool(lhs);
+        const auto r = eval_bool(rhs);
+        if (lhs.id() == rhs.id())
+        {
+            return kind == Z3_OP_EQ;
+        }
+        if (!l.has_value() || !r.has_value())
+        {
+            return std::nullopt;
+        }
+        return (*l == *r) == (kind == Z3_OP_EQ);
+    }
+
+    // Compare lhs - rhs against zero, cancelling common terms first so that `x + 1 > x`
+    // holds without any bound on x.
+    Linear diff;
+    if (!linearize(lhs, 1, diff) || !linearize(rhs, -1, diff))
+    {
+        return compare_to_zero(kind, add(eval_int(lhs), neg(eval_int(rhs))));
+    }
+    Interval range{.lo = diff.constant, .hi = diff.constant};
+    for (const auto& [term, coef] : diff.terms)
+    {
+        if (coef != 0)
+        {
+            range = add(range, scale(eval_int(term), coef));
+        }
+    }
+    return compare_to_zero(kind, range);
+}
+
+Interval Presolver::eval_int(const z3::expr& e) const
+{
+    std::int64_t value = 0;
+    if (e.is_numeral_i64(value))
+    {
+        return Interval{.lo = value, .hi = value};
+    }
+    if (is_int_const(e))
+    {
+        const auto it = bounds_.find(e.id());
+        return it != bounds_.end() ? it->second : Interval{};
+    }
+
+    switch (kind_of(e))
+    {
+    case Z3_OP_ADD:
+    case Z3_OP_SUB:
+    case Z3_OP_MUL:
+    {
+        const Z3_decl_kind kind = kind_of(e);
+        Interval out = eval_int(e.arg(0));
+        for (unsigned i = 1; i < e.num_args(); ++i)
+        {
+            const Interval arg = eval_int(e.arg(i));
+            out = kind == Z3_OP_ADD ? add(out, arg)
+                  : kind == Z3_OP_SUB ? add(out, neg(arg))
+                                      : mul(out, arg);
+        }
+        return out;
+    }
+    case Z3_OP_UMINUS:
+        return neg(eval_int(e.arg(0)));
+    case Z3_OP_ITE:
+        if (const auto c = eval_bool(e.arg(0)); c.has_value())
+        {
+            return eval_int(e.arg(*c ? 1 : 2));
+        }
+        return join(eval_int(e.arg(1)), eval_int(e.arg(2)));
+    default:
+        return Interval{};
+    }
+}
+
+} // namespace curlee::verification
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <curlee/diag/json.h>
+#include <curlee/verification/profile.h>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+namespace curlee::verification
+{
+
+namespace
+{
+
+[[nodiscard]] std::string millis(std::uint64_t micros)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << static_cast<double>(micros) / 1000.0;
+    return out.str();
+}
+
+[[nodiscard]] std::string megabytes(double mb)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << mb;
+    return out.str();
+}
+
+using curlee::diag::json_escape;
+
+[[nodiscard]] std::uint64_t total_micros(const std::vector<ObligationProfile>& profiles)
+{
+    return std::accumulate(profiles.begin(), profiles.end(), std::uint64_t{0},
+                           [](std::uint64_t sum, const ObligationProfile& p)
+                           { return sum + p.micros; });
+}
+
+} // namespace
+
+std::string_view obligation_kind_name(ObligationKind kind)
+{
+    switch (kind)
+    {
+    case ObligationKind::Ensures:
+        return "ensures";
+    case ObligationKind::CallRequires:
+        return "call-requires";
+    case ObligationKind::Arithmetic:
+        return "arithmetic";
+    }
+    return "ensures"; // GCOVR_EXCL_LINE
+}
+
+std::string_view settlement_name(Settlement settlement)
+{
+    switch (settlement)
+    {
+    case Settlement::Presolver:
+        return "presolver";
+    case Settlement::Certificate:
+        return "certificate";
+    case Settlement::Cache:
+        return "cache";
+    case Settlement::Solver:
+        return "solver";
+    }
+    return "solver"; // GCOVR_EXCL_LINE
+}
+
+std::string_view verdict_name(CheckResult verdict)
+{
+    switch (verdict)
+    {
+    case CheckResult::Unsat:
+        return "proven";
+    case CheckResult::Sat:
+        return "refuted";
+    case CheckResult::Unknown:
+        return "unknown";
+    case CheckResult::BudgetExceeded:
+        return "budget";
+    }
+    return "unknown"; // GCOVR_EXCL_LINE
+}
+
+std::string
+render_verification_profile(const std::vector<ObligationProfile>& profiles,
+                            const std::function<std::string(const ObligationProfile&)>& where)
+{
+    std::ostringstream out;
+    out << "verification: " << profiles.size() << " obligations, "
+        << millis(total_micros(profiles)) << " ms";
+    // Layers in the order an obligation meets them.
+    for (const auto settlement : {Settlement::Certificate, Settlement::Presolver,
+                                  Settlement::Cache, Settlement::Solver})
+    {
+        const auto count =
+            std::count_if(profiles.begin(), profiles.end(), [&](const ObligationProfile& p)
+                          { return p.settled_by == settlement; });
+        out << (settlement == Settlement::Certificate ? " (" : ", ")
+            << settlement_name(settlement) << " " << count;
+    }
+    out << ")\n";
+
+    out << "\nobligations (by time):\n";
+    out << "  " << std::right << std::setw(10) << "ms" << std::setw(7) << "facts"
+        << std::setw(11) << "conflicts" << std::setw(11) << "decisions" << std::setw(10)
+        << "mem MB" << "  " << std::left << std::setw(9) << "verdict" << std::setw(13)
+        << "settled by" << std::setw(15) << "kind" << std::setw(16) << "function"
+        << "location\n";
+    std::vector<const ObligationProfile*> order;
+    order.reserve(profiles.size());
+    for (const auto& profile : profiles)
+    {
+        order.push_back(&profile);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const ObligationProfile* a, const ObligationProfile* b)
+                     { return a->micros > b->micros; });
+    for (const auto* p : order)
+    {
+        out << "  " << std::right << std::setw(10) << millis(p->micros) << std::setw(7)
+            << p->facts << std::setw(11) << p->statistics.conflicts << std::setw(11)
+            << p->statistics.decisions << std::setw(10) << megabytes(p->statistics.memory_mb)
+            << "  " << std::left << std::setw(9) << verdict_name(p->verdict) << std::setw(13)
+            << settlement_name(p->settled_by) << std::setw(15) << obligation_kind_name(p->kind)
+            << std::setw(16) << p->function << where(*p) << "\n";
+    }
+    return out.str();
+}
+
+std::string
+verification_profile_json(const std::vector<ObligationProfile>& profiles,
+                          const std::function<std::string(const ObligationProfile&)>& where)
+{
+    std::ostringstream out;
+    out << "{\"total_micros\":" << total_micros(profiles) << ",\"obligations\":[";
+    for (std::size_t i = 0; i < profiles.size(); ++i)
+    {
+        const auto& p = profiles[i];
+        out << (i > 0 ? "," : "") << "{\"function\":\"" << json_escape(p.function)
+            << "\",\"kind\":\"" << obligation_kind_name(p.kind) << "\",\"location\":\""
+            << json_escape(where(p)) << "\",\"facts\":" << p.facts
+            << ",\"micros\":" << p.micros << ",\"settled_by\":\""
+            << settlement_name(p.settled_by) << "\",\"verdict\":\"" << verdict_name(p.verdict)
+            << "\",\"conflicts\":" << p.statistics.conflicts
+            << ",\"decisions\":" << p.statistics.decisions
+            << ",\"memory_mb\":" << megabytes(p.statistics.memory_mb) << "}";
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+} // namespace curlee::verification
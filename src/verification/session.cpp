@@ -0,0 +1,134 @@
+#include <charconv>
+#include <curlee/verification/cache_file.h>
+#include <curlee/verification/session.h>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace curlee::verification
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/** Bumped whenever the entry layout or the fingerprint rendering changes. */
+constexpr std::string_view kEntryHeader = "curlee-function 1";
+constexpr std::string_view kEntrySuffix = ".function";
+
+[[nodiscard]] std::string serialize(const std::string& fingerprint, const FunctionResult& result)
+{
+    std::string out(kEntryHeader);
+    out += "\nproven";
+    for (const std::size_t offset : result.proven_arithmetic)
+    {
+        out += " " + std::to_string(offset);
+    }
+    out += '\n';
+    out += fingerprint;
+    return out;
+}
+
+[[nodiscard]] std::optional<FunctionResult> deserialize(const std::string& bytes,
+                                                        const std::string& fingerprint)
+{
+    const std::string_view view(bytes);
+    const auto header_end = view.find('\n');
+    if (header_end == std::string_view::npos || view.substr(0, header_end) != kEntryHeader)
+    {
+        return std::nullopt;
+    }
+    const auto proven_end = view.find('\n', header_end + 1);
+    if (proven_end == std::string_view::npos ||
+        view.substr(proven_end + 1) != std::string_view(fingerprint))
+    {
+        return std::nullopt;
+    }
+
+    std::string_view proven = view.substr(header_end + 1, proven_end - header_end - 1);
+    if (!proven.starts_with("proven"))
+    {
+        return std::nullopt;
+    }
+    proven.remove_prefix(6);
+
+    FunctionResult result;
+    while (!proven.empty())
+    {
+        if (proven.front() != ' ')
+        {
+            return std::nullopt;
+        }
+        proven.remove_prefix(1);
+        std::size_t offset = 0;
+        const auto [ptr, ec] = std::from_chars(proven.data(), proven.data() + proven.size(), offset);
+        if (ec != std::errc{})
+        {
+            return std::nullopt;
+        }
+        result.proven_arithmetic.push_back(offset);
+        proven.remove_prefix(static_cast<std::size_t>(ptr - proven.data()));
+    }
+    return result;
+}
+
+} // namespace
+
+VerificationSession::VerificationSession(fs::path dir) : dir_(std::move(dir)) {}
+
+VerificationSession::VerificationSession(std::size_t max_functions) : results_(max_functions) {}
+
+std::optional<FunctionResult> VerificationSession::lookup(std::string_view function,
+                                                          const std::string& fingerprint)
+{
+    {
+        const std::lock_guard lock(mutex_);
+        if (const auto* stored = results_.find(function);
+            stored != nullptr && stored->first == fingerprint)
+        {
+            return stored->second;
+        }
+    }
+    if (!dir_.has_value())
+    {
+        return std::nullopt;
+    }
+
+    const fs::path path = *dir_ / (sha256_hex(fingerprint) + std::string(kEntrySuffix));
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+    auto result = deserialize(bytes, fingerprint);
+    if (result.has_value())
+    {
+        // Recency for CompileCache::evict(); losing this race to another process is harmless.
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        const std::lock_guard lock(mutex_);
+        results_.insert_or_assign(std::string(function), std::make_pair(fingerprint, *result));
+    }
+    return result;
+}
+
+void VerificationSession::store(std::string_view function, const std::string& fingerprint,
+                                const FunctionResult& result)
+{
+    {
+        const std::lock_guard lock(mutex_);
+        results_.insert_or_assign(std::string(function), std::make_pair(fingerprint, result));
+    }
+    if (!dir_.has_value())
+    {
+        return;
+    }
+
+    write_file_atomically(*dir_ / (sha256_hex(fingerprint) + std::string(kEntrySuffix)),
+                          serialize(fingerprint, result));
+}
+
+} // namespace curlee::verification
@@ -1,11 +1,821 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <curlee/verification/solver.h>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace curlee::verification
 {
 
-Solver::Solver() : solver_(ctx_) {}
+namespace
+{
+
+// Only the rlimit is a solver parameter: Z3's shared timer threads can lose a "timeout" when
+// several contexts check concurrently (as under -j or --portfolio), so the time budget is
+// enforced by a Watchdog instead.
+z3::params budget_params(z3::context& ctx, const SolverOptions& options)
+{
+    z3::params params(ctx);
+    if (options.rlimit != 0)
+    {
+        params.set("rlimit", options.rlimit);
+    }
+    return params;
+}
+
+/**
+ * @brief The one thread that enforces time budgets and cancel flags for every check in the
+ * process, so a check does not pay for starting a thread of its own.
+ *
+ * It sleeps until the earliest deadline, looking at cancel flags every millisecond while any
+ * armed check has one. A check past its deadline or cancelled is interrupted every millisecond
+ * until disarmed, because Z3 drops an interrupt that arrives before check() starts.
+ */
+class WatchdogThread
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static WatchdogThread& instance()
+    {
+        static WatchdogThread watchdog;
+        return watchdog;
+    }
+
+    WatchdogThread(const WatchdogThread&) = delete;
+    WatchdogThread& operator=(const WatchdogThread&) = delete;
+
+    [[nodiscard]] std::uint64_t arm(z3::context& ctx, Clock::time_point deadline,
+                                    const std::atomic<bool>* cancel)
+    {
+        std::uint64_t id = 0;
+        {
+            const std::lock_guard lock(mutex_);
+            id = next_id_++;
+            armed_.emplace(id, Armed{.ctx = &ctx, .deadline = deadline, .cancel = cancel});
+        }
+        cv_.notify_all();
+        return id;
+    }
+
+    /** After this returns, the context is never interrupted on behalf of `id` again. */
+    void disarm(std::uint64_t id)
+    {
+        const std::lock_guard lock(mutex_);
+        armed_.erase(id);
+    }
+
+  private:
+    struct Armed
+    {
+        z3::context* ctx;
+        Clock::time_point deadline;
+        const std::atomic<bool>* cancel;
+    };
+
+    WatchdogThread() : thread_([this] { run(); }) {}
+
+    ~WatchdogThread()
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void run()
+    {
+        std::unique_lock lock(mutex_);
+        while (!stopping_)
+        {
+            const auto now = Clock::now();
+            auto wake = Clock::time_point::max();
+            for (const auto& [id, armed] : armed_)
+            {
+                const bool cancelled = armed.cancel != nullptr && armed.cancel->load();
+                if (cancelled || now >= armed.deadline)
+                {
+                    armed.ctx->interrupt();
+                    wake = std::min(wake, now + std::chrono::milliseconds(1));
+                    continue;
+                }
+                wake = std::min(wake, armed.cancel == nullptr
+                                          ? armed.deadline
+                                          : now + std::chrono::milliseconds(1));
+            }
+            if (wake == Clock::time_point::max())
+            {
+                cv_.wait(lock);
+            }
+            else
+            {
+                cv_.wait_until(lock, wake);
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::uint64_t next_id_ = 0;
+    std::unordered_map<std::uint64_t, Armed> armed_;
+    std::thread thread_;
+};
+
+/**
+ * @brief Interrupts a context once `timeout_ms` has elapsed or `cancel` is raised, until
+ * destroyed.
+ */
+class Watchdog
+{
+  public:
+    Watchdog(z3::context& ctx, unsigned timeout_ms, const std::atomic<bool>* cancel)
+    {
+        if (timeout_ms == 0 && cancel == nullptr)
+        {
+            return;
+        }
+        const auto deadline =
+            timeout_ms == 0 ? WatchdogThread::Clock::time_point::max()
+                            : WatchdogThread::Clock::now() + std::chrono::milliseconds(timeout_ms);
+        id_ = WatchdogThread::instance().arm(ctx, deadline, cancel);
+    }
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    ~Watchdog()
+    {
+        if (id_.has_value())
+        {
+            WatchdogThread::instance().disarm(*id_);
+        }
+    }
+
+  private:
+    std::optional<std::uint64_t> id_;
+};
+
+std::uint64_t rlimit_count(const z3::solver& solver)
+{
+    const z3::stats stats = solver.statistics();
+    for (unsigned i = 0; i < stats.size(); ++i)
+    {
+        if (stats.key(i) == "rlimit count")
+        {
+            return stats.is_uint(i) ? stats.uint_value(i)
+                                    : static_cast<std::uint64_t>(stats.double_value(i));
+        }
+    }
+    return 0;
+}
+
+/** Conflicts and decisions so far (the SMT core's and the SAT core's), and current memory. */
+SolverStatistics statistics_of(const z3::solver& solver)
+{
+    SolverStatistics out;
+    const z3::stats stats = solver.statistics();
+    for (unsigned i = 0; i < stats.size(); ++i)
+    {
+        const std::string key = stats.key(i);
+        const double value = stats.is_uint(i) ? stats.uint_value(i) : stats.double_value(i);
+        if (key == "conflicts" || key == "sat conflicts")
+        {
+            out.conflicts += static_cast<std::uint64_t>(value);
+        }
+        else if (key == "decisions" || key == "sat decisions")
+        {
+            out.decisions += static_cast<std::uint64_t>(value);
+        }
+        else if (key == "memory")
+        {
+            out.memory_mb = value;
+        }
+    }
+    return out;
+}
+
+/**
+ * Check `solver`, telling an exhausted budget apart from a genuine unknown. After push(), Z3
+ * reports a timeout as "incomplete" and an rlimit stop as plain "unknown", so the budgets are
+ * measured rather than read from reason_unknown(). `statistics` receives the check's own work.
+ */
+CheckResult checked(z3::solver& solver, const SolverOptions& options,
+                    SolverStatistics& statistics)
+{
+    if (options.cancel != nullptr && options.cancel->load())
+    {
+        return CheckResult::Unknown;
+    }
+    const std::uint64_t rlimit_before = options.rlimit != 0 ? rlimit_count(solver) : 0;
+    // A reused solver's counters cover all its earlier checks too, unless a pop reset them.
+    const SolverStatistics before = statistics_of(solver);
+    const auto started = std::chrono::steady_clock::now();
+    const auto res = [&]
+    {
+        const Watchdog watchdog(solver.ctx(), options.timeout_ms, options.cancel);
+        return solver.check();
+    }();
+    statistics = statistics_of(solver);
+    if (statistics.conflicts >= before.conflicts && statistics.decisions >= before.decisions)
+    {
+        statistics.conflicts -= before.conflicts;
+        statistics.decisions -= before.decisions;
+    }
+    if (res == z3::sat)
+    {
+        return CheckResult::Sat;
+    }
+    if (res == z3::unsat)
+    {
+        return CheckResult::Unsat;
+    }
+
+    if (options.cancel != nullptr && options.cancel->load())
+    {
+        return CheckResult::Unknown;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    if (options.timeout_ms != 0 && elapsed >= std::chrono::milliseconds(options.timeout_ms))
+    {
+        return CheckResult::BudgetExceeded;
+    }
+    if (options.rlimit != 0 && rlimit_count(solver) - rlimit_before >= options.rlimit)
+    {
+        return CheckResult::BudgetExceeded;
+    }
+    return solver.reason_unknown().find("resource") != std::string::npos
+               ? CheckResult::BudgetExceeded
+               : CheckResult::Unknown;
+}
+
+/** Portfolio strategies, in the order their threads start. */
+constexpr std::size_t kPortfolioSize = 3;
+
+z3::solver portfolio_solver(z3::context& ctx, std::size_t strategy)
+{
+    switch (strategy)
+    {
+    case 0:
+        return z3::solver(ctx, "QF_LIA");
+    case 1:
+        return z3::solver(ctx);
+    default:
+        return (z3::tactic(ctx, "simplify") & z3::tactic(ctx, "smt")).mk_solver();
+    }
+}
+
+/** Width of the bit-vector standing for an Int variable: the VM's int64. */
+constexpr unsigned kVariableWidth = 64;
+
+/** Widest intermediate term before a query is left to the integer solver. */
+constexpr unsigned kMaxWidth = 512;
+
+/** Bits that hold `value` in two's complement. */
+unsigned signed_width(std::int64_t value)
+{
+    const auto magnitude = static_cast<std::uint64_t>(value < 0 ? ~value : value);
+    return static_cast<unsigned>(std::bit_width(magnitude)) + 1;
+}
+
+z3::expr widen(const z3::expr& bv, unsigned width)
+{
+    const unsigned have = bv.get_sort().bv_size();
+    return have < width ? z3::sext(bv, width - have) : bv;
+}
+
+/**
+ * Lowers Int formulas to bit-vector formulas that mean the same for int64 variables. Every Int
+ * constant becomes a 64-bit bit-vector, and every sum, difference, negation and product is
+ * computed (on sign-extended operands) one bit wider than its result can need, so nothing
+ * wraps: the only change from the integer encoding is that variables are bounded like the
+ * VM's values. Anything else, such as `div`, leaves the query to the integer solver.
+ */
+class BitVectorLowering
+{
+  public:
+    explicit BitVectorLowering(z3::context& ctx) : ctx_(ctx) {}
+
+    /** `e` lowered, or nullopt when it uses an operator the encoding does not cover. */
+    std::optional<z3::expr> lower(const z3::expr& e)
+    {
+        if (!e.is_app())
+        {
+            return std::nullopt;
+        }
+        // Merged path conditions share subterms, so each one is lowered once.
+        if (const auto it = done_.find(e.id()); it != done_.end())
+        {
+            return it->second;
+        }
+        auto lowered = lower_app(e);
+        if (lowered.has_value())
+        {
+            done_.insert_or_assign(e.id(), *lowered);
+        }
+        return lowered;
+    }
+
+  private:
+    std::optional<z3::expr> lower_app(const z3::expr& e)
+    {
+        std::vector<z3::expr> args;
+        args.reserve(e.num_args());
+        for (unsigned i = 0; i < e.num_args(); ++i)
+        {
+            auto arg = lower(e.arg(i));
+            if (!arg.has_value())
+            {
+                return std::nullopt;
+            }
+            args.push_back(std::move(*arg));
+        }
+
+        switch (e.decl().decl_kind())
+        {
+        case Z3_OP_TRUE:
+        case Z3_OP_FALSE:
+            return e;
+        case Z3_OP_UNINTERPRETED:
+            if (e.num_args() != 0 || !(e.is_bool() || e.is_int()))
+            {
+                return std::nullopt;
+            }
+            if (e.is_bool())
+            {
+                return e;
+            }
+            // Named like the Int constant, so a model can be read back by name.
+            return ctx_.bv_const(e.decl().name().str().c_str(), kVariableWidth);
+        case Z3_OP_ANUM:
+        {
+            std::int64_t value = 0;
+            if (!e.is_numeral_i64(value))
+            {
+                return std::nullopt;
+            }
+            return ctx_.bv_val(value, signed_width(value));
+        }
+        case Z3_OP_ADD:
+        case Z3_OP_SUB:
+        case Z3_OP_MUL:
+            return arithmetic(e.decl().decl_kind(), args);
+        case Z3_OP_UMINUS:
+        {
+            const unsigned width = args[0].get_sort().bv_size() + 1;
+            if (width > kMaxWidth)
+            {
+                return std::nullopt;
+            }
+            return -widen(args[0], width);
+        }
+        case Z3_OP_LE:
+        case Z3_OP_LT:
+        case Z3_OP_GE:
+        case Z3_OP_GT:
+        {
+            const auto [a, b] = common_width(args[0], args[1]);
+            switch (e.decl().decl_kind())
+            {
+            case Z3_OP_LE:
+                return z3::sle(a, b);
+            case Z3_OP_LT:
+                return z3::slt(a, b);
+            case Z3_OP_GE:
+                return z3::sge(a, b);
+            default:
+                return z3::sgt(a, b);
+            }
+        }
+        case Z3_OP_EQ:
+        case Z3_OP_DISTINCT:
+        {
+            if (args.size() != 2)
+            {
+                return std::nullopt;
+            }
+            const auto [a, b] = args[0].is_bv() ? common_width(args[0], args[1])
+                                                : std::pair{args[0], args[1]};
+            return e.decl().decl_kind() == Z3_OP_EQ ? a == b : a != b;
+        }
+        case Z3_OP_ITE:
+        {
+            const auto [a, b] = args[1].is_bv() ? common_width(args[1], args[2])
+                                                : std::pair{args[1], args[2]};
+            return z3::ite(args[0], a, b);
+        }
+        case Z3_OP_AND:
+        case Z3_OP_OR:
+        {
+            z3::expr_vector operands(ctx_);
+            for (const auto& arg : args)
+            {
+                operands.push_back(arg);
+            }
+            return e.decl().decl_kind() == Z3_OP_AND ? z3::mk_and(operands)
+                                                     : z3::mk_or(operands);
+        }
+        case Z3_OP_NOT:
+            return !args[0];
+        case Z3_OP_IMPLIES:
+            return z3::implies(args[0], args[1]);
+        case Z3_OP_IFF:
+            return args[0] == args[1];
+        default:
+            return std::nullopt;
+        }
+    }
+
+    static std::pair<z3::expr, z3::expr> common_width(const z3::expr& a, const z3::expr& b)
+    {
+        const unsigned width = std::max(a.get_sort().bv_size(), b.get_sort().bv_size());
+        return {widen(a, width), widen(b, width)};
+    }
+
+    static std::optional<z3::expr> arithmetic(Z3_decl_kind kind, const std::vector<z3::expr>& args)
+    {
+        z3::expr acc = args[0];
+        for (std::size_t i = 1; i < args.size(); ++i)
+        {
+            const unsigned a = acc.get_sort().bv_size();
+            const unsigned b = args[i].get_sort().bv_size();
+            const unsigned width = kind == Z3_OP_MUL ? a + b : std::max(a, b) + 1;
+            if (width > kMaxWidth)
+            {
+                return std::nullopt;
+            }
+            const z3::expr lhs = widen(acc, width);
+            const z3::expr rhs = widen(args[i], width);
+            acc = kind == Z3_OP_ADD ? lhs + rhs : kind == Z3_OP_SUB ? lhs - rhs : lhs * rhs;
+        }
+        return acc;
+    }
+
+    z3::context& ctx_;
+    std::unordered_map<unsigned, z3::expr> done_;
+};
+
+/** Visits every distinct subterm of `assertions` until `stop` returns true. */
+template <typename Stop>
+bool any_subterm(const z3::expr_vector& assertions, Stop stop)
+{
+    std::unordered_set<unsigned> seen;
+    std::vector<z3::expr> pending;
+    for (unsigned i = 0; i < assertions.size(); ++i)
+    {
+        pending.push_back(assertions[static_cast<int>(i)]);
+    }
+    while (!pending.empty())
+    {
+        const z3::expr next = pending.back();
+        pending.pop_back();
+        if (!next.is_app() || !seen.insert(next.id()).second)
+        {
+            continue;
+        }
+        if (stop(next))
+        {
+            return true;
+        }
+        for (unsigned i = 0; i < next.num_args(); ++i)
+        {
+            pending.push_back(next.arg(i));
+        }
+    }
+    return false;
+}
+
+/** Whether `assertions` multiply two terms that are not numerals. */
+bool has_nonlinear_product(const z3::expr_vector& assertions)
+{
+    return any_subterm(assertions,
+                       [](const z3::expr& e)
+                       {
+                           if (e.decl().decl_kind() != Z3_OP_MUL)
+                           {
+                               return false;
+                           }
+                           unsigned variable = 0;
+                           for (unsigned i = 0; i < e.num_args(); ++i)
+                           {
+                               variable += e.arg(i).is_numeral() ? 0 : 1;
+                           }
+                           return variable > 1;
+                       });
+}
+
+/** The int64 range of every Int constant in `assertions`. */
+z3::expr_vector int64_bounds(const z3::expr_vector& assertions)
+{
+    auto& ctx = assertions.ctx();
+    z3::expr_vector bounds(ctx);
+    any_subterm(assertions,
+                [&](const z3::expr& e)
+                {
+                    if (e.is_int() && e.num_args() == 0 &&
+                        e.decl().decl_kind() == Z3_OP_UNINTERPRETED)
+                    {
+                        bounds.push_back(e >= ctx.int_val(std::numeric_limits<std::int64_t>::min()) &&
+                                         e <= ctx.int_val(std::numeric_limits<std::int64_t>::max()));
+                    }
+                    return false;
+                });
+    return bounds;
+}
+
+/** `assertions` lowered to bit-vectors, or nullopt when some operator is not covered. */
+std::optional<z3::expr_vector> lower_to_bit_vectors(const z3::expr_vector& assertions)
+{
+    BitVectorLowering lowering(assertions.ctx());
+    z3::expr_vector out(assertions.ctx());
+    for (unsigned i = 0; i < assertions.size(); ++i)
+    {
+        auto lowered = lowering.lower(assertions[static_cast<int>(i)]);
+        if (!lowered.has_value())
+        {
+            return std::nullopt;
+        }
+        out.push_back(*lowered);
+    }
+    return out;
+}
+
+/** One way of solving a query, built in the context of the assertions it is given. */
+struct Strategy
+{
+    /** May throw z3::exception when the strategy rejects the query. */
+    std::function<z3::solver(const z3::expr_vector&)> build;
+    /** The solver answers for the bit-vector lowering of the query. */
+    bool bit_vector = false;
+};
+
+/**
+ * The portfolio's strategies: the integer ones (with int64 bounds unless the theory is
+ * Integer) unless BitVector lowers the query, and the bit-vector solver when it is used.
+ */
+std::vector<Strategy> portfolio_for(const SolverOptions& options, bool bit_vectors)
+{
+    std::vector<Strategy> out;
+    if (options.theory != IntTheory::BitVector || !bit_vectors)
+    {
+        const bool bounded = options.theory != IntTheory::Integer;
+        for (std::size_t i = 0; i < kPortfolioSize; ++i)
+        {
+            out.push_back({.build =
+                               [i, bounded](const z3::expr_vector& query)
+                           {
+                               z3::solver solver = portfolio_solver(query.ctx(), i);
+                               solver.add(query);
+                               if (bounded)
+                               {
+                                   solver.add(int64_bounds(query));
+                               }
+                               return solver;
+                           },
+                           .bit_vector = false});
+        }
+    }
+    if (bit_vectors)
+    {
+        out.push_back({.build =
+                           [](const z3::expr_vector& query)
+                       {
+                           z3::solver solver(query.ctx(), "QF_BV");
+                           solver.add(*lower_to_bit_vectors(query));
+                           return solver;
+                       },
+                       .bit_vector = true});
+    }
+    return out;
+}
+
+/** A finished check; `model` lives in the caller's context. */
+struct Outcome
+{
+    CheckResult result = CheckResult::Unknown;
+    std::optional<z3::model> model;
+    bool bit_vector = false;
+    SolverStatistics statistics;
+};
+
+/**
+ * Run `strategies` on separate threads and take the first sat/unsat answer. A z3::context is
+ * single-threaded, so every strategy gets its own copy of the assertions, in the context of
+ * `contexts` with its index; missing contexts are created and kept for later races.
+ */
+Outcome race(z3::context& ctx, std::vector<std::unique_ptr<z3::context>>& contexts,
+             const z3::expr_vector& assertions, const std::vector<Strategy>& strategies,
+             const SolverOptions& options)
+{
+    struct Lane
+    {
+        z3::context* ctx = nullptr;
+        std::optional<z3::expr_vector> assertions;
+        CheckResult result = CheckResult::Unknown;
+        std::optional<z3::model> model;
+        SolverStatistics statistics;
+    };
+
+    const std::size_t count = strategies.size();
+    while (contexts.size() < count)
+    {
+        contexts.push_back(std::make_unique<z3::context>());
+    }
+    std::vector<Lane> lanes(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        lanes[i].ctx = contexts[i].get();
+        lanes[i].assertions.emplace(*lanes[i].ctx, assertions);
+    }
+
+    std::atomic<std::size_t> winner{count};
+    std::vector<std::atomic<bool>> finished(count);
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        threads.emplace_back(
+            [&, i]
+            {
+                auto& lane = lanes[i];
+                struct Finish
+                {
+                    std::atomic<bool>& flag;
+                    ~Finish() { flag = true; }
+                } finish{finished[i]};
+                if (winner.load() != count)
+                {
+                    return;
+                }
+                try
+                {
+                    z3::solver solver = strategies[i].build(*lane.assertions);
+                    solver.set(budget_params(*lane.ctx, options));
+                    lane.result = checked(solver, options, lane.statistics);
+                    if (lane.result != CheckResult::Sat && lane.result != CheckResult::Unsat)
+                    {
+                        return;
+                    }
+
+                    if (lane.result == CheckResult::Sat)
+                    {
+                        lane.model = solver.get_model();
+                    }
+                    std::size_t none = count;
+                    winner.compare_exchange_strong(none, i);
+                }
+                catch (const z3::exception&)
+                {
+                    // A strategy that rejects the query (e.g. outside QF_LIA) just loses.
+                    lane.result = CheckResult::Unknown;
+                }
+            });
+    }
+    // Z3 drops an interrupt that arrives before a lane's check() starts, so keep interrupting
+    // the losers until they stop.
+    auto all_finished = [&]
+    { return std::all_of(finished.begin(), finished.end(), [](const auto& f) { return f.load(); }); };
+    while (!all_finished())
+    {
+        if (const std::size_t won = winner.load(); won != count)
+        {
+            for (std::size_t j = 0; j < count; ++j)
+            {
+                if (j != won && !finished[j])
+                {
+                    lanes[j].ctx->interrupt();
+                }
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    Outcome outcome;
+    if (const std::size_t won = winner.load(); won != count)
+    {
+        outcome.result = lanes[won].result;
+        outcome.bit_vector = strategies[won].bit_vector;
+        outcome.statistics = lanes[won].statistics;
+        if (lanes[won].model.has_value())
+        {
+            outcome.model = z3::model(*lanes[won].model, ctx, z3::model::translate{});
+        }
+        return outcome;
+    }
+
+    const bool budget = std::any_of(lanes.begin(), lanes.end(), [](const Lane& lane)
+                                    { return lane.result == CheckResult::BudgetExceeded; });
+    outcome.result = budget ? CheckResult::BudgetExceeded : CheckResult::Unknown;
+    return outcome;
+}
+
+/**
+ * Indices of a minimal subset of `facts` that is unsat together with `solver`'s assertions;
+ * adds tracked copies of `facts` to `solver`, so callers push first or use a scratch solver.
+ */
+std::optional<std::vector<std::size_t>> minimal_core_of(z3::solver& solver,
+                                                        const std::vector<z3::expr>& facts,
+                                                        unsigned timeout_ms)
+{
+    auto& ctx = solver.ctx();
+    // Each fact only holds while its tracking literal is assumed.
+    std::vector<z3::expr> literals;
+    literals.reserve(facts.size());
+    for (std::size_t i = 0; i < facts.size(); ++i)
+    {
+        literals.push_back(ctx.bool_const(("curlee.core." + std::to_string(i)).c_str()));
+        solver.add(z3::implies(literals.back(), facts[i]));
+    }
+    auto unsat_with = [&](const std::vector<std::size_t>& subset)
+    {
+        z3::expr_vector assumptions(ctx);
+        for (const std::size_t i : subset)
+        {
+            assumptions.push_back(literals[i]);
+        }
+        const Watchdog watchdog(ctx, timeout_ms, nullptr);
+        return solver.check(assumptions) == z3::unsat;
+    };
+
+    std::vector<std::size_t> all(facts.size());
+    std::iota(all.begin(), all.end(), std::size_t{0});
+    if (!unsat_with(all))
+    {
+        return std::nullopt;
+    }
+
+    const z3::expr_vector found = solver.unsat_core();
+    std::vector<std::size_t> core;
+    for (std::size_t i = 0; i < literals.size(); ++i)
+    {
+        for (unsigned j = 0; j < found.size(); ++j)
+        {
+            if (z3::eq(found[static_cast<int>(j)], literals[i]))
+            {
+                core.push_back(i);
+                break;
+            }
+        }
+    }
+    // Z3's core is small but not minimal: drop facts one at a time while it stays unsat.
+    // A check that runs out of budget keeps the fact, so the core is still valid.
+    for (std::size_t i = 0; i < core.size();)
+    {
+        auto without = core;
+        without.erase(without.begin() + static_cast<std::ptrdiff_t>(i));
+        if (unsat_with(without))
+        {
+            core = std::move(without);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return core;
+}
+
+} // namespace
+
+std::string_view int_theory_name(IntTheory theory)
+{
+    switch (theory)
+    {
+    case IntTheory::Integer:
+        return "int";
+    case IntTheory::BitVector:
+        return "bv";
+    case IntTheory::Auto:
+        return "auto";
+    }
+    return "int"; // GCOVR_EXCL_LINE
+}
+
+Solver::Solver() : Solver(SolverOptions{}) {}
+
+Solver::Solver(SolverOptions options) : options_(options), solver_(ctx_)
+{
+    solver_.set(budget_params(ctx_, options_));
+}
 
 z3::context& Solver::context()
 {
@@ -33,22 +843,226 @@ void Solver::pop()
 
 CheckResult Solver::check()
 {
-    const auto res = solver_.check();
-    switch (res)
+    last_model_.reset();
+    last_bit_vector_ = false;
+    if (options_.theory == IntTheory::Integer && !options_.portfolio)
     {
-    case z3::sat:
-        last_result_ = CheckResult::Sat;
-        last_model_ = solver_.get_model();
-        return CheckResult::Sat;
-    case z3::unsat:
-        last_result_ = CheckResult::Unsat;
-        last_model_.reset();
-        return CheckResult::Unsat;
-    default:
-        last_result_ = CheckResult::Unknown;
-        last_model_.reset();
-        return CheckResult::Unknown;
+        return finish(solver_, false);
+    }
+
+    const z3::expr_vector assertions = solver_.assertions();
+    std::optional<z3::expr_vector> lowered;
+    if (options_.theory == IntTheory::BitVector ||
+        (options_.theory == IntTheory::Auto && has_nonlinear_product(assertions)))
+    {
+        lowered = lower_to_bit_vectors(assertions);
+    }
+
+    if (options_.portfolio)
+    {
+        auto outcome = race(ctx_, lane_ctxs_, assertions,
+                            portfolio_for(options_, lowered.has_value()), options_);
+        last_result_ = outcome.result;
+        last_model_ = std::move(outcome.model);
+        last_statistics_ = outcome.statistics;
+        last_bit_vector_ = outcome.bit_vector;
+        return *last_result_;
+    }
+    if (!lowered.has_value())
+    {
+        solver_.push();
+        solver_.add(int64_bounds(assertions));
+        const CheckResult result = finish(solver_, false);
+        solver_.pop();
+        return result;
+    }
+    if (options_.theory == IntTheory::BitVector)
+    {
+        z3::solver solver = bit_vector_solver(ctx_);
+        solver.add(*lowered);
+        return finish(solver, true);
+    }
+    return check_race(assertions, *lowered);
+}
+
+CheckResult Solver::finish(z3::solver& solver, bool bit_vector)
+{
+    last_result_ = checked(solver, options_, last_statistics_);
+    if (*last_result_ == CheckResult::Sat)
+    {
+        last_model_ = solver.get_model();
+        last_bit_vector_ = bit_vector;
+    }
+    return *last_result_;
+}
+
+z3::solver Solver::bit_vector_solver(z3::context& ctx) const
+{
+    // Never pushed: after a push(), Z3 leaves the fast bit-blasting QF_BV tactic for its slower
+    // incremental core.
+    z3::solver solver(ctx, "QF_BV");
+    solver.set(budget_params(ctx, options_));
+    return solver;
+}
+
+CheckResult Solver::check_race(const z3::expr_vector& assertions, const z3::expr_vector& lowered)
+{
+    // The bit-vector lane runs on another thread, in a context of its own that later races
+    // reuse (creating one costs more than most checks); the integer lane runs here, on solver_.
+    if (race_ctx_ == nullptr)
+    {
+        race_ctx_ = std::make_unique<z3::context>();
+    }
+    z3::solver race_solver = bit_vector_solver(*race_ctx_);
+    race_solver.add(z3::expr_vector(*race_ctx_, lowered));
+    solver_.push();
+    solver_.add(int64_bounds(assertions));
+
+    enum Winner
+    {
+        None,
+        Integers,
+        BitVectors,
+    };
+    std::atomic<Winner> winner{None};
+    std::atomic<bool> integers_done{false};
+    std::atomic<bool> bit_vectors_done{false};
+    auto definitive = [](CheckResult r) { return r == CheckResult::Sat || r == CheckResult::Unsat; };
+
+    CheckResult bv_result = CheckResult::Unknown;
+    std::optional<z3::model> bv_model;
+    SolverStatistics bv_statistics;
+    std::thread lane(
+        [&]
+        {
+            struct Finish
+            {
+                std::atomic<bool>& flag;
+                ~Finish() { flag = true; }
+            } finish{bit_vectors_done};
+            bv_result = checked(race_solver, options_, bv_statistics);
+            if (!definitive(bv_result))
+            {
+                return;
+            }
+            if (bv_result == CheckResult::Sat)
+            {
+                bv_model = race_solver.get_model();
+            }
+            Winner none = None;
+            if (winner.compare_exchange_strong(none, BitVectors))
+            {
+                // Z3 drops an interrupt that arrives before check() starts, so repeat it.
+                while (!integers_done)
+                {
+                    ctx_.interrupt();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+
+    SolverStatistics int_statistics;
+    const CheckResult int_result = checked(solver_, options_, int_statistics);
+    std::optional<z3::model> int_model;
+    if (int_result == CheckResult::Sat)
+    {
+        int_model = solver_.get_model();
+    }
+    integers_done = true;
+    Winner none = None;
+    if (definitive(int_result) && winner.compare_exchange_strong(none, Integers))
+    {
+        while (!bit_vectors_done)
+        {
+            race_ctx_->interrupt();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    lane.join();
+    solver_.pop();
+
+    switch (winner.load())
+    {
+    case Integers:
+        last_result_ = int_result;
+        last_statistics_ = int_statistics;
+        last_model_ = std::move(int_model);
+        break;
+    case BitVectors:
+        last_result_ = bv_result;
+        last_statistics_ = bv_statistics;
+        if (bv_model.has_value())
+        {
+            last_model_ = z3::model(*bv_model, ctx_, z3::model::translate{});
+            last_bit_vector_ = true;
+        }
+        break;
+    case None:
+        last_statistics_ = int_statistics;
+        last_result_ = int_result == CheckResult::BudgetExceeded ||
+                               bv_result == CheckResult::BudgetExceeded
+                           ? CheckResult::BudgetExceeded
+                           : CheckResult::Unknown;
+        break;
     }
+    return *last_result_;
+}
+
+std::optional<std::vector<std::size_t>> Solver::minimal_core(const std::vector<z3::expr>& facts)
+{
+    last_result_.reset();
+    last_model_.reset();
+    if (options_.theory == IntTheory::Integer)
+    {
+        solver_.push();
+        auto core = minimal_core_of(solver_, facts, options_.timeout_ms);
+        solver_.pop();
+        return core;
+    }
+
+    // An expr_vector copy shares its elements, so the query is built afresh.
+    const z3::expr_vector assertions = solver_.assertions();
+    z3::expr_vector query(ctx_);
+    for (unsigned i = 0; i < assertions.size(); ++i)
+    {
+        query.push_back(assertions[static_cast<int>(i)]);
+    }
+    for (const auto& fact : facts)
+    {
+        query.push_back(fact);
+    }
+
+    // Shrinking needs one incremental solver, so Auto only searches over bounded integers.
+    const auto lowered = options_.theory == IntTheory::BitVector ? lower_to_bit_vectors(query)
+                                                                 : std::nullopt;
+    if (!lowered.has_value())
+    {
+        solver_.push();
+        solver_.add(int64_bounds(query));
+        auto core = minimal_core_of(solver_, facts, options_.timeout_ms);
+        solver_.pop();
+        return core;
+    }
+
+    z3::solver solver = bit_vector_solver(ctx_);
+    std::vector<z3::expr> tracked;
+    for (unsigned i = 0; i < lowered->size(); ++i)
+    {
+        if (i < assertions.size())
+        {
+            solver.add((*lowered)[static_cast<int>(i)]);
+        }
+        else
+        {
+            tracked.push_back((*lowered)[static_cast<int>(i)]);
+        }
+    }
+    return minimal_core_of(solver, tracked, options_.timeout_ms);
+}
+
+const SolverStatistics& Solver::last_statistics() const
+{
+    return last_statistics_;
 }
 
 std::optional<Model> Solver::model_for(const std::vector<z3::expr>& vars) const
@@ -66,7 +1080,12 @@ std::optional<Model> Solver::model_for(const std::vector<z3::expr>& vars) const
     for (const auto& var : vars)
     {
         const auto name = var.decl().name().str();
-        const auto value = last_model_->eval(var, true).to_string();
+        // A bit-vector model holds the int64 standing for each Int variable, under its name.
+        const z3::expr term =
+            last_bit_vector_ && var.is_int()
+                ? z3::bv2int(var.ctx().bv_const(name.c_str(), kVariableWidth), true)
+                : var;
+        const auto value = last_model_->eval(term, true).to_string();
         model.entries.push_back({name, value});
     }
 
@@ -3,10 +3,12 @@
 #include <curlee/source/span.h>
 #include <curlee/vm/bytecode.h>
 #include <curlee/vm/chunk_codec.h>
+#include <curlee/vm/span_table.h>
 #include <curlee/vm/value.h>
 #include <limits>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -117,7 +119,7 @@ struct Reader
 std::vector<std::uint8_t> encode_chunk(const Chunk& chunk)
 {
     static constexpr char kMagic[] = "CURLEE_CHUNK";
-    static constexpr std::uint32_t kChunkFormatVersion = 2;
+    static constexpr std::uint32_t kChunkFormatVersion = 4;
 
     std::vector<std::uint8_t> out;
     out.reserve(64 + chunk.code.size());
@@ -135,11 +137,9 @@ std::vector<std::uint8_t> encode_chunk(const Chunk& chunk)
     out.insert(out.end(), chunk.code.begin(), chunk.code.end());
 
     append_u64(out, static_cast<std::uint64_t>(chunk.spans.size()));
-    for (const auto& span : chunk.spans)
-    {
-        append_u64(out, static_cast<std::uint64_t>(span.start));
-        append_u64(out, static_cast<std::uint64_t>(span.end));
-    }
+    const auto& span_table = chunk.spans.bytes();
+    append_u64(out, static_cast<std::uint64_t>(span_table.size()));
+    out.insert(out.end(), span_table.begin(), span_table.end());
 
     append_u64(out, static_cast<std::uint64_t>(chunk.constants.size()));
     for (const auto& c : chunk.constants)
@@ -147,20 +147,20 @@ std::vector<std::uint8_t> encode_chunk(const Chunk& chunk)
         if (c.kind == ValueKind::Int)
         {
             append_u8(out, 0);
-            append_u64(out, static_cast<std::uint64_t>(c.int_value));
+            append_u64(out, static_cast<std::uint64_t>(c.as_int()));
             continue;
         }
         if (c.kind == ValueKind::Bool)
         {
             append_u8(out, 1);
-            append_u8(out, c.bool_value ? 1 : 0);
+            append_u8(out, c.as_bool() ? 1 : 0);
             continue;
         }
         if (c.kind == ValueKind::String)
         {
             append_u8(out, 2);
-            append_u64(out, static_cast<std::uint64_t>(c.string_value.size()));
-            out.insert(out.end(), c.string_value.begin(), c.string_value.end());
+            append_u64(out, static_cast<std::uint64_t>(c.as_string().size()));
+            out.insert(out.end(), c.as_string().begin(), c.as_string().end());
             continue;
         }
 
@@ -168,6 +168,15 @@ std::vector<std::uint8_t> encode_chunk(const Chunk& chunk)
         append_u8(out, 3);
     }
 
+    append_u64(out, static_cast<std::uint64_t>(chunk.functions.size()));
+    for (const auto& fn : chunk.functions)
+    {
+        append_u64(out, static_cast<std::uint64_t>(fn.entry));
+        append_u64(out, static_cast<std::uint64_t>(fn.arity));
+        append_u64(out, static_cast<std::uint64_t>(fn.locals));
+        append_u64(out, static_cast<std::uint64_t>(fn.max_stack));
+    }
+
     return out;
 } // GCOVR_EXCL_LINE
 
@@ -176,6 +185,11 @@ std::variant<Chunk, ChunkDecodeError> decode_chunk(const std::vector<std::uint8_
     static constexpr char kMagic[] = "CURLEE_CHUNK";
     static constexpr std::uint32_t kChunkFormatVersionV1 = 1;
     static constexpr std::uint32_t kChunkFormatVersionV2 = 2;
+    static constexpr std::uint32_t kChunkFormatVersionV3 = 3;
+    static constexpr std::uint32_t kChunkFormatVersionV4 = 4;
+    // LoadLocal/StoreLocal address slots with a u16, so no frame needs more; larger counts
+    // would only make the VM and the verifier allocate until they fail.
+    static constexpr std::size_t kMaxFrameSlots = std::size_t{1} << 16;
 
     Reader r{.in = bytes};
 
@@ -193,7 +207,8 @@ std::variant<Chunk, ChunkDecodeError> decode_chunk(const std::vector<std::uint8_
     {
         return ChunkDecodeError{"truncated chunk version"};
     }
-    if (*ver != kChunkFormatVersionV1 && *ver != kChunkFormatVersionV2)
+    if (*ver != kChunkFormatVersionV1 && *ver != kChunkFormatVersionV2 &&
+        *ver != kChunkFormatVersionV3 && *ver != kChunkFormatVersionV4)
     {
         return ChunkDecodeError{"unsupported chunk format version"};
     }
@@ -260,6 +275,10 @@ std::variant<Chunk, ChunkDecodeError> decode_chunk(const std::vector<std::uint8_
         }
         max_locals = std::get<std::size_t>(ml);
     }
+    if (max_locals > kMaxFrameSlots)
+    {
+        return ChunkDecodeError{"max_locals out of range"};
+    }
 
     std::size_t code_len = 0;
     if (v1)
@@ -307,9 +326,30 @@ std::variant<Chunk, ChunkDecodeError> decode_chunk(const std::vector<std::uint8_
         spans_len = std::get<std::size_t>(sl);
     }
 
-    std::vector<curlee::source::Span> spans;
-    spans.reserve(spans_len);
-    for (std::size_t i = 0; i < spans_len; ++i)
+    SpanTable spans;
+    if (*ver == kChunkFormatVersionV4)
+    {
+        const auto tl = read_u64_size("truncated span table length", "span table too large");
+        if (const auto* err = std::get_if<ChunkDecodeError>(&tl))
+        {
+            return *err;
+        }
+        auto table_bytes = r.read_bytes(std::get<std::size_t>(tl));
+        if (!table_bytes.has_value())
+        {
+            return ChunkDecodeError{"truncated span table"};
+        }
+        auto table = SpanTable::from_bytes(std::move(*table_bytes), spans_len);
+        if (!table.has_value())
+        {
+            return ChunkDecodeError{"invalid span table"};
+        }
+        spans = std::move(*table);
+    }
+
+    // Older versions store one span per code byte; re-encoding them keeps every lookup intact.
+    const std::size_t per_byte_spans = (*ver == kChunkFormatVersionV4) ? 0 : spans_len;
+    for (std::size_t i = 0; i < per_byte_spans; ++i)
     {
         if (v1)
         {
@@ -319,8 +359,8 @@ std::variant<Chunk, ChunkDecodeError> decode_chunk(const std::vector<std::uint8_
             {
                 return ChunkDecodeError{"truncated span"};
             }
-            spans.push_back(curlee::source::Span{.start = static_cast<std::size_t>(*start),
-                                                 .end = static_cast<std::size_t>(*end)});
+            spans.add(i, curlee::source::Span{.start = static_cast<std::size_t>(*start),
+                                              .end = static_cast<std::size_t>(*end)});
         }
         else
         {
@@ -334,8 +374,8 @@ std::variant<Chunk, ChunkDecodeError> decode_chunk(const std::vector<std::uint8_
             {
                 return *err;
             }
-            spans.push_back(curlee::source::Span{.start = std::get<std::size_t>(start),
-                                                 .end = std::get<std::size_t>(end)});
+            spans.add(i, curlee::source::Span{.start = std::get<std::size_t>(start),
+                                              .end = std::get<std::size_t>(end)});
         }
     }
 
@@ -437,11 +477,53 @@ std::variant<Chunk, ChunkDecodeError> decode_chunk(const std::vector<std::uint8_
         return ChunkDecodeError{"unknown constant kind"};
     }
 
+    std::vector<FunctionInfo> functions;
+    if (*ver == kChunkFormatVersionV3 || *ver == kChunkFormatVersionV4)
+    {
+        const auto fl = read_u64_size("truncated function table length", "too many functions");
+        if (const auto* err = std::get_if<ChunkDecodeError>(&fl))
+        {
+            return *err;
+        }
+        const std::size_t fn_len = std::get<std::size_t>(fl);
+        for (std::size_t i = 0; i < fn_len; ++i)
+        {
+            std::size_t fields[4] = {};
+            for (auto& field : fields)
+            {
+                const auto v = read_u64_size("truncated function", "function field too large");
+                if (const auto* err = std::get_if<ChunkDecodeError>(&v))
+                {
+                    return *err;
+                }
+                field = std::get<std::size_t>(v);
+            }
+            if (fields[0] >= code_len)
+            {
+                return ChunkDecodeError{"function entry out of range"};
+            }
+            if (fields[1] > kMaxFrameSlots || fields[2] > kMaxFrameSlots)
+            {
+                return ChunkDecodeError{"function frame out of range"};
+            }
+            // Every value a function pushes takes at least one instruction byte.
+            if (fields[3] > code_len)
+            {
+                return ChunkDecodeError{"function max_stack out of range"};
+            }
+            functions.push_back(FunctionInfo{.entry = fields[0],
+                                             .arity = fields[1],
+                                             .locals = fields[2],
+                                             .max_stack = fields[3]});
+        }
+    }
+
     Chunk out;
     out.max_locals = max_locals;
     out.code = std::move(*code_bytes);
     out.spans = std::move(spans);
     out.constants = std::move(constants);
+    out.functions = std::move(functions);
 
     if (out.spans.size() != out.code.size())
     {
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <curlee/vm/profiler.h>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+namespace curlee::vm
+{
+
+namespace
+{
+
+constexpr std::size_t kNoFunction = std::numeric_limits<std::size_t>::max();
+
+[[nodiscard]] std::string function_label(const Chunk& chunk, std::size_t entry)
+{
+    if (const FunctionInfo* fn = chunk.function_at(entry); fn != nullptr && !fn->name.empty())
+    {
+        return fn->name;
+    }
+    return entry == 0 ? std::string("<entry>") : "fn@" + std::to_string(entry);
+}
+
+[[nodiscard]] std::string percent(std::uint64_t part, std::uint64_t total)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1)
+        << (total == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total))
+        << "%";
+    return out.str();
+}
+
+} // namespace
+
+void Profiler::begin(const Chunk& chunk)
+{
+    chunk_ = &chunk;
+    opcodes_ = {};
+    offset_counts_.assign(chunk.code.size(), 0);
+    offset_cycles_.assign(chunk.code.size(), 0);
+    instructions_ = 0;
+    total_cycles_ = 0;
+    has_current_ = false;
+
+    functions_.clear();
+    function_by_entry_.clear();
+    nodes_.assign(1, StackNode{.function = kNoFunction, .self_cycles = 0, .children = {}});
+    activations_.clear();
+    enter(0, profile_clock());
+}
+
+void Profiler::call(std::size_t target)
+{
+    enter(target, profile_clock());
+}
+
+void Profiler::ret()
+{
+    // The entry activation is only closed by end(); a stray Ret fails the run anyway.
+    if (activations_.size() > 1)
+    {
+        leave(profile_clock());
+    }
+}
+
+void Profiler::end()
+{
+    const std::uint64_t now = profile_clock();
+    close_instruction(now);
+    while (!activations_.empty())
+    {
+        leave(now);
+    }
+}
+
+std::size_t Profiler::function_index(std::size_t entry)
+{
+    const auto [it, inserted] = function_by_entry_.emplace(entry, functions_.size());
+    if (inserted)
+    {
+        FunctionState state;
+        state.profile.entry = entry;
+        state.profile.name = function_label(*chunk_, entry);
+        functions_.push_back(std::move(state));
+    }
+    return it->second;
+}
+
+void Profiler::enter(std::size_t entry, std::uint64_t now)
+{
+    const std::size_t fn = function_index(entry);
+    auto& state = functions_[fn];
+    ++state.profile.calls;
+    ++state.active;
+
+    const std::size_t parent = activations_.empty() ? 0 : activations_.back().node;
+    std::size_t node = 0;
+    if (const auto it = nodes_[parent].children.find(fn); it != nodes_[parent].children.end())
+    {
+        node = it->second;
+    }
+    else
+    {
+        node = nodes_.size();
+        nodes_[parent].children.emplace(fn, node);
+        nodes_.push_back(StackNode{.function = fn, .self_cycles = 0, .children = {}});
+    }
+    activations_.push_back(Activation{.node = node, .start = now, .callee_cycles = 0});
+}
+
+void Profiler::leave(std::uint64_t now)
+{
+    const Activation activation = activations_.back();
+    activations_.pop_back();
+
+    const std::uint64_t inclusive = now - activation.start;
+    const std::uint64_t exclusive = inclusive - std::min(inclusive, activation.callee_cycles);
+    auto& node = nodes_[activation.node];
+    node.self_cycles += exclusive;
+
+    auto& state = functions_[node.function];
+    state.profile.exclusive_cycles += exclusive;
+    if (--state.active == 0)
+    {
+        state.profile.inclusive_cycles += inclusive;
+    }
+    if (!activations_.empty())
+    {
+        activations_.back().callee_cycles += inclusive;
+    }
+}
+
+std::vector<FunctionProfile> Profiler::functions() const
+{
+    std::vector<FunctionProfile> out;
+    out.reserve(functions_.size());
+    for (const auto& state : functions_)
+    {
+        out.push_back(state.profile);
+    }
+    std::stable_sort(out.begin(), out.end(), [](const auto& a, const auto& b)
+                     { return a.exclusive_cycles > b.exclusive_cycles; });
+    return out;
+}
+
+std::vector<SpanProfile> Profiler::hot_spans(std::size_t limit) const
+{
+    if (chunk_ == nullptr)
+    {
+        return {};
+    }
+
+    // Decode the span table once and walk it alongside the (ascending) offsets.
+    const auto records = chunk_->spans.entries();
+    const std::size_t covered = std::min(offset_counts_.size(), chunk_->spans.size());
+    std::map<std::pair<std::size_t, std::size_t>, SpanProfile> by_span;
+    std::size_t record = 0;
+    for (std::size_t offset = 0; offset < covered; ++offset)
+    {
+        while (record < records.size() && records[record].offset <= offset)
+        {
+            ++record;
+        }
+        if (offset_counts_[offset] == 0 || record == 0)
+        {
+            continue;
+        }
+        const auto& span = records[record - 1].span;
+        auto& entry = by_span[{span.start, span.end}];
+        entry.span = span;
+        entry.count += offset_counts_[offset];
+        entry.cycles += offset_cycles_[offset];
+    }
+
+    std::vector<SpanProfile> out;
+    out.reserve(by_span.size());
+    for (const auto& [key, profile] : by_span)
+    {
+        out.push_back(profile);
+    }
+    std::stable_sort(out.begin(), out.end(),
+                     [](const auto& a, const auto& b) { return a.cycles > b.cycles; });
+    if (out.size() > limit)
+    {
+        out.resize(limit);
+    }
+    return out;
+}
+
+std::string Profiler::collapsed_stacks() const
+{
+    std::string out;
+    if (nodes_.empty())
+    {
+        return out;
+    }
+
+    // Depth-first from the root sentinel, visiting callees in first-seen function order.
+    std::vector<std::pair<std::size_t, std::string>> pending;
+    for (auto it = nodes_[0].children.rbegin(); it != nodes_[0].children.rend(); ++it)
+    {
+        pending.emplace_back(it->second, functions_[it->first].profile.name);
+    }
+    while (!pending.empty())
+    {
+        auto [node_index, path] = std::move(pending.back());
+        pending.pop_back();
+        const auto& node = nodes_[node_index];
+        if (node.self_cycles > 0)
+        {
+            out += path;
+            out += ' ';
+            out += std::to_string(node.self_cycles);
+            out += '\n';
+        }
+        for (auto it = node.children.rbegin(); it != node.children.rend(); ++it)
+        {
+            pending.emplace_back(it->second, path + ";" + functions_[it->first].profile.name);
+        }
+    }
+    return out;
+}
+
+std::string
+render_profile_report(const Profiler& profiler,
+                      const std::function<std::string(const curlee::source::Span&)>& where,
+                      std::size_t max_spans)
+{
+    const std::uint64_t total = profiler.total_cycles();
+    std::ostringstream out;
+    out << "profile: " << profiler.instructions() << " instructions, " << total << " cycles\n";
+
+    out << "\nopcodes (by cycles):\n";
+    out << "  " << std::left << std::setw(14) << "opcode" << std::right << std::setw(12)
+        << "count" << std::setw(16) << "cycles" << std::setw(10) << "share" << std::setw(12)
+        << "cyc/op" << "\n";
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < kOpCodeCount; ++i)
+    {
+        if (profiler.opcodes()[i].count > 0)
+        {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+                     { return profiler.opcodes()[a].cycles > profiler.opcodes()[b].cycles; });
+    for (const std::size_t i : order)
+    {
+        const auto& op = profiler.opcodes()[i];
+        out << "  " << std::left << std::setw(14) << opcode_name(static_cast<OpCode>(i))
+            << std::right << std::setw(12) << op.count << std::setw(16) << op.cycles
+            << std::setw(10) << percent(op.cycles, total) << std::setw(12)
+            << op.cycles / op.count << "\n";
+    }
+
+    out << "\nfunctions (by exclusive cycles):\n";
+    out << "  " << std::left << std::setw(20) << "function" << std::right << std::setw(10)
+        << "calls" << std::setw(16) << "inclusive" << std::setw(16) << "exclusive"
+        << std::setw(10) << "share" << "\n";
+    for (const auto& fn : profiler.functions())
+    {
+        out << "  " << std::left << std::setw(20) << fn.name << std::right << std::setw(10)
+            << fn.calls << std::setw(16) << fn.inclusive_cycles << std::setw(16)
+            << fn.exclusive_cycles << std::setw(10) << percent(fn.exclusive_cycles, total)
+            << "\n";
+    }
+
+    out << "\nhot spans (by cycles):\n";
+    for (const auto& span : profiler.hot_spans(max_spans))
+    {
+        out << "  " << std::left << std::setw(36) << where(span.span) << " " << std::right
+            << std::setw(12) << span.count << std::setw(16) << span.cycles << std::setw(10)
+            << percent(span.cycles, total) << "\n";
+    }
+    return out.str();
+}
+
+} // namespace curlee::vm
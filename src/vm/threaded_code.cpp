@@ -0,0 +1,128 @@
+#include <cstddef>
+#include <cstdint>
+#include <curlee/vm/threaded_code.h>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace curlee::vm
+{
+
+namespace
+{
+
+constexpr std::uint32_t kNoInstr = std::numeric_limits<std::uint32_t>::max();
+
+[[nodiscard]] bool is_branch(std::uint8_t handler_id)
+{
+    return handler_id == static_cast<std::uint8_t>(OpCode::Jump) ||
+           handler_id == static_cast<std::uint8_t>(OpCode::JumpIfFalse) ||
+           handler_id == static_cast<std::uint8_t>(OpCode::Call);
+}
+
+} // namespace
+
+std::vector<std::uint16_t> function_index(const Chunk& chunk)
+{
+    std::vector<std::uint16_t> function_of(chunk.code.size(), kThreadedNoFunction);
+    for (std::size_t i = 0; i < chunk.functions.size() && i < kThreadedNoFunction; ++i)
+    {
+        const std::size_t entry = chunk.functions[i].entry;
+        if (entry < function_of.size() && function_of[entry] == kThreadedNoFunction)
+        {
+            function_of[entry] = static_cast<std::uint16_t>(i);
+        }
+    }
+    return function_of;
+}
+
+std::optional<ThreadedCode> predecode(const Chunk& chunk)
+{
+    const std::size_t size = chunk.code.size();
+    if (size >= static_cast<std::size_t>(kNoInstr))
+    {
+        return std::nullopt;
+    }
+
+    ThreadedCode out;
+    out.instrs.reserve(size + 1);
+
+    // Byte offset -> instruction index, for resolving branch targets.
+    std::vector<std::uint32_t> index_of(size, kNoInstr);
+
+    const std::vector<std::uint16_t> function_of = function_index(chunk);
+
+    std::size_t pos = 0;
+    while (pos < size)
+    {
+        index_of[pos] = static_cast<std::uint32_t>(out.instrs.size());
+
+        ThreadedInstr instr;
+        instr.offset = static_cast<std::uint32_t>(pos);
+        const std::uint8_t byte = chunk.code[pos];
+        if (byte >= kOpCodeCount)
+        {
+            instr.handler_id = static_cast<std::uint8_t>(ThreadedPseudoOp::Nop);
+            out.instrs.push_back(instr);
+            pos += 1;
+            continue;
+        }
+
+        const auto op = static_cast<OpCode>(byte);
+        if (!has_u16_operand(op))
+        {
+            instr.handler_id = byte;
+            out.instrs.push_back(instr);
+            pos += 1;
+            continue;
+        }
+
+        if (pos + 2 >= size)
+        {
+            // Nothing after a truncated operand can be decoded; the switch loop errors here too.
+            instr.handler_id = static_cast<std::uint8_t>(ThreadedPseudoOp::Truncated);
+            instr.operand = byte;
+            out.instrs.push_back(instr);
+            break;
+        }
+
+        const std::uint16_t lo = chunk.code[pos + 1];
+        const std::uint16_t hi = chunk.code[pos + 2];
+        instr.handler_id = byte;
+        instr.operand = static_cast<std::uint16_t>(lo | (hi << 8));
+        out.instrs.push_back(instr);
+        pos += 3;
+    }
+
+    ThreadedInstr end;
+    end.handler_id = static_cast<std::uint8_t>(ThreadedPseudoOp::End);
+    end.offset = static_cast<std::uint32_t>(size);
+    out.instrs.push_back(end);
+
+    for (auto& instr : out.instrs)
+    {
+        if (!is_branch(instr.handler_id))
+        {
+            continue;
+        }
+        if (instr.operand >= size)
+        {
+            instr.operand = kThreadedInvalidTarget;
+            continue;
+        }
+        const std::uint32_t target = index_of[instr.operand];
+        if (target == kNoInstr)
+        {
+            return std::nullopt;
+        }
+        if (instr.handler_id == static_cast<std::uint8_t>(OpCode::Call))
+        {
+            instr.callee = function_of[instr.operand];
+        }
+        instr.operand = target;
+    }
+
+    return out;
+}
+
+} // namespace curlee::vm
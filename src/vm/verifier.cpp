@@ -0,0 +1,638 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <curlee/vm/verifier.h>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace curlee::vm
+{
+
+namespace
+{
+
+// Abstract value kinds as a bitset; 0 means "no information yet" (optimistic bottom).
+using Kinds = std::uint8_t;
+constexpr Kinds kInt = 1;
+constexpr Kinds kBool = 2;
+constexpr Kinds kString = 4;
+constexpr Kinds kUnit = 8;
+constexpr Kinds kAny = kInt | kBool | kString | kUnit;
+
+constexpr std::size_t kMaxRounds = 256;
+constexpr std::size_t kMaxPrefix = 255;
+
+[[nodiscard]] Kinds kind_of(const Value& value)
+{
+    switch (value.kind)
+    {
+    case ValueKind::Int:
+        return kInt;
+    case ValueKind::Bool:
+        return kBool;
+    case ValueKind::String:
+        return kString;
+    case ValueKind::Unit:
+        return kUnit;
+    }
+    return kAny; // GCOVR_EXCL_LINE
+}
+
+[[nodiscard]] bool only(Kinds kinds, Kinds allowed)
+{
+    return (kinds & ~allowed) == 0;
+}
+
+struct AbsState
+{
+    std::vector<Kinds> stack;
+    std::vector<Kinds> locals;
+};
+
+// One analysis context: ip=0 (the root, entered with an empty stack and Unit locals) or a call
+// target. A target with a FunctionInfo gets a fresh frame holding its `args`; one without shares
+// the caller's frame (unknown local kinds). Either may also consume `prefix` caller values left
+// on the operand stack.
+struct Context
+{
+    bool root = false;
+    const FunctionInfo* fn = nullptr;
+    std::optional<std::size_t> frame_size;       // shared frames: smallest caller frame
+    std::vector<Kinds> args;                     // parameter kinds, joined over all call sites
+    std::vector<Kinds> prefix;                   // bottom..top, joined over all call sites
+    std::optional<std::vector<Kinds>> ret_stack; // abstract stack at every reachable Ret
+    std::vector<bool> writes;                    // local slots stored here or in callees
+    std::vector<bool> reached;
+    std::vector<bool> unproven;  // kinds not proven for this instruction
+    std::vector<Kinds> operands; // Add only: union of the operand kinds seen
+};
+
+struct NeedPrefix
+{
+    std::size_t count = 0;
+};
+
+using StepOutcome = std::variant<std::monostate, NeedPrefix, BytecodeVerifyError>;
+
+[[nodiscard]] bool is_pseudo(const ThreadedInstr& instr, ThreadedPseudoOp op)
+{
+    return instr.handler_id == static_cast<std::uint8_t>(op);
+}
+
+class Verifier
+{
+  public:
+    Verifier(const Chunk& chunk, const ThreadedCode& code) : chunk_(chunk), code_(code) {}
+
+    std::optional<BytecodeVerifyError> run()
+    {
+        Context& root = contexts_[0];
+        root.root = true;
+        root.frame_size = chunk_.max_locals;
+
+        for (std::size_t round = 0; round < kMaxRounds; ++round)
+        {
+            changed_ = false;
+            // contexts_ may grow while iterating; std::map iterators stay valid.
+            for (auto& [entry, ctx] : contexts_)
+            {
+                const auto outcome = analyze(entry, ctx);
+                if (const auto* err = std::get_if<BytecodeVerifyError>(&outcome))
+                {
+                    return *err;
+                }
+                if (const auto* need = std::get_if<NeedPrefix>(&outcome))
+                {
+                    if (ctx.prefix.size() + need->count > kMaxPrefix)
+                    {
+                        return error("call consumes too many stack values", entry);
+                    }
+                    ctx.prefix.insert(ctx.prefix.begin(), need->count, Kinds{0});
+                    changed_ = true;
+                }
+            }
+            if (!changed_)
+            {
+                return std::nullopt;
+            }
+        }
+        return error("bytecode verifier did not converge", 0);
+    }
+
+    // Instruction facts combined over every context that reaches it.
+    void specialise(ThreadedCode& code) const
+    {
+        for (std::size_t i = 0; i < code.instrs.size(); ++i)
+        {
+            bool reached = false;
+            bool proven = true;
+            Kinds operands = 0;
+            for (const auto& [entry, ctx] : contexts_)
+            {
+                (void)entry;
+                if (ctx.reached[i])
+                {
+                    reached = true;
+                    proven = proven && !ctx.unproven[i];
+                    operands |= ctx.operands[i];
+                }
+            }
+            if (reached)
+            {
+                code.instrs[i].handler_id =
+                    specialised_handler(code.instrs[i], proven, operands);
+            }
+        }
+        code.verified = true;
+    }
+
+  private:
+    const Chunk& chunk_;
+    const ThreadedCode& code_;
+    std::map<std::uint32_t, Context> contexts_;
+    bool changed_ = false;
+
+    [[nodiscard]] BytecodeVerifyError error(std::string message, std::uint32_t index) const
+    {
+        return BytecodeVerifyError{.message = std::move(message),
+                                   .offset = code_.instrs[index].offset};
+    }
+
+    Context& context_for(std::uint32_t entry, std::uint16_t callee)
+    {
+        auto it = contexts_.find(entry);
+        if (it == contexts_.end())
+        {
+            Context ctx;
+            if (callee != kThreadedNoFunction)
+            {
+                ctx.fn = &chunk_.functions[callee];
+                ctx.args.assign(ctx.fn->arity, Kinds{0});
+                ctx.frame_size = std::max(ctx.fn->locals, ctx.fn->arity);
+            }
+            it = contexts_.emplace(entry, std::move(ctx)).first;
+            changed_ = true;
+        }
+        return it->second;
+    }
+
+    void join_into(std::vector<Kinds>& dst, const std::vector<Kinds>& src)
+    {
+        // Top-aligned join; dst and src have the same length here.
+        for (std::size_t i = 0; i < dst.size(); ++i)
+        {
+            const Kinds merged = dst[i] | src[i];
+            if (merged != dst[i])
+            {
+                dst[i] = merged;
+                changed_ = true;
+            }
+        }
+    }
+
+    StepOutcome analyze(std::uint32_t entry, Context& ctx)
+    {
+        const std::size_t n = code_.instrs.size();
+        const std::size_t locals_count = ctx.frame_size.value_or(0);
+
+        ctx.reached.assign(n, false);
+        ctx.unproven.assign(n, false);
+        ctx.operands.assign(n, Kinds{0});
+        ctx.writes.resize(locals_count, false);
+        std::optional<std::vector<Kinds>> ret_stack;
+
+        std::vector<std::optional<AbsState>> states(n);
+        std::vector<std::uint32_t> worklist;
+
+        AbsState init;
+        init.stack = ctx.prefix;
+        init.locals.assign(locals_count, ctx.root || ctx.fn != nullptr ? kUnit : kAny);
+        std::copy(ctx.args.begin(), ctx.args.end(), init.locals.begin());
+        states[entry] = std::move(init);
+        worklist.push_back(entry);
+
+        while (!worklist.empty())
+        {
+            const std::uint32_t i = worklist.back();
+            worklist.pop_back();
+            AbsState s = *states[i];
+            ctx.reached[i] = true;
+            const ThreadedInstr& instr = code_.instrs[i];
+
+            const auto require = [&](std::size_t count) -> StepOutcome
+            {
+                if (s.stack.size() >= count)
+                {
+                    return std::monostate{};
+                }
+                if (ctx.root)
+                {
+                    return error("stack underflow", i);
+                }
+                return NeedPrefix{.count = count - s.stack.size()};
+            };
+            const auto pop = [&s]()
+            {
+                const Kinds k = s.stack.back();
+                s.stack.pop_back();
+                return k;
+            };
+            const auto flow = [&](std::uint32_t succ, const AbsState& out) -> StepOutcome
+            {
+                auto& slot = states[succ];
+                if (!slot.has_value())
+                {
+                    slot = out;
+                    worklist.push_back(succ);
+                    return std::monostate{};
+                }
+                if (slot->stack.size() != out.stack.size())
+                {
+                    return error("inconsistent stack depth", succ);
+                }
+                bool grew = false;
+                for (std::size_t k = 0; k < out.stack.size(); ++k)
+                {
+                    grew = grew || (slot->stack[k] | out.stack[k]) != slot->stack[k];
+                    slot->stack[k] |= out.stack[k];
+                }
+                for (std::size_t k = 0; k < out.locals.size(); ++k)
+                {
+                    grew = grew || (slot->locals[k] | out.locals[k]) != slot->locals[k];
+                    slot->locals[k] |= out.locals[k];
+                }
+                if (grew)
+                {
+                    worklist.push_back(succ);
+                }
+                return std::monostate{};
+            };
+            const auto fallthrough = [&]() { return flow(i + 1, s); };
+
+#define CURLEE_VERIFY_TRY(expr)                                                                    \
+    do                                                                                             \
+    {                                                                                              \
+        auto outcome_ = (expr);                                                                    \
+        if (!std::holds_alternative<std::monostate>(outcome_))                                     \
+        {                                                                                          \
+            return outcome_;                                                                       \
+        }                                                                                          \
+    } while (false)
+
+            if (instr.handler_id >= kOpCodeCount)
+            {
+                if (is_pseudo(instr, ThreadedPseudoOp::Nop))
+                {
+                    CURLEE_VERIFY_TRY(fallthrough());
+                    continue;
+                }
+                if (is_pseudo(instr, ThreadedPseudoOp::End))
+                {
+                    continue; // VM reports "no return"; nothing unsafe happens.
+                }
+                return error("truncated operand", i);
+            }
+
+            const auto op = static_cast<OpCode>(instr.handler_id);
+            switch (op)
+            {
+            case OpCode::Constant:
+                if (instr.operand >= chunk_.constants.size())
+                {
+                    return error("constant index out of range", i);
+                }
+                s.stack.push_back(kind_of(chunk_.constants[instr.operand]));
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            case OpCode::LoadLocal:
+                if (instr.operand >= locals_count)
+                {
+                    return error("local index out of range", i);
+                }
+                s.stack.push_back(s.locals[instr.operand]);
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            case OpCode::StoreLocal:
+                CURLEE_VERIFY_TRY(require(1));
+                if (instr.operand >= locals_count)
+                {
+                    return error("local index out of range", i);
+                }
+                s.locals[instr.operand] = pop();
+                if (!ctx.writes[instr.operand])
+                {
+                    ctx.writes[instr.operand] = true;
+                    changed_ = true;
+                }
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            case OpCode::Add:
+            {
+                CURLEE_VERIFY_TRY(require(2));
+                const Kinds rhs = pop();
+                const Kinds lhs = pop();
+                ctx.operands[i] |= static_cast<Kinds>(lhs | rhs);
+                if (only(lhs, kInt) && only(rhs, kInt))
+                {
+                    s.stack.push_back(kInt);
+                }
+                else if (only(lhs, kString) && only(rhs, kString))
+                {
+                    s.stack.push_back(kString);
+                }
+                else
+                {
+                    ctx.unproven[i] = true;
+                    s.stack.push_back(kInt | kString);
+                }
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            }
+            case OpCode::Sub:
+            case OpCode::Mul:
+            case OpCode::Div:
+            case OpCode::AddUnchecked:
+            case OpCode::SubUnchecked:
+            case OpCode::MulUnchecked:
+            case OpCode::DivUnchecked:
+            case OpCode::Less:
+            case OpCode::LessEqual:
+            case OpCode::Greater:
+            case OpCode::GreaterEqual:
+            {
+                CURLEE_VERIFY_TRY(require(2));
+                const Kinds rhs = pop();
+                const Kinds lhs = pop();
+                if (!only(lhs, kInt) || !only(rhs, kInt))
+                {
+                    ctx.unproven[i] = true;
+                }
+                const bool arith = op != OpCode::Less && op != OpCode::LessEqual &&
+                                   op != OpCode::Greater && op != OpCode::GreaterEqual;
+                s.stack.push_back(arith ? kInt : kBool);
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            }
+            case OpCode::Neg:
+            case OpCode::NegUnchecked:
+            case OpCode::Not:
+            {
+                CURLEE_VERIFY_TRY(require(1));
+                const Kinds expected = op == OpCode::Not ? kBool : kInt;
+                if (!only(pop(), expected))
+                {
+                    ctx.unproven[i] = true;
+                }
+                s.stack.push_back(expected);
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            }
+            case OpCode::Equal:
+            case OpCode::NotEqual:
+                CURLEE_VERIFY_TRY(require(2));
+                (void)pop();
+                (void)pop();
+                s.stack.push_back(kBool);
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            case OpCode::Pop:
+                CURLEE_VERIFY_TRY(require(1));
+                (void)pop();
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            case OpCode::Return:
+                CURLEE_VERIFY_TRY(require(1));
+                break;
+            case OpCode::Jump:
+                if (instr.operand == kThreadedInvalidTarget)
+                {
+                    return error("jump target out of range", i);
+                }
+                CURLEE_VERIFY_TRY(flow(instr.operand, s));
+                break;
+            case OpCode::JumpIfFalse:
+                CURLEE_VERIFY_TRY(require(1));
+                if (instr.operand == kThreadedInvalidTarget)
+                {
+                    return error("jump target out of range", i);
+                }
+                if (!only(pop(), kBool))
+                {
+                    ctx.unproven[i] = true;
+                }
+                CURLEE_VERIFY_TRY(fallthrough());
+                CURLEE_VERIFY_TRY(flow(instr.operand, s));
+                break;
+            case OpCode::Call:
+            {
+                if (instr.operand == kThreadedInvalidTarget)
+                {
+                    return error("call target out of range", i);
+                }
+                Context& callee = context_for(instr.operand, instr.callee);
+                const std::size_t below = callee.prefix.size();
+                const std::size_t consumed = below + callee.args.size();
+                CURLEE_VERIFY_TRY(require(consumed));
+
+                const auto args_begin = s.stack.end() - static_cast<std::ptrdiff_t>(consumed);
+                const auto params_begin = args_begin + static_cast<std::ptrdiff_t>(below);
+                join_into(callee.prefix, std::vector<Kinds>(args_begin, params_begin));
+                join_into(callee.args, std::vector<Kinds>(params_begin, s.stack.end()));
+                if (callee.fn == nullptr &&
+                    (!callee.frame_size.has_value() || *callee.frame_size > locals_count))
+                {
+                    callee.frame_size = locals_count;
+                    changed_ = true;
+                }
+
+                if (!callee.ret_stack.has_value())
+                {
+                    break; // No summary yet; the return site is reached in a later round.
+                }
+                s.stack.erase(args_begin, s.stack.end());
+                s.stack.insert(s.stack.end(), callee.ret_stack->begin(), callee.ret_stack->end());
+                // Only a shared-frame callee can write the caller's locals.
+                for (std::size_t slot = 0; callee.fn == nullptr && slot < callee.writes.size();
+                     ++slot)
+                {
+                    if (!callee.writes[slot])
+                    {
+                        continue;
+                    }
+                    s.locals[slot] = kAny;
+                    if (!ctx.writes[slot])
+                    {
+                        ctx.writes[slot] = true;
+                        changed_ = true;
+                    }
+                }
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            }
+            case OpCode::Ret:
+                if (ctx.root)
+                {
+                    return error("return with empty call stack", i);
+                }
+                if (!ret_stack.has_value())
+                {
+                    ret_stack = s.stack;
+                }
+                else if (ret_stack->size() != s.stack.size())
+                {
+                    return error("inconsistent stack depth at return", i);
+                }
+                else
+                {
+                    for (std::size_t k = 0; k < s.stack.size(); ++k)
+                    {
+                        (*ret_stack)[k] |= s.stack[k];
+                    }
+                }
+                break;
+            case OpCode::Print:
+                CURLEE_VERIFY_TRY(require(1));
+                (void)pop();
+                s.stack.push_back(kUnit);
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            case OpCode::PythonCall:
+                s.stack.push_back(kUnit);
+                CURLEE_VERIFY_TRY(fallthrough());
+                break;
+            }
+
+#undef CURLEE_VERIFY_TRY
+        }
+
+        if (ret_stack.has_value())
+        {
+            if (!ctx.ret_stack.has_value() || ctx.ret_stack->size() != ret_stack->size())
+            {
+                ctx.ret_stack = std::move(ret_stack);
+                changed_ = true;
+            }
+            else
+            {
+                join_into(*ctx.ret_stack, *ret_stack);
+            }
+        }
+        return std::monostate{};
+    }
+
+    [[nodiscard]] static std::uint8_t specialised_handler(const ThreadedInstr& instr, bool proven,
+                                                          Kinds operands)
+    {
+        const auto pseudo = [](ThreadedPseudoOp op) { return static_cast<std::uint8_t>(op); };
+        if (instr.handler_id >= kOpCodeCount)
+        {
+            return instr.handler_id;
+        }
+
+        switch (static_cast<OpCode>(instr.handler_id))
+        {
+        case OpCode::Constant:
+            return pseudo(ThreadedPseudoOp::VerifiedConstant);
+        case OpCode::LoadLocal:
+            return pseudo(ThreadedPseudoOp::VerifiedLoadLocal);
+        case OpCode::StoreLocal:
+            return pseudo(ThreadedPseudoOp::VerifiedStoreLocal);
+        case OpCode::Pop:
+            return pseudo(ThreadedPseudoOp::VerifiedPop);
+        case OpCode::Equal:
+            return pseudo(ThreadedPseudoOp::VerifiedEqual);
+        case OpCode::NotEqual:
+            return pseudo(ThreadedPseudoOp::VerifiedNotEqual);
+        case OpCode::Return:
+            return pseudo(ThreadedPseudoOp::VerifiedReturn);
+        case OpCode::Jump:
+            return pseudo(ThreadedPseudoOp::VerifiedJump);
+        case OpCode::Call:
+            return pseudo(ThreadedPseudoOp::VerifiedCall);
+        case OpCode::Ret:
+            return pseudo(ThreadedPseudoOp::VerifiedRet);
+        case OpCode::Print:
+            return pseudo(ThreadedPseudoOp::VerifiedPrint);
+        case OpCode::PythonCall:
+            return instr.handler_id;
+        default:
+            break;
+        }
+
+        if (!proven)
+        {
+            return instr.handler_id;
+        }
+
+        switch (static_cast<OpCode>(instr.handler_id))
+        {
+        case OpCode::Add:
+            // Int+Int in one context and String+String in another stays on the checked handler.
+            if (operands == kInt)
+            {
+                return pseudo(ThreadedPseudoOp::VerifiedAddInt);
+            }
+            if (operands == kString)
+            {
+                return pseudo(ThreadedPseudoOp::VerifiedAddString);
+            }
+            return instr.handler_id;
+        case OpCode::Sub:
+            return pseudo(ThreadedPseudoOp::VerifiedSubInt);
+        case OpCode::Mul:
+            return pseudo(ThreadedPseudoOp::VerifiedMulInt);
+        case OpCode::Div:
+            return pseudo(ThreadedPseudoOp::VerifiedDivInt);
+        case OpCode::Neg:
+            return pseudo(ThreadedPseudoOp::VerifiedNegInt);
+        case OpCode::AddUnchecked:
+            return pseudo(ThreadedPseudoOp::VerifiedAddIntUnchecked);
+        case OpCode::SubUnchecked:
+            return pseudo(ThreadedPseudoOp::VerifiedSubIntUnchecked);
+        case OpCode::MulUnchecked:
+            return pseudo(ThreadedPseudoOp::VerifiedMulIntUnchecked);
+        case OpCode::DivUnchecked:
+            return pseudo(ThreadedPseudoOp::VerifiedDivIntUnchecked);
+        case OpCode::NegUnchecked:
+            return pseudo(ThreadedPseudoOp::VerifiedNegIntUnchecked);
+        case OpCode::Not:
+            return pseudo(ThreadedPseudoOp::VerifiedNotBool);
+        case OpCode::Less:
+            return pseudo(ThreadedPseudoOp::VerifiedLessInt);
+        case OpCode::LessEqual:
+            return pseudo(ThreadedPseudoOp::VerifiedLessEqualInt);
+        case OpCode::Greater:
+            return pseudo(ThreadedPseudoOp::VerifiedGreaterInt);
+        case OpCode::GreaterEqual:
+            return pseudo(ThreadedPseudoOp::VerifiedGreaterEqualInt);
+        case OpCode::JumpIfFalse:
+            return pseudo(ThreadedPseudoOp::VerifiedJumpIfFalse);
+        default:
+            return instr.handler_id; // GCOVR_EXCL_LINE
+        }
+    }
+};
+
+} // namespace
+
+std::optional<BytecodeVerifyError> verify_bytecode(const Chunk& chunk, ThreadedCode& code)
+{
+    if (code.verified)
+    {
+        return std::nullopt;
+    }
+
+    Verifier verifier(chunk, code);
+    if (auto err = verifier.run(); err.has_value())
+    {
+        return err;
+    }
+    verifier.specialise(code);
+    return std::nullopt;
+}
+
+} // namespace curlee::vm
@@ -1,38 +1,34 @@
 #include <cerrno>
 #include <chrono>
 #include <csignal>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <curlee/vm/vm.h>
 #include <fcntl.h>
 #include <filesystem>
+#include <functional>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <poll.h>
 #include <string>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <thread>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
 namespace
 {
 
-struct ProcResult
-{
-    int exit_code = -1;
-    std::string out;
-    std::string err;
-    bool timed_out = false;
-    bool output_limit_exceeded = false;
-};
-
 constexpr int kPythonRunnerTimeoutMs = 500;
 constexpr std::size_t kPythonRunnerMaxOutputBytes = 1 * 1024 * 1024;
-
-ProcResult run_process_argv(const std::vector<const char*>& argv, const std::string& exe_path,
-                            const std::string& stdin_data, int timeout_ms,
-                            std::size_t max_output_bytes);
+constexpr std::size_t kPythonRunnerMaxCallsPerWorker = 256;
+constexpr std::size_t kPythonRunnerMaxIdleWorkers = 4;
 
 void set_nonblocking(int fd)
 {
@@ -92,106 +88,126 @@ void read_into(int fd, std::string& out, bool& eof, std::size_t& total_bytes,
     }
 }
 
-ProcResult run_process(const std::string& exe_path, const std::string& stdin_data, int timeout_ms,
-                       std::size_t max_output_bytes)
+struct SigPipeIgnoreGuard
 {
-    std::vector<std::string> argv_storage;
-    argv_storage.push_back(exe_path);
+    using Handler = void (*)(int);
+    Handler old;
+
+    SigPipeIgnoreGuard() : old(std::signal(SIGPIPE, SIG_IGN)) {}
 
-    std::vector<const char*> argv;
-    argv.reserve(argv_storage.size() + 1);
-    for (const auto& s : argv_storage)
+    ~SigPipeIgnoreGuard()
     {
-        argv.push_back(s.c_str());
+        if (old != SIG_ERR) // GCOVR_EXCL_LINE
+        {
+            (void)std::signal(SIGPIPE, old);
+        }
     }
-    argv.push_back(nullptr);
+};
+
+/** @brief How to start a runner: argv[0] is the executable, `env` its complete environment. */
+struct RunnerCommand
+{
+    std::vector<std::string> argv;
+    std::vector<std::string> env;
+};
 
-    return run_process_argv(argv, exe_path, stdin_data, timeout_ms, max_output_bytes);
+/** @brief The deterministic, scrubbed environment every runner process starts with. */
+std::vector<std::string> runner_env()
+{
+    std::vector<std::string> env;
+    env.emplace_back("LC_ALL=C");
+    env.emplace_back("LANG=C");
+    env.emplace_back("TZ=UTC");
+    env.emplace_back("PYTHONHASHSEED=0");
+    for (const char* key : {"PATH", "LD_LIBRARY_PATH", "ASAN_OPTIONS", "UBSAN_OPTIONS",
+                            "LSAN_OPTIONS"})
+    {
+        if (const char* value = std::getenv(key); value != nullptr)
+        {
+            env.emplace_back(std::string(key) + "=" + value);
+        }
+    }
+    return env;
 }
 
-ProcResult run_process_argv(const std::vector<const char*>& argv, const std::string& exe_path,
-                            const std::string& stdin_data, int timeout_ms,
-                            std::size_t max_output_bytes)
+/** @brief A live runner process and the parent ends of its stdio pipes. */
+struct RunnerWorker
+{
+    pid_t pid = -1;
+    int in_fd = -1;
+    int out_fd = -1;
+    int err_fd = -1;
+    std::size_t calls = 0;
+};
+
+/** @brief Outcome of one request sent to a worker. */
+struct RunnerReply
+{
+    /** First stdout line (without the newline), or everything written before stdout closed. */
+    std::string response;
+    /** Exit code once the worker has been reaped; -1 while it is still alive. */
+    int exit_code = -1;
+    bool timed_out = false;
+    bool output_limit_exceeded = false;
+    bool closed = false;     ///< stdout reached EOF
+    bool trailing = false;   ///< bytes followed the response line
+};
+
+using Deadline = std::chrono::steady_clock::time_point;
+
+/** @brief Start a worker; returns nullopt when pipes or fork are unavailable. */
+std::optional<RunnerWorker> spawn_worker(const RunnerCommand& command)
 {
     int in_pipe[2] = {-1, -1};
     int out_pipe[2] = {-1, -1};
     int err_pipe[2] = {-1, -1};
-    ProcResult result;
 
-    std::vector<char*> argv_mut;
-    argv_mut.reserve(argv.size());
-    for (const auto* a : argv)
+    std::vector<char*> argv;
+    argv.reserve(command.argv.size() + 1);
+    for (const auto& a : command.argv)
     {
-        argv_mut.push_back(const_cast<char*>(a));
-    }
-
-    const auto* parent_path = std::getenv("PATH");
-    const auto* parent_ld_library_path = std::getenv("LD_LIBRARY_PATH");
-    const auto* parent_asan_options = std::getenv("ASAN_OPTIONS");
-    const auto* parent_ubsan_options = std::getenv("UBSAN_OPTIONS");
-    const auto* parent_lsan_options = std::getenv("LSAN_OPTIONS");
-
-    std::vector<std::string> env_storage;
-    env_storage.emplace_back("LC_ALL=C");
-    env_storage.emplace_back("LANG=C");
-    env_storage.emplace_back("TZ=UTC");
-    env_storage.emplace_back("PYTHONHASHSEED=0");
-    if (parent_path != nullptr)
-    {
-        env_storage.emplace_back(std::string("PATH=") + parent_path);
-    }
-    if (parent_ld_library_path != nullptr)
-    {
-        env_storage.emplace_back(std::string("LD_LIBRARY_PATH=") + parent_ld_library_path);
-    }
-    if (parent_asan_options != nullptr)
-    {
-        env_storage.emplace_back(std::string("ASAN_OPTIONS=") + parent_asan_options);
-    }
-    if (parent_ubsan_options != nullptr)
-    {
-        env_storage.emplace_back(std::string("UBSAN_OPTIONS=") + parent_ubsan_options);
-    }
-    if (parent_lsan_options != nullptr)
-    {
-        env_storage.emplace_back(std::string("LSAN_OPTIONS=") + parent_lsan_options);
+        argv.push_back(const_cast<char*>(a.c_str()));
     }
+    argv.push_back(nullptr);
 
     std::vector<char*> envp;
-    envp.reserve(env_storage.size() + 1);
-    for (auto& kv : env_storage)
+    envp.reserve(command.env.size() + 1);
+    for (const auto& kv : command.env)
     {
-        envp.push_back(kv.data());
+        envp.push_back(const_cast<char*>(kv.c_str()));
     }
     envp.push_back(nullptr);
 
-    if (pipe(in_pipe) != 0)
+    // Close-on-exec keeps one worker from inheriting another's pipes, which would otherwise
+    // hide the EOF that tells an idle worker to exit.
+    if (pipe2(in_pipe, O_CLOEXEC) != 0)
     {
-        result.exit_code = 127; // GCOVR_EXCL_LINE
-        return result;          // GCOVR_EXCL_LINE
-    } // GCOVR_EXCL_LINE
-    if (pipe(out_pipe) != 0)
+        return std::nullopt;
+    }
+    if (pipe2(out_pipe, O_CLOEXEC) != 0)
     {
         close(in_pipe[0]);
         close(in_pipe[1]);
-        result.exit_code = 127;
-        return result;
+        return std::nullopt;
     }
-    if (pipe(err_pipe) != 0)
+    if (pipe2(err_pipe, O_CLOEXEC) != 0)
     {
         close(in_pipe[0]);
         close(in_pipe[1]);
         close(out_pipe[0]);
         close(out_pipe[1]);
-        result.exit_code = 127;
-        return result;
+        return std::nullopt;
     }
 
     const pid_t pid = fork();
     if (pid < 0) // GCOVR_EXCL_LINE
     {
-        result.exit_code = 127; // GCOVR_EXCL_LINE
-        return result;          // GCOVR_EXCL_LINE
+        for (const int fd : {in_pipe[0], in_pipe[1], out_pipe[0], out_pipe[1], err_pipe[0], // GCOVR_EXCL_LINE
+                             err_pipe[1]})
+        {
+            close(fd); // GCOVR_EXCL_LINE
+        }
+        return std::nullopt; // GCOVR_EXCL_LINE
     }
 
     if (pid == 0) // GCOVR_EXCL_LINE
@@ -200,14 +216,7 @@ ProcResult run_process_argv(const std::vector<const char*>& argv, const std::str
         (void)dup2(out_pipe[1], STDOUT_FILENO); // GCOVR_EXCL_LINE
         (void)dup2(err_pipe[1], STDERR_FILENO); // GCOVR_EXCL_LINE
 
-        close(in_pipe[0]);  // GCOVR_EXCL_LINE
-        close(in_pipe[1]);  // GCOVR_EXCL_LINE
-        close(out_pipe[0]); // GCOVR_EXCL_LINE
-        close(out_pipe[1]); // GCOVR_EXCL_LINE
-        close(err_pipe[0]); // GCOVR_EXCL_LINE
-        close(err_pipe[1]); // GCOVR_EXCL_LINE
-
-        execve(exe_path.c_str(), argv_mut.data(), envp.data());         // GCOVR_EXCL_LINE
+        execve(argv[0], argv.data(), envp.data());                      // GCOVR_EXCL_LINE
         std::cerr << "execve failed: " << std::strerror(errno) << "\n"; // GCOVR_EXCL_LINE
         std::cerr.flush();                                              // GCOVR_EXCL_LINE
         _exit(127);                                                     // GCOVR_EXCL_LINE
@@ -216,107 +225,150 @@ ProcResult run_process_argv(const std::vector<const char*>& argv, const std::str
     close(in_pipe[0]);
     close(out_pipe[1]);
     close(err_pipe[1]);
+    set_nonblocking(out_pipe[0]);
+    set_nonblocking(err_pipe[0]);
 
-    // Write input then close.
-    {
-        struct SigPipeIgnoreGuard
-        {
-            using Handler = void (*)(int);
-            Handler old;
+    RunnerWorker worker;
+    worker.pid = pid;
+    worker.in_fd = in_pipe[1];
+    worker.out_fd = out_pipe[0];
+    worker.err_fd = err_pipe[0];
+    return worker;
+}
+
+[[nodiscard]] int exit_code_of(int status)
+{
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128;
+}
 
-            SigPipeIgnoreGuard() : old(std::signal(SIGPIPE, SIG_IGN)) {}
+/**
+ * @brief Close a worker's pipes and collect its exit code.
+ *
+ * A worker that is still running at `deadline` (or immediately, with `kill_now`) is killed.
+ */
+int reap_worker(RunnerWorker& worker, Deadline deadline, bool kill_now)
+{
+    close(worker.in_fd);
+    close(worker.out_fd);
+    close(worker.err_fd);
+    worker.in_fd = worker.out_fd = worker.err_fd = -1;
 
-            ~SigPipeIgnoreGuard()
+    int status = 0;
+    if (!kill_now)
+    {
+        while (true)
+        {
+            const pid_t done = waitpid(worker.pid, &status, WNOHANG);
+            if (done == worker.pid)
             {
-                if (old != SIG_ERR) // GCOVR_EXCL_LINE
-                {
-                    (void)std::signal(SIGPIPE, old);
-                }
+                return exit_code_of(status);
+            }
+            if (done < 0) // GCOVR_EXCL_LINE
+            {
+                return 127; // GCOVR_EXCL_LINE
             }
-        } sigpipe_guard;
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    (void)kill(worker.pid, SIGKILL);
+    if (waitpid(worker.pid, &status, 0) < 0) // GCOVR_EXCL_LINE
+    {
+        return 127; // GCOVR_EXCL_LINE
+    }
+    return exit_code_of(status);
+}
+
+/** @brief True once the worker process has exited (it is reaped as a side effect). */
+[[nodiscard]] bool worker_exited(RunnerWorker& worker)
+{
+    int status = 0;
+    if (waitpid(worker.pid, &status, WNOHANG) != worker.pid)
+    {
+        return false;
+    }
+    close(worker.in_fd);
+    close(worker.out_fd);
+    close(worker.err_fd);
+    return true;
+}
 
-        const char* data = stdin_data.data();
-        std::size_t remaining = stdin_data.size();
+/** @brief Write one request line and read until a response line, EOF, timeout or output cap. */
+RunnerReply exchange(RunnerWorker& worker, const std::string& request, Deadline deadline,
+                     std::size_t max_output_bytes)
+{
+    RunnerReply reply;
+    {
+        SigPipeIgnoreGuard sigpipe_guard;
+        const char* data = request.data();
+        std::size_t remaining = request.size();
         while (remaining > 0)
         {
-            const ssize_t n = write(in_pipe[1], data, remaining);
-            if (n < 0) // GCOVR_EXCL_LINE
+            const ssize_t n = write(worker.in_fd, data, remaining);
+            if (n < 0)
             {
-                break; // GCOVR_EXCL_LINE
+                // The worker is gone; its stdout will report EOF below.
+                break;
             }
             data += n;
             remaining -= static_cast<std::size_t>(n);
         }
-        close(in_pipe[1]);
     }
 
-    set_nonblocking(out_pipe[0]);
-    set_nonblocking(err_pipe[0]);
-
-    bool out_eof = false;
+    std::string out;
+    std::string err;
     bool err_eof = false;
     bool limit_hit = false;
     std::size_t total_bytes = 0;
-    const auto start = std::chrono::steady_clock::now();
-    while (!out_eof || !err_eof)
+    while (true)
     {
         const auto now = std::chrono::steady_clock::now();
-        const auto elapsed_ms =
-            std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
-        if (elapsed_ms > timeout_ms)
+        if (now >= deadline)
         {
-            result.timed_out = true;
+            reply.timed_out = true;
             break;
         }
 
         struct pollfd fds[2];
-        fds[0].fd = out_pipe[0];
+        fds[0].fd = worker.out_fd;
         fds[0].events = POLLIN;
-        fds[1].fd = err_pipe[0];
+        fds[1].fd = err_eof ? -1 : worker.err_fd;
         fds[1].events = POLLIN;
-        const int remaining_ms = timeout_ms - static_cast<int>(elapsed_ms);
-        const int poll_ms = (remaining_ms < 50) ? remaining_ms : 50;
+        const auto remaining_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+        const int poll_ms = static_cast<int>(remaining_ms < 50 ? remaining_ms + 1 : 50);
         (void)poll(fds, 2, poll_ms);
 
-        if (!out_eof)
-        {
-            read_into(out_pipe[0], result.out, out_eof, total_bytes, max_output_bytes, limit_hit);
-        }
+        read_into(worker.out_fd, out, reply.closed, total_bytes, max_output_bytes, limit_hit);
         if (!err_eof)
         {
-            read_into(err_pipe[0], result.err, err_eof, total_bytes, max_output_bytes, limit_hit);
+            read_into(worker.err_fd, err, err_eof, total_bytes, max_output_bytes, limit_hit);
         }
 
         if (limit_hit)
         {
-            result.output_limit_exceeded = true;
+            reply.output_limit_exceeded = true;
+            reply.closed = false;
+            break;
+        }
+        if (const auto newline = out.find('\n'); newline != std::string::npos)
+        {
+            reply.trailing = newline + 1 < out.size();
+            out.resize(newline);
+            break;
+        }
+        if (reply.closed)
+        {
             break;
         }
     }
 
-    if (result.timed_out || result.output_limit_exceeded)
-    {
-        (void)kill(pid, SIGKILL);
-    }
-
-    close(out_pipe[0]);
-    close(err_pipe[0]);
-
-    int status = 0;
-    if (waitpid(pid, &status, 0) < 0) // GCOVR_EXCL_LINE
-    {
-        result.exit_code = 127; // GCOVR_EXCL_LINE
-        return result;          // GCOVR_EXCL_LINE
-    }
-    if (WIFEXITED(status))
-    {
-        result.exit_code = WEXITSTATUS(status);
-    }
-    else
-    {
-        result.exit_code = 128;
-    }
-    return result;
+    reply.response = std::move(out);
+    return reply;
 }
 
 std::string find_bwrap_path()
@@ -405,11 +457,174 @@ std::optional<std::string> extract_error_message(std::string_view json)
     return std::nullopt;
 }
 
-const curlee::vm::VM::Capabilities kEmptyCaps;
+[[nodiscard]] std::optional<std::string_view> response_id(std::string_view json)
+{
+    const std::string_view needle = "\"id\":\"";
+    const std::size_t start = json.find(needle);
+    if (start == std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+    const std::size_t begin = start + needle.size();
+    const std::size_t end = json.find('"', begin);
+    if (end == std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+    return json.substr(begin, end - begin);
+}
+
+/**
+ * @brief Warm runner processes shared by every VM in the process.
+ *
+ * Workers are keyed by their full command line and environment, so a sandboxed runner is only
+ * reused for sandboxed calls under the same bwrap and runner binaries. Requests carry fresh ids
+ * over the newline JSON protocol. A worker goes back to the pool only after a clean, in-sync
+ * answer (`ok`, or a structured error); crashes, timeouts, oversized or unparseable output and
+ * reaching `max_calls_per_worker` all retire it, and the next call starts a fresh one.
+ */
+class PythonRunnerPool
+{
+  public:
+    explicit PythonRunnerPool(std::size_t max_calls_per_worker)
+        : max_calls_per_worker_(max_calls_per_worker)
+    {
+    }
+
+    PythonRunnerPool(const PythonRunnerPool&) = delete;
+    PythonRunnerPool& operator=(const PythonRunnerPool&) = delete;
+
+    ~PythonRunnerPool()
+    {
+        // Closing stdin asks each runner to exit; stragglers are killed shortly after.
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        for (auto& [key, workers] : idle_)
+        {
+            for (auto& worker : workers)
+            {
+                (void)reap_worker(worker, deadline, false);
+            }
+        }
+    }
+
+    /** @brief Send `{"op": op}` to a worker for `command`, spawning one if none is idle. */
+    RunnerReply call(const RunnerCommand& command, std::string_view op, int timeout_ms,
+                     std::size_t max_output_bytes)
+    {
+        const std::string key = key_of(command);
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+        std::string id;
+        std::optional<RunnerWorker> worker;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            id = "vm-" + std::to_string(++next_request_);
+            auto it = idle_.find(key);
+            while (it != idle_.end() && !it->second.empty() && !worker.has_value())
+            {
+                RunnerWorker candidate = it->second.back();
+                it->second.pop_back();
+                if (!worker_exited(candidate))
+                {
+                    worker = candidate;
+                }
+            }
+        }
+        const std::string request =
+            "{\"protocol_version\":1,\"id\":\"" + id + "\",\"op\":\"" + std::string(op) + "\"}\n";
+
+        const bool reused = worker.has_value();
+        if (!reused)
+        {
+            worker = spawn(command);
+        }
+        if (!worker.has_value())
+        {
+            RunnerReply failed;
+            failed.closed = true;
+            failed.exit_code = 127;
+            return failed;
+        }
+
+        RunnerReply reply = exchange(*worker, request, deadline, max_output_bytes);
+        if (reused && reply.closed && reply.response.empty())
+        {
+            // The idle worker died between calls; that is not this request's failure.
+            (void)reap_worker(*worker, deadline, true);
+            worker = spawn(command);
+            if (!worker.has_value())
+            {
+                reply.exit_code = 127;
+                return reply;
+            }
+            reply = exchange(*worker, request, deadline, max_output_bytes);
+        }
+
+        ++worker->calls;
+        const bool in_sync = !reply.closed && !reply.timed_out && !reply.output_limit_exceeded &&
+                             !reply.trailing && response_id(reply.response) == id;
+        const bool answered = response_ok_true(reply.response) ||
+                              extract_error_message(reply.response).has_value();
+        if (in_sync && answered && worker->calls < max_calls_per_worker_)
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            auto& workers = idle_[key];
+            if (workers.size() < kPythonRunnerMaxIdleWorkers)
+            {
+                workers.push_back(*worker);
+                return reply;
+            }
+        }
+
+        const bool kill_now = reply.timed_out || reply.output_limit_exceeded || !reply.closed;
+        reply.exit_code = reap_worker(*worker, deadline, kill_now);
+        return reply;
+    }
+
+    /** @brief Number of runner processes started so far. */
+    [[nodiscard]] std::size_t spawned() const
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return spawned_;
+    }
+
+  private:
+    [[nodiscard]] static std::string key_of(const RunnerCommand& command)
+    {
+        std::string key;
+        for (const auto& part : {std::cref(command.argv), std::cref(command.env)})
+        {
+            for (const auto& s : part.get())
+            {
+                key += s;
+                key.push_back('\0');
+            }
+            key.push_back('\n');
+        }
+        return key;
+    }
+
+    std::optional<RunnerWorker> spawn(const RunnerCommand& command)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            ++spawned_;
+        }
+        return spawn_worker(command);
+    }
+
+    std::size_t max_calls_per_worker_;
+    mutable std::mutex mutex_;
+    std::map<std::string, std::vector<RunnerWorker>> idle_;
+    std::uint64_t next_request_ = 0;
+    std::size_t spawned_ = 0;
+};
 
-const curlee::vm::VM::Capabilities& empty_caps()
+PythonRunnerPool& python_runner_pool()
 {
-    return kEmptyCaps;
+    static PythonRunnerPool pool(kPythonRunnerMaxCallsPerWorker);
+    return pool;
 }
 
 } // namespace
@@ -420,11 +635,81 @@ namespace curlee::vm
 namespace
 {
 
+constexpr std::size_t kInitialStackCapacity = 64;
+
+/** @brief Saved caller state; locals of live frames are contiguous in VM::locals_. */
+template <typename Ip> struct CallFrame
+{
+    Ip return_ip;
+    std::size_t base;
+    std::size_t size;
+};
+
+/** @brief Slots of the frame entered by a call to `fn` (parameters always fit). */
+[[nodiscard]] std::size_t frame_slots(const FunctionInfo& fn)
+{
+    return fn.locals < fn.arity ? fn.arity : fn.locals;
+}
+
+// Int arithmetic. Checked opcodes fail the run on overflow; unchecked ones are only emitted
+// where the verifier proved the result fits, and wrap (rather than hit undefined behaviour)
+// should a hand-assembled chunk break that promise. DivUnchecked cannot wrap its way out of a
+// zero divisor or INT64_MIN / -1 (both trap in hardware), so it keeps one combined test for them.
+[[nodiscard]] bool add_overflows(std::int64_t a, std::int64_t b, std::int64_t& out)
+{
+    return __builtin_add_overflow(a, b, &out);
+}
+
+[[nodiscard]] bool sub_overflows(std::int64_t a, std::int64_t b, std::int64_t& out)
+{
+    return __builtin_sub_overflow(a, b, &out);
+}
+
+[[nodiscard]] bool mul_overflows(std::int64_t a, std::int64_t b, std::int64_t& out)
+{
+    return __builtin_mul_overflow(a, b, &out);
+}
+
+[[nodiscard]] constexpr bool div_overflows(std::int64_t a, std::int64_t b)
+{
+    return a == std::numeric_limits<std::int64_t>::min() && b == -1;
+}
+
+[[nodiscard]] constexpr bool div_traps(std::int64_t a, std::int64_t b)
+{
+    return b == 0 || div_overflows(a, b);
+}
+
+[[nodiscard]] constexpr const char* div_trap_message(std::int64_t b)
+{
+    return b == 0 ? "divide by zero" : "integer overflow";
+}
+
+[[nodiscard]] constexpr std::int64_t wrapping_add(std::int64_t a, std::int64_t b)
+{
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) + static_cast<std::uint64_t>(b));
+}
+
+[[nodiscard]] constexpr std::int64_t wrapping_sub(std::int64_t a, std::int64_t b)
+{
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) - static_cast<std::uint64_t>(b));
+}
+
+[[nodiscard]] constexpr std::int64_t wrapping_mul(std::int64_t a, std::int64_t b)
+{
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) * static_cast<std::uint64_t>(b));
+}
+
+[[nodiscard]] constexpr std::int64_t wrapping_neg(std::int64_t a)
+{
+    return static_cast<std::int64_t>(std::uint64_t{0} - static_cast<std::uint64_t>(a));
+}
+
 [[nodiscard]] VmResult ok_result(Value value)
 {
     VmResult result;
     result.ok = true;
-    result.value = value;
+    result.value = std::move(value);
     result.error.clear();
     result.error_span = std::nullopt;
     return result;
@@ -441,11 +726,75 @@ namespace
     return result;
 } // GCOVR_EXCL_LINE
 
+/** @brief Perform the PythonCall effect; returns the error message on failure. */
+[[nodiscard]] std::optional<std::string> python_call(VM::CapabilityMask capabilities)
+{
+    if (!runtime::has_capability(capabilities, runtime::Capability::PythonFfi))
+    {
+        return std::string("python capability required");
+    }
+
+    const bool use_sandbox =
+        runtime::has_capability(capabilities, runtime::Capability::PythonSandbox);
+    RunnerCommand command;
+    if (use_sandbox)
+    {
+        command.argv = {find_bwrap_path(),
+                        "--die-with-parent",
+                        "--unshare-net",
+                        "--ro-bind",
+                        "/",
+                        "/",
+                        "--proc",
+                        "/proc",
+                        "--dev",
+                        "/dev",
+                        "--tmpfs",
+                        "/tmp",
+                        "--"};
+    }
+    command.argv.push_back(find_python_runner_path());
+    command.argv.push_back("--serve");
+    command.env = runner_env();
+
+    const RunnerReply proc = python_runner_pool().call(
+        command, "handshake", kPythonRunnerTimeoutMs, kPythonRunnerMaxOutputBytes);
+
+    if (proc.timed_out)
+    {
+        return std::string("python runner timed out");
+    }
+    if (proc.output_limit_exceeded)
+    {
+        return std::string("python runner output too large");
+    }
+
+    if (!response_ok_true(proc.response))
+    {
+        std::string msg = "python runner failed";
+        if (auto m = extract_error_message(proc.response); m.has_value())
+        {
+            msg = *m;
+        }
+        else if (proc.exit_code == 127)
+        {
+            msg = use_sandbox ? "python sandbox exec failed" : "python runner exec failed";
+        }
+        else if (use_sandbox)
+        {
+            msg = "python sandbox failed";
+        }
+        return msg;
+    }
+
+    return std::nullopt;
+}
+
 } // namespace
 
 bool VM::push(Value value)
 {
-    stack_.push_back(value);
+    stack_.push_back(std::move(value));
     return true;
 }
 
@@ -455,19 +804,19 @@ std::optional<Value> VM::pop()
     {
         return std::nullopt;
     }
-    Value value = stack_.back();
+    Value value = std::move(stack_.back());
     stack_.pop_back();
     return value;
 }
 
 VmResult VM::run(const Chunk& chunk)
 {
-    return run(chunk, std::numeric_limits<std::size_t>::max(), empty_caps());
+    return run(chunk, std::numeric_limits<std::size_t>::max(), VM::CapabilityMask{0});
 }
 
 VmResult VM::run(const Chunk& chunk, std::size_t fuel)
 {
-    return run(chunk, fuel, empty_caps());
+    return run(chunk, fuel, VM::CapabilityMask{0});
 }
 
 VmResult VM::run(const Chunk& chunk, const Capabilities& capabilities)
@@ -477,38 +826,126 @@ VmResult VM::run(const Chunk& chunk, const Capabilities& capabilities)
 
 VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capabilities)
 {
-    stack_.clear();
-    std::vector<Value> locals(chunk.max_locals, Value::unit_v());
-    std::vector<std::size_t> call_stack;
+    return run(chunk, fuel, runtime::resolve_capabilities(capabilities));
+}
 
-    std::size_t ip = 0;
-    while (ip < chunk.code.size())
+VmResult VM::run(const Chunk& chunk, std::size_t fuel, CapabilityMask capabilities)
+{
+    if (profiler_ != nullptr)
     {
-        if (fuel == 0)
+        return run_profiled(chunk, fuel, capabilities);
+    }
+    if (dispatch_mode_ == DispatchMode::Threaded)
+    {
+        if (auto code = predecode(chunk); code.has_value())
         {
-            return err_result("out of fuel", std::nullopt);
+            // Unverifiable code keeps its checked handlers and reports errors at run time.
+            (void)verify_bytecode(chunk, *code);
+            return run_threaded(*code, chunk, fuel, capabilities);
         }
-        --fuel;
+    }
+    return run_switch<false>(chunk, fuel, capabilities);
+}
 
-        const std::size_t op_index = ip;
-        const auto op = static_cast<OpCode>(chunk.code[ip++]);
-        const auto span = (op_index < chunk.spans.size())
-                              ? std::optional<curlee::source::Span>(chunk.spans[op_index])
-                              : std::nullopt;
+VmResult VM::run(const PreparedChunk& prepared)
+{
+    return run(prepared, std::numeric_limits<std::size_t>::max(), VM::CapabilityMask{0});
+}
+
+VmResult VM::run(const PreparedChunk& prepared, std::size_t fuel)
+{
+    return run(prepared, fuel, VM::CapabilityMask{0});
+}
+
+VmResult VM::run(const PreparedChunk& prepared, const Capabilities& capabilities)
+{
+    return run(prepared, std::numeric_limits<std::size_t>::max(), capabilities);
+}
+
+VmResult VM::run(const PreparedChunk& prepared, std::size_t fuel,
+                 const Capabilities& capabilities)
+{
+    return run(prepared, fuel, runtime::resolve_capabilities(capabilities));
+}
+
+VmResult VM::run(const PreparedChunk& prepared, std::size_t fuel, CapabilityMask capabilities)
+{
+    if (profiler_ != nullptr)
+    {
+        return run_profiled(prepared.chunk_, fuel, capabilities);
+    }
+    if (dispatch_mode_ == DispatchMode::Threaded && prepared.code_.has_value())
+    {
+        return run_threaded(*prepared.code_, prepared.chunk_, fuel, capabilities);
+    }
+    return run_switch<false>(prepared.chunk_, fuel, capabilities);
+}
+
+PreparedChunk::PreparedChunk(Chunk chunk) : chunk_(std::move(chunk)), code_(predecode(chunk_))
+{
+    if (code_.has_value())
+    {
+        verify_error_ = verify_bytecode(chunk_, *code_);
+    }
+    else
+    {
+        verify_error_ = BytecodeVerifyError{
+            .message = "jump or call target is not an instruction boundary", .offset = 0};
+    }
+}
+
+VmResult VM::run_profiled(const Chunk& chunk, std::size_t fuel, CapabilityMask capabilities)
+{
+    profiler_->begin(chunk);
+    auto result = run_switch<true>(chunk, fuel, capabilities);
+    profiler_->end();
+    return result;
+}
+
+template <bool kProfile>
+VmResult VM::run_switch(const Chunk& chunk, std::size_t fuel, CapabilityMask capabilities)
+{
+    stack_.clear();
+    stack_.reserve(kInitialStackCapacity);
+    std::vector<Value>& locals = locals_;
+    locals.assign(chunk.max_locals, Value::unit_v());
+    std::size_t frame_base = 0;
+    std::size_t frame_size = chunk.max_locals;
+    std::vector<CallFrame<std::size_t>> call_stack;
+    // Call targets resolve through this rather than Chunk::function_at's scan.
+    const std::vector<std::uint16_t> function_of = function_index(chunk);
+
+    std::size_t ip = 0;
+    while (ip < chunk.code.size())
+    {
+        if (fuel == 0)
+        {
+            return err_result("out of fuel", std::nullopt);
+        }
+        --fuel;
+
+        const std::size_t op_index = ip;
+        const auto op = static_cast<OpCode>(chunk.code[ip++]);
+        // Spans are only decoded when an instruction fails.
+        const auto span = [&chunk, op_index] { return chunk.spans.lookup(op_index); };
+        if constexpr (kProfile)
+        {
+            profiler_->instruction(op_index, op);
+        }
         switch (op)
         {
         case OpCode::Constant:
         {
             if (ip + 1 >= chunk.code.size())
             {
-                return err_result("truncated constant", span);
+                return err_result("truncated constant", span());
             }
             const std::uint16_t lo = chunk.code[ip++];
             const std::uint16_t hi = chunk.code[ip++];
             const std::uint16_t idx = static_cast<std::uint16_t>(lo | (hi << 8));
             if (idx >= chunk.constants.size())
             {
-                return err_result("constant index out of range", span);
+                return err_result("constant index out of range", span());
             }
             push(chunk.constants[idx]);
             break;
@@ -517,23 +954,23 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
         {
             if (ip + 1 >= chunk.code.size())
             {
-                return err_result("truncated local index", span);
+                return err_result("truncated local index", span());
             }
             const std::uint16_t lo = chunk.code[ip++];
             const std::uint16_t hi = chunk.code[ip++];
             const std::uint16_t idx = static_cast<std::uint16_t>(lo | (hi << 8));
-            if (idx >= locals.size())
+            if (idx >= frame_size)
             {
-                return err_result("local index out of range", span);
+                return err_result("local index out of range", span());
             }
-            push(locals[idx]);
+            push(locals[frame_base + idx]);
             break;
         }
         case OpCode::StoreLocal:
         {
             if (ip + 1 >= chunk.code.size())
             {
-                return err_result("truncated local index", span);
+                return err_result("truncated local index", span());
             }
             const std::uint16_t lo = chunk.code[ip++];
             const std::uint16_t hi = chunk.code[ip++];
@@ -541,13 +978,13 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto value = pop();
             if (!value.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
-            if (idx >= locals.size())
+            if (idx >= frame_size)
             {
-                return err_result("local index out of range", span);
+                return err_result("local index out of range", span());
             }
-            locals[idx] = *value;
+            locals[frame_base + idx] = std::move(*value);
             break;
         }
         case OpCode::Add:
@@ -556,19 +993,24 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind == ValueKind::Int && rhs->kind == ValueKind::Int)
             {
-                push(Value::int_v(lhs->int_value + rhs->int_value));
+                std::int64_t sum = 0;
+                if (add_overflows(lhs->as_int(), rhs->as_int(), sum))
+                {
+                    return err_result("integer overflow", span());
+                }
+                push(Value::int_v(sum));
                 break;
             }
             if (lhs->kind == ValueKind::String && rhs->kind == ValueKind::String)
             {
-                push(Value::string_v(lhs->string_value + rhs->string_value));
+                push(Value::string_v(lhs->as_string() + rhs->as_string()));
                 break;
             }
-            return err_result("add expects Int or String", span);
+            return err_result("add expects Int or String", span());
         }
         case OpCode::Sub:
         {
@@ -576,13 +1018,18 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
             {
-                return err_result("sub expects Int", span);
+                return err_result("sub expects Int", span());
             }
-            push(Value::int_v(lhs->int_value - rhs->int_value));
+            std::int64_t out = 0;
+            if (sub_overflows(lhs->as_int(), rhs->as_int(), out))
+            {
+                return err_result("integer overflow", span());
+            }
+            push(Value::int_v(out));
             break;
         }
         case OpCode::Mul:
@@ -591,13 +1038,18 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
             {
-                return err_result("mul expects Int", span);
+                return err_result("mul expects Int", span());
+            }
+            std::int64_t out = 0;
+            if (mul_overflows(lhs->as_int(), rhs->as_int(), out))
+            {
+                return err_result("integer overflow", span());
             }
-            push(Value::int_v(lhs->int_value * rhs->int_value));
+            push(Value::int_v(out));
             break;
         }
         case OpCode::Div:
@@ -606,17 +1058,21 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
             {
-                return err_result("div expects Int", span);
+                return err_result("div expects Int", span());
+            }
+            if (rhs->as_int() == 0)
+            {
+                return err_result("divide by zero", span());
             }
-            if (rhs->int_value == 0)
+            if (div_overflows(lhs->as_int(), rhs->as_int()))
             {
-                return err_result("divide by zero", span);
+                return err_result("integer overflow", span());
             }
-            push(Value::int_v(lhs->int_value / rhs->int_value));
+            push(Value::int_v(lhs->as_int() / rhs->as_int()));
             break;
         }
         case OpCode::Neg:
@@ -624,13 +1080,69 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto value = pop();
             if (!value.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
+            }
+            if (value->kind != ValueKind::Int)
+            {
+                return err_result("neg expects Int", span());
+            }
+            if (value->as_int() == std::numeric_limits<std::int64_t>::min())
+            {
+                return err_result("integer overflow", span());
+            }
+            push(Value::int_v(-value->as_int()));
+            break;
+        }
+        case OpCode::AddUnchecked:
+        case OpCode::SubUnchecked:
+        case OpCode::MulUnchecked:
+        case OpCode::DivUnchecked:
+        {
+            auto rhs = pop();
+            auto lhs = pop();
+            if (!rhs.has_value() || !lhs.has_value())
+            {
+                return err_result("stack underflow", span());
+            }
+            if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
+            {
+                return err_result("arithmetic expects Int", span());
+            }
+            const std::int64_t a = lhs->as_int();
+            const std::int64_t b = rhs->as_int();
+            switch (op)
+            {
+            case OpCode::AddUnchecked:
+                push(Value::int_v(wrapping_add(a, b)));
+                break;
+            case OpCode::SubUnchecked:
+                push(Value::int_v(wrapping_sub(a, b)));
+                break;
+            case OpCode::MulUnchecked:
+                push(Value::int_v(wrapping_mul(a, b)));
+                break;
+            default:
+                if (div_traps(a, b))
+                {
+                    return err_result(div_trap_message(b), span());
+                }
+                push(Value::int_v(a / b));
+                break;
+            }
+            break;
+        }
+        case OpCode::NegUnchecked:
+        {
+            auto value = pop();
+            if (!value.has_value())
+            {
+                return err_result("stack underflow", span());
             }
             if (value->kind != ValueKind::Int)
             {
-                return err_result("neg expects Int", span);
+                return err_result("neg expects Int", span());
             }
-            push(Value::int_v(-value->int_value));
+            push(Value::int_v(wrapping_neg(value->as_int())));
             break;
         }
         case OpCode::Not:
@@ -638,13 +1150,13 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto value = pop();
             if (!value.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (value->kind != ValueKind::Bool)
             {
-                return err_result("not expects Bool", span);
+                return err_result("not expects Bool", span());
             }
-            push(Value::bool_v(!value->bool_value));
+            push(Value::bool_v(!value->as_bool()));
             break;
         }
         case OpCode::Equal:
@@ -653,7 +1165,7 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             push(Value::bool_v(*lhs == *rhs));
             break;
@@ -664,7 +1176,7 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             push(Value::bool_v(!(*lhs == *rhs)));
             break;
@@ -675,13 +1187,13 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
             {
-                return err_result("lt expects Int", span);
+                return err_result("lt expects Int", span());
             }
-            push(Value::bool_v(lhs->int_value < rhs->int_value));
+            push(Value::bool_v(lhs->as_int() < rhs->as_int()));
             break;
         }
         case OpCode::LessEqual:
@@ -690,13 +1202,13 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
             {
-                return err_result("le expects Int", span);
+                return err_result("le expects Int", span());
             }
-            push(Value::bool_v(lhs->int_value <= rhs->int_value));
+            push(Value::bool_v(lhs->as_int() <= rhs->as_int()));
             break;
         }
         case OpCode::Greater:
@@ -705,13 +1217,13 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
             {
-                return err_result("gt expects Int", span);
+                return err_result("gt expects Int", span());
             }
-            push(Value::bool_v(lhs->int_value > rhs->int_value));
+            push(Value::bool_v(lhs->as_int() > rhs->as_int()));
             break;
         }
         case OpCode::GreaterEqual:
@@ -720,20 +1232,20 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto lhs = pop();
             if (!rhs.has_value() || !lhs.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (lhs->kind != ValueKind::Int || rhs->kind != ValueKind::Int)
             {
-                return err_result("ge expects Int", span);
+                return err_result("ge expects Int", span());
             }
-            push(Value::bool_v(lhs->int_value >= rhs->int_value));
+            push(Value::bool_v(lhs->as_int() >= rhs->as_int()));
             break;
         }
         case OpCode::Pop:
         {
             if (!pop().has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             break;
         }
@@ -742,22 +1254,22 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto result = pop();
             if (!result.has_value())
             {
-                return err_result("missing return", span);
+                return err_result("missing return", span());
             }
-            return ok_result(*result);
+            return ok_result(std::move(*result));
         }
         case OpCode::Jump:
         {
             if (ip + 1 >= chunk.code.size())
             {
-                return err_result("truncated jump target", span);
+                return err_result("truncated jump target", span());
             }
             const std::uint16_t lo = chunk.code[ip++];
             const std::uint16_t hi = chunk.code[ip++];
             const std::uint16_t target = static_cast<std::uint16_t>(lo | (hi << 8));
             if (static_cast<std::size_t>(target) >= chunk.code.size())
             {
-                return err_result("jump target out of range", span);
+                return err_result("jump target out of range", span());
             }
             ip = static_cast<std::size_t>(target);
             break;
@@ -766,7 +1278,7 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
         {
             if (ip + 1 >= chunk.code.size())
             {
-                return err_result("truncated jump target", span);
+                return err_result("truncated jump target", span());
             }
             const std::uint16_t lo = chunk.code[ip++];
             const std::uint16_t hi = chunk.code[ip++];
@@ -775,17 +1287,17 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
             auto cond = pop();
             if (!cond.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             if (cond->kind != ValueKind::Bool)
             {
-                return err_result("jump-if-false expects Bool", span);
+                return err_result("jump-if-false expects Bool", span());
             }
-            if (!cond->bool_value)
+            if (!cond->as_bool())
             {
                 if (static_cast<std::size_t>(target) >= chunk.code.size())
                 {
-                    return err_result("jump target out of range", span);
+                    return err_result("jump target out of range", span());
                 }
                 ip = static_cast<std::size_t>(target);
             }
@@ -795,17 +1307,41 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
         {
             if (ip + 1 >= chunk.code.size())
             {
-                return err_result("truncated call target", span);
+                return err_result("truncated call target", span());
             }
             const std::uint16_t lo = chunk.code[ip++];
             const std::uint16_t hi = chunk.code[ip++];
             const std::uint16_t target = static_cast<std::uint16_t>(lo | (hi << 8));
             if (static_cast<std::size_t>(target) >= chunk.code.size())
             {
-                return err_result("call target out of range", span);
+                return err_result("call target out of range", span());
             }
 
-            call_stack.push_back(ip);
+            const FunctionInfo* fn = function_of[target] == kThreadedNoFunction
+                                         ? nullptr
+                                         : &chunk.functions[function_of[target]];
+            if (fn != nullptr && stack_.size() < fn->arity)
+            {
+                return err_result("stack underflow", span());
+            }
+            call_stack.push_back({.return_ip = ip, .base = frame_base, .size = frame_size});
+            if (fn != nullptr)
+            {
+                frame_base = locals.size();
+                frame_size = frame_slots(*fn);
+                locals.resize(frame_base + frame_size);
+                const std::size_t args = stack_.size() - fn->arity;
+                for (std::size_t i = 0; i < fn->arity; ++i)
+                {
+                    locals[frame_base + i] = std::move(stack_[args + i]);
+                }
+                stack_.resize(args);
+                stack_.reserve(args + fn->max_stack);
+            }
+            if constexpr (kProfile)
+            {
+                profiler_->call(target);
+            }
             ip = static_cast<std::size_t>(target);
             break;
         }
@@ -813,22 +1349,30 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
         {
             if (call_stack.empty())
             {
-                return err_result("return with empty call stack", span);
+                return err_result("return with empty call stack", span());
             }
-            ip = call_stack.back();
+            const auto& caller = call_stack.back();
+            ip = caller.return_ip;
+            frame_base = caller.base;
+            frame_size = caller.size;
+            locals.resize(frame_base + frame_size);
             call_stack.pop_back();
+            if constexpr (kProfile)
+            {
+                profiler_->ret();
+            }
             break;
         }
         case OpCode::Print:
         {
-            if (!capabilities.contains("io:stdout"))
+            if (!runtime::has_capability(capabilities, runtime::Capability::IoStdout))
             {
-                return err_result("missing capability io:stdout", span);
+                return err_result("missing capability io:stdout", span());
             }
             auto value = pop();
             if (!value.has_value())
             {
-                return err_result("stack underflow", span);
+                return err_result("stack underflow", span());
             }
             // MVP: stub effect. No ambient IO; host can later wire an output sink.
             push(Value::unit_v());
@@ -836,88 +1380,817 @@ VmResult VM::run(const Chunk& chunk, std::size_t fuel, const Capabilities& capab
         }
         case OpCode::PythonCall:
         {
-            if (!capabilities.contains("python:ffi"))
+            if (auto error = python_call(capabilities); error.has_value())
             {
-                return err_result("python capability required", span);
+                return err_result(*error, span());
             }
+            push(Value::unit_v());
+            break;
+        }
+        }
+    }
 
-            const std::string runner = find_python_runner_path();
-            const std::string request =
-                "{\"protocol_version\":1,\"id\":\"vm\",\"op\":\"handshake\"}\n";
+    return err_result("no return", std::nullopt);
+}
 
-            const bool use_sandbox = capabilities.contains("python:sandbox");
-            ProcResult proc;
-            if (use_sandbox)
-            {
-                const std::string bwrap = find_bwrap_path();
+// Direct-threaded interpreter over pre-decoded instructions. With GCC/Clang every handler ends
+// in an indirect `goto` through the handler address resolved at load time (one branch per
+// handler instead of a shared switch); other compilers switch over the decoded handler id.
+// Error messages, spans and fuel accounting mirror run_switch exactly.
+#if defined(__GNUC__) || defined(__clang__)
+#define CURLEE_VM_COMPUTED_GOTO 1
+#else
+#define CURLEE_VM_COMPUTED_GOTO 0
+#endif
 
-                std::vector<std::string> argv_storage;
-                argv_storage.push_back(bwrap);
-                argv_storage.push_back("--die-with-parent");
-                argv_storage.push_back("--unshare-net");
-                argv_storage.push_back("--ro-bind");
-                argv_storage.push_back("/");
-                argv_storage.push_back("/");
-                argv_storage.push_back("--proc");
-                argv_storage.push_back("/proc");
-                argv_storage.push_back("--dev");
-                argv_storage.push_back("/dev");
-                argv_storage.push_back("--tmpfs");
-                argv_storage.push_back("/tmp");
-                argv_storage.push_back("--");
-                argv_storage.push_back(runner);
+#if CURLEE_VM_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define CURLEE_VM_HANDLER(name, id) handler_##name:
+#define CURLEE_VM_DISPATCH()                                                                       \
+    do                                                                                             \
+    {                                                                                              \
+        instr = ip++;                                                                              \
+        goto* instr->handler;                                                                      \
+    } while (false)
+#else
+#define CURLEE_VM_HANDLER(name, id) case id:
+#define CURLEE_VM_DISPATCH()                                                                       \
+    do                                                                                             \
+    {                                                                                              \
+        instr = ip++;                                                                              \
+        goto dispatch;                                                                             \
+    } while (false)
+#endif
 
-                std::vector<const char*> argv;
-                argv.reserve(argv_storage.size() + 1);
-                for (const auto& s : argv_storage)
-                {
-                    argv.push_back(s.c_str());
-                }
-                argv.push_back(nullptr);
+#define CURLEE_VM_OP(name) CURLEE_VM_HANDLER(name, static_cast<std::uint8_t>(OpCode::name))
+#define CURLEE_VM_PSEUDO(name)                                                                     \
+    CURLEE_VM_HANDLER(name, static_cast<std::uint8_t>(ThreadedPseudoOp::name))
+
+#define CURLEE_VM_CONSUME_FUEL()                                                                   \
+    do                                                                                             \
+    {                                                                                              \
+        if (fuel == 0)                                                                             \
+        {                                                                                          \
+            return err_result("out of fuel", std::nullopt);                                        \
+        }                                                                                          \
+        --fuel;                                                                                    \
+    } while (false)
+
+#define CURLEE_VM_INT_BINARY(name, expr, message)                                                  \
+    CURLEE_VM_OP(name)                                                                             \
+    {                                                                                              \
+        CURLEE_VM_CONSUME_FUEL();                                                                  \
+        if (stack_.size() < 2)                                                                     \
+        {                                                                                          \
+            return err_result("stack underflow", span_of(instr));                                  \
+        }                                                                                          \
+        const Value rhs = std::move(stack_.back());                                                \
+        stack_.pop_back();                                                                         \
+        Value& lhs = stack_.back();                                                                \
+        if (lhs.kind != ValueKind::Int || rhs.kind != ValueKind::Int)                              \
+        {                                                                                          \
+            return err_result(message, span_of(instr));                                            \
+        }                                                                                          \
+        const std::int64_t a = lhs.as_int();                                                       \
+        const std::int64_t b = rhs.as_int();                                                       \
+        lhs = (expr);                                                                              \
+        CURLEE_VM_DISPATCH();                                                                      \
+    }
 
-                proc = run_process_argv(argv, bwrap, request, kPythonRunnerTimeoutMs,
-                                        kPythonRunnerMaxOutputBytes);
-            }
-            else
-            {
-                proc = run_process(runner, request, kPythonRunnerTimeoutMs,
-                                   kPythonRunnerMaxOutputBytes);
-            }
+// Checked Int arithmetic: `overflows(a, b, out)` computes `out` or reports overflow.
+#define CURLEE_VM_CHECKED_INT_BINARY(name, overflows, message)                                     \
+    CURLEE_VM_OP(name)                                                                             \
+    {                                                                                              \
+        CURLEE_VM_CONSUME_FUEL();                                                                  \
+        if (stack_.size() < 2)                                                                     \
+        {                                                                                          \
+            return err_result("stack underflow", span_of(instr));                                  \
+        }                                                                                          \
+        const Value rhs = std::move(stack_.back());                                                \
+        stack_.pop_back();                                                                         \
+        Value& lhs = stack_.back();                                                                \
+        if (lhs.kind != ValueKind::Int || rhs.kind != ValueKind::Int)                              \
+        {                                                                                          \
+            return err_result(message, span_of(instr));                                            \
+        }                                                                                          \
+        std::int64_t out = 0;                                                                      \
+        if (overflows(lhs.as_int(), rhs.as_int(), out))                                            \
+        {                                                                                          \
+            return err_result("integer overflow", span_of(instr));                                 \
+        }                                                                                          \
+        lhs = Value::int_v(out);                                                                   \
+        CURLEE_VM_DISPATCH();                                                                      \
+    }
 
-            if (proc.timed_out)
-            {
-                return err_result("python runner timed out", span);
-            }
-            if (proc.output_limit_exceeded)
+// Push a frame for the call in `instr` (target and arity already checked) and jump to it.
+#define CURLEE_VM_ENTER_CALL()                                                                     \
+    do                                                                                             \
+    {                                                                                              \
+        call_stack.push_back({.return_ip = ip, .base = frame_base, .size = frame_size});          \
+        if (instr->callee != kThreadedNoFunction)                                                  \
+        {                                                                                          \
+            const FunctionInfo& fn = chunk.functions[instr->callee];                               \
+            frame_base = locals.size();                                                            \
+            frame_size = frame_slots(fn);                                                          \
+            locals.resize(frame_base + frame_size);                                                \
+            frame = locals.data() + frame_base;                                                    \
+            const std::size_t args = stack_.size() - fn.arity;                                     \
+            for (std::size_t i = 0; i < fn.arity; ++i)                                             \
+            {                                                                                      \
+                frame[i] = std::move(stack_[args + i]);                                            \
+            }                                                                                      \
+            stack_.resize(args);                                                                   \
+            stack_.reserve(args + fn.max_stack);                                                   \
+        }                                                                                          \
+        ip = base + instr->operand;                                                                \
+    } while (false)
+
+// Pop the innermost frame (the call stack is non-empty) and resume the caller.
+#define CURLEE_VM_LEAVE_CALL()                                                                     \
+    do                                                                                             \
+    {                                                                                              \
+        const auto& caller = call_stack.back();                                                    \
+        ip = caller.return_ip;                                                                     \
+        frame_base = caller.base;                                                                  \
+        frame_size = caller.size;                                                                  \
+        locals.resize(frame_base + frame_size);                                                    \
+        frame = locals.data() + frame_base;                                                        \
+        call_stack.pop_back();                                                                     \
+    } while (false)
+
+// Verified handlers: stack depth and operand kinds were proven by verify_bytecode.
+#define CURLEE_VM_VERIFIED_INT_BINARY(name, expr)                                                  \
+    CURLEE_VM_PSEUDO(name)                                                                         \
+    {                                                                                              \
+        CURLEE_VM_CONSUME_FUEL();                                                                  \
+        const std::int64_t b = stack_.back().as_int();                                             \
+        stack_.pop_back();                                                                         \
+        Value& lhs = stack_.back();                                                                \
+        const std::int64_t a = lhs.as_int();                                                       \
+        lhs = (expr);                                                                              \
+        CURLEE_VM_DISPATCH();                                                                      \
+    }
+
+#define CURLEE_VM_VERIFIED_CHECKED_INT_BINARY(name, overflows)                                     \
+    CURLEE_VM_PSEUDO(name)                                                                         \
+    {                                                                                              \
+        CURLEE_VM_CONSUME_FUEL();                                                                  \
+        const std::int64_t b = stack_.back().as_int();                                             \
+        stack_.pop_back();                                                                         \
+        Value& lhs = stack_.back();                                                                \
+        std::int64_t out = 0;                                                                      \
+        if (overflows(lhs.as_int(), b, out))                                                       \
+        {                                                                                          \
+            return err_result("integer overflow", span_of(instr));                                 \
+        }                                                                                          \
+        lhs = Value::int_v(out);                                                                   \
+        CURLEE_VM_DISPATCH();                                                                      \
+    }
+
+VmResult VM::run_threaded(ThreadedCode& code, const Chunk& chunk, std::size_t fuel,
+                          CapabilityMask capabilities)
+{
+#if CURLEE_VM_COMPUTED_GOTO
+    // Indexed by handler id: OpCode values first, then ThreadedPseudoOp values.
+    static const void* const kHandlers[] = {
+        &&handler_Constant,
+        &&handler_LoadLocal,
+        &&handler_StoreLocal,
+        &&handler_Add,
+        &&handler_Sub,
+        &&handler_Mul,
+        &&handler_Div,
+        &&handler_Neg,
+        &&handler_Not,
+        &&handler_Equal,
+        &&handler_NotEqual,
+        &&handler_Less,
+        &&handler_LessEqual,
+        &&handler_Greater,
+        &&handler_GreaterEqual,
+        &&handler_Pop,
+        &&handler_Return,
+        &&handler_Jump,
+        &&handler_JumpIfFalse,
+        &&handler_Call,
+        &&handler_Ret,
+        &&handler_Print,
+        &&handler_PythonCall,
+        &&handler_AddUnchecked,
+        &&handler_SubUnchecked,
+        &&handler_MulUnchecked,
+        &&handler_DivUnchecked,
+        &&handler_NegUnchecked,
+        &&handler_Nop,
+        &&handler_Truncated,
+        &&handler_End,
+        &&handler_VerifiedConstant,
+        &&handler_VerifiedLoadLocal,
+        &&handler_VerifiedStoreLocal,
+        &&handler_VerifiedPop,
+        &&handler_VerifiedEqual,
+        &&handler_VerifiedNotEqual,
+        &&handler_VerifiedAddInt,
+        &&handler_VerifiedAddString,
+        &&handler_VerifiedSubInt,
+        &&handler_VerifiedMulInt,
+        &&handler_VerifiedDivInt,
+        &&handler_VerifiedNegInt,
+        &&handler_VerifiedNotBool,
+        &&handler_VerifiedLessInt,
+        &&handler_VerifiedLessEqualInt,
+        &&handler_VerifiedGreaterInt,
+        &&handler_VerifiedGreaterEqualInt,
+        &&handler_VerifiedReturn,
+        &&handler_VerifiedJump,
+        &&handler_VerifiedJumpIfFalse,
+        &&handler_VerifiedCall,
+        &&handler_VerifiedRet,
+        &&handler_VerifiedPrint,
+        &&handler_VerifiedAddIntUnchecked,
+        &&handler_VerifiedSubIntUnchecked,
+        &&handler_VerifiedMulIntUnchecked,
+        &&handler_VerifiedDivIntUnchecked,
+        &&handler_VerifiedNegIntUnchecked,
+    };
+    static_assert(sizeof(kHandlers) / sizeof(kHandlers[0]) == kThreadedHandlerCount);
+
+    if (!code.handlers_resolved)
+    {
+        for (auto& instr : code.instrs)
+        {
+            instr.handler = kHandlers[instr.handler_id];
+        }
+        code.handlers_resolved = true;
+    }
+#endif
+
+    stack_.clear();
+    stack_.reserve(kInitialStackCapacity);
+    std::vector<Value>& locals = locals_;
+    locals.assign(chunk.max_locals, Value::unit_v());
+    Value* frame = locals.data();
+    std::size_t frame_base = 0;
+    std::size_t frame_size = chunk.max_locals;
+    std::vector<CallFrame<const ThreadedInstr*>> call_stack;
+
+    const ThreadedInstr* const base = code.instrs.data();
+    const ThreadedInstr* ip = base;
+    const ThreadedInstr* instr = nullptr;
+
+    const auto span_of = [&chunk](const ThreadedInstr* at) -> std::optional<curlee::source::Span>
+    { return chunk.spans.lookup(at->offset); };
+
+    CURLEE_VM_DISPATCH();
+
+#if !CURLEE_VM_COMPUTED_GOTO
+dispatch:
+    switch (instr->handler_id)
+    {
+#endif
+
+    CURLEE_VM_OP(Constant)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (instr->operand >= chunk.constants.size())
+        {
+            return err_result("constant index out of range", span_of(instr));
+        }
+        stack_.push_back(chunk.constants[instr->operand]);
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(LoadLocal)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (instr->operand >= frame_size)
+        {
+            return err_result("local index out of range", span_of(instr));
+        }
+        stack_.push_back(frame[instr->operand]);
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(StoreLocal)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.empty())
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        if (instr->operand >= frame_size)
+        {
+            return err_result("local index out of range", span_of(instr));
+        }
+        frame[instr->operand] = std::move(stack_.back());
+        stack_.pop_back();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Add)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.size() < 2)
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        Value& lhs = stack_.back();
+        if (lhs.kind == ValueKind::Int && rhs.kind == ValueKind::Int)
+        {
+            std::int64_t sum = 0;
+            if (add_overflows(lhs.as_int(), rhs.as_int(), sum))
             {
-                return err_result("python runner output too large", span);
+                return err_result("integer overflow", span_of(instr));
             }
+            lhs = Value::int_v(sum);
+            CURLEE_VM_DISPATCH();
+        }
+        if (lhs.kind == ValueKind::String && rhs.kind == ValueKind::String)
+        {
+            lhs = Value::string_v(lhs.as_string() + rhs.as_string());
+            CURLEE_VM_DISPATCH();
+        }
+        return err_result("add expects Int or String", span_of(instr));
+    }
+
+    CURLEE_VM_CHECKED_INT_BINARY(Sub, sub_overflows, "sub expects Int")
+    CURLEE_VM_CHECKED_INT_BINARY(Mul, mul_overflows, "mul expects Int")
+    CURLEE_VM_INT_BINARY(Less, Value::bool_v(a < b), "lt expects Int")
+    CURLEE_VM_INT_BINARY(LessEqual, Value::bool_v(a <= b), "le expects Int")
+    CURLEE_VM_INT_BINARY(Greater, Value::bool_v(a > b), "gt expects Int")
+    CURLEE_VM_INT_BINARY(GreaterEqual, Value::bool_v(a >= b), "ge expects Int")
 
-            if (!response_ok_true(proc.out))
+    CURLEE_VM_OP(Div)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.size() < 2)
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        Value& lhs = stack_.back();
+        if (lhs.kind != ValueKind::Int || rhs.kind != ValueKind::Int)
+        {
+            return err_result("div expects Int", span_of(instr));
+        }
+        if (rhs.as_int() == 0)
+        {
+            return err_result("divide by zero", span_of(instr));
+        }
+        if (div_overflows(lhs.as_int(), rhs.as_int()))
+        {
+            return err_result("integer overflow", span_of(instr));
+        }
+        lhs = Value::int_v(lhs.as_int() / rhs.as_int());
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Neg)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.empty())
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        Value& value = stack_.back();
+        if (value.kind != ValueKind::Int)
+        {
+            return err_result("neg expects Int", span_of(instr));
+        }
+        if (value.as_int() == std::numeric_limits<std::int64_t>::min())
+        {
+            return err_result("integer overflow", span_of(instr));
+        }
+        value = Value::int_v(-value.as_int());
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_INT_BINARY(AddUnchecked, Value::int_v(wrapping_add(a, b)), "arithmetic expects Int")
+    CURLEE_VM_INT_BINARY(SubUnchecked, Value::int_v(wrapping_sub(a, b)), "arithmetic expects Int")
+    CURLEE_VM_INT_BINARY(MulUnchecked, Value::int_v(wrapping_mul(a, b)), "arithmetic expects Int")
+
+    CURLEE_VM_OP(DivUnchecked)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.size() < 2)
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        Value& lhs = stack_.back();
+        if (lhs.kind != ValueKind::Int || rhs.kind != ValueKind::Int)
+        {
+            return err_result("arithmetic expects Int", span_of(instr));
+        }
+        if (div_traps(lhs.as_int(), rhs.as_int()))
+        {
+            return err_result(div_trap_message(rhs.as_int()), span_of(instr));
+        }
+        lhs = Value::int_v(lhs.as_int() / rhs.as_int());
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(NegUnchecked)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.empty())
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        Value& value = stack_.back();
+        if (value.kind != ValueKind::Int)
+        {
+            return err_result("neg expects Int", span_of(instr));
+        }
+        value = Value::int_v(wrapping_neg(value.as_int()));
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Not)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.empty())
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        Value& value = stack_.back();
+        if (value.kind != ValueKind::Bool)
+        {
+            return err_result("not expects Bool", span_of(instr));
+        }
+        value = Value::bool_v(!value.as_bool());
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Equal)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.size() < 2)
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        stack_.back() = Value::bool_v(stack_.back() == rhs);
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(NotEqual)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.size() < 2)
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        stack_.back() = Value::bool_v(!(stack_.back() == rhs));
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Pop)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.empty())
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        stack_.pop_back();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Return)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.empty())
+        {
+            return err_result("missing return", span_of(instr));
+        }
+        return ok_result(std::move(stack_.back()));
+    }
+
+    CURLEE_VM_OP(Jump)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (instr->operand == kThreadedInvalidTarget)
+        {
+            return err_result("jump target out of range", span_of(instr));
+        }
+        ip = base + instr->operand;
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(JumpIfFalse)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (stack_.empty())
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        const Value cond = std::move(stack_.back());
+        stack_.pop_back();
+        if (cond.kind != ValueKind::Bool)
+        {
+            return err_result("jump-if-false expects Bool", span_of(instr));
+        }
+        if (!cond.as_bool())
+        {
+            if (instr->operand == kThreadedInvalidTarget)
             {
-                std::string msg = "python runner failed";
-                if (auto m = extract_error_message(proc.out); m.has_value())
-                {
-                    msg = *m;
-                }
-                else if (proc.exit_code == 127)
-                {
-                    msg = use_sandbox ? "python sandbox exec failed" : "python runner exec failed";
-                }
-                else if (use_sandbox)
-                {
-                    msg = "python sandbox failed";
-                }
-                return err_result(msg, span);
+                return err_result("jump target out of range", span_of(instr));
             }
+            ip = base + instr->operand;
+        }
+        CURLEE_VM_DISPATCH();
+    }
 
-            push(Value::unit_v());
-            break;
+    CURLEE_VM_OP(Call)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (instr->operand == kThreadedInvalidTarget)
+        {
+            return err_result("call target out of range", span_of(instr));
+        }
+        if (instr->callee != kThreadedNoFunction &&
+            stack_.size() < chunk.functions[instr->callee].arity)
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        CURLEE_VM_ENTER_CALL();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Ret)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (call_stack.empty())
+        {
+            return err_result("return with empty call stack", span_of(instr));
+        }
+        CURLEE_VM_LEAVE_CALL();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(Print)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (!runtime::has_capability(capabilities, runtime::Capability::IoStdout))
+        {
+            return err_result("missing capability io:stdout", span_of(instr));
+        }
+        if (stack_.empty())
+        {
+            return err_result("stack underflow", span_of(instr));
+        }
+        // MVP: stub effect. No ambient IO; host can later wire an output sink.
+        stack_.back() = Value::unit_v();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_OP(PythonCall)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (auto error = python_call(capabilities); error.has_value())
+        {
+            return err_result(*error, span_of(instr));
+        }
+        stack_.push_back(Value::unit_v());
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(Nop)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(Truncated)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        switch (static_cast<OpCode>(instr->operand))
+        {
+        case OpCode::Constant:
+            return err_result("truncated constant", span_of(instr));
+        case OpCode::LoadLocal:
+        case OpCode::StoreLocal:
+            return err_result("truncated local index", span_of(instr));
+        case OpCode::Call:
+            return err_result("truncated call target", span_of(instr));
+        default:
+            return err_result("truncated jump target", span_of(instr));
+        }
+    }
+
+    CURLEE_VM_PSEUDO(End)
+    {
+        return err_result("no return", std::nullopt);
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedConstant)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        stack_.push_back(chunk.constants[instr->operand]);
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedLoadLocal)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        stack_.push_back(frame[instr->operand]);
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedStoreLocal)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        frame[instr->operand] = std::move(stack_.back());
+        stack_.pop_back();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedPop)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        stack_.pop_back();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedEqual)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        stack_.back() = Value::bool_v(stack_.back() == rhs);
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedNotEqual)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        stack_.back() = Value::bool_v(!(stack_.back() == rhs));
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_VERIFIED_CHECKED_INT_BINARY(VerifiedAddInt, add_overflows)
+    CURLEE_VM_VERIFIED_CHECKED_INT_BINARY(VerifiedSubInt, sub_overflows)
+    CURLEE_VM_VERIFIED_CHECKED_INT_BINARY(VerifiedMulInt, mul_overflows)
+    CURLEE_VM_VERIFIED_INT_BINARY(VerifiedLessInt, Value::bool_v(a < b))
+    CURLEE_VM_VERIFIED_INT_BINARY(VerifiedLessEqualInt, Value::bool_v(a <= b))
+    CURLEE_VM_VERIFIED_INT_BINARY(VerifiedGreaterInt, Value::bool_v(a > b))
+    CURLEE_VM_VERIFIED_INT_BINARY(VerifiedGreaterEqualInt, Value::bool_v(a >= b))
+
+    CURLEE_VM_PSEUDO(VerifiedAddString)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        const Value rhs = std::move(stack_.back());
+        stack_.pop_back();
+        Value& lhs = stack_.back();
+        lhs = Value::string_v(lhs.as_string() + rhs.as_string());
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedDivInt)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        const std::int64_t b = stack_.back().as_int();
+        if (b == 0)
+        {
+            return err_result("divide by zero", span_of(instr));
         }
+        stack_.pop_back();
+        Value& lhs = stack_.back();
+        if (div_overflows(lhs.as_int(), b))
+        {
+            return err_result("integer overflow", span_of(instr));
         }
+        lhs = Value::int_v(lhs.as_int() / b);
+        CURLEE_VM_DISPATCH();
     }
 
+    CURLEE_VM_PSEUDO(VerifiedNegInt)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        Value& value = stack_.back();
+        if (value.as_int() == std::numeric_limits<std::int64_t>::min())
+        {
+            return err_result("integer overflow", span_of(instr));
+        }
+        value = Value::int_v(-value.as_int());
+        CURLEE_VM_DISPATCH();
+    }
+
+    // Proven by the verifier and by verify_bytecode: no checks left beyond the division trap.
+    CURLEE_VM_VERIFIED_INT_BINARY(VerifiedAddIntUnchecked, Value::int_v(wrapping_add(a, b)))
+    CURLEE_VM_VERIFIED_INT_BINARY(VerifiedSubIntUnchecked, Value::int_v(wrapping_sub(a, b)))
+    CURLEE_VM_VERIFIED_INT_BINARY(VerifiedMulIntUnchecked, Value::int_v(wrapping_mul(a, b)))
+
+    CURLEE_VM_PSEUDO(VerifiedDivIntUnchecked)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        const std::int64_t b = stack_.back().as_int();
+        stack_.pop_back();
+        Value& lhs = stack_.back();
+        if (div_traps(lhs.as_int(), b))
+        {
+            return err_result(div_trap_message(b), span_of(instr));
+        }
+        lhs = Value::int_v(lhs.as_int() / b);
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedNegIntUnchecked)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        Value& value = stack_.back();
+        value = Value::int_v(wrapping_neg(value.as_int()));
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedNotBool)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        Value& value = stack_.back();
+        value = Value::bool_v(!value.as_bool());
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedReturn)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        return ok_result(std::move(stack_.back()));
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedJump)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        ip = base + instr->operand;
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedJumpIfFalse)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        const bool cond = stack_.back().as_bool();
+        stack_.pop_back();
+        if (!cond)
+        {
+            ip = base + instr->operand;
+        }
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedCall)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        CURLEE_VM_ENTER_CALL();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedRet)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        CURLEE_VM_LEAVE_CALL();
+        CURLEE_VM_DISPATCH();
+    }
+
+    CURLEE_VM_PSEUDO(VerifiedPrint)
+    {
+        CURLEE_VM_CONSUME_FUEL();
+        if (!runtime::has_capability(capabilities, runtime::Capability::IoStdout))
+        {
+            return err_result("missing capability io:stdout", span_of(instr));
+        }
+        stack_.back() = Value::unit_v();
+        CURLEE_VM_DISPATCH();
+    }
+
+#if !CURLEE_VM_COMPUTED_GOTO
+    }
     return err_result("no return", std::nullopt);
+#endif
 }
 
+#undef CURLEE_VM_VERIFIED_CHECKED_INT_BINARY
+#undef CURLEE_VM_VERIFIED_INT_BINARY
+#undef CURLEE_VM_LEAVE_CALL
+#undef CURLEE_VM_ENTER_CALL
+#undef CURLEE_VM_CHECKED_INT_BINARY
+#undef CURLEE_VM_INT_BINARY
+#undef CURLEE_VM_CONSUME_FUEL
+#undef CURLEE_VM_PSEUDO
+#undef CURLEE_VM_OP
+#undef CURLEE_VM_DISPATCH
+#undef CURLEE_VM_HANDLER
+
+#if CURLEE_VM_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
 } // namespace curlee::vm
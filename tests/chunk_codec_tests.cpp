@@ -2,6 +2,7 @@
 #include <cstdlib>
 #include <curlee/source/span.h>
 #include <curlee/vm/chunk_codec.h>
+#include <curlee/vm/span_table.h>
 #include <curlee/vm/value.h>
 #include <iostream>
 #include <limits>
@@ -109,8 +110,24 @@ static void expect_roundtrip(const curlee::vm::Chunk& expected,
     expect_eq(got.spans.size(), expected.spans.size(), what + ": spans size");
     for (std::size_t i = 0; i < got.spans.size(); ++i)
     {
-        expect_eq(got.spans[i].start, expected.spans[i].start, what + ": span start");
-        expect_eq(got.spans[i].end, expected.spans[i].end, what + ": span end");
+        const auto a = got.spans.lookup(i);
+        const auto b = expected.spans.lookup(i);
+        expect(a.has_value() == b.has_value(), what + ": span presence");
+        if (a.has_value())
+        {
+            expect_eq(a->start, b->start, what + ": span start");
+            expect_eq(a->end, b->end, what + ": span end");
+        }
+    }
+
+    expect_eq(got.functions.size(), expected.functions.size(), what + ": functions size");
+    for (std::size_t i = 0; i < got.functions.size(); ++i)
+    {
+        expect_eq(got.functions[i].entry, expected.functions[i].entry, what + ": fn entry");
+        expect_eq(got.functions[i].arity, expected.functions[i].arity, what + ": fn arity");
+        expect_eq(got.functions[i].locals, expected.functions[i].locals, what + ": fn locals");
+        expect_eq(got.functions[i].max_stack, expected.functions[i].max_stack,
+                  what + ": fn max_stack");
     }
 
     expect_eq(got.constants.size(), expected.constants.size(), what + ": constants size");
@@ -122,13 +139,13 @@ static void expect_roundtrip(const curlee::vm::Chunk& expected,
         switch (a.kind)
         {
         case curlee::vm::ValueKind::Int:
-            expect_eq(a.int_value, b.int_value, what + ": int constant");
+            expect_eq(a.as_int(), b.as_int(), what + ": int constant");
             break;
         case curlee::vm::ValueKind::Bool:
-            expect(a.bool_value == b.bool_value, what + ": bool constant");
+            expect(a.as_bool() == b.as_bool(), what + ": bool constant");
             break;
         case curlee::vm::ValueKind::String:
-            expect_eq(a.string_value, b.string_value, what + ": string constant");
+            expect_eq(a.as_string(), b.as_string(), what + ": string constant");
             break;
         case curlee::vm::ValueKind::Unit:
             break;
@@ -146,8 +163,9 @@ static std::vector<std::uint8_t> encode_chunk_v1(const curlee::vm::Chunk& chunk)
     out.insert(out.end(), chunk.code.begin(), chunk.code.end());
 
     append_u32(out, static_cast<std::uint32_t>(chunk.spans.size()));
-    for (const auto& s : chunk.spans)
+    for (std::size_t i = 0; i < chunk.spans.size(); ++i)
     {
+        const auto s = chunk.spans.lookup(i).value_or(curlee::source::Span{});
         append_u32(out, static_cast<std::uint32_t>(s.start));
         append_u32(out, static_cast<std::uint32_t>(s.end));
     }
@@ -159,16 +177,62 @@ static std::vector<std::uint8_t> encode_chunk_v1(const curlee::vm::Chunk& chunk)
         {
         case curlee::vm::ValueKind::Int:
             append_u8(out, 0);
-            append_u64(out, static_cast<std::uint64_t>(c.int_value));
+            append_u64(out, static_cast<std::uint64_t>(c.as_int()));
+            break;
+        case curlee::vm::ValueKind::Bool:
+            append_u8(out, 1);
+            append_u8(out, c.as_bool() ? 1 : 0);
+            break;
+        case curlee::vm::ValueKind::String:
+            append_u8(out, 2);
+            append_u32(out, static_cast<std::uint32_t>(c.as_string().size()));
+            out.insert(out.end(), c.as_string().begin(), c.as_string().end());
+            break;
+        case curlee::vm::ValueKind::Unit:
+            append_u8(out, 3);
+            break;
+        }
+    }
+
+    return out;
+}
+
+// Versions 2 and 3: u64 fields and one span per code byte; version 3 adds the function table.
+static std::vector<std::uint8_t> encode_chunk_per_byte_spans(const curlee::vm::Chunk& chunk,
+                                                             std::uint32_t ver)
+{
+    std::vector<std::uint8_t> out = append_magic_and_ver(ver);
+
+    append_u64(out, static_cast<std::uint64_t>(chunk.max_locals));
+
+    append_u64(out, static_cast<std::uint64_t>(chunk.code.size()));
+    out.insert(out.end(), chunk.code.begin(), chunk.code.end());
+
+    append_u64(out, static_cast<std::uint64_t>(chunk.spans.size()));
+    for (std::size_t i = 0; i < chunk.spans.size(); ++i)
+    {
+        const auto s = chunk.spans.lookup(i).value_or(curlee::source::Span{});
+        append_u64(out, static_cast<std::uint64_t>(s.start));
+        append_u64(out, static_cast<std::uint64_t>(s.end));
+    }
+
+    append_u64(out, static_cast<std::uint64_t>(chunk.constants.size()));
+    for (const auto& c : chunk.constants)
+    {
+        switch (c.kind)
+        {
+        case curlee::vm::ValueKind::Int:
+            append_u8(out, 0);
+            append_u64(out, static_cast<std::uint64_t>(c.as_int()));
             break;
         case curlee::vm::ValueKind::Bool:
             append_u8(out, 1);
-            append_u8(out, c.bool_value ? 1 : 0);
+            append_u8(out, c.as_bool() ? 1 : 0);
             break;
         case curlee::vm::ValueKind::String:
             append_u8(out, 2);
-            append_u32(out, static_cast<std::uint32_t>(c.string_value.size()));
-            out.insert(out.end(), c.string_value.begin(), c.string_value.end());
+            append_u64(out, static_cast<std::uint64_t>(c.as_string().size()));
+            out.insert(out.end(), c.as_string().begin(), c.as_string().end());
             break;
         case curlee::vm::ValueKind::Unit:
             append_u8(out, 3);
@@ -176,27 +240,152 @@ static std::vector<std::uint8_t> encode_chunk_v1(const curlee::vm::Chunk& chunk)
         }
     }
 
+    if (ver >= 3)
+    {
+        append_u64(out, static_cast<std::uint64_t>(chunk.functions.size()));
+        for (const auto& fn : chunk.functions)
+        {
+            append_u64(out, static_cast<std::uint64_t>(fn.entry));
+            append_u64(out, static_cast<std::uint64_t>(fn.arity));
+            append_u64(out, static_cast<std::uint64_t>(fn.locals));
+            append_u64(out, static_cast<std::uint64_t>(fn.max_stack));
+        }
+    }
     return out;
 }
 
+static curlee::vm::SpanTable per_byte_spans(const std::vector<curlee::source::Span>& spans)
+{
+    curlee::vm::SpanTable table;
+    for (std::size_t i = 0; i < spans.size(); ++i)
+    {
+        table.add(i, spans[i]);
+    }
+    return table;
+}
+
 int main()
 {
     using curlee::source::Span;
     using curlee::vm::Chunk;
     using curlee::vm::Value;
 
-    // v2 roundtrip.
+    // Current-version roundtrip.
     Chunk chunk;
     chunk.max_locals = 2;
     chunk.code = {0x01, 0x02, 0x03};
-    chunk.spans = {Span{.start = 0, .end = 1}, Span{.start = 1, .end = 2},
-                   Span{.start = 2, .end = 3}};
+    chunk.spans = per_byte_spans(
+        {Span{.start = 0, .end = 1}, Span{.start = 1, .end = 2}, Span{.start = 2, .end = 3}});
     chunk.constants = {Value::int_v(-7), Value::bool_v(true), Value::bool_v(false),
                        Value::string_v("hi"), Value::unit_v()};
 
     {
         const auto bytes = curlee::vm::encode_chunk(chunk);
-        expect_roundtrip(chunk, bytes, "v2 roundtrip");
+        expect_roundtrip(chunk, bytes, "roundtrip");
+    }
+
+    // v3 roundtrip with call-frame descriptors.
+    {
+        Chunk c3 = chunk;
+        c3.functions = {
+            curlee::vm::FunctionInfo{.entry = 0, .locals = 2, .max_stack = 1},
+            curlee::vm::FunctionInfo{.entry = 2, .arity = 1, .locals = 3, .max_stack = 1},
+        };
+        expect_roundtrip(c3, curlee::vm::encode_chunk(c3), "v3 roundtrip");
+    }
+
+    // v3 function table errors.
+    {
+        Chunk c3 = chunk;
+        auto bytes = curlee::vm::encode_chunk(c3);
+        bytes.resize(bytes.size() - 1);
+        expect_decode_err(bytes, "truncated function table length");
+    }
+    {
+        Chunk c3 = chunk;
+        c3.functions = {curlee::vm::FunctionInfo{.entry = 1}};
+        auto bytes = curlee::vm::encode_chunk(c3);
+        bytes.resize(bytes.size() - 8);
+        expect_decode_err(bytes, "truncated function");
+    }
+    {
+        Chunk c3 = chunk;
+        c3.functions = {curlee::vm::FunctionInfo{.entry = 3}};
+        expect_decode_err(curlee::vm::encode_chunk(c3), "function entry out of range");
+    }
+    {
+        // Frame sizes the VM would try (and fail) to allocate are rejected up front.
+        Chunk c3 = chunk;
+        c3.functions = {curlee::vm::FunctionInfo{.entry = 0, .locals = std::size_t{1} << 40}};
+        expect_decode_err(curlee::vm::encode_chunk(c3), "function frame out of range");
+        c3.functions = {curlee::vm::FunctionInfo{.entry = 0, .arity = (std::size_t{1} << 16) + 1}};
+        expect_decode_err(curlee::vm::encode_chunk(c3), "function frame out of range");
+        c3.functions = {curlee::vm::FunctionInfo{.entry = 0, .max_stack = 4}};
+        expect_decode_err(curlee::vm::encode_chunk(c3), "function max_stack out of range");
+        c3.functions.clear();
+        c3.max_locals = (std::size_t{1} << 16) + 1;
+        expect_decode_err(curlee::vm::encode_chunk(c3), "max_locals out of range");
+    }
+
+    // v2 chunks (no function table) and v3 chunks (per-byte spans) still decode.
+    {
+        expect_roundtrip(chunk, encode_chunk_per_byte_spans(chunk, 2), "v2 decode");
+        Chunk c3 = chunk;
+        c3.functions = {curlee::vm::FunctionInfo{.entry = 2, .arity = 1, .locals = 1}};
+        expect_roundtrip(c3, encode_chunk_per_byte_spans(c3, 3), "v3 decode");
+    }
+
+    // Span tables key spans by instruction start and cover operand bytes.
+    {
+        Chunk emitted;
+        const Span a{.start = 10, .end = 14};
+        const Span b{.start = 3, .end = 20};
+        emitted.emit_constant(Value::int_v(1), a); // 0..2
+        emitted.emit_constant(Value::int_v(2), a); // 3..5
+        emitted.emit(curlee::vm::OpCode::Add, b);  // 6
+        emitted.emit(curlee::vm::OpCode::Return);  // 7
+
+        const auto& spans = emitted.spans;
+        expect_eq(spans.size(), emitted.code.size(), "span table covers the code");
+        expect_eq(spans.record_count(), std::size_t{3}, "runs of one span share a record");
+        expect(spans.lookup(4).has_value() && spans.lookup(4)->start == 10, "operand span");
+        expect(spans.lookup(6).has_value() && spans.lookup(6)->start == 3 &&
+                   spans.lookup(6)->end == 20,
+               "span moving backwards");
+        expect(spans.lookup(7).has_value() && spans.lookup(7)->end == 0, "default span");
+        expect(!spans.lookup(8).has_value(), "no span past the code");
+        expect_eq(spans.entries().size(), std::size_t{3}, "decoded entries");
+
+        expect_roundtrip(emitted, curlee::vm::encode_chunk(emitted), "emitted roundtrip");
+        const auto v3 = encode_chunk_per_byte_spans(emitted, 3);
+        expect_roundtrip(emitted, v3, "emitted v3 decode");
+        expect(std::get<Chunk>(curlee::vm::decode_chunk(v3)).spans == spans,
+               "per-byte spans re-encode to the same table");
+        expect(curlee::vm::encode_chunk(emitted).size() + 100 < v3.size(),
+               "v4 spans are much smaller than per-byte spans");
+    }
+
+    // v4 span table errors.
+    {
+        const auto full = curlee::vm::encode_chunk(chunk);
+        // magic, version, max_locals, code_len, code, spans_len
+        const std::size_t table_len_at = sizeof("CURLEE_CHUNK") + 4 + 8 + 8 + 3 + 8;
+
+        auto bytes = std::vector<std::uint8_t>(full.begin(), full.begin() + table_len_at + 4);
+        expect_decode_err(bytes, "truncated span table length");
+
+        bytes = std::vector<std::uint8_t>(full.begin(), full.begin() + table_len_at + 9);
+        expect_decode_err(bytes, "truncated span table");
+
+        auto bad = full;
+        bad[table_len_at + 8 + 8] = 0x80; // the last varint never terminates
+        expect_decode_err(bad, "invalid span table");
+
+        Chunk empty_table = chunk;
+        empty_table.spans.clear();
+        bad = curlee::vm::encode_chunk(empty_table);
+        bad[table_len_at - 8] = 3; // claims to cover the code with no records
+        expect_decode_err(bad, "invalid span table");
     }
 
     // v1 decode compatibility.
@@ -425,7 +614,7 @@ int main()
         Chunk bad;
         bad.max_locals = 0;
         bad.code = {0x01, 0x02};
-        bad.spans = {Span{.start = 0, .end = 0}};
+        bad.spans.add(0, Span{.start = 0, .end = 0});
         bad.constants = {};
 
         const auto bytes = curlee::vm::encode_chunk(bad);
@@ -494,7 +683,7 @@ int main()
         Chunk c;
         c.max_locals = 0;
         c.code = {0x01};
-        c.spans = {Span{.start = 0, .end = 0}};
+        c.spans.add(0, Span{.start = 0, .end = 0});
         c.constants = {Value::string_v("hi")};
 
         auto bytes = encode_chunk_v1(c);
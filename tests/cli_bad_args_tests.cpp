@@ -492,6 +492,80 @@ int main()
         expect_contains(err, "error: unknown command: wat", "stderr");
     }
 
+    // check: -j needs a non-negative integer.
+    for (const std::vector<std::string>& argv :
+         {std::vector<std::string>{"curlee", "check", "-j"},
+          std::vector<std::string>{"curlee", "check", "-jx", fixture.string()},
+          std::vector<std::string>{"curlee", "check", "--jobs=-1", fixture.string()},
+          std::vector<std::string>{"curlee", "check", "--solver-timeout", fixture.string()},
+          std::vector<std::string>{"curlee", "check", "--solver-rlimit=99999999999",
+                                   fixture.string()}})
+    {
+        std::string out;
+        std::string err;
+        if (run_cli_capture(argv, out, err) != 2)
+        {
+            fail("expected usage exit code for bad check integer option");
+        }
+        expect_contains(err, "usage:", "stderr");
+    }
+
+    // check: -j N and solver budgets otherwise behave like plain check.
+    {
+        std::string out;
+        std::string err;
+        if (run_cli_capture({"curlee", "check", "-j", "4", fixture.string()}, out, err) != 0 ||
+            run_cli_capture({"curlee", "check", "-j2", fixture.string()}, out, err) != 0)
+        {
+            fail("expected parallel check to succeed; stderr=" + err);
+        }
+        if (run_cli_capture({"curlee", "check", "--portfolio", "--solver-timeout", "5000",
+                             "--solver-rlimit=0", fixture.string()},
+                            out, err) != 0)
+        {
+            fail("expected budgeted portfolio check to succeed; stderr=" + err);
+        }
+        if (run_cli_capture({"curlee", "check", "--int-theory", "bv", fixture.string()}, out,
+                            err) != 0 ||
+            run_cli_capture({"curlee", "check", "--int-theory=auto", fixture.string()}, out,
+                            err) != 0)
+        {
+            fail("expected check under a bit-vector theory to succeed; stderr=" + err);
+        }
+    }
+
+    // check: a product of two variables only verifies with int64 variables.
+    {
+        const fs::path nonlinear = find_repo_relative(fs::path("tests") / "fixtures" /
+                                                      "check_nonlinear_contract.curlee");
+        std::string out;
+        std::string err;
+        if (run_cli_capture({"curlee", "check", nonlinear.string()}, out, err) == 0)
+        {
+            fail("expected integer check of a non-linear contract to fail");
+        }
+        expect_contains(err, "non-linear multiplication is not supported", "stderr");
+        if (run_cli_capture({"curlee", "check", "--int-theory", "auto", nonlinear.string()}, out,
+                            err) != 0)
+        {
+            fail("expected auto check of a non-linear contract to succeed; stderr=" + err);
+        }
+    }
+
+    // check: --int-theory takes int, bv or auto.
+    for (const std::vector<std::string>& argv :
+         {std::vector<std::string>{"curlee", "check", "--int-theory", "real", fixture.string()},
+          std::vector<std::string>{"curlee", "check", fixture.string(), "--int-theory"}})
+    {
+        std::string out;
+        std::string err;
+        if (run_cli_capture(argv, out, err) != 2)
+        {
+            fail("expected usage exit code for a bad --int-theory");
+        }
+        expect_contains(err, "usage:", "stderr");
+    }
+
     std::cout << "OK\n";
     return 0;
 }
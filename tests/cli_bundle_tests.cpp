@@ -644,6 +644,103 @@ int main()
         fs::remove_all(dir);
     }
 
+    // Certified bundles: the receiver re-verifies the source against the bundle's certificate
+    // and runs the bytecode only if the source reproduces it.
+    {
+        const fs::path dir = temp_path("curlee_cli_bundle_certificate");
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+
+        const fs::path entry = dir / "main.curlee";
+        const fs::path bundle_path = dir / "certified.bundle";
+        write_all(entry, "fn inc(x: Int) -> Int [ requires x > 0; requires x < 1000; ensures "
+                         "result > x; ] {\n"
+                         "  return x + 1;\n"
+                         "}\n"
+                         "fn main() -> Int {\n"
+                         "  return inc(5);\n"
+                         "}\n");
+
+        std::string out;
+        std::string err;
+        int rc = run_cli({"curlee", "bundle", "create", "--cap", "io:stdout", entry.string(),
+                          bundle_path.string()},
+                         out, err);
+        if (rc != 0 || out != "curlee bundle create: ok\n")
+        {
+            fail("expected bundle create to succeed; stderr: " + err);
+        }
+        const auto loaded = read_bundle(bundle_path.string());
+        const auto* created = std::get_if<Bundle>(&loaded);
+        if (created == nullptr || !created->manifest.proof.has_value() ||
+            !created->manifest.proof->starts_with("curlee-proof-1 ") ||
+            created->manifest.capabilities != std::vector<std::string>{"io:stdout"})
+        {
+            fail("expected the created bundle to carry a proof certificate");
+        }
+
+        rc = run_cli({"curlee", "bundle", "verify", bundle_path.string(), entry.string()}, out, err);
+        if (rc != 0 || out != "curlee bundle verify: ok\n" || !err.empty())
+        {
+            fail("expected bundle verify to re-verify the source; stderr: " + err);
+        }
+
+        rc = run_cli({"curlee", "run", "--cap", "io:stdout", "--bundle", bundle_path.string(),
+                      entry.string()},
+                     out, err);
+        if (rc != 0 || out.find("curlee run: result 6") == std::string::npos)
+        {
+            fail("expected the certified bundle to run; stderr: " + err);
+        }
+
+        // The certificate vouches for this source only.
+        write_all(entry, "fn main() -> Int {\n"
+                         "  return 7;\n"
+                         "}\n");
+        rc = run_cli({"curlee", "run", "--cap", "io:stdout", "--bundle", bundle_path.string(),
+                      entry.string()},
+                     out, err);
+        if (rc == 0 || err.find("bundle bytecode does not match the verified program") ==
+                           std::string::npos)
+        {
+            fail("expected a certified bundle to reject a different source");
+        }
+
+        // A source that no longer verifies is rejected like any other.
+        write_all(entry, "fn main() -> Int [ ensures result > 9; ] {\n"
+                         "  return 7;\n"
+                         "}\n");
+        rc = run_cli({"curlee", "bundle", "verify", bundle_path.string(), entry.string()}, out, err);
+        if (rc == 0 || err.find("ensures clause not satisfied") == std::string::npos)
+        {
+            fail("expected bundle verify to report the failing contract");
+        }
+
+        // Opaque proofs cannot be checked against a source.
+        Bundle opaque;
+        opaque.manifest.proof = "proof-v1";
+        opaque.bytecode = curlee::vm::encode_chunk(make_return_int_chunk(7));
+        const fs::path opaque_path = dir / "opaque.bundle";
+        if (!write_bundle(opaque_path.string(), opaque).message.empty())
+        {
+            fail("expected bundle write to succeed");
+        }
+        rc = run_cli({"curlee", "bundle", "verify", opaque_path.string(), entry.string()}, out,
+                     err);
+        if (rc == 0 || err.find("bundle has no proof certificate") == std::string::npos)
+        {
+            fail("expected bundle verify with a source to require a certificate");
+        }
+
+        rc = run_cli({"curlee", "bundle", "create", entry.string()}, out, err);
+        if (rc == 0 || err.find("expected curlee bundle create") == std::string::npos)
+        {
+            fail("expected bundle create without an output path to be a usage error");
+        }
+
+        fs::remove_all(dir);
+    }
+
     fs::remove(ok_path);
     fs::remove(ok2_path);
     fs::remove(bad_path);
@@ -0,0 +1,285 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <curlee/cli/cli.h>
+#include <curlee/cli/compile_cache.h>
+#include <curlee/verification/cache_file.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+[[noreturn]] static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+static void write_file(const fs::path& path, const std::string& contents)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+    if (!out)
+    {
+        fail("failed to write " + path.string());
+    }
+}
+
+static std::size_t count_entries(const fs::path& dir)
+{
+    std::size_t n = 0;
+    for (const auto& e : fs::directory_iterator(dir))
+    {
+        if (e.path().extension() == ".entry")
+        {
+            ++n;
+        }
+    }
+    return n;
+}
+
+static int run_cli_capture(std::vector<std::string> argv_storage, std::string& out,
+                           std::string& err)
+{
+    std::ostringstream captured_out;
+    std::ostringstream captured_err;
+
+    auto* old_out = std::cout.rdbuf(captured_out.rdbuf());
+    auto* old_err = std::cerr.rdbuf(captured_err.rdbuf());
+
+    std::vector<char*> argv;
+    argv.reserve(argv_storage.size());
+    for (auto& s : argv_storage)
+    {
+        argv.push_back(s.data());
+    }
+
+    const int rc = curlee::cli::run(static_cast<int>(argv.size()), argv.data());
+
+    std::cout.rdbuf(old_out);
+    std::cerr.rdbuf(old_err);
+
+    out = captured_out.str();
+    err = captured_err.str();
+    return rc;
+}
+
+int main()
+{
+    using curlee::cli::CacheDependency;
+    using curlee::cli::CacheEntry;
+    using curlee::cli::CompileCache;
+
+    // SHA-256 test vectors, including a message that needs a second padding block.
+    if (curlee::verification::sha256_hex("") !=
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" ||
+        curlee::verification::sha256_hex("abc") !=
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" ||
+        curlee::verification::sha256_hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") !=
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1")
+    {
+        fail("sha256_hex does not match the standard test vectors");
+    }
+
+    const fs::path root = fs::temp_directory_path() /
+                          ("curlee_cli_compile_cache_tests." + std::to_string(::getpid()));
+    fs::remove_all(root);
+    const fs::path cache_dir = root / "cache";
+    const fs::path main_path = root / "src" / "main.curlee";
+    const fs::path mod_path = root / "src" / "mymod" / "math.curlee";
+
+    write_file(main_path,
+               "import mymod.math;\n\nfn main() -> Int {\n  return mymod.math.add1(41);\n}\n");
+    write_file(mod_path, "fn add1(x: Int) -> Int {\n  return x + 1;\n}\n");
+
+    ::setenv("CURLEE_CACHE_DIR", cache_dir.c_str(), 1);
+
+    // A cold check stores one entry; a cold run reuses it and still prints the result.
+    {
+        std::string out;
+        std::string err;
+        if (run_cli_capture({"curlee", "check", main_path.string()}, out, err) != 0)
+        {
+            fail("expected cold check to succeed; stderr=" + err);
+        }
+        if (count_entries(cache_dir) != 1)
+        {
+            fail("expected check to store exactly one cache entry");
+        }
+        if (run_cli_capture({"curlee", "run", main_path.string()}, out, err) != 0 ||
+            out != "curlee run: result 42\n")
+        {
+            fail("expected cached run to print result 42; stdout=" + out + " stderr=" + err);
+        }
+    }
+
+    // Changing an import invalidates the entry: the broken module is checked and rejected.
+    {
+        write_file(mod_path, "fn add1(x: Int) -> Int {\n  return true;\n}\n");
+        std::string out;
+        std::string err;
+        if (run_cli_capture({"curlee", "check", main_path.string()}, out, err) == 0)
+        {
+            fail("expected check to fail after the imported module changed");
+        }
+        write_file(mod_path, "fn add1(x: Int) -> Int {\n  return x + 1;\n}\n");
+        if (run_cli_capture({"curlee", "run", main_path.string()}, out, err) != 0 ||
+            out != "curlee run: result 42\n")
+        {
+            fail("expected run to succeed once the module is restored; stderr=" + err);
+        }
+    }
+
+    // A hit skips the front end entirely: a stored verdict is trusted as-is.
+    {
+        const fs::path bad = root / "src" / "bad.curlee";
+        const std::string contents = "fn main() -> Unit {\n  return 0;\n}\n";
+        write_file(bad, contents);
+        const CompileCache cache(cache_dir, CompileCache::kDefaultMaxBytes);
+        cache.store(CompileCache::key(bad.string(), contents, "check+emit"), CacheEntry{});
+
+        std::string out;
+        std::string err;
+        if (run_cli_capture({"curlee", "check", bad.string()}, out, err) != 0)
+        {
+            fail("expected check to answer from the cache without type checking");
+        }
+        // No chunk was stored, so run falls back to the full pipeline and reports the error.
+        if (run_cli_capture({"curlee", "run", bad.string()}, out, err) == 0)
+        {
+            fail("expected run without a cached chunk to re-check and fail");
+        }
+    }
+
+    // Failures are never compile-cached, but their solved obligations are: a re-check
+    // reproduces the diagnostic, model included, from the obligation cache.
+    {
+        const fs::path failing = root / "src" / "failing.curlee";
+        write_file(failing, "fn need_pos(x: Int) -> Int [ requires x > 0; ] {\n  return x;\n}\n"
+                            "fn main() -> Int {\n  return need_pos(0);\n}\n");
+        std::string out;
+        std::string cold_err;
+        std::string warm_err;
+        if (run_cli_capture({"curlee", "check", failing.string()}, out, cold_err) == 0 ||
+            run_cli_capture({"curlee", "check", failing.string()}, out, warm_err) == 0)
+        {
+            fail("expected the failing program to fail verification");
+        }
+        if (cold_err != warm_err || cold_err.find("need_pos::x = 0") == std::string::npos)
+        {
+            fail("expected a cached failure to render identically; stderr=" + warm_err);
+        }
+        std::size_t obligations = 0;
+        for (const auto& e : fs::directory_iterator(cache_dir / "obligations"))
+        {
+            obligations += e.path().extension() == ".obligation" ? 1 : 0;
+        }
+        if (obligations == 0)
+        {
+            fail("expected solved obligations to be stored under the cache directory");
+        }
+    }
+
+    // A check with int64 variables proves more, so its entry does not answer an integer check.
+    {
+        const fs::path bounded = root / "src" / "bounded.curlee";
+        write_file(bounded, "fn id(x: Int) -> Int [ ensures result <= 9223372036854775807; ] {\n"
+                            "  return x;\n}\n");
+        std::string out;
+        std::string err;
+        if (run_cli_capture({"curlee", "check", "--int-theory=bv", bounded.string()}, out, err) !=
+            0)
+        {
+            fail("expected the bit-vector check to succeed; stderr=" + err);
+        }
+        if (run_cli_capture({"curlee", "check", bounded.string()}, out, err) == 0)
+        {
+            fail("expected the integer check not to hit the bit-vector entry");
+        }
+    }
+
+    // --stats measures a cached program again, reporting the obligations the cache answered.
+    {
+        std::string out;
+        std::string err;
+        if (run_cli_capture({"curlee", "check", "--stats", main_path.string()}, out, err) != 0 ||
+            err.find("verification: 1 obligations") == std::string::npos ||
+            err.find("add1") == std::string::npos)
+        {
+            fail("expected --stats to verify a cached program again; stderr=" + err);
+        }
+    }
+
+    ::unsetenv("CURLEE_CACHE_DIR");
+
+    // Missing import candidates are dependencies too: creating one invalidates the entry.
+    {
+        const CompileCache cache(root / "deps", CompileCache::kDefaultMaxBytes);
+        const fs::path absent = root / "absent.curlee";
+        const CacheEntry entry{
+            .dependencies = {CacheDependency{.path = absent.string(), .hash = ""}},
+            .chunk = std::vector<std::uint8_t>{1, 2, 3},
+        };
+        cache.store("k", entry);
+        const auto hit = cache.lookup("k");
+        if (!hit.has_value() || hit->chunk != entry.chunk || hit->dependencies.size() != 1)
+        {
+            fail("expected a stored entry to round-trip");
+        }
+        write_file(absent, "fn f() -> Int {\n  return 1;\n}\n");
+        if (cache.lookup("k").has_value())
+        {
+            fail("expected creating a missing import candidate to invalidate the entry");
+        }
+    }
+
+    // Stores evict the least recently used entries to stay within the size bound.
+    {
+        const fs::path dir = root / "evict";
+        const CacheEntry entry{.dependencies = {},
+                               .chunk = std::vector<std::uint8_t>(1000, 0x42)};
+        const CompileCache cache(dir, 2500);
+        cache.store("a", entry);
+        cache.store("b", entry);
+        fs::last_write_time(dir / "a.entry",
+                            fs::file_time_type::clock::now() - std::chrono::hours(2));
+        cache.store("c", entry);
+        if (count_entries(dir) != 2 || cache.lookup("a").has_value() ||
+            !cache.lookup("b").has_value() || !cache.lookup("c").has_value())
+        {
+            fail("expected the least recently used entry to be evicted");
+        }
+
+        // Solved obligations and function results share the bound with compile entries.
+        write_file(dir / "obligations" / "old.obligation", std::string(1000, 'o'));
+        write_file(dir / "functions" / "new.function", std::string(10, 'f'));
+        fs::last_write_time(dir / "obligations" / "old.obligation",
+                            fs::file_time_type::clock::now() - std::chrono::hours(3));
+        cache.evict();
+        if (fs::exists(dir / "obligations" / "old.obligation") ||
+            !fs::exists(dir / "functions" / "new.function") || count_entries(dir) != 2)
+        {
+            fail("expected eviction to cover the obligation and function caches");
+        }
+    }
+
+    // Corrupt entries are misses, not errors.
+    {
+        const fs::path dir = root / "corrupt";
+        write_file(dir / "x.entry", "curlee-cache 1\nchunk 99\nshort");
+        if (CompileCache(dir, CompileCache::kDefaultMaxBytes).lookup("x").has_value())
+        {
+            fail("expected a truncated entry to miss");
+        }
+    }
+
+    fs::remove_all(root);
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include <cstdlib>
+#include <curlee/cli/cli.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+[[noreturn]] static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+static fs::path find_repo_relative(const fs::path& relative)
+{
+    fs::path dir = fs::current_path();
+    for (int i = 0; i < 8; ++i)
+    {
+        const fs::path candidate = dir / relative;
+        if (fs::exists(candidate))
+        {
+            return candidate;
+        }
+        if (!dir.has_parent_path())
+        {
+            break;
+        }
+        dir = dir.parent_path();
+    }
+    fail("unable to locate repo-relative path: " + relative.string());
+}
+
+static int run_cli_capture(std::vector<std::string> argv_storage, std::string& out,
+                           std::string& err)
+{
+    std::ostringstream captured_out;
+    std::ostringstream captured_err;
+
+    auto* old_out = std::cout.rdbuf(captured_out.rdbuf());
+    auto* old_err = std::cerr.rdbuf(captured_err.rdbuf());
+
+    std::vector<char*> argv;
+    argv.reserve(argv_storage.size());
+    for (auto& s : argv_storage)
+    {
+        argv.push_back(s.data());
+    }
+
+    const int rc = curlee::cli::run(static_cast<int>(argv.size()), argv.data());
+
+    std::cout.rdbuf(old_out);
+    std::cerr.rdbuf(old_err);
+
+    out = captured_out.str();
+    err = captured_err.str();
+    return rc;
+}
+
+int main()
+{
+    const fs::path fib = find_repo_relative(fs::path("tests") / "fixtures" / "run_profile.curlee");
+    const fs::path infinite =
+        find_repo_relative(fs::path("tests") / "fixtures" / "run_infinite_loop.curlee");
+    const fs::path stacks = fs::temp_directory_path() / "curlee_cli_profile_tests.folded";
+
+    // --profile prints the report to stderr and leaves stdout unchanged.
+    {
+        std::string out;
+        std::string err;
+        const int rc = run_cli_capture({"curlee", "run", "--profile", fib.string()}, out, err);
+        if (rc != 0 || out != "curlee run: result 55\n")
+        {
+            fail("expected profiled run to succeed with the usual stdout; stderr=" + err);
+        }
+        for (const char* needle : {"profile: ", "opcodes (by cycles):", "Call", "functions",
+                                   "main", "fib", "hot spans", "run_profile.curlee:"})
+        {
+            if (err.find(needle) == std::string::npos)
+            {
+                fail(std::string("expected profile report to mention '") + needle + "':\n" + err);
+            }
+        }
+    }
+
+    // --profile-stacks writes collapsed stacks (and implies --profile).
+    for (const std::string& flag : {std::string("--profile-stacks=") + stacks.string(),
+                                    std::string("--profile-stacks")})
+    {
+        std::error_code ec;
+        fs::remove(stacks, ec);
+
+        std::vector<std::string> argv = {"curlee", "run", flag};
+        if (flag == "--profile-stacks")
+        {
+            argv.push_back(stacks.string());
+        }
+        argv.push_back(fib.string());
+
+        std::string out;
+        std::string err;
+        if (run_cli_capture(argv, out, err) != 0 || err.find("profile: ") == std::string::npos)
+        {
+            fail("expected " + flag + " to profile the run; stderr=" + err);
+        }
+
+        std::ifstream in(stacks);
+        const std::string folded((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+        if (folded.find("main;fib;fib ") == std::string::npos)
+        {
+            fail("expected collapsed stacks for recursive calls:\n" + folded);
+        }
+        fs::remove(stacks, ec);
+    }
+
+    // Failing runs still report where the time went.
+    {
+        std::string out;
+        std::string err;
+        const int rc = run_cli_capture(
+            {"curlee", "run", "--fuel", "50", "--profile", infinite.string()}, out, err);
+        if (rc == 0 || err.find("out of fuel") == std::string::npos ||
+            err.find("profile: 50 instructions") == std::string::npos)
+        {
+            fail("expected out-of-fuel run to be profiled; stderr=" + err);
+        }
+    }
+
+    // Unwritable stacks path is an error.
+    {
+        std::string out;
+        std::string err;
+        const int rc = run_cli_capture(
+            {"curlee", "run", "--profile-stacks=/no/such/dir/out.folded", fib.string()}, out, err);
+        if (rc == 0 || err.find("failed to write profile stacks") == std::string::npos)
+        {
+            fail("expected unwritable stacks path to fail");
+        }
+    }
+
+    // Usage errors.
+    for (const std::vector<std::string>& argv :
+         {std::vector<std::string>{"curlee", "run", fib.string(), "--profile-stacks"},
+          std::vector<std::string>{"curlee", "run", "--profile-stacks=", fib.string()}})
+    {
+        std::string out;
+        std::string err;
+        if (run_cli_capture(argv, out, err) != 2 ||
+            err.find("expected file path after --profile-stacks") == std::string::npos)
+        {
+            fail("expected usage error for missing --profile-stacks path");
+        }
+    }
+
+    // check --stats prints a table of obligations to stderr, slowest first, even on failure.
+    const fs::path nonlinear =
+        find_repo_relative(fs::path("tests") / "fixtures" / "check_nonlinear_contract.curlee");
+    const fs::path divide =
+        find_repo_relative(fs::path("tests") / "fixtures" / "check_requires_divide.curlee");
+    {
+        std::string out;
+        std::string err;
+        const int rc = run_cli_capture(
+            {"curlee", "check", "--int-theory", "auto", "--stats", nonlinear.string()}, out, err);
+        if (rc != 0 || !out.empty())
+        {
+            fail("expected check --stats to succeed with empty stdout; stderr=" + err);
+        }
+        for (const char* needle :
+             {"verification: 4 obligations", "obligations (by time):", "conflicts", "ensures",
+              "arithmetic", "call-requires", "proven", "area",
+              "check_nonlinear_contract.curlee:4:"})
+        {
+            if (err.find(needle) == std::string::npos)
+            {
+                fail(std::string("expected stats table to mention '") + needle + "':\n" + err);
+            }
+        }
+
+        const int failed =
+            run_cli_capture({"curlee", "check", "--stats", divide.string()}, out, err);
+        if (failed == 0 || err.find("requires clause not satisfied") == std::string::npos ||
+            err.find("refuted") == std::string::npos)
+        {
+            fail("expected failing check to report its obligations; stderr=" + err);
+        }
+    }
+
+    // --stats=json prints JSON to stdout instead.
+    {
+        std::string out;
+        std::string err;
+        const int rc = run_cli_capture(
+            {"curlee", "check", "--int-theory=auto", "--stats=json", nonlinear.string()}, out, err);
+        if (rc != 0 || !err.empty() || !out.starts_with("{\"total_micros\":") ||
+            out.find("\"function\":\"area\",\"kind\":\"ensures\"") == std::string::npos ||
+            out.find("check_nonlinear_contract.curlee:4:") == std::string::npos ||
+            !out.ends_with("]}\n"))
+        {
+            fail("expected JSON stats on stdout; stdout=" + out + " stderr=" + err);
+        }
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
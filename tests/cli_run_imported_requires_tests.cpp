@@ -0,0 +1,118 @@
+#include <cstdlib>
+#include <curlee/cli/cli.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+[[noreturn]] static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+static int run_cli_capture(const std::vector<std::string>& argv_storage, std::string& out,
+                           std::string& err)
+{
+    std::ostringstream captured_out;
+    std::ostringstream captured_err;
+
+    auto* old_out = std::cout.rdbuf(captured_out.rdbuf());
+    auto* old_err = std::cerr.rdbuf(captured_err.rdbuf());
+
+    std::vector<std::string> args = argv_storage;
+    std::vector<char*> argv;
+    argv.reserve(args.size());
+    for (auto& s : args)
+    {
+        argv.push_back(s.data());
+    }
+
+    const int rc = curlee::cli::run(static_cast<int>(argv.size()), argv.data());
+
+    std::cout.rdbuf(old_out);
+    std::cerr.rdbuf(old_err);
+
+    out = captured_out.str();
+    err = captured_err.str();
+    return rc;
+}
+
+static void expect_contains(const std::string& haystack, const std::string& needle,
+                            const std::string& what)
+{
+    if (haystack.find(needle) == std::string::npos)
+    {
+        fail("expected " + what + " to contain '" + needle + "'\n---\n" + haystack + "\n---");
+    }
+}
+
+static void expect_not_contains(const std::string& haystack, const std::string& needle,
+                                const std::string& what)
+{
+    if (haystack.find(needle) != std::string::npos)
+    {
+        fail("expected " + what + " not to contain '" + needle + "'\n---\n" + haystack + "\n---");
+    }
+}
+
+static void write_file(const fs::path& path, const std::string& contents)
+{
+    fs::create_directories(path.parent_path());
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f)
+    {
+        fail("failed to open file: " + path.string());
+    }
+
+    f << contents;
+    if (!f)
+    {
+        fail("failed to write file: " + path.string());
+    }
+}
+
+int main()
+{
+    // run: a module-qualified call is not checked against the callee's `requires`, so the
+    // callee's arithmetic must keep its overflow check.
+    {
+        const auto pid = static_cast<unsigned long>(::getpid());
+        const fs::path dir =
+            fs::temp_directory_path() / ("curlee_cli_imported_requires_" + std::to_string(pid));
+
+        write_file(dir / "mymod" / "math.curlee",
+                   "fn add1(x: Int) -> Int [ requires x < 100; ] { return x + 1; }\n");
+        write_file(dir / "main.curlee",
+                   "import mymod.math as m;\n"
+                   "fn main() -> Int { return m.add1(9223372036854775807); }\n");
+
+        std::string out;
+        std::string err;
+        int rc = run_cli_capture({"curlee", "check", (dir / "main.curlee").string()}, out, err);
+        if (rc != 0)
+        {
+            fail("expected check to succeed\n---\n" + err + "\n---");
+        }
+
+        rc = run_cli_capture({"curlee", "run", (dir / "main.curlee").string()}, out, err);
+        if (rc != 1)
+        {
+            fail("expected error exit code for overflowing imported add1");
+        }
+
+        expect_not_contains(out, "-9223372036854775808", "stdout");
+        expect_contains(err, "integer overflow", "stderr");
+
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    return 0;
+}
@@ -5,6 +5,8 @@
 #include <curlee/vm/vm.h>
 #include <iostream>
 #include <memory>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 static void fail(const std::string& msg)
@@ -13,7 +15,9 @@ static void fail(const std::string& msg)
     std::exit(1);
 }
 
-static curlee::vm::Chunk compile_to_chunk(const std::string& source)
+static curlee::vm::Chunk
+compile_to_chunk(const std::string& source,
+                 const std::unordered_set<std::size_t>& proven_arithmetic = {})
 {
     const auto lexed = curlee::lexer::lex(source);
     if (std::holds_alternative<curlee::diag::Diagnostic>(lexed))
@@ -29,7 +33,7 @@ static curlee::vm::Chunk compile_to_chunk(const std::string& source)
     }
 
     const auto& program = std::get<curlee::parser::Program>(parsed);
-    const auto emitted = curlee::compiler::emit_bytecode(program);
+    const auto emitted = curlee::compiler::emit_bytecode(program, proven_arithmetic);
     if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(emitted))
     {
         fail("expected bytecode emission to succeed");
@@ -87,6 +91,11 @@ static std::vector<curlee::vm::OpCode> decode_ops(const curlee::vm::Chunk& chunk
         case OpCode::Ret:
         case OpCode::Print:
         case OpCode::PythonCall:
+        case OpCode::AddUnchecked:
+        case OpCode::SubUnchecked:
+        case OpCode::MulUnchecked:
+        case OpCode::DivUnchecked:
+        case OpCode::NegUnchecked:
             break;
         }
     }
@@ -107,6 +116,43 @@ static bool contains_op(const std::vector<curlee::vm::OpCode>& ops, curlee::vm::
 
 int main()
 {
+    {
+        // Arithmetic proven safe by the verifier is lowered to unchecked opcodes; everything
+        // else gets the overflow-checked ones.
+        using curlee::vm::OpCode;
+        const std::string source =
+            "fn main() -> Int { let x: Int = 7; return -(x * 3 - 1) / 2 + x; }";
+        std::unordered_set<std::size_t> every_expr;
+        for (std::size_t id = 0; id < 64; ++id)
+        {
+            every_expr.insert(id);
+        }
+
+        const auto checked_ops = decode_ops(compile_to_chunk(source));
+        const auto unchecked = compile_to_chunk(source, every_expr);
+        const auto unchecked_ops = decode_ops(unchecked);
+        const std::pair<OpCode, OpCode> variants[] = {
+            {OpCode::Add, OpCode::AddUnchecked}, {OpCode::Sub, OpCode::SubUnchecked},
+            {OpCode::Mul, OpCode::MulUnchecked}, {OpCode::Div, OpCode::DivUnchecked},
+            {OpCode::Neg, OpCode::NegUnchecked},
+        };
+        for (const auto& [checked, proven] : variants)
+        {
+            if (!contains_op(checked_ops, checked) || contains_op(checked_ops, proven) ||
+                contains_op(unchecked_ops, checked) || !contains_op(unchecked_ops, proven))
+            {
+                fail("expected proven arithmetic to use unchecked opcodes: " +
+                     std::string(curlee::vm::opcode_name(checked)));
+            }
+        }
+
+        const auto res = run_chunk(unchecked);
+        if (!res.ok || !(res.value == curlee::vm::Value::int_v(-3)))
+        {
+            fail("expected unchecked arithmetic to compute -3");
+        }
+    }
+
     {
         const std::string source = "fn main() -> Int { let x: Int = 1; return x + 2; }";
 
@@ -196,6 +242,31 @@ int main()
         }
     }
 
+    {
+        // Recursion: every call gets its own frame, so `n` is not clobbered by the inner call.
+        const std::string source =
+            "fn fib(n: Int) -> Int { if (n < 2) { return n; } let a: Int = fib(n - 1); "
+            "let b: Int = fib(n - 2); return a + b; } fn main() -> Int { let x: Int = 0; "
+            "return fib(15); }";
+
+        const auto chunk = compile_to_chunk(source);
+        if (chunk.functions.size() != 2 || chunk.functions[0].entry != 0 ||
+            chunk.functions[0].locals != 1 || chunk.max_locals != 1)
+        {
+            fail("expected main's descriptor to describe the entry frame");
+        }
+        const auto* fib = &chunk.functions[1];
+        if (fib->arity != 1 || fib->locals != 3 || fib->max_stack != 2)
+        {
+            fail("expected fib descriptor arity=1 locals=3 max_stack=2");
+        }
+        const auto res = run_chunk(chunk);
+        if (!res.ok || !(res.value == curlee::vm::Value::int_v(610)))
+        {
+            fail("expected fib(15) to equal 610");
+        }
+    }
+
     {
         const std::string source =
             "fn negate(x: Bool) -> Bool { return !x; } fn main() -> Bool { return negate(false); }";
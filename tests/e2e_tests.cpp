@@ -76,7 +76,8 @@ static void check_program(const fs::path& path, bool run_vm)
 
     if (run_vm)
     {
-        const auto emitted = curlee::compiler::emit_bytecode(program);
+        const auto& proven = std::get<curlee::verification::Verified>(verified).proven_arithmetic;
+        const auto emitted = curlee::compiler::emit_bytecode(program, proven);
         if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(emitted))
         {
             fail("bytecode emit failed for " + path.string());
@@ -85,6 +86,38 @@ static void check_program(const fs::path& path, bool run_vm)
         curlee::vm::VM vm;
         const auto result = vm.run(chunk, 10000);
 
+        // Unchecked arithmetic at proven sites must not change what the program computes.
+        const auto checked = curlee::compiler::emit_bytecode(program);
+        const auto checked_result = vm.run(std::get<curlee::vm::Chunk>(checked), 10000);
+        if (checked_result.ok != result.ok || !(checked_result.value == result.value) ||
+            checked_result.error != result.error)
+        {
+            fail("proven and fully checked arithmetic disagree for " + path.string());
+        }
+
+        curlee::vm::VM switch_vm;
+        switch_vm.set_dispatch_mode(curlee::vm::DispatchMode::Switch);
+        const auto switch_result = switch_vm.run(chunk, 10000);
+        if (switch_result.ok != result.ok || !(switch_result.value == result.value) ||
+            switch_result.error != result.error)
+        {
+            fail("switch and threaded dispatch disagree for " + path.string());
+        }
+
+        // Everything the compiler emits must pass the load-time bytecode verifier.
+        const curlee::vm::PreparedChunk prepared(chunk);
+        if (!prepared.verified())
+        {
+            fail("bytecode verifier rejected " + path.string() + ": " +
+                 prepared.verify_error()->message);
+        }
+        const auto prepared_result = vm.run(prepared, 10000);
+        if (prepared_result.ok != result.ok || !(prepared_result.value == result.value) ||
+            prepared_result.error != result.error)
+        {
+            fail("verified and checked execution disagree for " + path.string());
+        }
+
         if (expect_vm_failure)
         {
             if (result.ok)
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <curlee/lexer/lexer.h>
+#include <curlee/parser/parser.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+namespace
+{
+
+using namespace curlee;
+
+// Spans, expression ids and where each name points, which dump() leaves out.
+class Fingerprint
+{
+  public:
+    explicit Fingerprint(std::string_view text) : text_(text) {}
+
+    std::string of(const parser::Program& program)
+    {
+        for (const auto& decl : program.imports)
+        {
+            span(decl.span);
+            for (const auto segment : decl.path)
+            {
+                view(segment);
+            }
+            if (decl.alias.has_value())
+            {
+                view(*decl.alias);
+            }
+        }
+        for (const auto& decl : program.structs)
+        {
+            span(decl.span);
+            view(decl.name);
+            for (const auto& field : decl.fields)
+            {
+                span(field.span);
+                view(field.type.name);
+            }
+        }
+        for (const auto& decl : program.enums)
+        {
+            span(decl.span);
+            for (const auto& variant : decl.variants)
+            {
+                span(variant.span);
+                view(variant.name);
+            }
+        }
+        for (const auto& function : program.functions)
+        {
+            span(function.span);
+            view(function.name);
+            for (const auto& param : function.params)
+            {
+                span(param.span);
+                view(param.type.name);
+                if (param.refinement.has_value())
+                {
+                    pred(*param.refinement);
+                }
+            }
+            for (const auto& clause : function.requires_clauses)
+            {
+                pred(clause);
+            }
+            for (const auto& clause : function.ensures)
+            {
+                pred(clause);
+            }
+            block(function.body);
+        }
+        return out_.str();
+    }
+
+  private:
+    std::string_view text_;
+    std::ostringstream out_;
+
+    void span(const source::Span& s) { out_ << '[' << s.start << ',' << s.end << ']'; }
+
+    void view(std::string_view v)
+    {
+        if (v.data() < text_.data() || v.data() + v.size() > text_.data() + text_.size())
+        {
+            fail("name '" + std::string(v) + "' does not point into the text");
+        }
+        out_ << '@' << (v.data() - text_.data());
+    }
+
+    void pred(const parser::Pred& p)
+    {
+        span(p.span);
+        std::visit(
+            [&](const auto& node)
+            {
+                using Node = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<Node, parser::PredName>)
+                {
+                    view(node.name);
+                }
+                else if constexpr (std::is_same_v<Node, parser::PredBinary>)
+                {
+                    pred(*node.lhs);
+                    pred(*node.rhs);
+                }
+            },
+            p.node);
+    }
+
+    void expr(const parser::Expr& e)
+    {
+        out_ << '#' << e.id;
+        span(e.span);
+        std::visit(
+            [&](const auto& node)
+            {
+                using Node = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<Node, parser::NameExpr>)
+                {
+                    view(node.name);
+                }
+                else if constexpr (std::is_same_v<Node, parser::IntExpr> ||
+                                   std::is_same_v<Node, parser::StringExpr>)
+                {
+                    view(node.lexeme);
+                }
+                else if constexpr (std::is_same_v<Node, parser::BinaryExpr>)
+                {
+                    expr(*node.lhs);
+                    expr(*node.rhs);
+                }
+                else if constexpr (std::is_same_v<Node, parser::CallExpr>)
+                {
+                    expr(*node.callee);
+                    for (const auto& arg : node.args)
+                    {
+                        expr(arg);
+                    }
+                }
+                else if constexpr (std::is_same_v<Node, parser::MemberExpr>)
+                {
+                    expr(*node.base);
+                    view(node.member);
+                }
+            },
+            e.node);
+    }
+
+    void block(const parser::Block& b)
+    {
+        span(b.span);
+        for (const auto& s : b.stmts)
+        {
+            span(s.span);
+            std::visit(
+                [&](const auto& node)
+                {
+                    using Node = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<Node, parser::LetStmt>)
+                    {
+                        view(node.name);
+                        expr(node.value);
+                    }
+                    else if constexpr (std::is_same_v<Node, parser::ReturnStmt>)
+                    {
+                        if (node.value.has_value())
+                        {
+                            expr(*node.value);
+                        }
+                    }
+                    else if constexpr (std::is_same_v<Node, parser::ExprStmt>)
+                    {
+                        expr(node.expr);
+                    }
+                    else if constexpr (std::is_same_v<Node, parser::IfStmt>)
+                    {
+                        expr(node.cond);
+                        block(*node.then_block);
+                        if (node.else_block != nullptr)
+                        {
+                            block(*node.else_block);
+                        }
+                    }
+                    else if constexpr (std::is_same_v<Node, parser::WhileStmt>)
+                    {
+                        expr(node.cond);
+                        block(*node.body);
+                    }
+                    else if constexpr (std::is_same_v<Node, parser::UnsafeStmt>)
+                    {
+                        block(*node.body);
+                    }
+                    else if constexpr (std::is_same_v<Node, parser::BlockStmt>)
+                    {
+                        block(*node.block);
+                    }
+                },
+                s.node);
+        }
+    }
+};
+
+std::string diagnostics_summary(const std::vector<diag::Diagnostic>& diags)
+{
+    std::ostringstream out;
+    for (const auto& d : diags)
+    {
+        out << d.message;
+        if (d.span.has_value())
+        {
+            out << '[' << d.span->start << ',' << d.span->end << ']';
+        }
+        for (const auto& note : d.notes)
+        {
+            out << '+' << note.message;
+            if (note.span.has_value())
+            {
+                out << '[' << note.span->start << ',' << note.span->end << ']';
+            }
+        }
+        out << ';';
+    }
+    return out.str();
+}
+
+// A text with its tokens and, when it parses, its program.
+struct State
+{
+    std::unique_ptr<std::string> text;
+    std::vector<lexer::Token> tokens;
+    parser::Program program;
+    // Where the last accepted edit changed the tokens.
+    lexer::TokenEdit changed;
+};
+
+State parse_fully(std::string text)
+{
+    State state;
+    state.text = std::make_unique<std::string>(std::move(text));
+    auto lexed = lexer::lex(*state.text);
+    if (!std::holds_alternative<std::vector<lexer::Token>>(lexed))
+    {
+        fail("lex failed on the starting text");
+    }
+    state.tokens = std::get<std::vector<lexer::Token>>(std::move(lexed));
+    auto parsed = parser::parse(state.tokens);
+    if (!std::holds_alternative<parser::Program>(parsed))
+    {
+        fail("parse failed on the starting text");
+    }
+    state.program = std::get<parser::Program>(std::move(parsed));
+    return state;
+}
+
+// Apply `edit` to `state` both ways and compare. Returns whether the edited text parses, in which
+// case `state` now holds it.
+bool check_edit(State& state, const source::TextEdit& edit, std::string_view inserted,
+                const std::string& what)
+{
+    auto text = std::make_unique<std::string>(*state.text);
+    text->replace(edit.start, edit.old_end - edit.start, inserted);
+
+    const auto full_lex = lexer::lex(*text);
+    auto relexed = lexer::relex(state.tokens, *text, edit);
+    if (const auto* err = std::get_if<diag::Diagnostic>(&full_lex))
+    {
+        const auto* relex_err = std::get_if<diag::Diagnostic>(&relexed);
+        if (relex_err == nullptr ||
+            diagnostics_summary({*err}) != diagnostics_summary({*relex_err}))
+        {
+            fail(what + ": relex and lex disagree on the error");
+        }
+        return false;
+    }
+    if (!std::holds_alternative<lexer::Relexed>(relexed))
+    {
+        fail(what + ": relex failed where lex succeeded");
+    }
+    const auto& tokens = std::get<std::vector<lexer::Token>>(full_lex);
+    const auto& incremental = std::get<lexer::Relexed>(relexed);
+    if (incremental.tokens.size() != tokens.size())
+    {
+        fail(what + ": relex produced a different number of tokens");
+    }
+    for (std::size_t i = 0; i < tokens.size(); ++i)
+    {
+        const auto& a = tokens[i];
+        const auto& b = incremental.tokens[i];
+        if (a.kind != b.kind || a.span.start != b.span.start || a.span.end != b.span.end ||
+            a.lexeme.data() != b.lexeme.data() || a.lexeme.size() != b.lexeme.size())
+        {
+            fail(what + ": relex differs from lex at token " + std::to_string(i));
+        }
+    }
+    const auto& changed = incremental.edit;
+    if (changed.first > changed.new_end || changed.first > changed.old_end ||
+        tokens.size() - changed.new_end != state.tokens.size() - changed.old_end)
+    {
+        fail(what + ": inconsistent token edit");
+    }
+
+    auto full_parse = parser::parse(tokens);
+    auto reparsed = parser::reparse(std::move(state.program), state.tokens, incremental);
+    if (const auto* diags = std::get_if<std::vector<diag::Diagnostic>>(&full_parse))
+    {
+        const auto* re_diags = std::get_if<std::vector<diag::Diagnostic>>(&reparsed);
+        if (re_diags == nullptr || diagnostics_summary(*diags) != diagnostics_summary(*re_diags))
+        {
+            fail(what + ": reparse and parse disagree on the errors");
+        }
+        state.program = std::get<parser::Program>(parser::parse(state.tokens));
+        return false;
+    }
+    if (!std::holds_alternative<parser::Program>(reparsed))
+    {
+        fail(what + ": reparse failed where parse succeeded");
+    }
+    const auto& expected = std::get<parser::Program>(full_parse);
+    auto& got = std::get<parser::Program>(reparsed);
+    if (parser::dump(got) != parser::dump(expected))
+    {
+        fail(what + ": reparse dump differs:\n" + parser::dump(got) + "\nvs\n" +
+             parser::dump(expected));
+    }
+    if (Fingerprint(*text).of(got) != Fingerprint(*text).of(expected))
+    {
+        fail(what + ": reparse spans, ids or names differ");
+    }
+
+    state.text = std::move(text);
+    state.tokens = incremental.tokens;
+    state.changed = incremental.edit;
+    state.program = std::move(got);
+    return true;
+}
+
+constexpr std::string_view kProgram = R"(import foo.bar as baz;
+import util;
+
+struct Point {
+  x: Int;
+  y: Int;
+}
+
+enum Shape {
+  Dot(Point);
+  Empty;
+}
+
+/* block comment */
+fn add(a: Int, b: Int where b > 0) -> Int
+  [ requires a >= 0;
+    ensures result > a; ]
+{
+  return a + b;
+}
+
+fn main() -> Int
+{
+  let p: Point = Point{x: 1, y: 2};
+  let s: String = "hi // there";
+  let sum: Int = add(p.x, p.y); // line comment
+  if (sum > 0) {
+    { let z: Int = -sum; }
+  } else {
+    while (sum < 0) {
+      unsafe { add(sum, 1); }
+      return util::zero();
+    }
+  }
+  return sum;
+}
+)";
+
+} // namespace
+
+int main()
+{
+    {
+        // Targeted edits: inside a function, between declarations, growing a token, opening a
+        // comment that swallows the rest, and moving an import after a declaration.
+        State state = parse_fully(std::string(kProgram));
+        const auto at = [&](std::string_view needle)
+        {
+            const auto pos = state.text->find(needle);
+            if (pos == std::string::npos)
+            {
+                fail("fixture lacks '" + std::string(needle) + "'");
+            }
+            return pos;
+        };
+        const auto replace = [&](std::size_t start, std::size_t end, std::string_view text,
+                                 const std::string& what)
+        {
+            return check_edit(state,
+                              source::TextEdit{.start = start,
+                                               .old_end = end,
+                                               .new_end = start + text.size()},
+                              text, what);
+        };
+
+        std::size_t pos = at("a + b");
+        if (!replace(pos, pos + 1, "b", "rename inside a body"))
+        {
+            fail("expected the renamed body to parse");
+        }
+        pos = at("/* block");
+        if (!replace(pos, pos, "\n\n", "blank lines between declarations"))
+        {
+            fail("expected blank lines to parse");
+        }
+
+        // Declarations before and after the edit keep their nodes.
+        const auto* add_return = &std::get<parser::BinaryExpr>(
+            std::get<parser::ReturnStmt>(state.program.functions.at(0).body.stmts.front().node)
+                .value->node);
+        const auto* add_lhs = add_return->lhs.get();
+        pos = at("sum > 0");
+        if (!replace(pos + 3, pos + 3, "mary", "grow an identifier"))
+        {
+            fail("expected a longer identifier to parse");
+        }
+        if (state.changed.old_end - state.changed.first != 1 ||
+            state.changed.new_end - state.changed.first != 1)
+        {
+            fail("expected growing an identifier to relex just that token");
+        }
+        const auto& add = state.program.functions.at(0);
+        if (std::get<parser::BinaryExpr>(std::get<parser::ReturnStmt>(add.body.stmts.front().node)
+                                             .value->node)
+                .lhs.get() != add_lhs)
+        {
+            fail("expected a function before the edit to keep its nodes");
+        }
+
+        pos = at("fn main");
+        if (replace(pos, pos, "/* ", "unterminated comment"))
+        {
+            fail("expected an unterminated comment to fail");
+        }
+
+        pos = at("enum Shape");
+        if (replace(pos, pos, "import late;\n", "import after a declaration"))
+        {
+            fail("expected a late import to fail");
+        }
+
+        pos = at("enum Shape");
+        if (!replace(pos, pos, "fn early() -> Int { return 1; }\n", "insert a function"))
+        {
+            fail("expected an inserted function to parse");
+        }
+    }
+
+    {
+        // Random edits, kept when they still parse, against full lexes and parses.
+        std::mt19937 rng(20240612);
+        State state = parse_fully(std::string(kProgram));
+        static constexpr std::string_view kSnippets[] = {
+            " ",  "\n", "x",  "1",       "(",    ")",      "{",        "}",      ";",
+            "//", "/*", "*/", "\"",      "->",   "-",      ">",        "=",      ",",
+            ".",  "::", "fn", "import ", "let ", "struct", "return 0;", "enum E { A; }"};
+        int kept = 0;
+        for (int round = 0; round < 3000; ++round)
+        {
+            if (state.text->size() < 40)
+            {
+                state = parse_fully(std::string(kProgram));
+            }
+            const auto& text = *state.text;
+            const std::size_t start = rng() % (text.size() + 1);
+            std::size_t end = start;
+            std::string inserted;
+            switch (rng() % 4)
+            {
+            case 0:
+                // Small replacement.
+                end = std::min(text.size(), start + rng() % 3);
+                inserted = kSnippets[rng() % std::size(kSnippets)];
+                break;
+            case 1:
+                // Paste a slice of the text itself, often whole declarations.
+                {
+                    const std::size_t from = rng() % text.size();
+                    inserted = text.substr(from, rng() % 300);
+                }
+                break;
+            case 2:
+                // Cut a slice.
+                end = std::min(text.size(), start + rng() % 200);
+                break;
+            default:
+                // Retype one identifier byte.
+                if (start < text.size() &&
+                    std::isalpha(static_cast<unsigned char>(text[start])) != 0)
+                {
+                    end = start + 1;
+                    inserted = "q";
+                }
+                break;
+            }
+            const source::TextEdit edit{
+                .start = start, .old_end = end, .new_end = start + inserted.size()};
+            if (check_edit(state, edit, inserted, "round " + std::to_string(round)))
+            {
+                ++kept;
+            }
+        }
+        if (kept < 300)
+        {
+            fail("too few random edits parsed: " + std::to_string(kept));
+        }
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <curlee/parser/ast.h>
 #include <curlee/source/source_file.h>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -21,6 +22,28 @@ static void fail(const std::string& msg)
 #include "../src/lsp/lsp.cpp"
 #undef main
 
+// The server uses run_front_end's result whole; most tests want one side of it.
+static std::vector<curlee::diag::Diagnostic>
+collect_diagnostics(const curlee::source::SourceFile& file)
+{
+    auto result = run_front_end(file);
+    if (auto* diags = std::get_if<std::vector<curlee::diag::Diagnostic>>(&result))
+    {
+        return std::move(*diags);
+    }
+    return {};
+}
+
+static std::shared_ptr<const Analysis> analyze(const curlee::source::SourceFile& file)
+{
+    auto result = run_front_end(file);
+    if (auto* analysis = std::get_if<std::shared_ptr<const Analysis>>(&result))
+    {
+        return std::move(*analysis);
+    }
+    return nullptr;
+}
+
 static std::string lsp_frame(const std::string& payload)
 {
     std::ostringstream oss;
@@ -198,6 +221,12 @@ int main()
         {
             fail("expected json_escape to escape special characters");
         }
+        // Other control characters must be escaped too; UTF-8 passes through.
+        if (json_escape(std::string("a\x01\x1f\b\f\xC3\xA9", 7)) !=
+            "a\\u0001\\u001f\\b\\f\xC3\xA9")
+        {
+            fail("expected json_escape to escape every control character");
+        }
     }
 
     {
@@ -408,6 +437,54 @@ int main()
         }
     }
 
+    {
+        // apply_content_change: ranged edits apply in order, out-of-range positions clamp to the
+        // end of their line or of the text, and a change without a range replaces everything.
+        curlee::source::Rope text("ab\ncd\n");
+        const auto apply = [&](std::string_view change)
+        {
+            const auto parsed = parse_json(change);
+            return parsed.has_value() && apply_content_change(text, *parsed);
+        };
+        if (!apply(R"({"range":{"start":{"line":1,"character":1},)"
+                   R"("end":{"line":1,"character":2}},"text":"X\nY"})") ||
+            text.str() != "ab\ncX\nY\n")
+        {
+            fail("expected a ranged change to replace its range");
+        }
+        if (!apply(R"({"range":{"start":{"line":0,"character":99},)"
+                   R"("end":{"line":1,"character":0}},"text":""})") ||
+            text.str() != "abcX\nY\n")
+        {
+            fail("expected a character past the line end to clamp to it");
+        }
+        if (!apply(R"({"range":{"start":{"line":9,"character":0},)"
+                   R"("end":{"line":9,"character":0}},"text":"z"})") ||
+            text.str() != "abcX\nY\nz")
+        {
+            fail("expected a line past the end to clamp to the end of the text");
+        }
+        if (apply(R"({"range":{"start":{"line":0}},"text":"q"})") ||
+            apply(R"({"range":{"start":{"line":0,"character":0}}})") || text.str() != "abcX\nY\nz")
+        {
+            fail("expected malformed changes to leave the text alone");
+        }
+        if (!apply(R"({"text":"fn main() -> Int { return 0; }"})") ||
+            text.str() != "fn main() -> Int { return 0; }" || text.line_count() != 1)
+        {
+            fail("expected a change without a range to replace the whole text");
+        }
+
+        // Columns are UTF-16 code units: "é" is two bytes but one unit.
+        text = curlee::source::Rope("  let s: String = \"\xC3\xA9\"; return 1;");
+        if (!apply(R"({"range":{"start":{"line":0,"character":30},)"
+                   R"("end":{"line":0,"character":31}},"text":"12"})") ||
+            text.str() != "  let s: String = \"\xC3\xA9\"; return 12;")
+        {
+            fail("expected columns after a non-ASCII character to count UTF-16 units");
+        }
+    }
+
     {
         // function_signature_to_string and find_function_by_name.
         curlee::parser::Function f;
@@ -496,7 +573,7 @@ int main()
         {
             fail("expected lex error diagnostics");
         }
-        if (analyze(file).has_value())
+        if (analyze(file) != nullptr)
         {
             fail("expected analyze to fail on lex error");
         }
@@ -507,7 +584,7 @@ int main()
         {
             fail("expected resolve error diagnostics");
         }
-        if (analyze(file).has_value())
+        if (analyze(file) != nullptr)
         {
             fail("expected analyze to fail on resolve error");
         }
@@ -518,7 +595,7 @@ int main()
         {
             fail("expected type error diagnostics");
         }
-        if (analyze(file).has_value())
+        if (analyze(file) != nullptr)
         {
             fail("expected analyze to fail on type error");
         }
@@ -529,7 +606,7 @@ int main()
         {
             fail("expected no diagnostics for valid program");
         }
-        if (!analyze(file).has_value())
+        if (analyze(file) == nullptr)
         {
             fail("expected analyze to succeed on valid program");
         }
@@ -643,7 +720,7 @@ int main()
             }
 
             const auto a = analyze(file);
-            if (!a.has_value())
+            if (a == nullptr)
             {
                 fail("expected analyze() to succeed for doc_change (unexpected) ");
             }
@@ -700,36 +777,15 @@ int main()
             file.path = "/tmp/ok.curlee";
             file.contents = doc_change;
             const auto a = analyze(file);
-            if (!a.has_value())
+            if (a == nullptr)
             {
                 fail("expected analyze() to succeed for doc_change when computing offsets");
             }
 
-            const auto best_expr_at = [&](std::size_t off) -> const curlee::parser::Expr*
-            {
-                const curlee::parser::Expr* best_expr = nullptr;
-                for (const auto& func : a->program.functions)
-                {
-                    for (const auto& stmt : func.body.stmts)
-                    {
-                        find_exprs_in_stmt(stmt, off, best_expr);
-                    }
-                }
-                return best_expr;
-            };
-
-            const auto best_call_at = [&](std::size_t off) -> const curlee::parser::Expr*
-            {
-                const curlee::parser::Expr* best_call = nullptr;
-                for (const auto& func : a->program.functions)
-                {
-                    for (const auto& stmt : func.body.stmts)
-                    {
-                        find_call_exprs_in_stmt(stmt, off, best_call);
-                    }
-                }
-                return best_call;
-            };
+            const auto best_expr_at = [&](std::size_t off)
+            { return a->positions.exprs.innermost(off); };
+            const auto best_call_at = [&](std::size_t off)
+            { return a->positions.calls.innermost(off); };
 
             bool found = false;
             const std::size_t limit = std::min(doc_change.size(), scoped_call + 16);
@@ -1046,14 +1102,14 @@ int main()
         const std::string bad = "fn main() -> Int { return true; }";
         const curlee::source::SourceFile file{.path = "/tmp/bad_type.curlee", .contents = bad};
         const auto a = analyze(file);
-        if (a.has_value())
+        if (a != nullptr)
         {
             fail("expected analyze() to fail for type error");
         }
     }
 
     {
-        // Manually build partial ASTs to cover null-pointer branches in find_* helpers.
+        // Manually build partial ASTs to cover null-pointer branches in the index_* helpers.
         using curlee::parser::Expr;
         using curlee::parser::Stmt;
 
@@ -1065,47 +1121,26 @@ int main()
                         .span = span,
                         .node = curlee::parser::UnaryExpr{.op = curlee::lexer::TokenKind::Bang,
                                                           .rhs = nullptr}};
-        (void)find_expr_at(unary_null, 1, nullptr);
-        (void)find_call_expr_at(unary_null, 1, nullptr);
+        PositionIndex index;
+        index_expr(unary_null, index);
 
         Expr binary_null{.id = 3,
                          .span = span,
                          .node = curlee::parser::BinaryExpr{
                              .op = curlee::lexer::TokenKind::Plus, .lhs = nullptr, .rhs = nullptr}};
-        (void)find_expr_at(binary_null, 1, nullptr);
-        (void)find_call_expr_at(binary_null, 1, nullptr);
+        index_expr(binary_null, index);
 
         Expr call_null_callee{
             .id = 4, .span = span, .node = curlee::parser::CallExpr{.callee = nullptr, .args = {}}};
-        (void)find_expr_at(call_null_callee, 1, nullptr);
-        (void)find_call_expr_at(call_null_callee, 1, nullptr);
-
-        // Cover the false branch of `if (!best || expr.span.length() < best->span.length())`
-        // inside find_call_expr_at.
-        Expr small_call{.id = 40,
-                        .span = curlee::source::Span{.start = 0, .end = 1},
-                        .node = curlee::parser::CallExpr{.callee = nullptr, .args = {}}};
-        Expr big_call{.id = 41,
-                      .span = curlee::source::Span{.start = 0, .end = 10},
-                      .node = curlee::parser::CallExpr{.callee = nullptr, .args = {}}};
-        (void)find_call_expr_at(big_call, 0, &small_call);
-        (void)find_call_expr_at(small_call, 0, &big_call);
+        index_expr(call_null_callee, index);
 
         Expr member_null{.id = 5,
                          .span = span,
                          .node = curlee::parser::MemberExpr{.base = nullptr, .member = "m"}};
-        (void)find_expr_at(member_null, 1, nullptr);
-        (void)find_call_expr_at(member_null, 1, nullptr);
+        index_expr(member_null, index);
 
         Expr group_null{.id = 6, .span = span, .node = curlee::parser::GroupExpr{.inner = nullptr}};
-        (void)find_expr_at(group_null, 1, nullptr);
-        (void)find_call_expr_at(group_null, 1, nullptr);
-
-        // Also hit the initial predicate in find_call_expr_at for non-call nodes and
-        // out-of-span offsets.
-        const Expr leaf = make_leaf(30);
-        (void)find_call_expr_at(leaf, 1, nullptr);
-        (void)find_call_expr_at(call_null_callee, 999, nullptr);
+        index_expr(group_null, index);
 
         Stmt ret_no_value{.span = span, .node = curlee::parser::ReturnStmt{.value = std::nullopt}};
         Stmt ret_with_value{
@@ -1139,25 +1174,287 @@ int main()
                         .node = curlee::parser::UnsafeStmt{
                             .body = std::make_unique<curlee::parser::Block>(std::move(one_block))}};
 
-        const curlee::parser::Expr* best = nullptr;
-        find_call_exprs_in_stmt(ret_no_value, 1, best);
-        find_call_exprs_in_stmt(ret_with_value, 1, best);
-        find_call_exprs_in_stmt(if_null_blocks, 1, best);
-        find_call_exprs_in_stmt(while_null_body, 1, best);
-        find_call_exprs_in_stmt(block_null, 1, best);
-        find_call_exprs_in_stmt(unsafe_null, 1, best);
-        find_call_exprs_in_stmt(unsafe_empty, 1, best);
-        find_call_exprs_in_stmt(unsafe_one, 1, best);
-
-        best = nullptr;
-        find_exprs_in_stmt(ret_no_value, 1, best);
-        find_exprs_in_stmt(ret_with_value, 1, best);
-        find_exprs_in_stmt(if_null_blocks, 1, best);
-        find_exprs_in_stmt(while_null_body, 1, best);
-        find_exprs_in_stmt(block_null, 1, best);
-        find_exprs_in_stmt(unsafe_null, 1, best);
-        find_exprs_in_stmt(unsafe_empty, 1, best);
-        find_exprs_in_stmt(unsafe_one, 1, best);
+        index_stmt(ret_no_value, index);
+        index_stmt(ret_with_value, index);
+        index_stmt(if_null_blocks, index);
+        index_stmt(while_null_body, index);
+        index_stmt(block_null, index);
+        index_stmt(unsafe_null, index);
+        index_stmt(unsafe_empty, index);
+        index_stmt(unsafe_one, index);
+
+        // Every span here is the same, so the first node indexed wins.
+        index.exprs.build();
+        index.calls.build();
+        if (index.exprs.innermost(1) != &unary_null ||
+            index.calls.innermost(1) != &call_null_callee)
+        {
+            fail("expected equal spans to resolve to the first node indexed");
+        }
+    }
+
+    {
+        // SpanIndex: innermost of nested spans, gaps between siblings, and empty spans.
+        const int outer = 0;
+        const int left = 1;
+        const int left_inner = 2;
+        const int right = 3;
+        const int empty = 4;
+        SpanIndex<int> index;
+        index.add(curlee::source::Span{.start = 0, .end = 20}, &outer);
+        index.add(curlee::source::Span{.start = 2, .end = 8}, &left);
+        index.add(curlee::source::Span{.start = 4, .end = 6}, &left_inner);
+        index.add(curlee::source::Span{.start = 10, .end = 15}, &right);
+        index.add(curlee::source::Span{.start = 16, .end = 16}, &empty);
+        index.build();
+
+        const std::vector<std::pair<std::size_t, const int*>> expected = {
+            {0, &outer},  {2, &left},   {4, &left_inner}, {5, &left_inner}, {6, &left},
+            {7, &left},   {8, &outer},  {10, &right},     {14, &right},     {15, &outer},
+            {16, &outer}, {19, &outer}, {20, nullptr},    {99, nullptr}};
+        for (const auto& [offset, node] : expected)
+        {
+            if (index.innermost(offset) != node)
+            {
+                fail("unexpected SpanIndex::innermost at offset " + std::to_string(offset));
+            }
+        }
+        if (SpanIndex<int>{}.innermost(0) != nullptr)
+        {
+            fail("expected an empty SpanIndex to find nothing");
+        }
+    }
+
+    {
+        // The position index agrees with a full walk for every offset: the smallest expression
+        // containing it, the first in pre-order on ties.
+        const std::string text = "fn add(a: Int, b: Int) -> Int { return a + b; }\n"
+                                 "fn main() -> Int {\n"
+                                 "  let x: Int = (add(1, -2) * 3);\n"
+                                 "  if (x > 0) { return add(x, add(x, 1)); }\n"
+                                 "  while (x < 10) { add(x, 1); }\n"
+                                 "  return x;\n"
+                                 "}\n";
+        const auto analysis =
+            analyze(curlee::source::SourceFile{.path = "/tmp/index.curlee", .contents = text});
+        if (analysis == nullptr)
+        {
+            fail("expected the position index fixture to analyze");
+        }
+
+        std::vector<const curlee::parser::Expr*> preorder;
+        const std::function<void(const curlee::parser::Expr&)> walk_expr =
+            [&](const curlee::parser::Expr& e)
+        {
+            preorder.push_back(&e);
+            std::visit(
+                [&](const auto& node)
+                {
+                    using T = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<T, curlee::parser::UnaryExpr>)
+                    {
+                        walk_expr(*node.rhs);
+                    }
+                    else if constexpr (std::is_same_v<T, curlee::parser::BinaryExpr>)
+                    {
+                        walk_expr(*node.lhs);
+                        walk_expr(*node.rhs);
+                    }
+                    else if constexpr (std::is_same_v<T, curlee::parser::CallExpr>)
+                    {
+                        walk_expr(*node.callee);
+                        for (const auto& arg : node.args)
+                        {
+                            walk_expr(arg);
+                        }
+                    }
+                    else if constexpr (std::is_same_v<T, curlee::parser::GroupExpr>)
+                    {
+                        walk_expr(*node.inner);
+                    }
+                },
+                e.node);
+        };
+        const std::function<void(const curlee::parser::Stmt&)> walk_stmt =
+            [&](const curlee::parser::Stmt& st)
+        {
+            std::visit(
+                [&](const auto& node)
+                {
+                    using T = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<T, curlee::parser::LetStmt>)
+                    {
+                        walk_expr(node.value);
+                    }
+                    else if constexpr (std::is_same_v<T, curlee::parser::ReturnStmt>)
+                    {
+                        walk_expr(*node.value);
+                    }
+                    else if constexpr (std::is_same_v<T, curlee::parser::ExprStmt>)
+                    {
+                        walk_expr(node.expr);
+                    }
+                    else if constexpr (std::is_same_v<T, curlee::parser::IfStmt>)
+                    {
+                        walk_expr(node.cond);
+                        for (const auto& inner : node.then_block->stmts)
+                        {
+                            walk_stmt(inner);
+                        }
+                    }
+                    else if constexpr (std::is_same_v<T, curlee::parser::WhileStmt>)
+                    {
+                        walk_expr(node.cond);
+                        for (const auto& inner : node.body->stmts)
+                        {
+                            walk_stmt(inner);
+                        }
+                    }
+                },
+                st.node);
+        };
+        for (const auto& func : analysis->program.functions)
+        {
+            for (const auto& st : func.body.stmts)
+            {
+                walk_stmt(st);
+            }
+        }
+
+        for (std::size_t offset = 0; offset <= text.size(); ++offset)
+        {
+            const curlee::parser::Expr* want_expr = nullptr;
+            const curlee::parser::Expr* want_call = nullptr;
+            for (const auto* e : preorder)
+            {
+                if (offset < e->span.start || offset >= e->span.end)
+                {
+                    continue;
+                }
+                if (want_expr == nullptr || e->span.length() < want_expr->span.length())
+                {
+                    want_expr = e;
+                }
+                if (std::holds_alternative<curlee::parser::CallExpr>(e->node) &&
+                    (want_call == nullptr || e->span.length() < want_call->span.length()))
+                {
+                    want_call = e;
+                }
+            }
+            if (analysis->positions.exprs.innermost(offset) != want_expr ||
+                analysis->positions.calls.innermost(offset) != want_call)
+            {
+                fail("position index disagrees with a full walk at offset " +
+                     std::to_string(offset));
+            }
+
+            const curlee::resolver::NameUse* want_use = nullptr;
+            for (const auto& use : analysis->resolution.uses)
+            {
+                if (offset >= use.span.start && offset < use.span.end)
+                {
+                    want_use = &use;
+                    break;
+                }
+            }
+            if (analysis->positions.uses.innermost(offset) != want_use)
+            {
+                fail("position index finds the wrong name use at offset " +
+                     std::to_string(offset));
+            }
+        }
+    }
+
+    {
+        // The verification worker publishes contract failures with the version they belong to.
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::string> published;
+        {
+            VerificationWorker worker(
+                std::chrono::milliseconds(0),
+                [&](const VerificationJob& job, const std::vector<curlee::diag::Diagnostic>& diags)
+                {
+                    const curlee::source::LineMap map(job.analysis->file.contents);
+                    const std::lock_guard lock(mutex);
+                    published.push_back(
+                        publish_diagnostics_message(job.uri, job.version, diags, map));
+                    cv.notify_all();
+                });
+            worker.schedule(VerificationJob{
+                .uri = "file:///tmp/ensures.curlee",
+                .version = 7,
+                .analysis = analyze(curlee::source::SourceFile{
+                    .path = "/tmp/ensures.curlee",
+                    .contents = "fn main() -> Int [ ensures result == 0; ] { return 1; }"})});
+            std::unique_lock lock(mutex);
+            if (!cv.wait_for(lock, std::chrono::seconds(30), [&] { return !published.empty(); }))
+            {
+                fail("expected the verification worker to publish");
+            }
+        }
+        if (published.size() != 1 || published[0].find("\"version\":7") == std::string::npos ||
+            published[0].find("ensures clause not satisfied") == std::string::npos)
+        {
+            fail("expected verification diagnostics for version 7");
+        }
+    }
+
+    {
+        // A newer version supersedes a pending one, and forget() drops pending work.
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::optional<std::int64_t>> published;
+        {
+            VerificationWorker worker(
+                std::chrono::milliseconds(200),
+                [&](const VerificationJob& job, const std::vector<curlee::diag::Diagnostic>&)
+                {
+                    const std::lock_guard lock(mutex);
+                    published.push_back(job.version);
+                    cv.notify_all();
+                });
+            const auto analysis = analyze(curlee::source::SourceFile{
+                .path = "/tmp/a.curlee",
+                .contents = "fn main() -> Int [ ensures result == 1; ] { return 1; }"});
+            worker.schedule(VerificationJob{
+                .uri = "file:///tmp/a.curlee", .version = 1, .analysis = analysis});
+            worker.schedule(VerificationJob{
+                .uri = "file:///tmp/a.curlee", .version = 2, .analysis = analysis});
+            worker.schedule(VerificationJob{
+                .uri = "file:///tmp/b.curlee", .version = 1, .analysis = analysis});
+            worker.forget("file:///tmp/b.curlee");
+            std::unique_lock lock(mutex);
+            if (!cv.wait_for(lock, std::chrono::seconds(30), [&] { return !published.empty(); }))
+            {
+                fail("expected the verification worker to publish the latest version");
+            }
+        }
+        // The worker has stopped, so nothing else can be published: neither the superseded
+        // version nor the forgotten document.
+        if (published.size() != 1 || published[0] != std::optional<std::int64_t>(2))
+        {
+            fail("expected only the latest version to be verified");
+        }
+    }
+
+    {
+        // An analysis owns the text its AST points into, so it outlives the document buffer.
+        auto text = std::make_unique<std::string>("fn answer() -> Int { return 42; }");
+        const auto analysis =
+            analyze(curlee::source::SourceFile{.path = "/tmp/answer.curlee", .contents = *text});
+        text.reset();
+        if (analysis == nullptr || analysis->program.functions.size() != 1 ||
+            analysis->program.functions[0].name != "answer")
+        {
+            fail("expected the analysis to keep its own copy of the source");
+        }
+        const auto& contents = analysis->file.contents;
+        const auto name = analysis->program.functions[0].name;
+        if (name.data() < contents.data() || name.data() >= contents.data() + contents.size())
+        {
+            fail("expected the AST to point into the analysis' source");
+        }
     }
 
     std::cout << "OK\n";
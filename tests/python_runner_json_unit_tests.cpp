@@ -33,7 +33,9 @@ static MainResult run_runner_main_with_io(const std::string& stdin_text)
 
     auto* old_in = std::cin.rdbuf(in.rdbuf());
     auto* old_out = std::cout.rdbuf(out.rdbuf());
-    const int rc = curlee_python_runner_main__do_not_call();
+    char arg0[] = "curlee_python_runner";
+    char* argv[] = {arg0, nullptr};
+    const int rc = curlee_python_runner_main__do_not_call(1, argv);
     std::cin.rdbuf(old_in);
     std::cout.rdbuf(old_out);
 
@@ -59,7 +59,8 @@ static void read_into(int fd, std::string& out, bool& eof)
     }
 }
 
-static ProcResult run_runner(const std::string& exe_path, const std::string& stdin_data)
+static ProcResult run_runner(const std::string& exe_path, const std::string& stdin_data,
+                             const std::vector<std::string>& args = {})
 {
     int in_pipe[2] = {-1, -1};
     int out_pipe[2] = {-1, -1};
@@ -89,6 +90,10 @@ static ProcResult run_runner(const std::string& exe_path, const std::string& std
 
         std::vector<char*> argv;
         argv.push_back(const_cast<char*>(exe_path.c_str()));
+        for (const auto& arg : args)
+        {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
         argv.push_back(nullptr);
 
         execv(exe_path.c_str(), argv.data());
@@ -662,6 +667,40 @@ int main(int argc, char** argv)
         }
     }
 
+    // --serve answers every line (errors included) until stdin closes, then exits 0.
+    {
+        const auto res = run_runner(
+            runner,
+            "{\"protocol_version\":1,\"id\":\"s1\",\"op\":\"handshake\"}\n"
+            "not json\n"
+            "{\"protocol_version\":1,\"id\":\"s2\",\"op\":\"echo\",\"echo\":{\"value\":\"x\"}}\n",
+            {"--serve"});
+        if (res.exit_code != 0)
+        {
+            fail("expected serve mode to exit 0 at end of input");
+        }
+        const std::string expected =
+            "{\"id\":\"s1\",\"ok\":true,\"protocol_version\":1,\"result\":{\"type\":\"string\","
+            "\"value\":\"ok\"}}\n"
+            "{\"error\":{\"kind\":\"invalid_request\",\"message\":\"malformed "
+            "json\",\"retryable\":false},\"id\":\"\",\"ok\":false,\"protocol_version\":1}\n"
+            "{\"id\":\"s2\",\"ok\":true,\"protocol_version\":1,\"result\":{\"type\":\"string\","
+            "\"value\":\"x\"}}\n";
+        if (res.out != expected)
+        {
+            fail("serve mode stdout mismatch");
+        }
+    }
+
+    // --serve with no input at all is a clean shutdown, not an error.
+    {
+        const auto res = run_runner(runner, "", {"--serve"});
+        if (res.exit_code != 0 || !res.out.empty())
+        {
+            fail("expected serve mode with empty input to exit 0 silently");
+        }
+    }
+
     std::cout << "OK\n";
     return 0;
 }
@@ -0,0 +1,132 @@
+#include <cstdlib>
+#include <curlee/source/line_map.h>
+#include <curlee/source/rope.h>
+#include <iostream>
+#include <random>
+#include <string>
+
+static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+static void expect_eq(std::size_t got, std::size_t expected, const std::string& what)
+{
+    if (got != expected)
+    {
+        fail(what + ": got=" + std::to_string(got) + " expected=" + std::to_string(expected));
+    }
+}
+
+// Every query must answer as a LineMap over the same text would.
+static void expect_matches(const curlee::source::Rope& rope, const std::string& text,
+                           const std::string& what)
+{
+    if (rope.str() != text)
+    {
+        fail(what + ": text differs");
+    }
+    expect_eq(rope.size(), text.size(), what + ": size");
+
+    const curlee::source::LineMap map(text);
+    expect_eq(rope.line_count(), map.line_count(), what + ": line_count");
+    for (std::size_t line = 0; line <= map.line_count() + 1; ++line)
+    {
+        expect_eq(rope.line_start_offset(line), map.line_start_offset(line),
+                  what + ": line_start_offset(" + std::to_string(line) + ")");
+    }
+    for (std::size_t offset = 0; offset <= text.size() + 1; ++offset)
+    {
+        const auto got = rope.offset_to_line_col(offset);
+        const auto expected = map.offset_to_line_col(offset);
+        expect_eq(got.line, expected.line, what + ": line at " + std::to_string(offset));
+        expect_eq(got.col, expected.col, what + ": col at " + std::to_string(offset));
+    }
+}
+
+int main()
+{
+    {
+        const curlee::source::Rope empty;
+        expect_matches(empty, "", "empty");
+        expect_matches(curlee::source::Rope("a\nbc\ndef"), "a\nbc\ndef", "small");
+    }
+
+    {
+        // Edits at the start, middle and end, and offsets past the end.
+        std::string text = "fn main() -> Int {\n  return 0;\n}\n";
+        curlee::source::Rope rope(text);
+
+        rope.replace(29, 30, "42");
+        text.replace(29, 1, "42");
+        expect_matches(rope, text, "replace in the middle");
+
+        rope.replace(0, 0, "// hi\n");
+        text.insert(0, "// hi\n");
+        expect_matches(rope, text, "insert at the start");
+
+        rope.replace(text.size(), text.size() + 10, "\n\n");
+        text += "\n\n";
+        expect_matches(rope, text, "append");
+
+        rope.replace(0, text.size() + 99, "");
+        expect_matches(rope, "", "delete everything");
+
+        rope.replace(5, 7, "x\ny");
+        expect_matches(rope, "x\ny", "insert into an empty rope");
+    }
+
+    {
+        // Random edits over a text spanning many chunks, including pastes larger than a chunk.
+        std::mt19937 rng(20240611);
+        const auto random_text = [&](std::size_t length)
+        {
+            static constexpr std::string_view kAlphabet = "ab c\n{}\n";
+            std::string out;
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                out.push_back(kAlphabet[rng() % kAlphabet.size()]);
+            }
+            return out;
+        };
+
+        std::string text = random_text(5000);
+        curlee::source::Rope rope(text);
+        expect_matches(rope, text, "initial");
+        for (int round = 0; round < 300; ++round)
+        {
+            const std::size_t start = text.empty() ? 0 : rng() % (text.size() + 1);
+            const std::size_t length = rng() % 4 == 0 ? rng() % 3000 : rng() % 8;
+            const std::size_t end = std::min(text.size(), start + length);
+            const std::string inserted = random_text(rng() % 5 == 0 ? rng() % 2500 : rng() % 4);
+            rope.replace(start, end, inserted);
+            text.replace(start, end - start, inserted);
+            if (round % 25 == 0)
+            {
+                expect_matches(rope, text, "round " + std::to_string(round));
+            }
+            else if (rope.str() != text)
+            {
+                fail("text differs after round " + std::to_string(round));
+            }
+        }
+        expect_matches(rope, text, "final");
+    }
+
+    {
+        // utf16_offset counts LSP columns: "é" is two bytes but one unit, "😀" four bytes and two.
+        const curlee::source::Rope rope("a\xC3\xA9" "b\n\xF0\x9F\x98\x80" "c\nz");
+        expect_eq(rope.utf16_offset(1, 0), 0, "utf16: start of line");
+        expect_eq(rope.utf16_offset(1, 2), 3, "utf16: after two-byte character");
+        expect_eq(rope.utf16_offset(1, 3), 4, "utf16: before newline");
+        expect_eq(rope.utf16_offset(1, 9), 4, "utf16: clamps to line end");
+        expect_eq(rope.utf16_offset(2, 1), 5, "utf16: inside surrogate pair");
+        expect_eq(rope.utf16_offset(2, 2), 9, "utf16: after surrogate pair");
+        expect_eq(rope.utf16_offset(3, 1), 12, "utf16: last line");
+        expect_eq(rope.utf16_offset(4, 0), 12, "utf16: past the last line");
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <cstdlib>
+#include <curlee/verification/certificate.h>
+#include <iostream>
+#include <string>
+
+static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+int main()
+{
+    using curlee::verification::decode_certificate;
+    using curlee::verification::encode_certificate;
+    using curlee::verification::ObligationHint;
+    using curlee::verification::ProofCertificate;
+    using Kind = ObligationHint::Kind;
+
+    // Round trip, including functions without obligations and empty cores.
+    {
+        ProofCertificate certificate;
+        certificate.functions["00000000000000aa"] = {
+            {.kind = Kind::Presolved, .core = {}},
+            {.kind = Kind::Core, .core = {0, 3, 12}},
+            {.kind = Kind::Unproven, .core = {}},
+            {.kind = Kind::Core, .core = {}},
+        };
+        certificate.functions["00000000000000bb"] = {};
+
+        const std::string text = encode_certificate(certificate);
+        if (text != "curlee-proof-1 00000000000000aa=p,c0.3.12,u,c 00000000000000bb=")
+        {
+            fail("unexpected encoding: " + text);
+        }
+
+        const auto decoded = decode_certificate(text);
+        if (!decoded.has_value() || decoded->functions.size() != 2)
+        {
+            fail("expected the certificate to decode");
+        }
+        const auto& hints = decoded->functions.at("00000000000000aa");
+        if (hints.size() != 4 || hints[0].kind != Kind::Presolved || hints[1].kind != Kind::Core ||
+            hints[1].core != std::vector<std::size_t>{0, 3, 12} || hints[2].kind != Kind::Unproven ||
+            hints[3].kind != Kind::Core || !hints[3].core.empty())
+        {
+            fail("expected hints to round-trip");
+        }
+        if (!decoded->functions.at("00000000000000bb").empty())
+        {
+            fail("expected a function without obligations to round-trip");
+        }
+    }
+
+    // Anything else, such as an opaque proof string, is not a certificate.
+    for (const std::string text : {"", "proof-v1", "curlee-proof-1 =p", "curlee-proof-1 f=x",
+                                   "curlee-proof-1 f=c1.", "curlee-proof-1 f=c-1", "curlee-proof-1 f"})
+    {
+        if (decode_certificate(text).has_value())
+        {
+            fail("expected '" + text + "' to be rejected");
+        }
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cstdlib>
 #include <curlee/diag/diagnostic.h>
 #include <curlee/lexer/lexer.h>
@@ -49,6 +50,16 @@ verify_program(std::string_view source, const std::string& what)
     return curlee::verification::verify(program, type_info);
 }
 
+static std::size_t proven_arithmetic_count(std::string_view source, const std::string& what)
+{
+    const auto verified = verify_program(source, what);
+    if (!std::holds_alternative<curlee::verification::Verified>(verified))
+    {
+        fail("expected verification to succeed for " + what);
+    }
+    return std::get<curlee::verification::Verified>(verified).proven_arithmetic.size();
+}
+
 static bool has_message_substr(const std::vector<curlee::diag::Diagnostic>& diags,
                                std::string_view needle)
 {
@@ -785,6 +796,744 @@ int main()
         }
     }
 
+    {
+        // Arithmetic safety: literal arithmetic is proven, unconstrained parameters are not.
+        struct Case
+        {
+            const char* what;
+            const char* source;
+            std::size_t proven;
+        };
+        const Case cases[] = {
+            {"literal sum", "fn main() -> Int { return 1 + 2 * 3; }\n", 2},
+            {"literal divide by zero", "fn main() -> Int { return 1 / 0; }\n", 0},
+            {"unguarded increment",
+             "fn inc(x: Int) -> Int { return x + 1; }\n"
+             "fn main() -> Int { return inc(1); }\n",
+             0},
+            {"guarded increment",
+             "fn inc(x: Int) -> Int {\n"
+             "  if (x < 100) { return x + 1; } else { return 0 - x; }\n"
+             "}\n"
+             "fn main() -> Int { return inc(1); }\n",
+             2},
+            {"while condition guard",
+             "fn f(x: Int) -> Int {\n"
+             "  while (x > 0) { return x - 1; }\n"
+             "  return x;\n"
+             "}\n"
+             "fn main() -> Int { return f(3); }\n",
+             1},
+            {"short-circuit guard",
+             "fn f(x: Int) -> Bool { return x != 0 && 10 / x > 1; }\n"
+             "fn main() -> Int { if (f(2)) { return 1; } return 0; }\n",
+             1},
+            {"guarded negation and product",
+             "fn f(x: Int) -> Int {\n"
+             "  if (x > 0 && x < 1000) { return -x * 2; }\n"
+             "  return -x;\n"
+             "}\n"
+             "fn main() -> Int { return f(3); }\n",
+             2},
+            {"requires of a verified program",
+             "fn div(n: Int, d: Int) -> Int [ requires d > 0; ] { return n / d; }\n"
+             "fn main() -> Int { return div(7, 2); }\n",
+             1},
+            {"requires of main",
+             "fn main() -> Int [ requires 1 > 2; ] {\n"
+             "  let x: Int = 5;\n"
+             "  return x + 1;\n"
+             "}\n",
+             0},
+            {"let refinements are assumptions",
+             "fn main() -> Int {\n"
+             "  let d: Int where d != 0 = 0;\n"
+             "  return 10 / d;\n"
+             "}\n",
+             0},
+        };
+        for (const auto& c : cases)
+        {
+            const auto proven = proven_arithmetic_count(c.source, c.what);
+            if (proven != c.proven)
+            {
+                fail(std::string("expected ") + std::to_string(c.proven) +
+                     " proven arithmetic site(s) for " + c.what + ", got " +
+                     std::to_string(proven));
+            }
+        }
+    }
+
+    {
+        // Parallel verification: every job count yields the same diagnostics, in the same order.
+        const std::string source = "fn pos(x: Int) -> Int [\n"
+                                   "  requires x > 0;\n"
+                                   "  ensures result > 1;\n"
+                                   "] {\n"
+                                   "  return x;\n"
+                                   "}\n"
+                                   "fn neg(x: Int) -> Int [ ensures result < 0; ] {\n"
+                                   "  return x + 1;\n"
+                                   "}\n"
+                                   "fn inc(x: Int) -> Int [ requires x < 100; ] {\n"
+                                   "  return x + 1;\n"
+                                   "}\n"
+                                   "fn main() -> Int {\n"
+                                   "  return pos(0) + inc(200) + neg(1);\n"
+                                   "}\n";
+        auto program = parse_program_or_fail(source, "parallel verification test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for parallel verification test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+        auto render = [&](std::size_t jobs)
+        {
+            const auto verified = curlee::verification::verify(
+                program, type_info, curlee::verification::VerifyOptions{.jobs = jobs});
+            if (!std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(verified))
+            {
+                fail("expected parallel verification test to fail verification");
+            }
+            std::string out;
+            for (const auto& d : std::get<std::vector<curlee::diag::Diagnostic>>(verified))
+            {
+                out += d.message + "@" + std::to_string(d.span.has_value() ? d.span->start : 0);
+                for (const auto& note : d.notes)
+                {
+                    out += "|" + note.message;
+                }
+                out += "\n";
+            }
+            return out;
+        };
+
+        const auto serial = render(1);
+        if (serial.find("requires clause not satisfied") == std::string::npos ||
+            serial.find("ensures clause not satisfied") == std::string::npos)
+        {
+            fail("expected requires and ensures failures in parallel verification test");
+        }
+        for (const std::size_t jobs : {std::size_t{2}, std::size_t{4}, std::size_t{0}})
+        {
+            if (render(jobs) != serial)
+            {
+                fail("expected -j " + std::to_string(jobs) + " diagnostics to match serial");
+            }
+        }
+    }
+
+    {
+        // Solver budgets: an obligation that runs out of budget gets its own diagnostic.
+        const std::string source = "fn inc(x: Int where x > 0) -> Int [ ensures result > 1; ] {\n"
+                                   "  return x + 1;\n"
+                                   "}\n";
+        auto program = parse_program_or_fail(source, "solver budget test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for solver budget test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+        // This obligation is trivial, so keep the presolver from settling it before Z3.
+        curlee::verification::VerifyOptions options;
+        options.presolve = false;
+        options.solver.rlimit = 1;
+        const auto starved = curlee::verification::verify(program, type_info, options);
+        if (!std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(starved))
+        {
+            fail("expected verification to fail under a tiny rlimit");
+        }
+        const auto& diags = std::get<std::vector<curlee::diag::Diagnostic>>(starved);
+        if (!has_message_substr(diags, "ensures clause not satisfied (solver budget exhausted)") ||
+            !any_note_has_substr(diags, "--solver-rlimit"))
+        {
+            fail("expected a solver budget exhausted diagnostic");
+        }
+
+        options.solver = curlee::verification::SolverOptions{
+            .timeout_ms = 10000, .rlimit = 0, .portfolio = true};
+        if (!std::holds_alternative<curlee::verification::Verified>(
+                curlee::verification::verify(program, type_info, options)))
+        {
+            fail("expected portfolio verification with a generous budget to succeed");
+        }
+    }
+
+    {
+        // Presolver: trivial obligations never reach Z3, and the verdict does not change.
+        const std::string source =
+            "fn pos(x: Int where x > 0) -> Int [ ensures result > 1; ] {\n"
+            "  return x + 1;\n"
+            "}\n"
+            "fn dec(x: Int) -> Int [ requires x > 0 && x < 100; ensures result >= 0; ] {\n"
+            "  if (x < 100) {\n"
+            "    return x - 1;\n"
+            "  }\n"
+            "  return 0;\n"
+            "}\n"
+            "fn main() -> Int {\n"
+            "  return pos(3) + dec(10);\n"
+            "}\n";
+        auto program = parse_program_or_fail(source, "presolver test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for presolver test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+        curlee::verification::VerificationStats with;
+        curlee::verification::VerificationStats without;
+        const auto presolved = curlee::verification::verify(
+            program, type_info, curlee::verification::VerifyOptions{.stats = &with});
+        const auto solved = curlee::verification::verify(
+            program, type_info,
+            curlee::verification::VerifyOptions{.presolve = false, .stats = &without});
+        if (!std::holds_alternative<curlee::verification::Verified>(presolved) ||
+            !std::holds_alternative<curlee::verification::Verified>(solved))
+        {
+            fail("expected presolver test to verify with and without the presolver");
+        }
+        if (std::get<curlee::verification::Verified>(presolved).proven_arithmetic !=
+            std::get<curlee::verification::Verified>(solved).proven_arithmetic)
+        {
+            fail("expected the presolver to prove the same arithmetic sites as Z3");
+        }
+        if (with.presolved + with.solver != without.presolved + without.solver ||
+            with.solver >= without.solver || with.presolved <= without.presolved)
+        {
+            fail("expected the presolver to settle obligations that otherwise reach Z3");
+        }
+    }
+
+    {
+        // Fact slicing: facts that share no variables with a goal are not asserted, but a
+        // contradiction among them (dead code) still discharges it, and a real failure still
+        // reports a model for the goal's variables.
+        const std::string source = "fn need_pos(x: Int) -> Int [ requires x > 0; ] {\n"
+                                   "  return x;\n"
+                                   "}\n"
+                                   "fn dead(y: Int, z: Int where z > 0 - 100) -> Int {\n"
+                                   "  if (y > 5) {\n"
+                                   "    if (y < 3) {\n"
+                                   "      return need_pos(z);\n"
+                                   "    }\n"
+                                   "  }\n"
+                                   "  return need_pos(1);\n"
+                                   "}\n";
+        if (!std::holds_alternative<curlee::verification::Verified>(
+                verify_program(source, "fact slicing dead code test")))
+        {
+            fail("expected contradictory facts outside the cone to discharge the goal");
+        }
+
+        const std::string failing = "fn need_pos(x: Int) -> Int [ requires x > 0; ] {\n"
+                                    "  return x;\n"
+                                    "}\n"
+                                    "fn live(y: Int where y > 5, z: Int where z > 0 - 100) -> "
+                                    "Int {\n"
+                                    "  return need_pos(z);\n"
+                                    "}\n";
+        const auto res = verify_program(failing, "fact slicing failure test");
+        if (!std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(res))
+        {
+            fail("expected the live call to fail verification");
+        }
+        const auto& diags = std::get<std::vector<curlee::diag::Diagnostic>>(res);
+        if (!has_message_substr(diags, "requires clause not satisfied") ||
+            !any_note_has_prefix(diags, "model:\nneed_pos::x = "))
+        {
+            fail("expected a model note for the callee parameter");
+        }
+    }
+
+    {
+        // Obligation cache: a second run answers every Z3 query from the cache and reports the
+        // same diagnostics, model note included.
+        const std::string source = "fn need_pos(x: Int) -> Int [ requires x > 0; ] {\n"
+                                   "  return x;\n"
+                                   "}\n"
+                                   "fn caller(y: Int where y > 0 - 5) -> Int {\n"
+                                   "  let z: Int = y + 1;\n"
+                                   "  return need_pos(y);\n"
+                                   "}\n";
+        auto program = parse_program_or_fail(source, "obligation cache test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for obligation cache test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+        curlee::verification::ObligationCache cache;
+        curlee::verification::VerificationStats cold;
+        curlee::verification::VerificationStats warm;
+        const auto first = curlee::verification::verify(
+            program, type_info,
+            curlee::verification::VerifyOptions{.presolve = false, .stats = &cold, .cache = &cache});
+        const auto second = curlee::verification::verify(
+            program, type_info,
+            curlee::verification::VerifyOptions{.presolve = false, .stats = &warm, .cache = &cache});
+        if (!std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(first) ||
+            !std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(second))
+        {
+            fail("expected the obligation cache test to fail verification");
+        }
+        const auto& cold_diags = std::get<std::vector<curlee::diag::Diagnostic>>(first);
+        const auto& warm_diags = std::get<std::vector<curlee::diag::Diagnostic>>(second);
+        if (cold_diags.size() != warm_diags.size() || cold_diags.empty() ||
+            cold_diags[0].notes.size() != warm_diags[0].notes.size())
+        {
+            fail("expected cached verdicts to reproduce the diagnostics");
+        }
+        for (std::size_t i = 0; i < cold_diags[0].notes.size(); ++i)
+        {
+            if (cold_diags[0].notes[i].message != warm_diags[0].notes[i].message)
+            {
+                fail("expected cached verdicts to reproduce the notes");
+            }
+        }
+        if (!any_note_has_prefix(warm_diags, "model:\nneed_pos::x = ") || cold.solver == 0 ||
+            cold.cached != 0 || warm.solver != 0 || warm.cached != cold.solver)
+        {
+            fail("expected the second run to be answered from the cache");
+        }
+    }
+
+    {
+        // Verification session: only functions whose body, own contract or callee contracts
+        // changed are verified again, and reused proofs follow their expressions' new ids.
+        auto verify_in = [](curlee::verification::VerificationSession& session,
+                            const std::string& source, curlee::verification::VerificationStats& stats)
+        {
+            auto program = parse_program_or_fail(source, "session test");
+            const auto typed = curlee::types::type_check(program);
+            if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+            {
+                fail("expected type checking to succeed for session test");
+            }
+            const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+            const auto with_session = curlee::verification::verify(
+                program, type_info,
+                curlee::verification::VerifyOptions{.stats = &stats, .session = &session});
+            const auto fresh = curlee::verification::verify(program, type_info);
+            if (!std::holds_alternative<curlee::verification::Verified>(with_session) ||
+                !std::holds_alternative<curlee::verification::Verified>(fresh) ||
+                std::get<curlee::verification::Verified>(with_session).proven_arithmetic !=
+                    std::get<curlee::verification::Verified>(fresh).proven_arithmetic)
+            {
+                fail("expected the session to prove exactly what a fresh verification proves");
+            }
+        };
+        const std::string dec = "fn dec(x: Int where x > 0) -> Int [ requires x < 100; ] {\n"
+                                "  return x - 1;\n"
+                                "}\n";
+        const std::string user = "fn user() -> Int {\n"
+                                 "  return dec(5) + 1;\n"
+                                 "}\n";
+        const std::string other = "fn other(y: Int where y < 10) -> Int {\n"
+                                  "  return y + 2;\n"
+                                  "}\n";
+
+        curlee::verification::VerificationSession session;
+        curlee::verification::VerificationStats stats;
+        verify_in(session, dec + user + other, stats);
+        if (stats.reused != 0)
+        {
+            fail("expected a cold session to verify every function");
+        }
+
+        // Editing dec's body shifts the ids of everything after it, but nothing else changed.
+        verify_in(session,
+                  "fn dec(x: Int where x > 0) -> Int [ requires x < 100; ] {\n"
+                  "  let y: Int = x - 1;\n"
+                  "  return y;\n"
+                  "}\n" +
+                      user + other,
+                  stats);
+        if (stats.reused != 2)
+        {
+            fail("expected a body edit to re-verify only the edited function");
+        }
+
+        // Changing dec's contract re-verifies its caller too.
+        verify_in(session,
+                  "fn dec(x: Int where x > 0) -> Int [ requires x < 50; ] {\n"
+                  "  let y: Int = x - 1;\n"
+                  "  return y;\n"
+                  "}\n" +
+                      user + other,
+                  stats);
+        if (stats.reused != 1)
+        {
+            fail("expected a contract edit to re-verify the function and its callers");
+        }
+    }
+
+    {
+        // Join points: code after an early return is checked under the merged fall-through
+        // condition, once, however many paths lead to it.
+        const auto early = verify_program("fn pos(x: Int) -> Int [ ensures result > 0; ] {\n"
+                                          "  if (x < 1) {\n"
+                                          "    return 1;\n"
+                                          "  }\n"
+                                          "  if (x == 5) {\n"
+                                          "    if (x > 100) { return 7; }\n"
+                                          "  } else {\n"
+                                          "    let y: Int = 2;\n"
+                                          "  }\n"
+                                          "  return x;\n"
+                                          "}\n",
+                                          "early return");
+        if (!std::holds_alternative<curlee::verification::Verified>(early))
+        {
+            fail("expected the fall-through guard to prove the final ensures");
+        }
+
+        // A condition over a branch-local name is dropped at the join, since a later `let` of
+        // the same name would otherwise inherit it.
+        const auto shadowed = verify_program("fn f(c: Bool) -> Int [ ensures result < 5; ] {\n"
+                                             "  if (c) {\n"
+                                             "    let y: Int where y > 0 = 1;\n"
+                                             "    if (y > 4) { return 0; }\n"
+                                             "  } else {\n"
+                                             "    return 0;\n"
+                                             "  }\n"
+                                             "  let y: Int = 10;\n"
+                                             "  return y;\n"
+                                             "}\n",
+                                             "branch-local condition");
+        if (!std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(shadowed))
+        {
+            fail("expected a branch-local condition not to leak past its block");
+        }
+
+        // 2^n paths reach the final return, which is still a single obligation.
+        constexpr int kLinks = 16;
+        std::string chain = "fn chain(x: Int, y: Int) -> Int [ ensures result > 0; ] {\n";
+        for (int k = 1; k <= kLinks; ++k)
+        {
+            const std::string n = std::to_string(k);
+            chain += "  if (x < " + n + ") { return " + n + "; } else {\n" +
+                     "    if (y < " + n + ") { let a: Int = " + n + "; } else { let b: Int = 0; }\n" +
+                     "  }\n";
+        }
+        chain += "  return x;\n}\n";
+        auto program = parse_program_or_fail(chain, "chained ifs");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for chained ifs");
+        }
+        curlee::verification::VerificationStats stats;
+        const auto res =
+            curlee::verification::verify(program, std::get<curlee::types::TypeInfo>(typed),
+                                         curlee::verification::VerifyOptions{.stats = &stats});
+        if (!std::holds_alternative<curlee::verification::Verified>(res) ||
+            stats.presolved + stats.solver != kLinks + 1)
+        {
+            fail("expected one ensures obligation per return in the chain");
+        }
+    }
+
+    {
+        // Proof certificates: a recorded certificate settles every solver obligation from its
+        // core, and a wrong core only costs a full solve.
+        using curlee::verification::ObligationHint;
+        const std::string source = "fn dec(x: Int where x > 0) -> Int [ requires x < 100; ] {\n"
+                                   "  let y: Int = x - 1;\n"
+                                   "  return y;\n"
+                                   "}\n"
+                                   "fn user(z: Int where z > 3) -> Int [ ensures result > 0; ] {\n"
+                                   "  if (z < 50) {\n"
+                                   "    let w: Int = dec(z);\n"
+                                   "    return z + 1;\n"
+                                   "  }\n"
+                                   "  return z;\n"
+                                   "}\n";
+        auto program = parse_program_or_fail(source, "certificate test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for certificate test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+        auto verify_with = [&](const curlee::verification::ProofCertificate* certificate,
+                               curlee::verification::ProofCertificate* record,
+                               curlee::verification::VerificationStats& stats)
+        {
+            curlee::verification::VerifyOptions options;
+            options.presolve = false;
+            options.stats = &stats;
+            options.certificate = certificate;
+            options.record_certificate = record;
+            const auto res = curlee::verification::verify(program, type_info, options);
+            if (!std::holds_alternative<curlee::verification::Verified>(res))
+            {
+                fail("expected the certificate test program to verify");
+            }
+            return std::get<curlee::verification::Verified>(res).proven_arithmetic;
+        };
+
+        curlee::verification::ProofCertificate certificate;
+        curlee::verification::VerificationStats producer;
+        const auto proven = verify_with(nullptr, &certificate, producer);
+        if (certificate.functions.size() != 2 || producer.solver == 0)
+        {
+            fail("expected a certificate entry for every function");
+        }
+
+        curlee::verification::VerificationStats receiver;
+        if (verify_with(&certificate, nullptr, receiver) != proven)
+        {
+            fail("expected the receiver to prove what the producer proved");
+        }
+        // Sites the producer left unproven keep their runtime checks without a second search.
+        std::size_t cores = 0;
+        std::size_t unproven = 0;
+        for (const auto& [key, hints] : certificate.functions)
+        {
+            for (const auto& hint : hints)
+            {
+                cores += hint.kind == ObligationHint::Kind::Core ? 1 : 0;
+                unproven += hint.kind == ObligationHint::Kind::Unproven ? 1 : 0;
+            }
+        }
+        if (cores == 0 || receiver.certified != cores ||
+            receiver.solver != producer.solver - cores - unproven)
+        {
+            fail("expected every core to be certified without a full solve");
+        }
+
+        // Point every core past the facts in scope: each obligation is solved as usual.
+        auto broken = certificate;
+        for (auto& [key, hints] : broken.functions)
+        {
+            for (auto& hint : hints)
+            {
+                if (hint.kind == ObligationHint::Kind::Core)
+                {
+                    hint.core = {1000};
+                }
+            }
+        }
+        curlee::verification::VerificationStats fallback;
+        if (verify_with(&broken, nullptr, fallback) != proven || fallback.certified != 0 ||
+            fallback.solver != producer.solver - unproven)
+        {
+            fail("expected a broken certificate to fall back to a full solve");
+        }
+    }
+
+    {
+        // Int theories: bit-vectors and auto bound every variable like the VM's int64 and
+        // accept products of two variables.
+        using curlee::verification::IntTheory;
+        const std::string source =
+            "fn id(x: Int) -> Int [ ensures result <= 9223372036854775807; ] {\n"
+            "  return x;\n"
+            "}\n"
+            "fn square(x: Int) -> Int [ requires x > 0 && x < 1000; ensures result > 0; ] {\n"
+            "  return x * x;\n"
+            "}\n"
+            "fn dec(x: Int) -> Int [ requires x > 0; ensures result >= 0; ] {\n"
+            "  return x - 1;\n"
+            "}\n";
+        auto program = parse_program_or_fail(source, "int theory test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for int theory test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+        curlee::verification::ObligationCache cache;
+        auto verify_under = [&](IntTheory theory)
+        {
+            curlee::verification::VerifyOptions options;
+            options.presolve = false;
+            options.cache = &cache;
+            options.solver.theory = theory;
+            return curlee::verification::verify(program, type_info, options);
+        };
+
+        // Integers reject the product and cannot bound `x`; the cached verdicts must not leak
+        // into the runs below.
+        const auto integer = verify_under(IntTheory::Integer);
+        if (!std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(integer))
+        {
+            fail("expected integer verification of the int theory test to fail");
+        }
+        const auto& integer_diags = std::get<std::vector<curlee::diag::Diagnostic>>(integer);
+        if (integer_diags.size() != 2 ||
+            !has_message_substr(integer_diags, "non-linear multiplication is not supported") ||
+            !has_message_substr(integer_diags, "ensures clause not satisfied"))
+        {
+            fail("expected the product and the int64 bound to fail over the integers");
+        }
+
+        const auto bit_vector = verify_under(IntTheory::BitVector);
+        if (!std::holds_alternative<curlee::verification::Verified>(bit_vector))
+        {
+            fail("expected bit-vector verification of the int theory test to succeed");
+        }
+        // x < 1000, so x * x cannot overflow.
+        if (std::get<curlee::verification::Verified>(bit_vector).proven_arithmetic.size() != 2)
+        {
+            fail("expected the product and the decrement to be proven safe");
+        }
+
+        // Auto proves the same goals; the bound comes from the cache shared with bit-vectors.
+        curlee::verification::VerificationStats stats;
+        curlee::verification::VerifyOptions options;
+        options.presolve = false;
+        options.cache = &cache;
+        options.stats = &stats;
+        options.solver.theory = IntTheory::Auto;
+        const auto automatic = curlee::verification::verify(program, type_info, options);
+        if (!std::holds_alternative<curlee::verification::Verified>(automatic) ||
+            std::get<curlee::verification::Verified>(automatic).proven_arithmetic.size() != 2 ||
+            stats.solver != 0 || stats.cached == 0)
+        {
+            fail("expected auto verification to reuse the bit-vector verdicts");
+        }
+    }
+
+    {
+        // Profiling records every obligation, in function order and independent of -j.
+        using curlee::verification::CheckResult;
+        using curlee::verification::ObligationKind;
+        using curlee::verification::ObligationProfile;
+        using curlee::verification::Settlement;
+        const std::string source =
+            "fn dec(x: Int) -> Int [ requires x > 0; ensures result >= 0; ] {\n"
+            "  return x - 1;\n"
+            "}\n"
+            "fn main() -> Int {\n"
+            "  return dec(0);\n"
+            "}\n";
+        auto program = parse_program_or_fail(source, "profile test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for profile test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+        auto profile_with = [&](std::size_t jobs)
+        {
+            std::vector<ObligationProfile> profile;
+            curlee::verification::VerifyOptions options;
+            options.jobs = jobs;
+            options.presolve = false;
+            options.profile = &profile;
+            (void)curlee::verification::verify(program, type_info, options);
+            return profile;
+        };
+
+        const auto profile = profile_with(1);
+        if (profile.size() != 3 || profile[0].function != "dec" ||
+            profile[0].kind != ObligationKind::Arithmetic || profile[1].function != "dec" ||
+            profile[1].kind != ObligationKind::Ensures || profile[2].function != "main" ||
+            profile[2].kind != ObligationKind::CallRequires)
+        {
+            fail("expected dec's arithmetic and ensures, then main's call precondition");
+        }
+        if (profile[1].verdict != CheckResult::Unsat ||
+            profile[1].settled_by != Settlement::Solver ||
+            profile[2].verdict != CheckResult::Sat ||
+            profile[2].settled_by != Settlement::Solver || profile[2].facts == 0)
+        {
+            fail("expected the ensures clause proven and the call precondition refuted by Z3");
+        }
+        // The call precondition is reported at the call, not at the callee's clause.
+        if (source.substr(profile[2].span.start, profile[2].span.end - profile[2].span.start) !=
+            "dec(0)")
+        {
+            fail("expected the call precondition to point at the call");
+        }
+
+        const auto parallel = profile_with(2);
+        if (parallel.size() != profile.size())
+        {
+            fail("expected the same obligations with two jobs");
+        }
+        for (std::size_t i = 0; i < profile.size(); ++i)
+        {
+            if (parallel[i].function != profile[i].function ||
+                parallel[i].kind != profile[i].kind || parallel[i].verdict != profile[i].verdict)
+            {
+                fail("expected obligations in the same order with two jobs");
+            }
+        }
+
+        auto where = [](const ObligationProfile& p) { return "at " + p.function; };
+        auto sorted = profile;
+        sorted[2].micros = 5000;
+        sorted[0].micros = 10;
+        const std::string table = curlee::verification::render_verification_profile(sorted, where);
+        if (table.find("verification: 3 obligations") == std::string::npos ||
+            table.find("solver 3") == std::string::npos ||
+            table.find("refuted") == std::string::npos ||
+            table.find("call-requires  main") == std::string::npos ||
+            table.find("at main") > table.find("at dec"))
+        {
+            fail("expected a summary and the slowest obligation first:\n" + table);
+        }
+        const std::string json = curlee::verification::verification_profile_json(sorted, where);
+        if (!json.starts_with("{\"total_micros\":") ||
+            json.find("[{\"function\":\"dec\",\"kind\":\"arithmetic\",\"location\":\"at dec\"") ==
+                std::string::npos ||
+            json.find("\"micros\":5000,\"settled_by\":\"solver\",\"verdict\":\"refuted\"") ==
+                std::string::npos ||
+            json.find("\"conflicts\":") == std::string::npos)
+        {
+            fail("expected JSON in verification order:\n" + json);
+        }
+    }
+
+    {
+        // Cancellation: a raised flag stops verification with a single diagnostic, and the
+        // session does not remember the functions it skipped.
+        const std::string source = "fn main() -> Int [ ensures result == 1; ] {\n"
+                                   "  return 1;\n"
+                                   "}\n";
+        auto program = parse_program_or_fail(source, "cancel test");
+        const auto typed = curlee::types::type_check(program);
+        if (std::holds_alternative<std::vector<curlee::diag::Diagnostic>>(typed))
+        {
+            fail("expected type checking to succeed for cancel test");
+        }
+        const auto& type_info = std::get<curlee::types::TypeInfo>(typed);
+
+        std::atomic<bool> cancel{true};
+        curlee::verification::VerificationSession session;
+        curlee::verification::VerificationStats stats;
+        curlee::verification::VerifyOptions options;
+        options.solver.cancel = &cancel;
+        options.session = &session;
+        const auto cancelled = curlee::verification::verify(program, type_info, options);
+        const auto* diags = std::get_if<std::vector<curlee::diag::Diagnostic>>(&cancelled);
+        if (diags == nullptr || diags->size() != 1 ||
+            (*diags)[0].message != "verification cancelled")
+        {
+            fail("expected a cancelled verification");
+        }
+
+        cancel = false;
+        options.stats = &stats;
+        if (!std::holds_alternative<curlee::verification::Verified>(
+                curlee::verification::verify(program, type_info, options)) ||
+            stats.reused != 0)
+        {
+            fail("expected the function to verify once the flag is lowered");
+        }
+    }
+
     std::cout << "OK\n";
     return 0;
 }
@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdlib>
+#include <curlee/verification/obligation_cache.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+int main()
+{
+    using curlee::verification::CheckResult;
+    using curlee::verification::normalize_query;
+    using curlee::verification::ObligationCache;
+    using curlee::verification::ObligationVerdict;
+
+    z3::context ctx;
+    const z3::expr x = ctx.int_const("x");
+    const z3::expr y = ctx.int_const("y");
+    const z3::expr a = ctx.int_const("f::a");
+    const z3::expr b = ctx.int_const("f::b");
+    const z3::expr flag = ctx.bool_const("flag");
+
+    // Queries that differ only in variable names normalize to the same text and key.
+    {
+        const auto q1 = normalize_query({x > 0, y == x + 1}, y > 1, {y});
+        const auto q2 = normalize_query({a > 0, b == a + 1}, b > 1, {b});
+        if (q1.text != q2.text || q1.key != q2.key || q1.key.size() != 64)
+        {
+            fail("expected alpha-equivalent queries to share a key; got\n" + q1.text + "\n" +
+                 q2.text);
+        }
+        // Renaming follows first occurrence, so swapping which variable is which matters.
+        const auto q3 = normalize_query({x > 0, y == x + 1}, x > 1, {x});
+        if (q3.text == q1.text)
+        {
+            fail("expected a different goal to change the query");
+        }
+        if (normalize_query({x > 0}, x > 1, {}).text == normalize_query({x > 0}, x > 1, {x}).text)
+        {
+            fail("expected model variables to be part of the query");
+        }
+        if (normalize_query({flag}, x > 0, {}).text.find("(declare-const v0 Bool)") ==
+            std::string::npos)
+        {
+            fail("expected declarations to carry sorts");
+        }
+    }
+
+    // In memory: verdicts round-trip and inconclusive answers are not stored.
+    {
+        ObligationCache cache;
+        const auto q = normalize_query({x > 0}, x > 1, {x});
+        if (cache.lookup(q).has_value())
+        {
+            fail("expected an empty cache to miss");
+        }
+        cache.store(q, ObligationVerdict{.result = CheckResult::Sat, .model_values = {"1"}});
+        const auto hit = cache.lookup(normalize_query({a > 0}, a > 1, {a}));
+        if (!hit.has_value() || hit->result != CheckResult::Sat || hit->model_values.size() != 1 ||
+            hit->model_values[0] != "1")
+        {
+            fail("expected the verdict to be found under a renamed query");
+        }
+
+        const auto unknown = normalize_query({x > 5}, x > 1, {});
+        cache.store(unknown, ObligationVerdict{.result = CheckResult::Unknown, .model_values = {}});
+        if (cache.lookup(unknown).has_value())
+        {
+            fail("expected unknown verdicts not to be cached");
+        }
+    }
+
+    // A capped cache forgets the least recently used verdict.
+    {
+        ObligationCache cache(std::size_t{2});
+        const auto q1 = normalize_query({x > 1}, x > 0, {});
+        const auto q2 = normalize_query({x > 2}, x > 0, {});
+        const auto q3 = normalize_query({x > 3}, x > 0, {});
+        const ObligationVerdict unsat{.result = CheckResult::Unsat, .model_values = {}};
+        cache.store(q1, unsat);
+        cache.store(q2, unsat);
+        (void)cache.lookup(q1);
+        cache.store(q3, unsat);
+        if (!cache.lookup(q1) || cache.lookup(q2) || !cache.lookup(q3))
+        {
+            fail("expected a capped cache to forget the least recently used verdict");
+        }
+    }
+
+    // On disk: verdicts survive the cache object, and entries must repeat their query.
+    {
+        const fs::path dir = fs::temp_directory_path() /
+                             ("curlee_verification_obligation_cache_tests." +
+                              std::to_string(::getpid()));
+        fs::remove_all(dir);
+
+        const auto q = normalize_query({x > 5}, x > 1, {});
+        {
+            ObligationCache cache(dir);
+            cache.store(q, ObligationVerdict{.result = CheckResult::Unsat, .model_values = {}});
+        }
+        {
+            // A disk hit also refreshes the entry's recency for the compile cache's eviction.
+            const fs::path entry = dir / (q.key + ".obligation");
+            const auto old = fs::file_time_type::clock::now() - std::chrono::hours(2);
+            fs::last_write_time(entry, old);
+            ObligationCache cache(dir);
+            const auto hit = cache.lookup(q);
+            if (!hit.has_value() || hit->result != CheckResult::Unsat)
+            {
+                fail("expected the verdict to persist on disk");
+            }
+            if (fs::last_write_time(entry) <= old)
+            {
+                fail("expected a disk hit to refresh the entry's modification time");
+            }
+        }
+
+        // A different query stored under the same file name (a hash collision) is a miss.
+        const auto other = normalize_query({x > 6}, x > 1, {});
+        fs::copy_file(dir / (q.key + ".obligation"), dir / (other.key + ".obligation"),
+                      fs::copy_options::overwrite_existing);
+        if (ObligationCache(dir).lookup(other).has_value())
+        {
+            fail("expected an entry for another query to miss");
+        }
+
+        {
+            std::ofstream out(dir / (q.key + ".obligation"), std::ios::trunc);
+            out << "curlee-obligation 1\nmaybe\n";
+        }
+        if (ObligationCache(dir).lookup(q).has_value())
+        {
+            fail("expected a corrupt entry to miss");
+        }
+
+        fs::remove_all(dir);
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
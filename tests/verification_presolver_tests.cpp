@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <cstdlib>
+#include <curlee/verification/presolver.h>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+static bool proves(const std::vector<z3::expr>& facts, const z3::expr& goal)
+{
+    curlee::verification::Presolver presolver;
+    for (const auto& fact : facts)
+    {
+        presolver.assume(fact);
+    }
+    return presolver.proves(goal);
+}
+
+int main()
+{
+    z3::context ctx;
+    const z3::expr x = ctx.int_const("x");
+    const z3::expr y = ctx.int_const("y");
+    const z3::expr result = ctx.int_const("result");
+    const z3::expr b = ctx.bool_const("b");
+
+    // Constant folding.
+    if (!proves({}, ctx.int_val(2) + ctx.int_val(3) == ctx.int_val(5)) ||
+        !proves({}, ctx.int_val(7) * ctx.int_val(6) > ctx.int_val(41)) ||
+        proves({}, ctx.int_val(1) > ctx.int_val(2)))
+    {
+        fail("expected constant goals to fold");
+    }
+
+    // Bounds from refinements, including strict and negated comparisons.
+    if (!proves({x > 0}, x >= 1) || !proves({x > 0}, x != 0) || !proves({!(x <= 5)}, x > 5) ||
+        !proves({x >= 0, x < 10}, x * 2 + 1 <= 19) || proves({x > 0}, x > 1))
+    {
+        fail("expected refinement bounds to discharge goals");
+    }
+
+    // Ensures clauses that restate the returned value.
+    if (!proves({x > 0, result == x + 1}, result > 1) ||
+        !proves({result == ctx.int_val(4)}, result == 4) || proves({result == x}, result > 0))
+    {
+        fail("expected return equalities to bound result");
+    }
+
+    // Common terms cancel without any bound on the variable.
+    if (!proves({}, x + 1 > x) || !proves({}, x - x == 0) || proves({}, x + y > x))
+    {
+        fail("expected linear normalization to cancel common terms");
+    }
+
+    // Syntactic implication: a goal that is (part of) a fact holds.
+    const z3::expr nonlinear = x * y > 3;
+    if (!proves({nonlinear && b}, nonlinear) || !proves({b}, b || nonlinear) ||
+        !proves({b == ctx.bool_val(true)}, b) || proves({}, nonlinear))
+    {
+        fail("expected facts to imply themselves and their consequences");
+    }
+
+    // Contradictory facts prove anything, just as Z3 would report unsat.
+    if (!proves({x > 5, x < 3}, ctx.bool_val(false)) || !proves({b, !b}, x == y))
+    {
+        fail("expected contradictory facts to prove any goal");
+    }
+
+    // Bounds near the int64 limits widen instead of wrapping.
+    {
+        const z3::expr in_range = x >= ctx.int_val(std::numeric_limits<std::int64_t>::min()) &&
+                                  x <= ctx.int_val(std::numeric_limits<std::int64_t>::max());
+        const z3::expr max = ctx.int_val(std::numeric_limits<std::int64_t>::max());
+        if (proves({in_range}, x + 1 <= max) || !proves({in_range, x < 100}, x + 1 <= max) ||
+            proves({in_range}, x * x >= 0 && x * x <= max))
+        {
+            fail("expected overflowing bounds to stay unsettled");
+        }
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <cstdlib>
+#include <curlee/verification/cache_file.h>
+#include <curlee/verification/session.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+int main()
+{
+    using curlee::verification::FunctionResult;
+    using curlee::verification::VerificationSession;
+
+    // In memory: one result per function, replaced when its fingerprint changes.
+    {
+        VerificationSession session;
+        session.store("f", "fn f v1", FunctionResult{.proven_arithmetic = {0, 3}});
+        const auto hit = session.lookup("f", "fn f v1");
+        if (!hit.has_value() || hit->proven_arithmetic != std::vector<std::size_t>{0, 3})
+        {
+            fail("expected a stored result to round-trip");
+        }
+        if (session.lookup("f", "fn f v2").has_value() || session.lookup("g", "fn f v1"))
+        {
+            fail("expected other fingerprints and functions to miss");
+        }
+        session.store("f", "fn f v2", FunctionResult{});
+        if (session.lookup("f", "fn f v1").has_value() || !session.lookup("f", "fn f v2"))
+        {
+            fail("expected a new fingerprint to replace the old result");
+        }
+    }
+
+    // A capped session forgets the least recently used function.
+    {
+        VerificationSession session(std::size_t{2});
+        session.store("f", "fn f", FunctionResult{});
+        session.store("g", "fn g", FunctionResult{});
+        (void)session.lookup("f", "fn f");
+        session.store("h", "fn h", FunctionResult{});
+        if (!session.lookup("f", "fn f") || session.lookup("g", "fn g") ||
+            !session.lookup("h", "fn h"))
+        {
+            fail("expected a capped session to forget the least recently used function");
+        }
+    }
+
+    // On disk: results outlive the session, and entries must repeat their fingerprint.
+    {
+        const fs::path dir = fs::temp_directory_path() /
+                             ("curlee_verification_session_tests." + std::to_string(::getpid()));
+        fs::remove_all(dir);
+
+        const std::string fingerprint = "fn f(x: Int) -> Int { return (x + 1); }\n";
+        {
+            VerificationSession session(dir);
+            session.store("f", fingerprint, FunctionResult{.proven_arithmetic = {1}});
+        }
+        {
+            VerificationSession session(dir);
+            const auto hit = session.lookup("f", fingerprint);
+            if (!hit.has_value() || hit->proven_arithmetic != std::vector<std::size_t>{1})
+            {
+                fail("expected the result to persist on disk");
+            }
+        }
+
+        // A different fingerprint stored under the same file name (a hash collision) is a miss.
+        const std::string other = "fn f(x: Int) -> Int { return (x + 2); }\n";
+        const fs::path entry = dir / (curlee::verification::sha256_hex(fingerprint) + ".function");
+        fs::copy_file(entry, dir / (curlee::verification::sha256_hex(other) + ".function"),
+                      fs::copy_options::overwrite_existing);
+        if (VerificationSession(dir).lookup("f", other).has_value())
+        {
+            fail("expected an entry for another fingerprint to miss");
+        }
+
+        {
+            std::ofstream out(entry, std::ios::trunc);
+            out << "curlee-function 1\nproven x\n" << fingerprint;
+        }
+        if (VerificationSession(dir).lookup("f", fingerprint).has_value())
+        {
+            fail("expected a corrupt entry to miss");
+        }
+
+        fs::remove_all(dir);
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -1,6 +1,12 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <curlee/verification/solver.h>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
 
 static void fail(const std::string& msg)
 {
@@ -123,6 +129,236 @@ int main()
         }
     }
 
+    // A resource limit turns a hard query into BudgetExceeded instead of running unbounded.
+    {
+        Solver solver(SolverOptions{.timeout_ms = 0, .rlimit = 1000, .portfolio = false});
+        auto& ctx = solver.context();
+        auto x = ctx.int_const("x");
+        auto y = ctx.int_const("y");
+        auto z = ctx.int_const("z");
+        solver.add(x > 0 && y > 0 && z > 0);
+        solver.add(x * x * x + y * y * y == z * z * z);
+
+        if (solver.check() != CheckResult::BudgetExceeded)
+        {
+            fail("expected rlimit to exhaust the budget");
+        }
+        if (solver.model_for({x}).has_value())
+        {
+            fail("expected no model after an exhausted budget");
+        }
+    }
+
+    // Portfolio: first definitive answer wins, and a sat model is usable from the caller's
+    // context.
+    {
+        Solver solver(SolverOptions{.timeout_ms = 0, .rlimit = 0, .portfolio = true});
+        auto& ctx = solver.context();
+        auto x = ctx.int_const("x");
+        solver.add(x > 5);
+        solver.add(x < 7);
+
+        if (solver.check() != CheckResult::Sat)
+        {
+            fail("expected portfolio to find satisfiable constraints");
+        }
+        const auto model = solver.model_for({x});
+        if (!model.has_value() || Solver::format_model(*model) != "x = 6")
+        {
+            fail("expected portfolio model x = 6");
+        }
+
+        solver.add(x > 6);
+        if (solver.check() != CheckResult::Unsat)
+        {
+            fail("expected portfolio to prove unsatisfiable constraints");
+        }
+    }
+
+    // Portfolio: when every strategy times out, the result is BudgetExceeded.
+    {
+        Solver solver(SolverOptions{.timeout_ms = 200, .rlimit = 0, .portfolio = true});
+        auto& ctx = solver.context();
+        auto x = ctx.int_const("x");
+        auto y = ctx.int_const("y");
+        auto z = ctx.int_const("z");
+        solver.add(x > 0 && y > 0 && z > 0);
+        solver.push();
+        solver.add(x * x * x + y * y * y == z * z * z);
+
+        if (solver.check() != CheckResult::BudgetExceeded)
+        {
+            fail("expected portfolio timeout to exhaust the budget");
+        }
+
+        // The lanes' contexts are kept for the next check, interrupted or not.
+        solver.pop();
+        if (solver.check() != CheckResult::Sat)
+        {
+            fail("expected a later portfolio check to reuse the interrupted lanes");
+        }
+    }
+
+    // last_statistics: the work of the last check only, on a solver that keeps its counters.
+    {
+        Solver solver;
+        auto& ctx = solver.context();
+        auto a = ctx.bool_const("a");
+        auto b = ctx.bool_const("b");
+        for (int round = 0; round < 2; ++round)
+        {
+            solver.push();
+            solver.add(a || b);
+            solver.add(a || !b);
+            solver.add(!a || b);
+            solver.add(!a || !b);
+            if (solver.check() != CheckResult::Unsat)
+            {
+                fail("expected the four clauses to be unsatisfiable");
+            }
+            const auto& statistics = solver.last_statistics();
+            if (statistics.conflicts == 0 || statistics.memory_mb <= 0)
+            {
+                fail("expected the refutation to report conflicts and memory");
+            }
+            solver.pop();
+        }
+    }
+
+    // cancel: raising the flag interrupts a check that would otherwise run unbounded, and
+    // later checks do not start.
+    {
+        std::atomic<bool> cancel{false};
+        Solver solver(SolverOptions{.cancel = &cancel});
+        auto& ctx = solver.context();
+        auto x = ctx.int_const("x");
+        auto y = ctx.int_const("y");
+        auto z = ctx.int_const("z");
+        solver.add(x > 0 && y > 0 && z > 0);
+        solver.add(x * x * x + y * y * y == z * z * z);
+
+        std::thread raiser(
+            [&cancel]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                cancel = true;
+            });
+        const auto interrupted = solver.check();
+        raiser.join();
+        if (interrupted != CheckResult::Unknown)
+        {
+            fail("expected a cancelled check to be unknown");
+        }
+        if (solver.check() != CheckResult::Unknown)
+        {
+            fail("expected no check to start once cancelled");
+        }
+    }
+
+    // minimal_core: Z3 may name redundant facts; none survive shrinking.
+    {
+        Solver solver;
+        auto& ctx = solver.context();
+        auto x = ctx.int_const("x");
+        auto y = ctx.int_const("y");
+        solver.add(!(x > 0));
+        const std::vector<z3::expr> facts = {y > 3, x > 5, x > 2, y < 10};
+
+        const auto core = solver.minimal_core(facts);
+        if (!core.has_value() || core->size() != 1 || ((*core)[0] != 1 && (*core)[0] != 2))
+        {
+            fail("expected a single-fact core");
+        }
+        if (solver.minimal_core({y > 3}).has_value())
+        {
+            fail("expected no core when the facts do not entail the goal");
+        }
+        if (solver.check() != CheckResult::Sat)
+        {
+            fail("expected minimal_core to leave the assertions unchanged");
+        }
+    }
+
+    // Bit-vector theory: variables are int64s, arithmetic does not wrap, and models report the
+    // Int values.
+    {
+        Solver solver(SolverOptions{.theory = IntTheory::BitVector});
+        auto& ctx = solver.context();
+        auto x = ctx.int_const("x");
+        auto y = ctx.int_const("y");
+        // Bit-blasting is only quick on small ranges; see IntTheory::Auto.
+        solver.add(x * y == 6 && x > 1 && x < 4 && y > x && y < 8);
+        if (solver.check() != CheckResult::Sat)
+        {
+            fail("expected bit-vectors to solve a product of two variables");
+        }
+        const auto model = solver.model_for({x, y, ctx.int_const("unused")});
+        if (!model.has_value() || Solver::format_model(*model) != "unused = 0\nx = 2\ny = 3")
+        {
+            fail("expected bit-vector model x = 2, y = 3");
+        }
+
+        // A sum of two int64s does not wrap around.
+        solver.push();
+        solver.add(x > 0 && y > 0 && x + y < 0);
+        if (solver.check() != CheckResult::Unsat)
+        {
+            fail("expected widened bit-vector addition not to wrap");
+        }
+        solver.pop();
+
+        // Division is not lowered; the query is solved over the integers instead.
+        solver.push();
+        solver.add(x / 2 == 1);
+        if (solver.check() != CheckResult::Sat)
+        {
+            fail("expected a query with division to fall back to integers");
+        }
+        solver.pop();
+
+        const auto max = ctx.int_val(std::numeric_limits<std::int64_t>::max());
+        solver.add(!(x <= max));
+        if (solver.check() != CheckResult::Unsat)
+        {
+            fail("expected every bit-vector variable to be an int64");
+        }
+        if (const auto core = solver.minimal_core({y > 3}); !core.has_value() || !core->empty())
+        {
+            fail("expected an empty bit-vector core");
+        }
+    }
+
+    // Auto: the bounded integer solver, raced against bit-vectors for non-linear queries.
+    {
+        Solver solver(SolverOptions{.theory = IntTheory::Auto});
+        auto& ctx = solver.context();
+        auto x = ctx.int_const("x");
+        auto y = ctx.int_const("y");
+        // Bit-blasting alone takes minutes to refute this; the integer solver does not.
+        const auto core = solver.minimal_core({y > 1, x >= y, x * y < 2});
+        if (!core.has_value() || *core != std::vector<std::size_t>{0, 1, 2})
+        {
+            fail("expected auto to find a non-linear core");
+        }
+
+        solver.add(x * y == 6 && x > 1 && y > x);
+        if (solver.check() != CheckResult::Sat)
+        {
+            fail("expected auto to solve a product of two variables");
+        }
+        const auto model = solver.model_for({x, y});
+        if (!model.has_value() || Solver::format_model(*model) != "x = 2\ny = 3")
+        {
+            fail("expected auto model x = 2, y = 3");
+        }
+
+        solver.add(x + y > ctx.int_val(std::numeric_limits<std::int64_t>::max()));
+        if (solver.check() != CheckResult::Unsat)
+        {
+            fail("expected auto to bound variables to int64");
+        }
+    }
+
     std::cout << "OK\n";
     return 0;
 }
@@ -241,7 +241,100 @@ static void vm_should_fail_no_return_at_end()
     }
 }
 
-int main()
+static RunnerCommand sh_command(const std::string& script)
+{
+    return RunnerCommand{.argv = {"/bin/sh", "-c", script}, .env = runner_env()};
+}
+
+static void pool_should_reuse_worker_until_max_calls(const std::string& runner)
+{
+    PythonRunnerPool pool(2);
+    const RunnerCommand command{.argv = {runner, "--serve"}, .env = runner_env()};
+
+    for (std::size_t call = 1; call <= 3; ++call)
+    {
+        const auto reply = pool.call(command, "handshake", 2000, 4096);
+        if (!response_ok_true(reply.response))
+        {
+            fail("expected pooled handshake to succeed: " + reply.response);
+        }
+    }
+    // Calls 1 and 2 share a worker, which is then retired; call 3 starts another.
+    if (pool.spawned() != 2)
+    {
+        fail("expected 2 runner spawns for 3 calls, got " + std::to_string(pool.spawned()));
+    }
+
+    // A different configuration never shares a worker.
+    RunnerCommand other = command;
+    other.env.emplace_back("CURLEE_TEST_POOL=1");
+    (void)pool.call(other, "handshake", 2000, 4096);
+    if (pool.spawned() != 3)
+    {
+        fail("expected a new worker for a different environment");
+    }
+}
+
+static void pool_should_replace_worker_that_died_while_idle()
+{
+    PythonRunnerPool pool(16);
+    // Answers one request with the matching id, then exits without reading another line.
+    const auto command = sh_command("IFS= read -r l; id=${l#*'\"id\":\"'}; id=${id%%'\"'*}; "
+                                    "printf '{\"id\":\"%s\",\"ok\":true}\\n' \"$id\"; "
+                                    "sleep 0.2");
+    for (int call = 0; call < 2; ++call)
+    {
+        const auto reply = pool.call(command, "handshake", 2000, 4096);
+        if (!response_ok_true(reply.response))
+        {
+            fail("expected one-shot worker call to succeed: " + reply.response);
+        }
+    }
+    if (pool.spawned() != 2)
+    {
+        fail("expected the dead idle worker to be replaced");
+    }
+}
+
+static void pool_should_recycle_after_timeout_and_protocol_errors()
+{
+    PythonRunnerPool pool(16);
+    const auto hang = sh_command("exec sleep 5");
+    for (int call = 0; call < 2; ++call)
+    {
+        const auto reply = pool.call(hang, "handshake", 50, 4096);
+        if (!reply.timed_out || reply.exit_code != 128)
+        {
+            fail("expected hung worker to time out and be killed");
+        }
+    }
+
+    // `cat` answers with the request itself: the id matches but it is neither ok nor a
+    // structured error, so the worker is not trusted with another request.
+    const RunnerCommand cat{.argv = {"/bin/cat"}, .env = runner_env()};
+    for (int call = 0; call < 2; ++call)
+    {
+        const auto reply = pool.call(cat, "handshake", 2000, 4096);
+        if (response_ok_true(reply.response) || reply.exit_code < 0)
+        {
+            fail("expected echoing worker to be retired");
+        }
+    }
+    if (pool.spawned() != 4)
+    {
+        fail("expected every failed call to retire its worker");
+    }
+
+    // Spawn failures surface as exec failures.
+    const auto missing = pool.call(RunnerCommand{.argv = {"/no/such/runner"}, .env = {}},
+                                   "handshake", 2000, 4096);
+    if (missing.exit_code != 127 || !missing.response.empty())
+    {
+        fail("expected missing runner to report exit code 127");
+    }
+}
+
+int main(int argc, char** argv)
 {
     set_nonblocking_should_ignore_invalid_fd();
     read_into_should_report_limit_when_already_full();
@@ -258,6 +351,13 @@ int main()
     vm_should_fail_print_missing_capability();
     vm_should_fail_no_return_at_end();
 
+    if (argc > 1)
+    {
+        pool_should_reuse_worker_until_max_calls(argv[1]);
+    }
+    pool_should_replace_worker_that_died_while_idle();
+    pool_should_recycle_after_timeout_and_protocol_errors();
+
     std::cout << "OK\n";
     return 0;
 }
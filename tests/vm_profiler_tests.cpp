@@ -0,0 +1,234 @@
+#include <cstdint>
+#include <cstdlib>
+#include <curlee/vm/profiler.h>
+#include <curlee/vm/vm.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using curlee::source::Span;
+using curlee::vm::Chunk;
+using curlee::vm::FunctionInfo;
+using curlee::vm::OpCode;
+using curlee::vm::Profiler;
+using curlee::vm::Value;
+using curlee::vm::VM;
+
+[[noreturn]] static void fail(const std::string& msg)
+{
+    std::cerr << "FAIL: " << msg << "\n";
+    std::exit(1);
+}
+
+static std::uint64_t count_of(const Profiler& profiler, OpCode op)
+{
+    return profiler.opcodes()[static_cast<std::size_t>(op)].count;
+}
+
+// fib(n) with `fib` described at entry 7; the entry code has no descriptor.
+static Chunk fib_chunk(std::int64_t n)
+{
+    const Span entry_span{.start = 0, .end = 6};
+    const Span test_span{.start = 10, .end = 15};
+    const Span body_span{.start = 20, .end = 40};
+
+    Chunk chunk;
+    chunk.emit_constant(Value::int_v(n), entry_span); // 0
+    chunk.emit(OpCode::Call, entry_span);             // 3
+    chunk.emit_u16(7);
+    chunk.emit(OpCode::Return, entry_span); // 6
+
+    chunk.functions.push_back(FunctionInfo{.entry = 7, .arity = 1, .locals = 1, .name = "fib"});
+    chunk.emit_local(OpCode::LoadLocal, 0, test_span); // 7
+    chunk.emit_constant(Value::int_v(2), test_span);   // 10
+    chunk.emit(OpCode::Less, test_span);               // 13
+    chunk.emit(OpCode::JumpIfFalse, test_span);        // 14
+    chunk.emit_u16(21);
+    chunk.emit_local(OpCode::LoadLocal, 0, test_span); // 17
+    chunk.emit(OpCode::Ret, test_span);                // 20
+    for (const std::int64_t k : {1, 2})                // 21, 31
+    {
+        chunk.emit_local(OpCode::LoadLocal, 0, body_span);
+        chunk.emit_constant(Value::int_v(k), body_span);
+        chunk.emit(OpCode::Sub, body_span);
+        chunk.emit(OpCode::Call, body_span);
+        chunk.emit_u16(7);
+    }
+    chunk.emit(OpCode::Add, body_span);
+    chunk.emit(OpCode::Ret, body_span);
+    return chunk;
+}
+
+static std::uint64_t sum_stacks(const std::string& stacks)
+{
+    std::istringstream lines(stacks);
+    std::string line;
+    std::uint64_t total = 0;
+    while (std::getline(lines, line))
+    {
+        const auto space = line.rfind(' ');
+        if (space == std::string::npos)
+        {
+            fail("collapsed stack line without a count: " + line);
+        }
+        total += std::stoull(line.substr(space + 1));
+    }
+    return total;
+}
+
+int main()
+{
+    // fib(10) makes 177 calls to fib: 89 leaves (6 instructions) and 88 inner calls (14).
+    {
+        const Chunk chunk = fib_chunk(10);
+        Profiler profiler;
+        VM vm;
+        vm.set_profiler(&profiler);
+        const auto res = vm.run(chunk);
+        if (!res.ok || !(res.value == Value::int_v(55)))
+        {
+            fail("expected profiled fib(10) to return 55");
+        }
+
+        const std::uint64_t expected_insns = 3 + 89 * 6 + 88 * 14;
+        if (profiler.instructions() != expected_insns)
+        {
+            fail("expected " + std::to_string(expected_insns) + " profiled instructions, got " +
+                 std::to_string(profiler.instructions()));
+        }
+        if (count_of(profiler, OpCode::Call) != 177 || count_of(profiler, OpCode::Ret) != 177 ||
+            count_of(profiler, OpCode::Return) != 1 || count_of(profiler, OpCode::Add) != 88)
+        {
+            fail("unexpected per-opcode counts");
+        }
+
+        std::uint64_t opcode_cycles = 0;
+        for (const auto& op : profiler.opcodes())
+        {
+            opcode_cycles += op.cycles;
+        }
+        if (opcode_cycles != profiler.total_cycles() || profiler.total_cycles() == 0)
+        {
+            fail("expected opcode cycles to add up to the run total");
+        }
+
+        const auto functions = profiler.functions();
+        if (functions.size() != 2)
+        {
+            fail("expected the entry code and fib in the function profile");
+        }
+        const auto& root = functions[0].entry == 0 ? functions[0] : functions[1];
+        const auto& fib = functions[0].entry == 0 ? functions[1] : functions[0];
+        if (root.name != "<entry>" || root.calls != 1 || fib.name != "fib" || fib.calls != 177)
+        {
+            fail("unexpected function names or call counts");
+        }
+        if (root.exclusive_cycles + fib.exclusive_cycles != root.inclusive_cycles)
+        {
+            fail("expected exclusive times to partition the entry's inclusive time");
+        }
+        // Recursive activations are counted once, so fib's inclusive time fits inside the root's.
+        if (fib.inclusive_cycles > root.inclusive_cycles ||
+            fib.exclusive_cycles > fib.inclusive_cycles)
+        {
+            fail("expected recursion not to double-count inclusive time");
+        }
+
+        const std::string stacks = profiler.collapsed_stacks();
+        if (stacks.find("<entry> ") == std::string::npos ||
+            stacks.find("<entry>;fib ") == std::string::npos ||
+            stacks.find("<entry>;fib;fib;fib;fib;fib;fib;fib;fib;fib ") == std::string::npos)
+        {
+            fail("expected collapsed stacks for every call depth:\n" + stacks);
+        }
+        if (sum_stacks(stacks) != root.inclusive_cycles)
+        {
+            fail("expected collapsed stacks to account for the whole run");
+        }
+
+        const auto spans = profiler.hot_spans(2);
+        if (spans.size() != 2)
+        {
+            fail("expected the two hottest spans");
+        }
+        std::uint64_t span_count = 0;
+        for (const auto& span : profiler.hot_spans(10))
+        {
+            span_count += span.count;
+        }
+        if (span_count != expected_insns || spans[0].cycles < spans[1].cycles)
+        {
+            fail("expected hot spans to cover every instruction, hottest first");
+        }
+
+        const std::string report = curlee::vm::render_profile_report(
+            profiler, [](const Span& span) { return "at:" + std::to_string(span.start); });
+        for (const char* needle :
+             {"profile: ", "opcodes (by cycles):", "JumpIfFalse", "functions (by exclusive",
+              "fib", "<entry>", "hot spans (by cycles):", "at:20"})
+        {
+            if (report.find(needle) == std::string::npos)
+            {
+                fail(std::string("expected report to mention '") + needle + "':\n" + report);
+            }
+        }
+
+        // Detaching the profiler leaves the last profile untouched.
+        vm.set_profiler(nullptr);
+        const auto again = vm.run(fib_chunk(3));
+        if (!again.ok || profiler.instructions() != expected_insns)
+        {
+            fail("expected unprofiled runs not to touch the profiler");
+        }
+    }
+
+    // Profiling does not change results: errors keep their message and span, and the profile
+    // is closed at the failing instruction.
+    {
+        const Span span{.start = 3, .end = 4};
+        Chunk chunk;
+        chunk.emit_constant(Value::int_v(1), span);
+        chunk.emit_constant(Value::int_v(0), span);
+        chunk.emit(OpCode::Div, span);
+        chunk.emit(OpCode::Return, span);
+
+        Profiler profiler;
+        VM vm;
+        vm.set_profiler(&profiler);
+        const auto res = vm.run(chunk);
+        if (res.ok || res.error != "divide by zero" || !res.error_span.has_value() ||
+            res.error_span->start != 3)
+        {
+            fail("expected profiled run to report divide by zero");
+        }
+        if (profiler.instructions() != 3 || count_of(profiler, OpCode::Div) != 1)
+        {
+            fail("expected the failing instruction to be profiled");
+        }
+        if (profiler.collapsed_stacks().rfind("<entry> ", 0) != 0)
+        {
+            fail("expected the entry activation to be closed on error");
+        }
+    }
+
+    // Prepared chunks and both dispatch modes are profiled the same way.
+    {
+        const curlee::vm::PreparedChunk prepared(fib_chunk(5));
+        Profiler profiler;
+        VM vm;
+        vm.set_dispatch_mode(curlee::vm::DispatchMode::Switch);
+        vm.set_profiler(&profiler);
+        const auto switched = vm.run(prepared);
+        const auto switched_insns = profiler.instructions();
+        vm.set_dispatch_mode(curlee::vm::DispatchMode::Threaded);
+        const auto threaded = vm.run(prepared);
+        if (!switched.ok || !threaded.ok || !(threaded.value == Value::int_v(5)) ||
+            profiler.instructions() != switched_insns)
+        {
+            fail("expected identical profiles regardless of dispatch mode");
+        }
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
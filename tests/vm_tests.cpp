@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cerrno>
 #include <cstdlib>
 #include <curlee/source/span.h>
@@ -6,7 +7,10 @@
 #include <fcntl.h>
 #include <filesystem>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <sys/resource.h>
+#include <tuple>
 #include <unistd.h>
 
 static void fail(const std::string& msg)
@@ -123,6 +127,512 @@ int main(int argc, char** argv)
         }
     }
 
+    // Compact Value: string copies share one heap object; moves leave Unit behind.
+    {
+        static_assert(sizeof(Value) <= 16);
+
+        Value original = Value::string_v("shared");
+        const Value copy = original;
+        if (!copy.same_string_object(original) || copy.as_string() != "shared")
+        {
+            fail("expected String copies to share the string heap object");
+        }
+
+        Value moved = std::move(original);
+        if (!moved.same_string_object(copy) || original.kind != ValueKind::Unit)
+        {
+            fail("expected String move to transfer the handle");
+        }
+
+        moved = Value::int_v(3);
+        if (copy.as_string() != "shared" || moved.as_int() != 3)
+        {
+            fail("expected reassigning a Value to release only its own handle");
+        }
+        if (!Value::int_v(1).as_string().empty())
+        {
+            fail("expected non-String values to expose an empty string payload");
+        }
+    }
+
+    // Threaded and switch dispatch produce identical results, including every error path.
+    {
+        const auto same_result = [](const VmResult& a, const VmResult& b)
+        {
+            const bool spans_equal =
+                a.error_span.has_value() == b.error_span.has_value() &&
+                (!a.error_span.has_value() || (a.error_span->start == b.error_span->start &&
+                                               a.error_span->end == b.error_span->end));
+            return a.ok == b.ok && a.value == b.value && a.error == b.error && spans_equal;
+        };
+
+        const auto expect_modes_agree =
+            [&](const Chunk& chunk, std::size_t fuel, const std::string& what)
+        {
+            VM switch_vm;
+            switch_vm.set_dispatch_mode(DispatchMode::Switch);
+            VM threaded_vm;
+            if (threaded_vm.dispatch_mode() != DispatchMode::Threaded)
+            {
+                fail("expected threaded dispatch to be the default");
+            }
+            const auto expected = switch_vm.run(chunk, fuel);
+            const auto got = threaded_vm.run(chunk, fuel);
+            if (!same_result(expected, got))
+            {
+                fail("dispatch modes disagree: " + what + " (switch='" + expected.error +
+                     "', threaded='" + got.error + "')");
+            }
+        };
+
+        const curlee::source::Span sp{.start = 3, .end = 9};
+
+        Chunk loop;
+        loop.emit_constant(Value::int_v(0), sp);
+        loop.emit_local(OpCode::StoreLocal, 0, sp);
+        const auto loop_start = loop.code.size();
+        loop.emit_local(OpCode::LoadLocal, 0, sp);
+        loop.emit_constant(Value::int_v(5), sp);
+        loop.emit(OpCode::Less, sp);
+        loop.emit(OpCode::JumpIfFalse, sp);
+        const auto exit_patch = loop.code.size();
+        loop.emit_u16(0);
+        loop.emit_local(OpCode::LoadLocal, 0, sp);
+        loop.emit_constant(Value::int_v(1), sp);
+        loop.emit(OpCode::Add, sp);
+        loop.emit_local(OpCode::StoreLocal, 0, sp);
+        loop.emit(OpCode::Jump, sp);
+        loop.emit_u16(static_cast<std::uint16_t>(loop_start));
+        loop.code[exit_patch] = static_cast<std::uint8_t>(loop.code.size());
+        loop.emit_local(OpCode::LoadLocal, 0, sp);
+        loop.emit(OpCode::Return, sp);
+        expect_modes_agree(loop, 1000, "counting loop");
+        expect_modes_agree(loop, 17, "counting loop out of fuel");
+
+        Chunk call;
+        call.emit(OpCode::Call, sp);
+        call.emit_u16(5);
+        call.emit(OpCode::Return, sp);
+        call.emit(OpCode::Pop, sp); // unreachable padding
+        call.emit_constant(Value::string_v("ab"), sp);
+        call.emit_constant(Value::string_v("cd"), sp);
+        call.emit(OpCode::Add, sp);
+        call.emit(OpCode::Ret, sp);
+        expect_modes_agree(call, 100, "call/ret with string add");
+
+        Chunk unknown_op;
+        unknown_op.code.push_back(0xEE);
+        unknown_op.spans.add(0, sp);
+        unknown_op.emit_constant(Value::bool_v(true), sp);
+        unknown_op.emit(OpCode::Not, sp);
+        unknown_op.emit(OpCode::Return, sp);
+        expect_modes_agree(unknown_op, 100, "unknown opcode byte is skipped");
+
+        Chunk truncated;
+        truncated.emit(OpCode::Constant, sp);
+        truncated.code.push_back(0);
+        expect_modes_agree(truncated, 100, "truncated constant");
+
+        Chunk bad_jump;
+        bad_jump.emit(OpCode::Jump, sp);
+        bad_jump.emit_u16(200);
+        expect_modes_agree(bad_jump, 100, "jump out of range");
+
+        // Jumping into the middle of an instruction forces the switch fallback.
+        Chunk misaligned;
+        misaligned.emit(OpCode::Jump, sp);
+        misaligned.emit_u16(4);
+        misaligned.emit_constant(Value::int_v(static_cast<std::uint8_t>(OpCode::Return)), sp);
+        expect_modes_agree(misaligned, 100, "misaligned jump target");
+        if (predecode(misaligned).has_value())
+        {
+            fail("expected predecode to reject a misaligned jump target");
+        }
+
+        Chunk type_errors;
+        type_errors.emit_constant(Value::bool_v(true), sp);
+        type_errors.emit_constant(Value::int_v(1), sp);
+        type_errors.emit(OpCode::Sub, sp);
+        expect_modes_agree(type_errors, 100, "sub type error");
+
+        Chunk no_return;
+        no_return.emit_constant(Value::int_v(1), sp);
+        expect_modes_agree(no_return, 100, "no return");
+        expect_modes_agree(Chunk{}, 0, "empty chunk with zero fuel");
+    }
+
+    // Load-time verification: proven chunks run check-free handlers with identical results, and
+    // chunks the verifier rejects still run (fully checked) with the usual runtime errors.
+    {
+        const curlee::source::Span sp{.start = 11, .end = 12};
+        const auto handler = [](auto op) { return static_cast<std::uint8_t>(op); };
+
+        const auto same_result = [](const VmResult& a, const VmResult& b)
+        {
+            return a.ok == b.ok && a.value == b.value && a.error == b.error &&
+                   a.error_span.has_value() == b.error_span.has_value();
+        };
+
+        const auto expect_prepared_agrees = [&](const PreparedChunk& prepared, std::size_t fuel,
+                                                const VM::Capabilities& caps,
+                                                const std::string& what)
+        {
+            VM switch_vm;
+            switch_vm.set_dispatch_mode(DispatchMode::Switch);
+            VM vm;
+            const auto expected = switch_vm.run(prepared.chunk(), fuel, caps);
+            const auto got = vm.run(prepared, fuel, caps);
+            const auto again = vm.run(prepared, fuel, caps);
+            if (!same_result(expected, got) || !same_result(expected, again))
+            {
+                fail("prepared chunk disagrees with switch dispatch: " + what + " (switch='" +
+                     expected.error + "', prepared='" + got.error + "')");
+            }
+            VM prepared_switch_vm;
+            prepared_switch_vm.set_dispatch_mode(DispatchMode::Switch);
+            if (!same_result(expected, prepared_switch_vm.run(prepared, fuel, caps)))
+            {
+                fail("prepared chunk disagrees under switch dispatch: " + what);
+            }
+        };
+
+        const auto verified_handlers = [](const Chunk& chunk)
+        {
+            auto code = predecode(chunk);
+            if (!code.has_value() || verify_bytecode(chunk, *code).has_value() || !code->verified)
+            {
+                fail("expected chunk to verify");
+            }
+            std::vector<std::uint8_t> ids;
+            for (const auto& instr : code->instrs)
+            {
+                ids.push_back(instr.handler_id);
+            }
+            return ids;
+        };
+        const auto contains = [](const std::vector<std::uint8_t>& ids, std::uint8_t id)
+        {
+            return std::find(ids.begin(), ids.end(), id) != ids.end();
+        };
+
+        const auto expect_rejected = [&](const Chunk& chunk, const std::string& message,
+                                         std::size_t offset)
+        {
+            const PreparedChunk prepared(chunk);
+            if (prepared.verified() || !prepared.verify_error().has_value() ||
+                prepared.verify_error()->message != message ||
+                prepared.verify_error()->offset != offset)
+            {
+                fail("expected verifier to reject with '" + message + "' at offset " +
+                     std::to_string(offset) + " (got '" +
+                     (prepared.verify_error().has_value() ? prepared.verify_error()->message
+                                                          : std::string("verified")) +
+                     "')");
+            }
+            expect_prepared_agrees(prepared, 100, VM::Capabilities{}, "rejected: " + message);
+        };
+
+        // Counting loop: Int arithmetic, comparisons and the branch are all proven.
+        Chunk loop;
+        loop.emit_constant(Value::int_v(0), sp);
+        loop.emit_local(OpCode::StoreLocal, 0, sp);
+        const auto loop_start = loop.code.size();
+        loop.emit_local(OpCode::LoadLocal, 0, sp);
+        loop.emit_constant(Value::int_v(5), sp);
+        loop.emit(OpCode::Less, sp);
+        loop.emit(OpCode::JumpIfFalse, sp);
+        const auto exit_patch = loop.code.size();
+        loop.emit_u16(0);
+        loop.emit_local(OpCode::LoadLocal, 0, sp);
+        loop.emit_constant(Value::int_v(1), sp);
+        loop.emit(OpCode::Add, sp);
+        loop.emit_local(OpCode::StoreLocal, 0, sp);
+        loop.emit(OpCode::Jump, sp);
+        loop.emit_u16(static_cast<std::uint16_t>(loop_start));
+        loop.code[exit_patch] = static_cast<std::uint8_t>(loop.code.size());
+        loop.emit_local(OpCode::LoadLocal, 0, sp);
+        loop.emit(OpCode::Return, sp);
+        {
+            const auto ids = verified_handlers(loop);
+            if (!contains(ids, handler(ThreadedPseudoOp::VerifiedAddInt)) ||
+                !contains(ids, handler(ThreadedPseudoOp::VerifiedLessInt)) ||
+                !contains(ids, handler(ThreadedPseudoOp::VerifiedJumpIfFalse)) ||
+                contains(ids, handler(OpCode::Add)))
+            {
+                fail("expected the counting loop to use proven Int handlers");
+            }
+            const PreparedChunk prepared(loop);
+            if (!prepared.verified())
+            {
+                fail("expected PreparedChunk to verify the counting loop");
+            }
+            expect_prepared_agrees(prepared, 1000, VM::Capabilities{}, "verified loop");
+            expect_prepared_agrees(prepared, 17, VM::Capabilities{}, "verified loop fuel");
+        }
+
+        // A callee consuming two caller values; both call sites pass Int.
+        Chunk args;
+        args.emit_constant(Value::int_v(9), sp);
+        args.emit_constant(Value::int_v(4), sp);
+        args.emit(OpCode::Call, sp);
+        const auto callee_patch = args.code.size();
+        args.emit_u16(0);
+        args.emit_constant(Value::int_v(1), sp);
+        args.emit(OpCode::Call, sp);
+        const auto callee_patch2 = args.code.size();
+        args.emit_u16(0);
+        args.emit(OpCode::Return, sp);
+        const auto callee = static_cast<std::uint8_t>(args.code.size());
+        args.code[callee_patch] = callee;
+        args.code[callee_patch2] = callee;
+        args.emit(OpCode::Sub, sp);
+        args.emit(OpCode::Ret, sp);
+        {
+            const auto ids = verified_handlers(args);
+            if (!contains(ids, handler(ThreadedPseudoOp::VerifiedSubInt)) ||
+                !contains(ids, handler(ThreadedPseudoOp::VerifiedCall)) ||
+                !contains(ids, handler(ThreadedPseudoOp::VerifiedRet)))
+            {
+                fail("expected callee arguments to be proven Int");
+            }
+            expect_prepared_agrees(PreparedChunk(args), 100, VM::Capabilities{}, "call args");
+        }
+
+        // The same callee reached with Int and String operands keeps its checked Add.
+        Chunk mixed;
+        mixed.emit_constant(Value::int_v(2), sp);
+        mixed.emit_constant(Value::int_v(3), sp);
+        mixed.emit(OpCode::Call, sp);
+        const auto mixed_patch = mixed.code.size();
+        mixed.emit_u16(0);
+        mixed.emit(OpCode::Pop, sp);
+        mixed.emit_constant(Value::string_v("a"), sp);
+        mixed.emit_constant(Value::string_v("b"), sp);
+        mixed.emit(OpCode::Call, sp);
+        const auto mixed_patch2 = mixed.code.size();
+        mixed.emit_u16(0);
+        mixed.emit(OpCode::Return, sp);
+        mixed.code[mixed_patch] = static_cast<std::uint8_t>(mixed.code.size());
+        mixed.code[mixed_patch2] = static_cast<std::uint8_t>(mixed.code.size());
+        mixed.emit(OpCode::Add, sp);
+        mixed.emit(OpCode::Ret, sp);
+        {
+            const auto ids = verified_handlers(mixed);
+            if (!contains(ids, handler(OpCode::Add)))
+            {
+                fail("expected mixed-kind Add to stay checked");
+            }
+            expect_prepared_agrees(PreparedChunk(mixed), 100, VM::Capabilities{}, "mixed add");
+        }
+
+        // String concatenation is proven separately from Int addition.
+        Chunk strings;
+        strings.emit_constant(Value::string_v("ab"), sp);
+        strings.emit_constant(Value::string_v("cd"), sp);
+        strings.emit(OpCode::Add, sp);
+        strings.emit(OpCode::Return, sp);
+        if (!contains(verified_handlers(strings), handler(ThreadedPseudoOp::VerifiedAddString)))
+        {
+            fail("expected String + String to be proven");
+        }
+        expect_prepared_agrees(PreparedChunk(strings), 100, VM::Capabilities{}, "strings");
+
+        // Kind errors are not proven away: the instruction keeps its checked handler.
+        Chunk kind_error;
+        kind_error.emit_constant(Value::bool_v(true), sp);
+        kind_error.emit_constant(Value::int_v(1), sp);
+        kind_error.emit(OpCode::Sub, sp);
+        kind_error.emit(OpCode::Return, sp);
+        if (!contains(verified_handlers(kind_error), handler(OpCode::Sub)))
+        {
+            fail("expected ill-kinded Sub to stay checked");
+        }
+        expect_prepared_agrees(PreparedChunk(kind_error), 100, VM::Capabilities{}, "kinds");
+
+        // Runtime-only failures remain checked on the verified path.
+        Chunk div_zero;
+        div_zero.emit_constant(Value::int_v(1), sp);
+        div_zero.emit_constant(Value::int_v(0), sp);
+        div_zero.emit(OpCode::Div, sp);
+        div_zero.emit(OpCode::Return, sp);
+        expect_prepared_agrees(PreparedChunk(div_zero), 100, VM::Capabilities{}, "div zero");
+
+        // Checked Int arithmetic reports int64 overflow on every dispatch path.
+        constexpr auto kMin = std::numeric_limits<std::int64_t>::min();
+        constexpr auto kMax = std::numeric_limits<std::int64_t>::max();
+        const auto arith = [&](std::int64_t a, std::optional<std::int64_t> b, OpCode op)
+        {
+            Chunk chunk;
+            chunk.emit_constant(Value::int_v(a), sp);
+            if (b.has_value())
+            {
+                chunk.emit_constant(Value::int_v(*b), sp);
+            }
+            chunk.emit(op, sp);
+            chunk.emit(OpCode::Return, sp);
+            return chunk;
+        };
+        const std::tuple<std::int64_t, std::optional<std::int64_t>, OpCode> overflows[] = {
+            {kMax, 1, OpCode::Add}, {kMin, 1, OpCode::Sub},         {kMax, 2, OpCode::Mul},
+            {kMin, -1, OpCode::Div}, {kMin, std::nullopt, OpCode::Neg},
+        };
+        for (const auto& [a, b, op] : overflows)
+        {
+            const Chunk chunk = arith(a, b, op);
+            VM vm;
+            const auto res = vm.run(chunk);
+            const std::string what(curlee::vm::opcode_name(op));
+            if (res.ok || res.error != "integer overflow" || !res.error_span.has_value())
+            {
+                fail("expected integer overflow from " + what + " (got '" + res.error + "')");
+            }
+            expect_prepared_agrees(PreparedChunk(chunk), 100, VM::Capabilities{}, what);
+        }
+
+        // Unchecked arithmetic (emitted at proven sites) computes the same values; verified,
+        // it runs on handlers with no checks left.
+        const std::tuple<std::int64_t, std::optional<std::int64_t>, OpCode, std::int64_t,
+                         ThreadedPseudoOp>
+            unchecked[] = {
+                {kMax - 1, 1, OpCode::AddUnchecked, kMax,
+                 ThreadedPseudoOp::VerifiedAddIntUnchecked},
+                {kMin + 1, 1, OpCode::SubUnchecked, kMin,
+                 ThreadedPseudoOp::VerifiedSubIntUnchecked},
+                {-7, 3, OpCode::MulUnchecked, -21, ThreadedPseudoOp::VerifiedMulIntUnchecked},
+                {-7, 2, OpCode::DivUnchecked, -3, ThreadedPseudoOp::VerifiedDivIntUnchecked},
+                {5, std::nullopt, OpCode::NegUnchecked, -5,
+                 ThreadedPseudoOp::VerifiedNegIntUnchecked},
+            };
+        for (const auto& [a, b, op, expected, verified] : unchecked)
+        {
+            const Chunk chunk = arith(a, b, op);
+            const std::string what(curlee::vm::opcode_name(op));
+            VM vm;
+            const auto res = vm.run(chunk);
+            if (!res.ok || !(res.value == Value::int_v(expected)))
+            {
+                fail("unexpected result from " + what);
+            }
+            if (!contains(verified_handlers(chunk), handler(verified)))
+            {
+                fail("expected verified " + what + " to drop every check");
+            }
+            expect_prepared_agrees(PreparedChunk(chunk), 100, VM::Capabilities{}, what);
+
+            // Untrusted bytecode is demoted to the checked opcodes, in place.
+            Chunk demoted = chunk;
+            demoted.demote_unchecked_arithmetic();
+            if (demoted.code.size() != chunk.code.size() ||
+                demoted.code[b.has_value() ? 6 : 3] !=
+                    static_cast<std::uint8_t>(curlee::vm::checked_variant(op)) ||
+                !(VM().run(demoted).value == Value::int_v(expected)))
+            {
+                fail("expected " + what + " to demote to its checked variant");
+            }
+        }
+
+        // A hand-assembled DivUnchecked that breaks its proof still traps instead of faulting.
+        for (const auto& [a, b, error] : {std::tuple{std::int64_t{1}, std::int64_t{0},
+                                                     "divide by zero"},
+                                          std::tuple{kMin, std::int64_t{-1}, "integer overflow"}})
+        {
+            const Chunk chunk = arith(a, b, OpCode::DivUnchecked);
+            if (VM().run(chunk).error != error)
+            {
+                fail(std::string("expected unchecked Div to report ") + error);
+            }
+            expect_prepared_agrees(PreparedChunk(chunk), 100, VM::Capabilities{},
+                                   std::string("unchecked ") + error);
+        }
+
+        // Unchecked opcodes still reject operands of the wrong kind unless verified.
+        Chunk unchecked_kind;
+        unchecked_kind.emit_constant(Value::bool_v(true), sp);
+        unchecked_kind.emit_constant(Value::int_v(1), sp);
+        unchecked_kind.emit(OpCode::AddUnchecked, sp);
+        unchecked_kind.emit(OpCode::Return, sp);
+        if (VM().run(unchecked_kind).error != "arithmetic expects Int")
+        {
+            fail("expected unchecked Add to check operand kinds");
+        }
+        expect_prepared_agrees(PreparedChunk(unchecked_kind), 100, VM::Capabilities{},
+                               "unchecked kinds");
+
+        Chunk print;
+        print.emit_constant(Value::int_v(1), sp);
+        print.emit(OpCode::Print, sp);
+        print.emit(OpCode::Return, sp);
+        VM::Capabilities stdout_caps;
+        stdout_caps.insert("io:stdout");
+        expect_prepared_agrees(PreparedChunk(print), 100, VM::Capabilities{}, "print denied");
+        expect_prepared_agrees(PreparedChunk(print), 100, stdout_caps, "print allowed");
+
+        // Structural errors are rejected at load time, reported at the opcode's byte offset.
+        Chunk underflow;
+        underflow.emit_constant(Value::int_v(1), sp);
+        underflow.emit(OpCode::Add, sp);
+        expect_rejected(underflow, "stack underflow", 3);
+
+        // An unreachable truncated operand is harmless; a reachable one is rejected.
+        Chunk truncated;
+        truncated.emit_constant(Value::int_v(1), sp);
+        truncated.emit(OpCode::Return, sp);
+        truncated.emit(OpCode::Constant, sp);
+        truncated.code.push_back(0);
+        (void)verified_handlers(truncated);
+        Chunk truncated_reached;
+        truncated_reached.emit(OpCode::Jump, sp);
+        truncated_reached.emit_u16(3);
+        truncated_reached.emit(OpCode::Call, sp);
+        truncated_reached.code.push_back(0);
+        expect_rejected(truncated_reached, "truncated operand", 3);
+
+        Chunk bad_jump;
+        bad_jump.emit(OpCode::Jump, sp);
+        bad_jump.emit_u16(200);
+        expect_rejected(bad_jump, "jump target out of range", 0);
+
+        Chunk bad_call;
+        bad_call.emit(OpCode::Call, sp);
+        bad_call.emit_u16(200);
+        expect_rejected(bad_call, "call target out of range", 0);
+
+        Chunk bad_constant;
+        bad_constant.emit(OpCode::Constant, sp);
+        bad_constant.emit_u16(7);
+        expect_rejected(bad_constant, "constant index out of range", 0);
+
+        Chunk bad_local;
+        bad_local.emit_local(OpCode::LoadLocal, 2, sp);
+        bad_local.emit(OpCode::Return, sp);
+        expect_rejected(bad_local, "local index out of range", 0);
+
+        Chunk stray_ret;
+        stray_ret.emit(OpCode::Ret, sp);
+        expect_rejected(stray_ret, "return with empty call stack", 0);
+
+        // if (true) { push 1 } then join with an empty stack.
+        Chunk unbalanced;
+        unbalanced.emit_constant(Value::bool_v(true), sp);
+        unbalanced.emit(OpCode::JumpIfFalse, sp);
+        unbalanced.emit_u16(9);
+        unbalanced.emit_constant(Value::int_v(1), sp);
+        unbalanced.emit_constant(Value::int_v(2), sp);
+        unbalanced.emit(OpCode::Return, sp);
+        expect_rejected(unbalanced, "inconsistent stack depth", 9);
+
+        // Misaligned targets cannot be pre-decoded at all.
+        Chunk misaligned;
+        misaligned.emit(OpCode::Jump, sp);
+        misaligned.emit_u16(4);
+        misaligned.emit_constant(Value::int_v(static_cast<std::uint8_t>(OpCode::Return)), sp);
+        if (PreparedChunk(misaligned).verified())
+        {
+            fail("expected a misaligned jump to fail verification");
+        }
+        expect_prepared_agrees(PreparedChunk(misaligned), 100, VM::Capabilities{}, "misaligned");
+    }
+
     auto run_twice_deterministic = [](const Chunk& chunk, Value expected)
     {
         VM vm;
@@ -294,6 +804,113 @@ int main(int argc, char** argv)
         run_twice_deterministic(chunk, Value::int_v(8));
     }
 
+    // Call frames: descriptors give each call a fresh frame holding its arguments.
+    {
+        const curlee::source::Span sp{.start = 21, .end = 22};
+        const auto expect_everywhere = [](const Chunk& chunk, const VmResult& expected,
+                                          const std::string& what)
+        {
+            VM switch_vm;
+            switch_vm.set_dispatch_mode(DispatchMode::Switch);
+            VM threaded_vm;
+            const PreparedChunk prepared(chunk);
+            const VmResult results[] = {switch_vm.run(chunk, 100000),
+                                        threaded_vm.run(chunk, 100000),
+                                        threaded_vm.run(prepared, 100000)};
+            for (const auto& res : results)
+            {
+                if (res.ok != expected.ok || !(res.value == expected.value) ||
+                    res.error != expected.error)
+                {
+                    fail("call frames: " + what + " (got '" + res.error + "' / " +
+                         to_string(res.value) + ")");
+                }
+            }
+        };
+        const auto ok_value = [](Value v)
+        {
+            VmResult res;
+            res.value = std::move(v);
+            return res;
+        };
+        const auto error = [](std::string message)
+        {
+            VmResult res;
+            res.ok = false;
+            res.error = std::move(message);
+            return res;
+        };
+
+        // fact(n) = n <= 1 ? 1 : n * fact(n - 1), called as fact(10).
+        Chunk fact;
+        fact.emit_constant(Value::int_v(10), sp);
+        fact.emit(OpCode::Call, sp);
+        fact.emit_u16(7);
+        fact.emit(OpCode::Return, sp);
+        fact.functions.push_back(
+            FunctionInfo{.entry = 7, .arity = 1, .locals = 1, .max_stack = 3});
+        fact.emit_local(OpCode::LoadLocal, 0, sp);
+        fact.emit_constant(Value::int_v(1), sp);
+        fact.emit(OpCode::LessEqual, sp);
+        fact.emit(OpCode::JumpIfFalse, sp);
+        fact.emit_u16(21);
+        fact.emit_constant(Value::int_v(1), sp);
+        fact.emit(OpCode::Ret, sp);
+        fact.emit_local(OpCode::LoadLocal, 0, sp); // @21
+        fact.emit_local(OpCode::LoadLocal, 0, sp);
+        fact.emit_constant(Value::int_v(1), sp);
+        fact.emit(OpCode::Sub, sp);
+        fact.emit(OpCode::Call, sp);
+        fact.emit_u16(7);
+        fact.emit(OpCode::Mul, sp);
+        fact.emit(OpCode::Ret, sp);
+        if (fact.max_locals != 0 || !PreparedChunk(fact).verified())
+        {
+            fail("expected recursive chunk to need no entry locals and to verify");
+        }
+        expect_everywhere(fact, ok_value(Value::int_v(3628800)), "recursive factorial");
+
+        // Callee slot 0 is its own: main's slot 0 survives the call.
+        Chunk isolated;
+        isolated.emit_constant(Value::int_v(10), sp);
+        isolated.emit_local(OpCode::StoreLocal, 0, sp);
+        isolated.emit(OpCode::Call, sp);
+        isolated.emit_u16(14);
+        isolated.emit(OpCode::Pop, sp);
+        isolated.emit_local(OpCode::LoadLocal, 0, sp);
+        isolated.emit(OpCode::Return, sp);
+        isolated.emit_constant(Value::int_v(99), sp); // @14
+        isolated.emit_local(OpCode::StoreLocal, 0, sp);
+        isolated.emit_local(OpCode::LoadLocal, 0, sp);
+        isolated.emit(OpCode::Ret, sp);
+        Chunk shared = isolated;
+        isolated.functions.push_back(FunctionInfo{.entry = 14, .locals = 1, .max_stack = 1});
+        expect_everywhere(isolated, ok_value(Value::int_v(10)), "callee frame is isolated");
+
+        // Without a descriptor the callee shares the caller's frame (pre-v3 layout).
+        expect_everywhere(shared, ok_value(Value::int_v(99)), "shared frame without descriptor");
+
+        // Frame-relative bounds: the callee frame has one slot.
+        Chunk out_of_frame = isolated;
+        out_of_frame.code[21] = 1; // LoadLocal 0 -> LoadLocal 1 inside the callee
+        expect_everywhere(out_of_frame, error("local index out of range"),
+                          "callee local out of range");
+        if (PreparedChunk(out_of_frame).verified())
+        {
+            fail("expected verifier to reject a local outside the callee frame");
+        }
+
+        // Not enough arguments on the stack for the callee's arity.
+        Chunk missing_arg;
+        missing_arg.emit(OpCode::Call, sp);
+        missing_arg.emit_u16(4);
+        missing_arg.emit(OpCode::Return, sp);
+        missing_arg.emit_local(OpCode::LoadLocal, 0, sp); // @4
+        missing_arg.emit(OpCode::Ret, sp);
+        missing_arg.functions.push_back(FunctionInfo{.entry = 4, .arity = 1, .locals = 1});
+        expect_everywhere(missing_arg, error("stack underflow"), "missing argument");
+    }
+
     // Cover success paths for comparisons and JumpIfFalse (cond=true => no jump).
     {
         Chunk chunk;
@@ -376,7 +993,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         const curlee::source::Span span{.start = 10, .end = 20};
         chunk.emit(OpCode::Jump, span);
-        chunk.emit_u16(999, span);
+        chunk.emit_u16(999);
         chunk.emit_constant(Value::int_v(1));
         chunk.emit(OpCode::Return);
 
@@ -424,6 +1041,33 @@ int main(int argc, char** argv)
         {
             fail("expected print to succeed with io:stdout capability");
         }
+
+        // The string set resolves once to a mask; unknown names contribute no bit.
+        namespace rt = curlee::runtime;
+        VM::Capabilities mixed = {"io:stdout", "python:sandbox", "net:raw"};
+        const auto mask = rt::resolve_capabilities(mixed);
+        if (mask != (rt::capability_bit(rt::Capability::IoStdout) |
+                     rt::capability_bit(rt::Capability::PythonSandbox)) ||
+            rt::has_capability(mask, rt::Capability::PythonFfi))
+        {
+            fail("expected known capability names to resolve to their bits");
+        }
+        for (std::size_t i = 0; i < rt::kCapabilityNames.size(); ++i)
+        {
+            if (rt::capability_from_name(rt::kCapabilityNames[i]) != static_cast<rt::Capability>(i))
+            {
+                fail("expected the capability registry to round-trip names");
+            }
+        }
+
+        const auto by_mask = vm.run(chunk, 100, mask);
+        const auto by_names = vm.run(chunk, 100, mixed);
+        const auto masked_out = vm.run(chunk, 100, ~rt::capability_bit(rt::Capability::IoStdout));
+        if (!by_mask.ok || !by_names.ok || !(by_mask.value == by_names.value) || masked_out.ok ||
+            masked_out.error != "missing capability io:stdout")
+        {
+            fail("expected mask and name-set runs to gate print identically");
+        }
     }
 
     {
@@ -517,7 +1161,7 @@ int main(int argc, char** argv)
         const curlee::source::Span span{.start = 3, .end = 4};
         Chunk chunk;
         chunk.emit(OpCode::Constant, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit(OpCode::Return, span);
 
         VM vm;
@@ -556,7 +1200,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.max_locals = 1;
         chunk.emit(OpCode::LoadLocal, span);
-        chunk.emit_u16(9, span);
+        chunk.emit_u16(9);
         chunk.emit(OpCode::Return, span);
         VM vm;
         const auto res = vm.run(chunk);
@@ -571,7 +1215,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.max_locals = 1;
         chunk.emit(OpCode::StoreLocal, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit(OpCode::Return, span);
         VM vm;
         const auto res = vm.run(chunk);
@@ -587,7 +1231,7 @@ int main(int argc, char** argv)
         chunk.max_locals = 1;
         chunk.emit_constant(Value::int_v(1), span);
         chunk.emit(OpCode::StoreLocal, span);
-        chunk.emit_u16(9, span);
+        chunk.emit_u16(9);
         chunk.emit(OpCode::Return, span);
         VM vm;
         const auto res = vm.run(chunk);
@@ -970,7 +1614,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.emit_constant(Value::int_v(1), span);
         chunk.emit(OpCode::JumpIfFalse, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit(OpCode::Return, span);
 
         VM vm;
@@ -996,13 +1640,13 @@ int main(int argc, char** argv)
         const curlee::source::Span span{.start = 84, .end = 85};
         Chunk chunk;
         chunk.code.push_back(0xFF);
-        chunk.spans.push_back(span);
+        chunk.spans.add(0, span);
         chunk.emit_constant(Value::int_v(5), span);
         chunk.emit(OpCode::Return, span);
 
         VM vm;
         const auto res = vm.run(chunk);
-        if (!res.ok || res.value.kind != ValueKind::Int || res.value.int_value != 5)
+        if (!res.ok || res.value.kind != ValueKind::Int || res.value.as_int() != 5)
         {
             fail("expected unknown opcode to be skipped and return 5");
         }
@@ -1091,7 +1735,7 @@ int main(int argc, char** argv)
 
         VM vm;
         const auto res = vm.run(chunk);
-        if (!res.ok || res.value.kind != ValueKind::Int || res.value.int_value != 123)
+        if (!res.ok || res.value.kind != ValueKind::Int || res.value.as_int() != 123)
         {
             fail("expected happy-path chunk to return 123");
         }
@@ -1121,7 +1765,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.emit(OpCode::Jump, span);
         const std::size_t patch_pos = chunk.code.size();
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
 
         // Skipped.
         chunk.emit_constant(Value::int_v(1), span);
@@ -1136,7 +1780,7 @@ int main(int argc, char** argv)
 
         VM vm;
         const auto res = vm.run(chunk);
-        if (!res.ok || res.value.kind != ValueKind::Int || res.value.int_value != 7)
+        if (!res.ok || res.value.kind != ValueKind::Int || res.value.as_int() != 7)
         {
             fail("expected Jump to land on return 7");
         }
@@ -1149,7 +1793,7 @@ int main(int argc, char** argv)
         chunk.emit_constant(Value::bool_v(false), span);
         chunk.emit(OpCode::JumpIfFalse, span);
         const std::size_t patch_pos = chunk.code.size();
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
 
         // Not taken (skipped because cond is false and we jump).
         chunk.emit_constant(Value::int_v(1), span);
@@ -1164,7 +1808,7 @@ int main(int argc, char** argv)
 
         VM vm;
         const auto res = vm.run(chunk);
-        if (!res.ok || res.value.kind != ValueKind::Int || res.value.int_value != 99)
+        if (!res.ok || res.value.kind != ValueKind::Int || res.value.as_int() != 99)
         {
             fail("expected JumpIfFalse (false) to jump to 99");
         }
@@ -1176,7 +1820,7 @@ int main(int argc, char** argv)
         chunk.emit_constant(Value::bool_v(true), span);
         chunk.emit(OpCode::JumpIfFalse, span);
         const std::size_t patch_pos = chunk.code.size();
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
 
         chunk.emit_constant(Value::int_v(1), span);
         chunk.emit(OpCode::Return, span);
@@ -1191,7 +1835,7 @@ int main(int argc, char** argv)
 
         VM vm;
         const auto res = vm.run(chunk);
-        if (!res.ok || res.value.kind != ValueKind::Int || res.value.int_value != 1)
+        if (!res.ok || res.value.kind != ValueKind::Int || res.value.as_int() != 1)
         {
             fail("expected JumpIfFalse (true) to not jump and return 1");
         }
@@ -1203,7 +1847,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.emit(OpCode::Call, span);
         const std::size_t patch_pos = chunk.code.size();
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
 
         // After returning from call.
         chunk.emit_constant(Value::int_v(7), span);
@@ -1220,7 +1864,7 @@ int main(int argc, char** argv)
 
         VM vm;
         const auto res = vm.run(chunk);
-        if (!res.ok || res.value.kind != ValueKind::Int || res.value.int_value != 7)
+        if (!res.ok || res.value.kind != ValueKind::Int || res.value.as_int() != 7)
         {
             fail("expected Call/Ret to return 7");
         }
@@ -1261,7 +1905,7 @@ int main(int argc, char** argv)
         const curlee::source::Span span{.start = 70, .end = 71};
         Chunk chunk;
         chunk.emit(OpCode::Constant, span);
-        chunk.emit_u16(999, span);
+        chunk.emit_u16(999);
         chunk.emit(OpCode::Return, span);
 
         VM vm;
@@ -1290,7 +1934,7 @@ int main(int argc, char** argv)
         const curlee::source::Span span{.start = 74, .end = 75};
         Chunk chunk;
         chunk.emit(OpCode::LoadLocal, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit(OpCode::Return, span);
 
         VM vm;
@@ -1319,7 +1963,7 @@ int main(int argc, char** argv)
         const curlee::source::Span span{.start = 78, .end = 79};
         Chunk chunk;
         chunk.emit(OpCode::StoreLocal, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit(OpCode::Return, span);
 
         VM vm;
@@ -1335,7 +1979,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.emit_constant(Value::int_v(1), span);
         chunk.emit(OpCode::StoreLocal, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit(OpCode::Return, span);
 
         VM vm;
@@ -1390,7 +2034,7 @@ int main(int argc, char** argv)
         const curlee::source::Span span{.start = 64, .end = 65};
         Chunk chunk;
         chunk.emit(OpCode::JumpIfFalse, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit(OpCode::Return, span);
         VM vm;
         const auto res = vm.run(chunk);
@@ -1405,7 +2049,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.emit_constant(Value::int_v(1), span);
         chunk.emit(OpCode::JumpIfFalse, span);
-        chunk.emit_u16(0, span);
+        chunk.emit_u16(0);
         chunk.emit_constant(Value::int_v(2), span);
         chunk.emit(OpCode::Return, span);
         VM vm;
@@ -1421,7 +2065,7 @@ int main(int argc, char** argv)
         Chunk chunk;
         chunk.emit_constant(Value::bool_v(false), span);
         chunk.emit(OpCode::JumpIfFalse, span);
-        chunk.emit_u16(999, span);
+        chunk.emit_u16(999);
         chunk.emit_constant(Value::int_v(1), span);
         chunk.emit(OpCode::Return, span);
         VM vm;
@@ -1448,7 +2092,7 @@ int main(int argc, char** argv)
         const curlee::source::Span span{.start = 72, .end = 73};
         Chunk chunk;
         chunk.emit(OpCode::Call, span);
-        chunk.emit_u16(999, span);
+        chunk.emit_u16(999);
         VM vm;
         const auto res = vm.run(chunk);
         if (res.ok || res.error != "call target out of range")
@@ -1920,6 +2564,24 @@ int main(int argc, char** argv)
             }
         }
 
+        // The real runner stays warm across calls and across VM runs.
+        (void)setenv("CURLEE_PYTHON_RUNNER", runner_real.c_str(), 1);
+        {
+            Chunk twice;
+            twice.emit(OpCode::PythonCall, span);
+            twice.emit(OpCode::PythonCall, span);
+            twice.emit(OpCode::Return, span);
+            for (int run = 0; run < 3; ++run)
+            {
+                VM warm_vm;
+                const auto res = warm_vm.run(twice, caps);
+                if (!res.ok || !(res.value == Value::unit_v()))
+                {
+                    fail("expected pooled python calls to succeed: " + res.error);
+                }
+            }
+        }
+
         (void)unsetenv("CURLEE_PYTHON_RUNNER");
         (void)unsetenv("CURLEE_BWRAP");
     }